@@ -0,0 +1,54 @@
+/**
+ * Asset packer
+ *
+ * Concatenates image files into a .gpak (see texture/assetpack.h) so a
+ * sample maps its whole texture set with one open() + one mmap() instead
+ * of opening and reading every file. Files are stored as-is and checked
+ * to be images stb_image can decode.
+ *
+ * Usage: packerBin <output.gpak> <image> [image ...]
+ */
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <texture/assetpack.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: packerBin <output.gpak> <image> [image ...]" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> files(argv + 2, argv + argc);
+    if (!WriteAssetPack(argv[1], files))
+        return -1;
+
+    // read the pack back the way the samples will
+    AssetPack pack;
+    if (!pack.Open(argv[1]))
+        return -1;
+    size_t total = 0;
+    for (unsigned int i = 0; i < pack.EntryCount(); i++)
+    {
+        const AssetPackEntry& entry = pack.Entry(i);
+        EncodedImage image;
+        int width, height, channels;
+        if (!pack.Find(entry.name, image) ||
+            !stbi_info_from_memory(image.bytes, (int)image.size, &width, &height, &channels))
+        {
+            std::cout << "ERROR::ASSETPACK::NOT_AN_IMAGE " << entry.name << std::endl;
+            return -1;
+        }
+        std::cout << "  " << entry.name << ": " << width << "x" << height << "x" << channels
+                  << ", " << entry.size / 1024 << " KB" << std::endl;
+        total += (size_t)entry.size;
+    }
+    std::cout << argv[1] << ": " << pack.EntryCount() << " files, " << total / 1024 << " KB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * BVH benchmark
+ *
+ * Scatters cube shaped objects through a volume that grows with their
+ * number (100k and 1M by default, -count N for one size), then times
+ *
+ *   - Build(), the binned SAH build
+ *   - Refit() after every object moved a little
+ *   - frustum queries from cameras looking through the field, against
+ *     testing every object's bounds in a flat list
+ *   - ray picks from the same cameras, against the flat list
+ *
+ * and checks that the BVH finds exactly what the flat list finds. Query
+ * times are the average of -queries cameras and rays.
+ *
+ * Usage: bvhBenchBin [-count N] [-queries N] [-runs N]
+ */
+#include <scene/bvh.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// best of runs, in ms
+template <class F>
+double best(int runs, F f)
+{
+    double ms = 1e30;
+    for (int r = 0; r < runs; r++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        ms = std::min(ms, elapsedMs(start));
+    }
+    return ms;
+}
+
+struct View {
+    Frustum frustum;
+    Ray ray;
+};
+
+void run(size_t count, int queries, int runs)
+{
+    std::mt19937 random(42);
+    // about 30 objects per 1000 units of volume, like a dense cube field
+    float side = std::cbrt((float)count / 0.03f);
+    std::uniform_real_distribution<float> position(0.0f, side);
+    std::uniform_real_distribution<float> size(0.25f, 1.0f);
+    std::vector<Aabb> bounds(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 half(size(random));
+        bounds[i] = Aabb(center - half, center + half);
+    }
+
+    std::cout << count << " objects in a " << side << " unit cube" << std::endl;
+    Bvh bvh;
+    double buildMs = best(runs, [&]() { bvh.Build(bounds); });
+    std::cout << "  build: " << buildMs << " ms, " << bvh.Nodes() << " nodes" << std::endl;
+
+    std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+    std::vector<Aabb> moved(bounds);
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 offset(jitter(random), jitter(random), jitter(random));
+        moved[i] = Aabb(bounds[i].min + offset, bounds[i].max + offset);
+    }
+    double refitMs = best(runs, [&]() { bvh.Refit(moved); });
+    std::cout << "  refit: " << refitMs << " ms" << std::endl;
+
+    // cameras inside the field looking somewhere, a 45 degree frustum reaching 100 units
+    std::vector<View> views(queries);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    for (int q = 0; q < queries; q++)
+    {
+        glm::vec3 eye(position(random), position(random), position(random));
+        glm::vec3 target(position(random), position(random), position(random));
+        views[q].frustum = Frustum::FromMatrix(projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+        views[q].ray = Ray(eye, glm::normalize(target - eye));
+    }
+
+    std::vector<int> visible, expected;
+    size_t visibleTotal = 0;
+    double bvhQueryMs = best(runs, [&]() {
+        visibleTotal = 0;
+        for (int q = 0; q < queries; q++)
+        {
+            visible.clear();
+            bvh.Query(views[q].frustum, visible);
+            visibleTotal += visible.size();
+        }
+    }) / queries;
+    double flatQueryMs = best(runs, [&]() {
+        for (int q = 0; q < queries; q++)
+        {
+            expected.clear();
+            for (size_t i = 0; i < count; i++)
+                if (views[q].frustum.Intersects(moved[i]))
+                    expected.push_back((int)i);
+        }
+    }) / queries;
+    std::cout << "  frustum query: " << bvhQueryMs << " ms, flat list " << flatQueryMs << " ms ("
+              << flatQueryMs / bvhQueryMs << "x), " << visibleTotal / queries << " objects visible on average" << std::endl;
+
+    std::vector<int> hits(queries);
+    std::vector<float> distances(queries);
+    double bvhRayMs = best(runs, [&]() {
+        for (int q = 0; q < queries; q++)
+            hits[q] = bvh.Raycast(views[q].ray, distances[q]);
+    }) / queries;
+    std::vector<int> flatHits(queries);
+    std::vector<float> flatDistances(queries);
+    double flatRayMs = best(runs, [&]() {
+        for (int q = 0; q < queries; q++)
+        {
+            const Ray& ray = views[q].ray;
+            glm::vec3 inv(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+            float closest = FLT_MAX, t;
+            flatHits[q] = -1;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (RayAabb(ray, inv, moved[i], closest, t) && t < closest)
+                {
+                    closest = t;
+                    flatHits[q] = (int)i;
+                }
+            }
+            flatDistances[q] = closest;
+        }
+    }) / queries;
+    std::cout << "  ray pick: " << bvhRayMs * 1000.0 << " us, flat list " << flatRayMs * 1000.0 << " us ("
+              << flatRayMs / bvhRayMs << "x)" << std::endl;
+
+    // same objects, same hits (a tie between two boxes may go either way)
+    size_t mismatches = 0;
+    for (int q = 0; q < queries; q++)
+    {
+        visible.clear();
+        bvh.Query(views[q].frustum, visible);
+        expected.clear();
+        for (size_t i = 0; i < count; i++)
+            if (views[q].frustum.Intersects(moved[i]))
+                expected.push_back((int)i);
+        std::sort(visible.begin(), visible.end());
+        if (visible != expected)
+            mismatches++;
+        if ((hits[q] < 0) != (flatHits[q] < 0) || (hits[q] >= 0 && distances[q] != flatDistances[q]))
+            mismatches++;
+    }
+    if (mismatches)
+        std::cout << "ERROR::BVHBENCH::MISMATCH " << mismatches << " queries differ from the flat list" << std::endl;
+    else
+        std::cout << "  queries match the flat list" << std::endl;
+}
+
+int main(int argc, char const *argv[])
+{
+    size_t count = 0;
+    int queries = 100, runs = 3;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "-count") == 0)
+            count = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "-queries") == 0)
+            queries = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-runs") == 0)
+            runs = std::max(1, atoi(argv[++i]));
+    }
+    if (count)
+        run(count, queries, runs);
+    else
+    {
+        run(100000, queries, runs);
+        run(1000000, queries, runs);
+    }
+    return 0;
+}
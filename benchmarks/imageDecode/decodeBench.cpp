@@ -0,0 +1,324 @@
+/**
+ * Image decode benchmark
+ *
+ * Compares the decode backends of texture/imagedecode.h on the sample
+ * textures one by one: stb_image against the JPEG decoder with each SIMD
+ * kernel on one thread and with the best kernel on all of them, checking
+ * that every backend returns stb's pixels. The same runs on large
+ * generated JPEGs (capture/jpegwrite.h) with and without restart markers,
+ * which is where one image on several threads pays off. Then a
+ * synthetic bulk-load corpus made of many
+ * copies of them (each copy is decoded from its own buffer, like a real
+ * asset set would be). The serial batch is run twice, with stb_image
+ * allocating from the heap and from a per-thread arena reset after each
+ * image (texture/stbi_arena.h), and the allocation counters are printed.
+ * Finally the whole image set is loaded from disk through stdio
+ * (stbi_load), through per-file mappings (DecodeImageFile) and, with
+ * -pack, out of a single mapped asset pack (see assetPacker).
+ *
+ * Usage: decodeBenchBin [-copies N] [-threads N] [-runs N] [-size N] [-pack file.gpak] [image ...]
+ *
+ *     -size N      edge of the generated JPEGs, 0 skips them (default 4096)
+ */
+#include <texture/stbi_arena.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <texture/imagedecode.h>
+#include <texture/assetpack.h>
+#include <capture/jpegwrite.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Timing {
+    double bestMs;
+    size_t pixels;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Decodes one image at a time inside an arena scope, releasing the pixels before the next
+class ArenaStbDecoder : public StbDecoder
+{
+public:
+    const char* Name() const { return "stb_image arena"; }
+
+    void DecodeBatch(const std::vector<EncodedImage>& in, int desiredChannels, std::vector<DecodedImage>& out){
+        out.resize(in.size());
+        for (size_t i = 0; i < in.size(); i++)
+        {
+            StbiArenaScope arena;
+            Decode(in[i], desiredChannels, out[i]);
+            consume(out[i]);
+        }
+    }
+
+    // stand-in for the upload; afterwards pixels is only tested against NULL
+    static void consume(DecodedImage& image){
+        volatile unsigned char sink = image.pixels ? image.pixels[0] : 0;
+        (void)sink;
+        stbi_image_free(image.pixels);
+    }
+};
+
+Timing runBatch(ImageDecoder& decoder, const std::vector<EncodedImage>& corpus, int runs, bool consumed = false)
+{
+    Timing timing;
+    timing.bestMs = 1e30;
+    timing.pixels = 0;
+    for (int r = 0; r < runs; r++)
+    {
+        std::vector<DecodedImage> out;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        decoder.DecodeBatch(corpus, 0, out);
+        timing.bestMs = std::min(timing.bestMs, elapsedMs(start));
+
+        timing.pixels = 0;
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            if (!out[i].pixels)
+                std::cout << "decode failed: " << stbi_failure_reason() << std::endl;
+            timing.pixels += (size_t)out[i].width * out[i].height;
+            if (!consumed)
+                FreeDecodedImage(out[i]);
+        }
+    }
+    return timing;
+}
+
+void report(const char* what, const ImageDecoder& decoder, const Timing& t, size_t images)
+{
+    std::cout << "  " << what << " [" << decoder.Name() << "]: " << t.bestMs << " ms, "
+              << images / (t.bestMs / 1000.0) << " images/s, "
+              << t.pixels / (t.bestMs * 1000.0) << " Mpixel/s" << std::endl;
+}
+
+// Whether the decoder returns stb_image's pixels for every channel count
+bool sameAsStb(ImageDecoder& decoder, const EncodedImage& in)
+{
+    StbDecoder stb;
+    for (int channels = 0; channels <= 4; channels++)
+    {
+        DecodedImage expected, image;
+        bool same = stb.Decode(in, channels, expected) && decoder.Decode(in, channels, image) &&
+                    image.width == expected.width && image.height == expected.height && image.channels == expected.channels &&
+                    memcmp(image.pixels, expected.pixels, (size_t)image.width * image.height * image.channels) == 0;
+        FreeDecodedImage(expected);
+        FreeDecodedImage(image);
+        if (!same)
+            return false;
+    }
+    return true;
+}
+
+// One image through every decoder; the first one is stb_image, the baseline
+void compareDecoders(const std::string& label, const std::vector<unsigned char>& file,
+                     const std::vector<std::unique_ptr<ImageDecoder> >& decoders, int runs)
+{
+    std::vector<EncodedImage> one(1);
+    one[0].bytes = file.data();
+    one[0].size = file.size();
+    std::cout << label << " (" << file.size() / 1024 << " KB)" << std::endl;
+    double baseMs = 0.0;
+    for (size_t d = 0; d < decoders.size(); d++)
+    {
+        Timing t = runBatch(*decoders[d], one, runs);
+        report("decode", *decoders[d], t, 1);
+        if (d == 0)
+            baseMs = t.bestMs;
+        else
+            std::cout << "    " << baseMs / t.bestMs << "x stb_image, "
+                      << (sameAsStb(*decoders[d], one[0]) ? "same pixels" : "PIXELS DIFFER") << std::endl;
+    }
+}
+
+// Smooth gradients under fine noise, roughly what a photo texture costs to entropy decode
+std::vector<unsigned char> generateImage(int size, int channels)
+{
+    std::vector<unsigned char> pixels((size_t)size * size * channels);
+    uint32_t seed = 12345;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                float v = 128.0f + 60.0f * std::sin(x * 0.013f * (c + 1) + y * 0.007f) +
+                          40.0f * std::sin((x - y) * 0.002f * (3 - c)) + (float)(seed >> 27) - 16.0f;
+                pixels[((size_t)y * size + x) * channels + c] = (unsigned char)std::min(255.0f, std::max(0.0f, v));
+            }
+        }
+    }
+    return pixels;
+}
+
+enum FileInput {
+    INPUT_STDIO,
+    INPUT_MMAP,
+    INPUT_PACK
+};
+
+// Best time to load and decode every path, each run opening the files (or the pack) again
+double loadSet(FileInput input, const std::vector<std::string>& paths, const char* packPath, int runs)
+{
+    double best = 1e30;
+    for (int r = 0; r < runs; r++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        AssetPack pack;
+        if (input == INPUT_PACK && !pack.Open(packPath))
+            return 0.0;
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            DecodedImage image;
+            bool ok;
+            if (input == INPUT_STDIO)
+            {
+                image.pixels = stbi_load(paths[i].c_str(), &image.width, &image.height, &image.channels, 0);
+                ok = image.pixels != NULL;
+            }
+            else if (input == INPUT_MMAP)
+                ok = DecodeImageFile(paths[i], 0, image);
+            else
+            {
+                EncodedImage packed;
+                ok = pack.Find(paths[i], packed) && DecodeImage(packed, 0, image);
+            }
+            if (!ok)
+                std::cout << "load failed: " << paths[i] << std::endl;
+            FreeDecodedImage(image);
+        }
+        best = std::min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+int main(int argc, char const *argv[])
+{
+    int copies = 64;
+    int runs = 3;
+    unsigned int threads = 0;
+    int size = 4096;
+    const char* packPath = NULL;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-copies") == 0 && i + 1 < argc)
+            copies = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+            threads = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-runs") == 0 && i + 1 < argc)
+            runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+            size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-pack") == 0 && i + 1 < argc)
+            packPath = argv[++i];
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.empty())
+    {
+        paths.push_back("../../textures/container.jpg");
+        paths.push_back("../../textures/wall.jpg");
+    }
+
+    std::vector<std::vector<unsigned char> > files;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        files.push_back(ReadFileBytes(paths[i]));
+        if (files.back().empty())
+        {
+            std::cout << "Failed to read " << paths[i] << std::endl;
+            return -1;
+        }
+    }
+
+    StbDecoder stb;
+    ArenaStbDecoder arenaStb;
+    ParallelStbDecoder parallel(threads);
+    JpegStbDecoder jpeg(threads);
+
+    // stb_image, every kernel on one thread, the best one on all threads
+    std::vector<std::unique_ptr<ImageDecoder> > decoders;
+    decoders.push_back(std::unique_ptr<ImageDecoder>(new StbDecoder()));
+    JpegKernel kernels[3] = {JPEG_KERNEL_SCALAR, JPEG_KERNEL_SSE2, JPEG_KERNEL_AVX2};
+    for (int k = 0; k < 3; k++)
+        if (JpegKernelSupported(kernels[k]))
+            decoders.push_back(std::unique_ptr<ImageDecoder>(new JpegStbDecoder(1, kernels[k])));
+    decoders.push_back(std::unique_ptr<ImageDecoder>(new JpegStbDecoder(threads)));
+
+    std::cout << "Single images (best of " << runs << "):" << std::endl;
+    for (size_t i = 0; i < files.size(); i++)
+        compareDecoders(paths[i], files[i], decoders, runs);
+
+    if (size > 0)
+    {
+        // restart markers every MCU row, like camera files, and once without any
+        std::vector<unsigned char> rgb = generateImage(size, 3);
+        std::vector<unsigned char> grey = generateImage(size, 1);
+        std::string edge = std::to_string(size) + "x" + std::to_string(size);
+        std::cout << "Generated images (best of " << runs << "):" << std::endl;
+        compareDecoders(edge + " 4:2:0, restart every MCU row",
+                        EncodeJPEG(rgb.data(), size, size, 3, 90, true, (size + 15) / 16), decoders, runs);
+        compareDecoders(edge + " 4:4:4, restart every MCU row",
+                        EncodeJPEG(rgb.data(), size, size, 3, 90, false, (size + 7) / 8), decoders, runs);
+        compareDecoders(edge + " grey, restart every MCU row",
+                        EncodeJPEG(grey.data(), size, size, 1, 90, false, (size + 7) / 8), decoders, runs);
+        compareDecoders(edge + " 4:2:0, no restart markers",
+                        EncodeJPEG(rgb.data(), size, size, 3, 90, true, 0), decoders, runs);
+    }
+
+    // every copy gets its own buffer so no decode reads another's cache lines
+    std::vector<std::vector<unsigned char> > corpusFiles;
+    for (int c = 0; c < copies; c++)
+        for (size_t i = 0; i < files.size(); i++)
+            corpusFiles.push_back(files[i]);
+    std::vector<EncodedImage> corpus(corpusFiles.size());
+    size_t corpusBytes = 0;
+    for (size_t i = 0; i < corpusFiles.size(); i++)
+    {
+        corpus[i].bytes = corpusFiles[i].data();
+        corpus[i].size = corpusFiles[i].size();
+        corpusBytes += corpus[i].size;
+    }
+
+    std::cout << "Corpus: " << corpus.size() << " images, " << corpusBytes / (1024 * 1024) << " MB encoded" << std::endl;
+    StbiAllocStats before = GetStbiAllocStats();
+    Timing serial = runBatch(stb, corpus, runs);
+    StbiAllocStats afterHeap = GetStbiAllocStats();
+    Timing arena = runBatch(arenaStb, corpus, runs, true);
+    StbiAllocStats afterArena = GetStbiAllocStats();
+    Timing threaded = runBatch(parallel, corpus, runs);
+    Timing split = runBatch(jpeg, corpus, runs);
+    report("batch", stb, serial, corpus.size());
+    report("batch", arenaStb, arena, corpus.size());
+    report("batch", parallel, threaded, corpus.size());
+    report("batch", jpeg, split, corpus.size());
+    std::cout << "  speedup: " << serial.bestMs / threaded.bestMs << "x across images, "
+              << serial.bestMs / split.bestMs << "x within images" << std::endl;
+    std::cout << "  heap:  " << afterHeap.heapAllocs - before.heapAllocs << " malloc, "
+              << afterHeap.heapFrees - before.heapFrees << " free" << std::endl;
+    std::cout << "  arena: " << afterArena.heapAllocs - afterHeap.heapAllocs << " malloc, "
+              << afterArena.arenaBlocks - afterHeap.arenaBlocks << " arena blocks, "
+              << afterArena.arenaAllocs - afterHeap.arenaAllocs << " bump allocations" << std::endl;
+    PrintStbiAllocStats();
+
+    std::cout << "File input, " << paths.size() << " images (best of " << runs << "):" << std::endl;
+    std::cout << "  stdio (stbi_load): " << loadSet(INPUT_STDIO, paths, packPath, runs) << " ms" << std::endl;
+    std::cout << "  mmap per file:     " << loadSet(INPUT_MMAP, paths, packPath, runs) << " ms" << std::endl;
+    if (packPath)
+        std::cout << "  asset pack:        " << loadSet(INPUT_PACK, paths, packPath, runs) << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * Scene graph update benchmark
+ *
+ * Builds a forest of -roots trees, -branch children per node and -depth
+ * levels below each root (32 x 8^4, about 150k nodes, by default), added
+ * depth first so SceneGraph has to sort them, and times:
+ *
+ *   - a pointer tree, heap nodes with child vectors updated recursively,
+ *     what ad hoc per sample code grows into
+ *   - SceneGraph with every root moved (the whole graph is recomputed)
+ *   - SceneGraph with -dirty percent of the nodes moved
+ *   - SceneGraph with nothing moved
+ *
+ * for 1 and -threads update threads, best of -runs, and checks that both
+ * hierarchies end with the same world matrices. Finally it checks that
+ * levels which do not split evenly over 4 update threads are recomputed
+ * to the last node.
+ *
+ * Usage: sceneGraphBenchBin [-roots N] [-branch N] [-depth N] [-dirty percent] [-threads N] [-runs N]
+ */
+#include <scene/scenegraph.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct PointerNode {
+    glm::mat4 local;
+    glm::mat4 world;
+    std::vector<std::unique_ptr<PointerNode> > children;
+};
+
+void updatePointerTree(PointerNode& node, const glm::mat4& parent)
+{
+    node.world = parent * node.local;
+    for (size_t i = 0; i < node.children.size(); i++)
+        updatePointerTree(*node.children[i], node.world);
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// best of runs, in ms; prepare() is not timed
+template <class P, class F>
+double best(int runs, P prepare, F f)
+{
+    double ms = 1e30;
+    for (int r = 0; r < runs; r++)
+    {
+        prepare();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        ms = std::min(ms, elapsedMs(start));
+    }
+    return ms;
+}
+
+struct Builder {
+    std::mt19937 random;
+    std::uniform_real_distribution<float> unit;
+    int branch;
+    int depth;
+    std::vector<SceneNode> nodes;               // graph node of every pointer node, depth first
+    std::vector<PointerNode*> pointerNodes;
+
+    Builder(int branch, int depth) : random(42), unit(-1.0f, 1.0f), branch(branch), depth(depth) {}
+
+    glm::mat4 randomLocal(){
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(unit(random), unit(random), unit(random)));
+        return glm::rotate(m, unit(random), glm::vec3(0.3f, 1.0f, 0.5f));
+    }
+
+    // depth first, so the graph gets children before their parent's siblings
+    void add(SceneGraph& graph, SceneNode parent, PointerNode& pointer, int level){
+        pointer.local = randomLocal();
+        SceneNode node = graph.Add(parent, pointer.local);
+        nodes.push_back(node);
+        pointerNodes.push_back(&pointer);
+        if (level == depth)
+            return;
+        for (int c = 0; c < branch; c++)
+        {
+            pointer.children.push_back(std::unique_ptr<PointerNode>(new PointerNode()));
+            add(graph, node, *pointer.children.back(), level + 1);
+        }
+    }
+};
+
+// One root with children wide levels, on 4 threads: every child must be recomputed
+bool checkUnevenLevel(size_t children)
+{
+    SceneGraph graph(4);
+    SceneNode root = graph.Add(SCENE_NO_PARENT, glm::mat4(1.0f));
+    std::vector<SceneNode> nodes;
+    for (size_t i = 0; i < children; i++)
+        nodes.push_back(graph.Add(root, glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, 0.0f))));
+    graph.Update();
+    glm::mat4 moved = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    graph.SetLocal(root, moved);
+    size_t updated = graph.Update();
+    size_t stale = 0;
+    for (size_t i = 0; i < children; i++)
+    {
+        glm::mat4 expected = moved * graph.Local(nodes[i]);
+        const glm::mat4& world = graph.World(nodes[i]);
+        float worst = 0.0f;
+        for (int c = 0; c < 4; c++)
+            for (int k = 0; k < 4; k++)
+                worst = std::max(worst, std::fabs(world[c][k] - expected[c][k]));
+        if (worst > 1e-5f)
+            stale++;
+    }
+    std::cout << "  " << children << " children on " << graph.Threads() << " threads: " << updated
+              << " nodes recomputed, " << stale << " stale" << std::endl;
+    return updated == children + 1 && stale == 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    int roots = 32, branch = 8, depth = 4, runs = 20;
+    float dirtyPercent = 1.0f;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "-roots") == 0)
+            roots = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-branch") == 0)
+            branch = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-depth") == 0)
+            depth = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-dirty") == 0)
+            dirtyPercent = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0)
+            threads = (unsigned int)std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-runs") == 0)
+            runs = std::max(1, atoi(argv[++i]));
+    }
+
+    Builder builder(branch, depth);
+    std::vector<PointerNode> pointerRoots(roots);
+    std::vector<unsigned int> threadCounts;
+    threadCounts.push_back(1);
+    if (threads > 1)
+        threadCounts.push_back(threads);
+
+    for (size_t t = 0; t < threadCounts.size(); t++)
+    {
+        SceneGraph graph(threadCounts[t]);
+        builder.nodes.clear();
+        builder.pointerNodes.clear();
+        builder.random.seed(42);
+        for (int r = 0; r < roots; r++)
+        {
+            pointerRoots[r].children.clear();
+            builder.add(graph, SCENE_NO_PARENT, pointerRoots[r], 0);
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        graph.Update();
+        double firstMs = elapsedMs(start);
+
+        const std::vector<SceneNode>& nodes = builder.nodes;
+        const std::vector<PointerNode*>& pointerNodes = builder.pointerNodes;
+        size_t count = nodes.size();
+        if (t == 0)
+        {
+            std::cout << count << " nodes (" << roots << " roots, " << branch << " children, " << depth
+                      << " levels down), best of " << runs << " runs" << std::endl;
+            double pointerMs = best(runs, []() {}, [&]() {
+                for (int r = 0; r < roots; r++)
+                    updatePointerTree(pointerRoots[r], glm::mat4(1.0f));
+            });
+            std::cout << "  pointer tree, everything: " << pointerMs << " ms" << std::endl;
+        }
+        std::cout << "SceneGraph, " << graph.Threads() << " thread(s), first update with the sort "
+                  << firstMs << " ms" << std::endl;
+
+        // moving the roots dirties everything below them
+        size_t updated = 0;
+        std::vector<SceneNode> rootNodes;
+        for (size_t i = 0; i < count; i++)
+            if (graph.Parent(nodes[i]) == SCENE_NO_PARENT)
+                rootNodes.push_back(nodes[i]);
+        double fullMs = best(runs, [&]() {
+            for (size_t r = 0; r < rootNodes.size(); r++)
+                graph.SetLocal(rootNodes[r], graph.Local(rootNodes[r]));
+        }, [&]() { updated = graph.Update(); });
+        std::cout << "  every root moved: " << fullMs << " ms, " << updated << " nodes recomputed" << std::endl;
+
+        std::mt19937 random(7);
+        std::uniform_int_distribution<size_t> pick(0, count - 1);
+        size_t moved = std::max<size_t>(1, (size_t)(count * dirtyPercent / 100.0f));
+        double sparseMs = best(runs, [&]() {
+            for (size_t i = 0; i < moved; i++)
+            {
+                SceneNode node = nodes[pick(random)];
+                graph.SetLocal(node, graph.Local(node));
+            }
+        }, [&]() { updated = graph.Update(); });
+        std::cout << "  " << moved << " random nodes moved: " << sparseMs << " ms, " << updated
+                  << " nodes recomputed" << std::endl;
+
+        double cleanMs = best(runs, [&]() { graph.Update(); }, [&]() { updated = graph.Update(); });
+        std::cout << "  nothing moved: " << cleanMs << " ms" << std::endl;
+
+        for (int r = 0; r < roots; r++)
+            updatePointerTree(pointerRoots[r], glm::mat4(1.0f));
+        float worst = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            const glm::mat4& a = graph.World(nodes[i]);
+            const glm::mat4& b = pointerNodes[i]->world;
+            for (int c = 0; c < 4; c++)
+                for (int k = 0; k < 4; k++)
+                    worst = std::max(worst, std::fabs(a[c][k] - b[c][k]));
+        }
+        std::cout << "  max difference from the pointer tree " << worst << std::endl;
+    }
+
+    std::cout << "Uneven levels:" << std::endl;
+    bool ok = checkUnevenLevel(4097);
+    ok = checkUnevenLevel(8195) && ok;
+    if (!ok)
+    {
+        std::cout << "ERROR::SCENEGRAPH::STALE_NODES" << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,295 @@
+/**
+ * Software rasterizer benchmark
+ *
+ * Renders the scenes of the textured samples with SoftRasterizer
+ * (softraster/softraster.h), no GL involved, at every thread count from
+ * one to the number of cores, and prints frame times, fill rate and the
+ * speedup over one thread:
+ *
+ *     coords   the rotating quad of coords/coords.cpp
+ *     camera   the cube of camera/cameraC.cpp on the --bench orbit
+ *     cubes    a grid of camera's cube, a few thousand triangles, to load
+ *              the front end (transform, clip, setup, binning) as well
+ *
+ * Scene time advances 1/60 s per frame as with --bench, so frame N here is
+ * frame N of the samples: -png writes the last frame of each scene as
+ * dir/<scene>.soft.png, -golden checks it against the sample's GL capture
+ * of that frame (one scene at a time).
+ *
+ * Before timing anything it checks that a quad covering a 801, 802 and
+ * 803 pixel wide image counts each pixel exactly once.
+ *
+ * The llvmpipe side of the comparison is the samples' own benchmark,
+ * "make bench-soft" in benchmarks/frameBench runs both rasterizers there.
+ *
+ * Usage: softRasterBench [-size WxH] [-frames N] [-threads N] [-grid N] [-png dir/] [-golden file.png]
+ *                        [scene ...]
+ */
+#include <texture/stbi_arena.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <softraster/softraster.h>
+#include <capture/pngwrite.h>
+#include <capture/golden.h>
+#include <camera.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// camera/cameraC.cpp's cube: position, texture coordinates
+static const float cubeVertices[] = {
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+};
+
+// coords/coords.cpp's quad: position, color, texture coordinates
+static const float quadVertices[] = {
+     0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,
+     0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,
+    -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f
+};
+
+struct SceneTiming {
+    double meanMs;
+    double bestMs;
+    SoftRasterStats stats;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One frame of a scene at time t, as the sample draws it
+void drawScene(const std::string& scene, SoftRasterizer& raster, const SoftTexture& texture, double t, int grid)
+{
+    float aspect = (float)raster.Width() / (float)raster.Height();
+    raster.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+    raster.BindTexture(&texture);
+    if (scene == "coords")
+    {
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        glm::mat4 fun = glm::rotate(glm::mat4(1.0f), (float)t * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
+        // the sample asks glDrawArrays for 36 vertices of this 4 vertex buffer; only the
+        // first triangle is made of real vertices, so that is what is drawn here
+        raster.DrawArrays(quadVertices, 8, 0, 6, 0, 3, fun * projection * view * model);
+        return;
+    }
+    // FrameBenchmark::ScriptCamera's orbit
+    Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+    float angle = (float)(t * 2.0 * 3.14159265358979 / 8.0);
+    camera.LookAt(glm::vec3(3.0f * cos(angle), 1.0f, 3.0f * sin(angle)), glm::vec3(0.0f));
+    glm::mat4 viewProjection = glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f) * camera.GetViewMatrix();
+    glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(-55.0f), glm::vec3(1.0f, 0.3f, 0.5f));
+    if (scene == "camera")
+    {
+        raster.DrawArrays(cubeVertices, 5, 0, 3, 0, 36, viewProjection * model);
+        return;
+    }
+    // cubes: grid x grid x grid small cubes filling the camera cube's volume
+    float size = 1.0f / grid;
+    for (int i = 0; i < grid; i++)
+        for (int j = 0; j < grid; j++)
+            for (int k = 0; k < grid; k++)
+            {
+                glm::vec3 offset((i + 0.5f) * size - 0.5f, (j + 0.5f) * size - 0.5f, (k + 0.5f) * size - 0.5f);
+                glm::mat4 cube = glm::scale(glm::translate(model, offset), glm::vec3(size * 0.8f));
+                raster.DrawArrays(cubeVertices, 5, 0, 3, 0, 36, viewProjection * cube);
+            }
+}
+
+// A quad past every edge of an image whose width is not a multiple of 4
+// covers each pixel once: no 4 pixel step may count, or write, the padding
+bool checkFragmentCount(unsigned int threads)
+{
+    static const float screenQuad[] = {
+        -2.0f, -2.0f, 0.0f,  0.0f, 0.0f,
+         2.0f, -2.0f, 0.0f,  1.0f, 0.0f,
+         2.0f,  2.0f, 0.0f,  1.0f, 1.0f,
+         2.0f,  2.0f, 0.0f,  1.0f, 1.0f,
+        -2.0f,  2.0f, 0.0f,  0.0f, 1.0f,
+        -2.0f, -2.0f, 0.0f,  0.0f, 0.0f
+    };
+    const int widths[] = {801, 802, 803};
+    for (int i = 0; i < 3; i++)
+    {
+        SoftRasterizer raster(widths[i], 61, threads);
+        raster.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+        raster.DrawArrays(screenQuad, 5, 0, 3, 0, 6, glm::mat4(1.0f));
+        raster.Flush();
+        uint64_t expected = (uint64_t)widths[i] * 61;
+        if (raster.Stats().fragments != expected)
+        {
+            std::cout << "ERROR::SOFTRASTERBENCH::FRAGMENT_COUNT " << widths[i] << "x61: " << raster.Stats().fragments
+                      << " fragments, expected " << expected << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+SceneTiming runScene(const std::string& scene, SoftRasterizer& raster, const SoftTexture& texture, int frames, int grid)
+{
+    SceneTiming timing;
+    timing.bestMs = 1e30;
+    double total = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        drawScene(scene, raster, texture, frame / 60.0, grid);
+        raster.Flush();
+        double ms = elapsedMs(start);
+        total += ms;
+        timing.bestMs = std::min(timing.bestMs, ms);
+    }
+    timing.meanMs = total / frames;
+    timing.stats = raster.Stats();
+    return timing;
+}
+
+int main(int argc, char const *argv[])
+{
+    int width = 800, height = 600, frames = 121, grid = 8;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string pngPrefix, goldenPath;
+    std::vector<std::string> scenes;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+            sscanf(argv[++i], "%dx%d", &width, &height);
+        else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+            frames = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+            maxThreads = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-grid") == 0 && i + 1 < argc)
+            grid = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-png") == 0 && i + 1 < argc)
+            pngPrefix = argv[++i];
+        else if (strcmp(argv[i], "-golden") == 0 && i + 1 < argc)
+            goldenPath = argv[++i];
+        else
+            scenes.push_back(argv[i]);
+    }
+    if (scenes.empty())
+    {
+        scenes.push_back("coords");
+        scenes.push_back("camera");
+        scenes.push_back("cubes");
+    }
+
+    SoftTexture texture;
+    if (!texture.Load("../../textures/container.jpg"))
+        return 1;
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    if (!checkFragmentCount(maxThreads))
+        return 1;
+
+    std::cout << width << "x" << height << ", " << frames << " frames per run, " << SoftRasterizer::TILE << "x"
+              << SoftRasterizer::TILE << " tiles" << std::endl;
+    bool ok = true;
+    for (size_t s = 0; s < scenes.size(); s++)
+    {
+        const std::string& scene = scenes[s];
+        if (scene != "coords" && scene != "camera" && scene != "cubes")
+        {
+            std::cout << "unknown scene " << scene << std::endl;
+            return 1;
+        }
+        double singleMs = 0.0;
+        for (size_t t = 0; t < threadCounts.size(); t++)
+        {
+            SoftRasterizer raster(width, height, threadCounts[t]);
+            SceneTiming timing = runScene(scene, raster, texture, frames, grid);
+            if (t == 0)
+                singleMs = timing.meanMs;
+            std::cout << "  " << scene << " " << threadCounts[t] << " threads: " << timing.meanMs << " ms/frame (best "
+                      << timing.bestMs << "), " << 1000.0 / timing.meanMs << " fps, "
+                      << timing.stats.fragments / (timing.meanMs * 1000.0) << " Mpixels/s, "
+                      << timing.stats.rasterized << " triangles in " << timing.stats.binned << " bins, speedup "
+                      << singleMs / timing.meanMs << "x" << std::endl;
+
+            if (t + 1 < threadCounts.size())
+                continue;
+            std::vector<unsigned char> image((size_t)width * height * 3);
+            raster.ReadPixels(image.data(), 3);
+            if (!pngPrefix.empty())
+                ok = WritePNG((pngPrefix + scene + ".soft.png").c_str(), image.data(), width, height, 3) && ok;
+            // -golden is the sample's GL capture of the same frame (make golden-update)
+            if (!goldenPath.empty() && scenes.size() == 1)
+            {
+                int gw, gh, gc;
+                unsigned char* golden = stbi_load(goldenPath.c_str(), &gw, &gh, &gc, 3);
+                if (!golden || gw != width || gh != height)
+                {
+                    std::cout << "ERROR::SOFTRASTERBENCH::GOLDEN_UNUSABLE " << goldenPath << std::endl;
+                    ok = false;
+                }
+                else
+                {
+                    ImageDiff diff = CompareImages(golden, image.data(), width, height, 3, 8);
+                    std::cout << "  against " << goldenPath << ": " << diff.differingPercent << "% pixels differ, max "
+                              << diff.maxDifference << ", mean " << diff.meanDifference << ", PSNR " << diff.psnr
+                              << " dB" << std::endl;
+                }
+                stbi_image_free(golden);
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/**
+ * Vertex transform benchmark
+ *
+ * Transforms a buffer of positions (1M by default) by a projection * view
+ * * model matrix, first the way the samples would with glm (mat4 * vec4
+ * on an array of vec3, and on the same SoA streams the kernels read),
+ * then with every kernel of simd/vtransform.h this CPU runs. Prints the
+ * best time of the runs, throughput, speedup over glm and the largest
+ * difference from glm's result. A million positions are 28 MB of streams
+ * in and out, so there the wide kernels wait on memory; -count 8192 keeps
+ * everything in cache and shows the arithmetic.
+ *
+ * Usage: vtransformBenchBin [-count N] [-runs N]
+ */
+#include <simd/vtransform.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+struct Streams {
+    std::vector<float> x, y, z, w;
+
+    explicit Streams(size_t count) : x(count), y(count), z(count), w(count) {}
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// best of runs, in ms
+template <class F>
+double best(int runs, F f)
+{
+    double ms = 1e30;
+    for (int r = 0; r < runs; r++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        ms = std::min(ms, elapsedMs(start));
+    }
+    return ms;
+}
+
+float maxDifference(const Streams& a, const Streams& b)
+{
+    float worst = 0.0f;
+    for (size_t i = 0; i < a.x.size(); i++)
+    {
+        worst = std::max(worst, std::fabs(a.x[i] - b.x[i]));
+        worst = std::max(worst, std::fabs(a.y[i] - b.y[i]));
+        worst = std::max(worst, std::fabs(a.z[i] - b.z[i]));
+        worst = std::max(worst, std::fabs(a.w[i] - b.w[i]));
+    }
+    return worst;
+}
+
+void report(const char* what, double ms, size_t count, double glmMs, float difference)
+{
+    std::cout << "  " << what << ": " << ms << " ms, " << count / (ms * 1000.0) << " Mvertices/s, "
+              << glmMs / ms << "x glm, max difference " << difference << std::endl;
+}
+
+int main(int argc, char const *argv[])
+{
+    size_t count = 1000000;
+    int runs = 20;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "-count") == 0)
+            count = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "-runs") == 0)
+            runs = std::max(1, atoi(argv[++i]));
+    }
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    Streams in(count);
+    std::vector<glm::vec3> aos(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        aos[i] = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+        in.x[i] = aos[i].x;
+        in.y[i] = aos[i].y;
+        in.z[i] = aos[i].z;
+    }
+    glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(-55.0f), glm::vec3(1.0f, 0.3f, 0.5f));
+    glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 mvp = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f) * view * model;
+
+    std::cout << count << " positions, best of " << runs << " runs, best kernel here: "
+              << VertexKernelName(BestVertexKernel()) << std::endl;
+
+    std::vector<glm::vec4> aosOut(count);
+    double aosMs = best(runs, [&]() {
+        for (size_t i = 0; i < count; i++)
+            aosOut[i] = mvp * glm::vec4(aos[i], 1.0f);
+    });
+    Streams reference(count);
+    double glmMs = best(runs, [&]() {
+        for (size_t i = 0; i < count; i++)
+        {
+            glm::vec4 p = mvp * glm::vec4(in.x[i], in.y[i], in.z[i], 1.0f);
+            reference.x[i] = p.x;
+            reference.y[i] = p.y;
+            reference.z[i] = p.z;
+            reference.w[i] = p.w;
+        }
+    });
+    Streams fromAos(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        fromAos.x[i] = aosOut[i].x;
+        fromAos.y[i] = aosOut[i].y;
+        fromAos.z[i] = aosOut[i].z;
+        fromAos.w[i] = aosOut[i].w;
+    }
+    report("glm, vec3 array", aosMs, count, glmMs, maxDifference(reference, fromAos));
+    report("glm, SoA streams", glmMs, count, glmMs, 0.0f);
+
+    const VertexKernel kernels[] = {VERTEX_KERNEL_SCALAR, VERTEX_KERNEL_SSE, VERTEX_KERNEL_AVX2};
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+        if (!VertexKernelSupported(kernels[k]))
+        {
+            std::cout << "  " << VertexKernelName(kernels[k]) << ": not supported here" << std::endl;
+            continue;
+        }
+        Streams out(count);
+        double ms = best(runs, [&]() {
+            TransformPositions(mvp, in.x.data(), in.y.data(), in.z.data(), count,
+                               out.x.data(), out.y.data(), out.z.data(), out.w.data(), kernels[k]);
+        });
+        report(VertexKernelName(kernels[k]), ms, count, glmMs, maxDifference(reference, out));
+    }
+    return 0;
+}
@@ -16,14 +16,65 @@
 #include <camera.h>
 
 
+/**
+ * stb_image allocations go to per-thread arenas
+ */
+#include <texture/stbi_arena.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+/**
+ * Baked .gtex textures
+ */
+#include <texture/texupload.h>
+#include <texture/asyncload.h>
+
 /**
  * Shader header class
  */
 #include <myshaders/shader_s.h>
 
+/**
+ * Headless benchmark mode
+ */
+#include <bench/framebench.h>
+
+/**
+ * Golden image capture and compare, --capture / --golden
+ */
+#include <capture/golden.h>
+
+/**
+ * Y4M recording of the fly-through, --record file.y4m
+ */
+#include <capture/videocapture.h>
+
+/**
+ * GPU timer scopes
+ */
+#include <profiling/gpuprofiler.h>
+
+/**
+ * CPU trace scopes, --trace file.json
+ */
+#include <profiling/trace.h>
+
+/**
+ * Frame time overlay, F1 toggles it
+ */
+#include <profiling/perfhud.h>
+
+/**
+ * CPU rasterizer backend, --softraster
+ */
+#include <softraster/softrenderer.h>
+
+/**
+ * Transform hierarchy
+ */
+#include <scene/scenegraph.h>
+
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -47,184 +98,278 @@ float lastFrame = 0.0f;
 
 int main(int argc, char const *argv[])
 {
+    // --trace records CPU scopes for chrome://tracing or ui.perfetto.dev (see profiling/trace.h)
+    TraceSession trace(argc, argv);
+
 	// Chore class for day to day openglling
 	/**
 	/ Inits GLFW, GLAD, Window Object
 	/*/
 	Chores chore;
 
-	GLFWwindow* window = chore.CreateWindow();
-    
-    /**
-     * Make window our context and bind the callbacks
-     */
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-
-    /**
-     * Create a "LOOK AT" matrix
-     */
-
-    /**
-     * Init GLAD function pointers
-     */
-    chore.InitGlad();
-
-    glEnable(GL_DEPTH_TEST);
-
-
-    // 3D Cube vertices
-    float vertices[] = {
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-    };
-
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // Point to position, as usual
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // Point to textures!
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    Shader camShader("/home/andrea/opengl/shaders/shaders_src/shaderCamera1.vs", "/home/andrea/opengl/shaders/shaders_src/shaderCamera1.fs");
-    // Activate the shader
-    camShader.use();
-
-    // Generate a texture
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    // Bind it, from now on all texture calls will be redirected to this texture object
-    glBindTexture(GL_TEXTURE_2D, texture);
-    // set the texture wrapping/filtering options (on the currently bound texture object)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);   
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // Load an image with stb_image
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load("../textures/container.jpg", &width, &height, &nrChannels, 0); 
-    if (data){
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }else{
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    //release the image memory
-    stbi_image_free(data);
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(1.0f, 0.3f, 0.5f));
-    camShader.setMat4("model", model);
-    //model = glm::translate(model, glm::vec3(1.0f, 1.0f, 0.0f));
-    /**
-     * Define the look at matrix for camera view FIXED METHOD
-     */
-    // glm::mat4 view;
-    // view  = glm::lookAt(
-    //             glm::vec3(0.0f, 2.0f, 3.0f), // camera position
-    //             glm::vec3(0.0f, 0.0f, 0.0f), // camera direction
-    //             glm::vec3(0.0f, 1.0f, 0.0f)  // up vector in world space
-    //         );
-    
-
-    // glm::mat4 projection;
-    // projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-
-    // The Loop
-    while (!glfwWindowShouldClose(window))
+    bool goldenOk;
+    // locals of this block own GL objects: it closes before glfwTerminate() so their destructors run with a live context
     {
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        // clear
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        int modelLoc = glGetUniformLocation(camShader.ID, "model");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        // unsigned int viewLoc  = glGetUniformLocation(camShader.ID, "view");
-        // glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        // unsigned int projLoc  = glGetUniformLocation(camShader.ID, "projection");
-        // glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        
-        // pass projection matrix to shader (note that in this case it could change every frame)
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        camShader.setMat4("projection", projection);
-
-        // camera/view transformation
-        glm::mat4 view = camera.GetViewMatrix();
-        camShader.setMat4("view", view);
-
-
-        glBindTexture(GL_TEXTURE_2D, texture);
+        // --bench runs the scene headless and reports frame timings (see bench/framebench.h)
+        FrameBenchmark bench(argc, argv, "camera");
+        bench.HintWindow();
+        // --golden compares one frame with a stored image (see capture/golden.h)
+        GoldenCapture golden(argc, argv);
+        // --record streams every frame as Y4M (see capture/videocapture.h)
+        VideoCapture video(argc, argv);
+        // --softraster draws the scene on the CPU (see softraster/softrenderer.h)
+        SoftRenderer soft(argc, argv);
+
+        GLFWwindow* window = chore.CreateWindow(video.Width(SCR_WIDTH), video.Height(SCR_HEIGHT));
+
+        /**
+         * Make window our context and bind the callbacks
+         */
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+
+        /**
+         * Create a "LOOK AT" matrix
+         */
+
+        /**
+         * Init GLAD function pointers
+         */
+        chore.InitGlad();
+        bench.Start();
+
+        // per pass GPU/CPU timings, read back a few frames late so nothing stalls
+        GpuProfiler profiler;
+
+        // on screen frame stats, one batched draw; kept out of benchmark runs
+        PerfHud hud("/home/andrea/opengl/shaders/shaders_src/hud.vs", "/home/andrea/opengl/shaders/shaders_src/hud.fs");
+        hud.SetVisible(!bench.Enabled());
+
+        glEnable(GL_DEPTH_TEST);
+
+
+        // 3D Cube vertices
+        float vertices[] = {
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+        };
+
+        unsigned int VBO, VAO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
         glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        // Point to position, as usual
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // Point to textures!
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        // Unbind
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        Shader camShader("/home/andrea/opengl/shaders/shaders_src/shaderCamera1.vs", "/home/andrea/opengl/shaders/shaders_src/shaderCamera1.fs");
+        // Activate the shader
+        camShader.use();
+
+        // Prefer the baked texture (see textureBaker, "make bake"): it is mmap'ed and
+        // uploaded with its mip chain, no jpg decode and no glGenerateMipmap
+        unsigned int texture = LoadTexPack("../textures/container.gtex");
+        // Otherwise decode and build the mips on a worker, the loop uploads them once ready
+        std::future<DecodedTexture> pendingTexture;
+        if (!texture)
+            pendingTexture = LoadTextureAsync("../textures/container.jpg");
+        // a golden frame must not depend on how fast the worker was
+        if (golden.Enabled() && pendingTexture.valid())
+            pendingTexture.wait();
+        // the software rasterizer samples its own copy, same image and mip filter
+        SoftTexture softTexture;
+        if (soft.Enabled())
+            softTexture.Load("../textures/container.jpg");
+
+        // the cube is the one node of the scene; setting its local matrix marks it for the next Update()
+        SceneGraph scene;
+        SceneNode cube = scene.Add(SCENE_NO_PARENT, glm::rotate(glm::mat4(1.0f), glm::radians(-55.0f), glm::vec3(1.0f, 0.3f, 0.5f)));
+        scene.Update();
+        glm::mat4 model = scene.World(cube);
+        camShader.setMat4("model", model);
+        //model = glm::translate(model, glm::vec3(1.0f, 1.0f, 0.0f));
+        /**
+         * Define the look at matrix for camera view FIXED METHOD
+         */
+        // glm::mat4 view;
+        // view  = glm::lookAt(
+        //             glm::vec3(0.0f, 2.0f, 3.0f), // camera position
+        //             glm::vec3(0.0f, 0.0f, 0.0f), // camera direction
+        //             glm::vec3(0.0f, 1.0f, 0.0f)  // up vector in world space
+        //         );
+
+
+        // glm::mat4 projection;
+        // projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+
+        // The Loop
+        while (!glfwWindowShouldClose(window) && bench.Running())
+        {
+            TRACE_SCOPE("frame");
+            bench.BeginFrame();
+            profiler.BeginFrame();
+
+            // input
+            // -----
+            {
+                TRACE_SCOPE("input");
+                processInput(window);
+                hud.ToggleOnKey(window, GLFW_KEY_F1);
+                bench.ScriptCamera(camera, glm::vec3(0.0f, 0.0f, 0.0f), 3.0f, 1.0f);
+            }
+
+            // render
+            // ------
+            // clear
+            profiler.Begin("clear");
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            profiler.End();
+
+            profiler.Begin("setup");
+            glm::mat4 projection, view;
+            {
+                TRACE_SCOPE("uniforms");
+                scene.Update();
+                model = scene.World(cube);
+                int modelLoc = glGetUniformLocation(camShader.ID, "model");
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+                // unsigned int viewLoc  = glGetUniformLocation(camShader.ID, "view");
+                // glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+                // unsigned int projLoc  = glGetUniformLocation(camShader.ID, "projection");
+                // glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+
+                // pass projection matrix to shader (note that in this case it could change every frame)
+                int fbWidth, fbHeight;
+                glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+                float aspect = fbHeight > 0 ? (float)fbWidth / (float)fbHeight : (float)SCR_WIDTH / (float)SCR_HEIGHT;
+                projection = glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f);
+                camShader.setMat4("projection", projection);
+
+                // camera/view transformation
+                view = camera.GetViewMatrix();
+                camShader.setMat4("view", view);
+            }
+
+
+            {
+                TRACE_SCOPE("texture upload");
+                if (TextureLoadReady(pendingTexture)){
+                    DecodedTexture decoded = pendingTexture.get();
+                    if (decoded.ok)
+                        texture = UploadMipChain(decoded.levels, decoded.channels, decoded.srgb);
+                }
+            }
+            profiler.End();
+
+            profiler.Begin("draw");
+            {
+                TRACE_SCOPE("draw");
+                if (soft.Enabled())
+                {
+                    SoftRasterizer& raster = soft.Begin(window, 0.0f, 0.0f, 0.0f, 1.0f);
+                    raster.BindTexture(&softTexture);
+                    raster.DrawArrays(vertices, 5, 0, 3, 0, 36, projection * view * model);
+                    soft.Present();
+                }
+                else
+                {
+                    glBindTexture(GL_TEXTURE_2D, texture);
+                    glBindVertexArray(VAO);
+                    glDrawArrays(GL_TRIANGLES, 0, 36);
+                }
+            }
+            profiler.End();
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            // captures are taken before the HUD, so it never shows in goldens or videos
+            golden.Frame(window);
+            video.Frame(window);
+            profiler.Begin("hud");
+            {
+                TRACE_SCOPE("hud");
+                hud.Draw(window);
+            }
+            profiler.End();
+
+            profiler.Begin("swap");
+            {
+                TRACE_SCOPE("swap");
+                glfwSwapBuffers(window);
+            }
+            profiler.End();
+            profiler.EndFrame();
+            bench.EndFrame();
+            glfwPollEvents();
+        }
+
+        profiler.Flush();
+        bench.AddSection("gpu_scopes", profiler.ReportJSON());
+        bench.AddSection("rasterizer", soft.Enabled() ? "\"software\"" : "\"gl\"");
+        bench.Finish();
+        if (!bench.Enabled())
+            profiler.PrintSummary();
+
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &texture);
+
+        video.Finish();
+        goldenOk = golden.Finish();
     }
-
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-
     glfwTerminate();
-	return 0;
+	return goldenOk ? 0 : 1;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
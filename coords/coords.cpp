@@ -10,14 +10,44 @@
  */
 #include <chores/chores.h>
 
+/**
+ * stb_image allocations go to per-thread arenas
+ */
+#include <texture/stbi_arena.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+/**
+ * Texture cache
+ */
+#include <texture/texcache.h>
+
 /**
  * Shader header class
  */
 #include <myshaders/shader_s.h>
 
+/**
+ * Headless benchmark mode
+ */
+#include <bench/framebench.h>
+
+/**
+ * Golden image capture and compare, --capture / --golden
+ */
+#include <capture/golden.h>
+
+/**
+ * CPU trace scopes, --trace file.json
+ */
+#include <profiling/trace.h>
+
+/**
+ * CPU rasterizer backend, --softraster
+ */
+#include <softraster/softrenderer.h>
+
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -28,162 +58,194 @@ const unsigned int SCR_HEIGHT = 600;
 
 int main(int argc, char const *argv[])
 {
+    // --trace records CPU scopes for chrome://tracing or ui.perfetto.dev (see profiling/trace.h)
+    TraceSession trace(argc, argv);
+
 	// Chore class for day to day openglling
 	/**
 	/ Inits GLFW, GLAD, Window Object
 	/*/
 	Chores chore;
 
-	GLFWwindow* window = chore.CreateWindow();
-    
-    /**
-     * Make window our context and bind the callbacks
-     */
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-    /**
-     * Init GLAD function pointers
-     */
-    chore.InitGlad();
-
-    // Generate a texture
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    // Bind it, from now on all texture calls will be redirected to this texture object
-    glBindTexture(GL_TEXTURE_2D, texture);
-    // set the texture wrapping/filtering options (on the currently bound texture object)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);   
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    /**
-     * Enable depth testing
-     */
-    glEnable(GL_DEPTH_TEST);
-
-    /**
-     * Load image and generate texture
-     */
-    // Load an image with stb_image
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load("../textures/container.jpg", &width, &height, &nrChannels, 0); 
-    if (data){
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }else{
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    //release the image memory
-    stbi_image_free(data);
-
-    // Load the shader
-    Shader coordsShader("/home/andrea/opengl/shaders/shaders_src/shaderCoords.vs", "/home/andrea/opengl/shaders/shaders_src/shaderTexture.fs");
-
-    // define vertices, with added texture coords!
-    float vertices[] = {
-        // positions          // colors           // texture coords
-         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,   // top right
-         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,   // bottom right
-        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,   // bottom left
-        -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f    // top left 
-    };
-
-    // Define and bind VAO e VBO
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // Point to position, as usual
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //Point to color!
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3* sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // Point to textures!
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    coordsShader.use();
-    unsigned int modelLoc = glGetUniformLocation(coordsShader.ID, "ModelMat");
-    unsigned int viewLoc  = glGetUniformLocation(coordsShader.ID, "ViewMat");
-    unsigned int projLoc  = glGetUniformLocation(coordsShader.ID, "ProjectionMat");
-    unsigned int funLoc   = glGetUniformLocation(coordsShader.ID, "FunMat");
-
-    /**
-     * Create a Model matrix
-     * Multiplyng the model matrix with the vertex transform the obj coords to world coords
-    */
-    glm::mat4 modelMat = glm::mat4(1.0f);
-    modelMat = glm::rotate(modelMat, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-    /**
-     * View Matrix
-     * To change the world view, camera-like
-     */
-    glm::mat4 viewMat = glm::mat4(1.0f);
-	// note that we're translating the scene in the reverse direction of where we want to move
-	// we move the scene to the negative z axis, which lies ahead of us to give the impression 
-	// of zooming out
-	viewMat = glm::translate(viewMat, glm::vec3(0.0f, 0.0f, -3.0f));
+    bool goldenOk;
+    // locals of this block own GL objects: it closes before glfwTerminate() so their destructors run with a live context
+    {
+        // --bench runs the scene headless and reports frame timings (see bench/framebench.h)
+        FrameBenchmark bench(argc, argv, "coords");
+        bench.HintWindow();
+        // --golden compares one frame with a stored image (see capture/golden.h)
+        GoldenCapture golden(argc, argv);
+        // --softraster draws the scene on the CPU (see softraster/softrenderer.h)
+        SoftRenderer soft(argc, argv);
 
-	/**
-	 * Projection matrix
-	 * To give our scene ortho/perspective view
-	 */
-	glm::mat4 projectionMat;
-	projectionMat = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        GLFWwindow* window = chore.CreateWindow();
 
+        /**
+         * Make window our context and bind the callbacks
+         */
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-	
-	// The Loop
-    while (!glfwWindowShouldClose(window))
-    {
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        // clear
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Funny rotation
-        glm::mat4 funMat = glm::mat4(1.0f);
-        funMat = glm::rotate(funMat, (float)glfwGetTime() * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
-       
-		glBindVertexArray(VAO);
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMat));
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(viewMat));
-		glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projectionMat));
-		glUniformMatrix4fv(funLoc, 1, GL_FALSE, glm::value_ptr(funMat));
-        // This call will automatically bind the texture to the uniform texture of the frag shader
-        glBindTexture(GL_TEXTURE_2D, texture);
-        
-        // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+        /**
+         * Init GLAD function pointers
+         */
+        chore.InitGlad();
+        bench.Start();
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+        /**
+         * Enable depth testing
+         */
+        glEnable(GL_DEPTH_TEST);
 
+        // Textures are owned by the cache: it serves the baked .gtex when there is one
+        // (see textureBaker, "make bake") and builds the mips on the CPU otherwise
+        TextureCache textureCache(64 * 1024 * 1024);
+        // all sample images in one mapping, when assetPacker has built it
+        AssetPack assetPack;
+        if (access("../textures/textures.gpak", R_OK) == 0 && assetPack.Open("../textures/textures.gpak"))
+            textureCache.SetAssetPack(&assetPack);
+        unsigned int texture = textureCache.Acquire("../textures/container.jpg");
+        SoftTexture softTexture;
+        if (soft.Enabled())
+            softTexture.Load("../textures/container.jpg");
+
+        // Load the shader
+        Shader coordsShader("/home/andrea/opengl/shaders/shaders_src/shaderCoords.vs", "/home/andrea/opengl/shaders/shaders_src/shaderTexture.fs");
+
+        // define vertices, with added texture coords!
+        float vertices[] = {
+            // positions          // colors           // texture coords
+             0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,   // top right
+             0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,   // bottom right
+            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,   // bottom left
+            -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f    // top left 
+        };
+
+        // Define and bind VAO e VBO
+        unsigned int VBO, VAO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        // Point to position, as usual
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        //Point to color!
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3* sizeof(float)));
+        glEnableVertexAttribArray(1);
+        // Point to textures!
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        // Unbind
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        coordsShader.use();
+        unsigned int modelLoc = glGetUniformLocation(coordsShader.ID, "ModelMat");
+        unsigned int viewLoc  = glGetUniformLocation(coordsShader.ID, "ViewMat");
+        unsigned int projLoc  = glGetUniformLocation(coordsShader.ID, "ProjectionMat");
+        unsigned int funLoc   = glGetUniformLocation(coordsShader.ID, "FunMat");
+
+        /**
+         * Create a Model matrix
+         * Multiplyng the model matrix with the vertex transform the obj coords to world coords
+        */
+        glm::mat4 modelMat = glm::mat4(1.0f);
+        modelMat = glm::rotate(modelMat, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+        /**
+         * View Matrix
+         * To change the world view, camera-like
+         */
+        glm::mat4 viewMat = glm::mat4(1.0f);
+        // note that we're translating the scene in the reverse direction of where we want to move
+        // we move the scene to the negative z axis, which lies ahead of us to give the impression 
+        // of zooming out
+        viewMat = glm::translate(viewMat, glm::vec3(0.0f, 0.0f, -3.0f));
+
+        /**
+         * Projection matrix
+         * To give our scene ortho/perspective view
+         */
+        glm::mat4 projectionMat;
+        projectionMat = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+
+
+
+        // The Loop
+        while (!glfwWindowShouldClose(window) && bench.Running())
+        {
+            TRACE_SCOPE("frame");
+            bench.BeginFrame();
+
+            // input
+            // -----
+            {
+                TRACE_SCOPE("input");
+                processInput(window);
+            }
+
+            // render
+            // ------
+            // clear
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // Funny rotation
+            glm::mat4 funMat = glm::mat4(1.0f);
+            funMat = glm::rotate(funMat, (float)bench.Time() * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
+
+            if (soft.Enabled())
+            {
+                SoftRasterizer& raster = soft.Begin(window, 0.0f, 0.0f, 0.0f, 1.0f);
+                raster.BindTexture(&softTexture);
+                // glDrawArrays below asks for 36 vertices of a 4 vertex buffer; the
+                // rasterizer is given the vertices that exist
+                raster.DrawArrays(vertices, 8, 0, 6, 0, sizeof(vertices) / (8 * sizeof(float)),
+                                  funMat * projectionMat * viewMat * modelMat);
+                soft.Present();
+            }
+            else
+            {
+                glBindVertexArray(VAO);
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMat));
+                glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(viewMat));
+                glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projectionMat));
+                glUniformMatrix4fv(funLoc, 1, GL_FALSE, glm::value_ptr(funMat));
+                // This call will automatically bind the texture to the uniform texture of the frag shader
+                glBindTexture(GL_TEXTURE_2D, texture);
+
+                // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            golden.Frame(window);
+            {
+                TRACE_SCOPE("swap");
+                glfwSwapBuffers(window);
+            }
+            bench.EndFrame();
+            glfwPollEvents();
+        }
+
+        bench.AddSection("rasterizer", soft.Enabled() ? "\"software\"" : "\"gl\"");
+        bench.Finish();
+
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        textureCache.Release(texture);
+        textureCache.PrintStats();
+
+        goldenOk = golden.Finish();
+    }
 	glfwTerminate();
-	return 0;
+	return goldenOk ? 0 : 1;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -0,0 +1,644 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+/**
+ * Chores class for avoid implementation etc.
+ */
+#include <chores/chores.h>
+
+/**
+ * Camera Class
+ */
+#include <camera.h>
+
+/**
+ * stb_image allocations go to per-thread arenas
+ */
+#include <texture/stbi_arena.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+/**
+ * Texture array: every material of the field in one texture object
+ */
+#include <texture/texarray.h>
+
+/**
+ * Shader header class
+ */
+#include <myshaders/shader_s.h>
+
+/**
+ * Headless benchmark mode
+ */
+#include <bench/framebench.h>
+
+/**
+ * Golden image capture and compare, --capture / --golden
+ */
+#include <capture/golden.h>
+
+/**
+ * GPU timer scopes
+ */
+#include <profiling/gpuprofiler.h>
+
+/**
+ * CPU trace scopes, --trace file.json
+ */
+#include <profiling/trace.h>
+
+/**
+ * Frame time overlay, F1 toggles it
+ */
+#include <profiling/perfhud.h>
+
+/**
+ * Transform hierarchy, the field and its cubes
+ */
+#include <scene/scenegraph.h>
+
+/**
+ * Bounding volume hierarchy, frustum culling
+ */
+#include <scene/bvh.h>
+
+/**
+ * Hierarchical Z occlusion culling from the last frames' depth
+ */
+#include <scene/occlusion.h>
+
+/**
+ * Picking: object ids drawn under the cursor, read back a frame later
+ */
+#include <scene/idpicker.h>
+
+/**
+ * Offscreen render targets, pooled by size and format
+ */
+#include <render/targetpool.h>
+
+/**
+ * Dynamic resolution from the GPU frame time
+ */
+#include <render/dynres.h>
+
+/**
+ * Render passes as a graph: ordering, culling, transient targets
+ */
+#include <render/framegraph.h>
+/**
+ * Depth prepass
+ */
+#include <render/depthprepass.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// cubes per side of the field
+const int FIELD_SIZE = 20;
+
+// camera
+Camera camera(glm::vec3(0.0f, 2.0f, 12.0f));
+float lastX = (float)SCR_WIDTH / 2.0f;
+float lastY = (float)SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f; // time between current frame and last frame
+float lastFrame = 0.0f;
+
+// Per instance data, matches attribute locations 2..6 of shaderCubeField.vs and 7 of shaderPick.vs
+struct CubeInstance {
+    glm::mat4 model;
+    float layer;
+    unsigned int id;
+};
+
+// the field for culling: a BVH over the cube bounds
+Bvh fieldBvh;
+// the cursor callback asks this for picks, the loop draws them
+IdPicker* cursorPicker = NULL;
+int hoveredCube = -1;
+
+int main(int argc, char const *argv[])
+{
+    // --trace records CPU scopes for chrome://tracing or ui.perfetto.dev (see profiling/trace.h)
+    TraceSession trace(argc, argv);
+
+	// Chore class for day to day openglling
+	/**
+	/ Inits GLFW, GLAD, Window Object
+	/*/
+	Chores chore;
+
+    bool goldenOk;
+    // locals of this block own GL objects: it closes before glfwTerminate() so their destructors run with a live context
+    {
+        // --bench runs the scene headless and reports frame timings (see bench/framebench.h)
+        FrameBenchmark bench(argc, argv, "cubeField");
+        bench.HintWindow();
+        // --golden compares one frame with a stored image (see capture/golden.h)
+        GoldenCapture golden(argc, argv);
+        // --hiz also culls cubes hidden behind nearer ones (see scene/occlusion.h)
+        OcclusionCuller occlusion(argc, argv);
+        // --msaa N draws the field into an N sample target, resolved before the HUD
+        int msaaSamples = 1;
+        for (int i = 1; i + 1 < argc; i++)
+            if (strcmp(argv[i], "--msaa") == 0)
+                msaaSamples = atoi(argv[i + 1]);
+        // --dynres MS scales the field's resolution to keep its GPU frame time under MS (see render/dynres.h)
+        DynamicResolution dynres(argc, argv);
+        // --prepass draws the field's depth first, then shades each covered pixel once (see render/depthprepass.h)
+        DepthPrepass prepass(argc, argv);
+
+        GLFWwindow* window = chore.CreateWindow();
+
+        /**
+         * Make window our context and bind the callbacks
+         */
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+
+        /**
+         * Init GLAD function pointers
+         */
+        chore.InitGlad();
+        bench.Start();
+
+        // per pass GPU/CPU timings, read back a few frames late so nothing stalls
+        GpuProfiler profiler;
+
+        // on screen frame stats, one batched draw; kept out of benchmark runs
+        PerfHud hud("/home/andrea/opengl/shaders/shaders_src/hud.vs", "/home/andrea/opengl/shaders/shaders_src/hud.fs");
+        hud.SetVisible(!bench.Enabled());
+
+        glEnable(GL_DEPTH_TEST);
+
+        // 3D Cube vertices
+        float vertices[] = {
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+        };
+
+        /**
+         * Materials: both images become layers of one array texture
+         */
+        TextureArrayBuilder materials;
+        int containerLayer = materials.AddFile("../textures/container.jpg");
+        int wallLayer = materials.AddFile("../textures/wall.jpg");
+        unsigned int textureArray = materials.Build();
+
+        /**
+         * The field: a checkerboard of the two materials, every cube a child of the field node
+         */
+        SceneGraph scene;
+        SceneNode field = scene.Add(SCENE_NO_PARENT);
+        std::vector<SceneNode> cubes;
+        std::vector<CubeInstance> instances;
+        for (int z = 0; z < FIELD_SIZE; z++)
+        {
+            for (int x = 0; x < FIELD_SIZE; x++)
+            {
+                glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3((x - FIELD_SIZE / 2) * 1.5f, 0.0f, (z - FIELD_SIZE / 2) * -1.5f));
+                local = glm::rotate(local, glm::radians(20.0f * (x + z)), glm::vec3(1.0f, 0.3f, 0.5f));
+                cubes.push_back(scene.Add(field, local));
+                CubeInstance cube;
+                cube.layer = (float)((x + z) % 2 == 0 ? containerLayer : wallLayer);
+                cube.id = (unsigned int)instances.size();
+                instances.push_back(cube);
+            }
+        }
+        scene.Update();
+        std::vector<Aabb> cubeBounds(cubes.size());
+        for (size_t i = 0; i < cubes.size(); i++)
+        {
+            instances[i].model = scene.World(cubes[i]);
+            cubeBounds[i] = TransformAabb(Aabb(glm::vec3(-0.5f), glm::vec3(0.5f)), instances[i].model);
+        }
+        fieldBvh.Build(cubeBounds);
+        // the cubes in view this frame, in field order, and their instance data
+        std::vector<int> visible;
+        std::vector<CubeInstance> visibleInstances;
+        visible.reserve(instances.size());
+        visibleInstances.reserve(instances.size());
+        double drawnCubes = 0.0;
+        int culledFrames = 0;
+
+        unsigned int VBO, VAO, instanceVBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        // Point to position, as usual
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // Point to textures!
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // Per instance model matrix, one vec4 column per location, and layer
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CubeInstance), instances.data(), GL_DYNAMIC_DRAW);
+        for (int column = 0; column < 4; column++)
+        {
+            glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(column * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(2 + column);
+            glVertexAttribDivisor(2 + column, 1);
+        }
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, layer));
+        glEnableVertexAttribArray(6);
+        glVertexAttribDivisor(6, 1);
+        // the cube's index for picking, an integer attribute
+        glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, sizeof(CubeInstance), (void*)offsetof(CubeInstance, id));
+        glEnableVertexAttribArray(7);
+        glVertexAttribDivisor(7, 1);
+        // Unbind
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        // the depth prepass reads positions only: a tightly packed copy, and the same instance matrices
+        std::vector<float> positions;
+        for (size_t v = 0; v < sizeof(vertices) / sizeof(float); v += 5)
+            positions.insert(positions.end(), vertices + v, vertices + v + 3);
+        unsigned int depthVBO, depthVAO;
+        glGenVertexArrays(1, &depthVAO);
+        glGenBuffers(1, &depthVBO);
+        glBindVertexArray(depthVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, depthVBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int column = 0; column < 4; column++)
+        {
+            glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(column * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(2 + column);
+            glVertexAttribDivisor(2 + column, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        Shader fieldShader("/home/andrea/opengl/shaders/shaders_src/shaderCubeField.vs", "/home/andrea/opengl/shaders/shaders_src/shaderCubeField.fs");
+        fieldShader.use();
+        fieldShader.setInt("ourTextures", 0);
+
+        // picking draws the same instances with their ids instead of textures
+        Shader pickShader("/home/andrea/opengl/shaders/shaders_src/shaderPick.vs", "/home/andrea/opengl/shaders/shaders_src/shaderPick.fs");
+        // and the depth prepass with no texture at all
+        Shader depthShader("/home/andrea/opengl/shaders/shaders_src/shaderDepth.vs", "/home/andrea/opengl/shaders/shaders_src/shaderDepth.fs");
+        IdPicker picker;
+        cursorPicker = &picker;
+
+        // the offscreen scene and its MSAA resolve, the same targets every frame until the size changes
+        RenderTargetPool targets;
+        FrameGraph graph(targets);
+
+        // The whole field samples this one texture, bind it once
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+
+        // The Loop
+        while (!glfwWindowShouldClose(window) && bench.Running())
+        {
+            TRACE_SCOPE("frame");
+            bench.BeginFrame();
+            profiler.BeginFrame();
+
+            float currentFrame = bench.Time();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            // -----
+            {
+                TRACE_SCOPE("input");
+                processInput(window);
+                hud.ToggleOnKey(window, GLFW_KEY_F1);
+                bench.ScriptCamera(camera, glm::vec3(0.0f, 0.0f, 0.0f), 16.0f, 6.0f);
+            }
+
+            // render
+            // ------
+            // the passes of the frame and what they read and write; the graph orders them, drops the
+            // ones nothing needs and hands out the offscreen targets (see render/framegraph.h)
+            int framebufferWidth, framebufferHeight, sceneWidth, sceneHeight;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            dynres.Update(profiler);
+            dynres.Apply(framebufferWidth, framebufferHeight, sceneWidth, sceneHeight);
+            float aspect = (float)SCR_WIDTH / (float)SCR_HEIGHT;
+            bool offscreen = (msaaSamples > 1 || dynres.Enabled()) && framebufferWidth > 0 && framebufferHeight > 0;
+
+            graph.Reset();
+            FrameResource backbuffer = graph.Import("backbuffer", 0, framebufferWidth, framebufferHeight);
+            FrameResource scene = offscreen
+                ? graph.Create("scene", RenderTargetDesc(sceneWidth, sceneHeight, GL_RGBA8, GL_DEPTH24_STENCIL8, msaaSamples))
+                : backbuffer;
+
+            // clear, cull and draw the field
+            int fieldPass = graph.AddPass("field", [&, scene]() {
+                if (graph.Target(scene))
+                    graph.Target(scene)->Bind();
+                profiler.Begin("clear");
+                glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                profiler.End();
+
+                profiler.Begin("field");
+                {
+                    TRACE_SCOPE("uniforms");
+                    fieldShader.setMat4("projection", camera.GetProjectionMatrix(aspect));
+                    fieldShader.setMat4("view", camera.GetViewMatrix());
+                }
+
+                // only the cubes the frustum touches go to the GPU; sorted so the draw order stays the field's
+                {
+                    TRACE_SCOPE("cull");
+                    occlusion.BeginFrame();
+                    visible.clear();
+                    fieldBvh.Query(camera.GetFrustum(aspect), visible);
+                    if (occlusion.Enabled())
+                        visible.erase(std::remove_if(visible.begin(), visible.end(),
+                                                     [&](int i) { return occlusion.Occluded(cubeBounds[i]); }),
+                                      visible.end());
+                    std::sort(visible.begin(), visible.end());
+                    visibleInstances.resize(visible.size());
+                    for (size_t i = 0; i < visible.size(); i++)
+                        visibleInstances[i] = instances[visible[i]];
+                    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+                    glBufferSubData(GL_ARRAY_BUFFER, 0, visibleInstances.size() * sizeof(CubeInstance), visibleInstances.data());
+                    glBindBuffer(GL_ARRAY_BUFFER, 0);
+                    drawnCubes += visible.size();
+                    culledFrames++;
+                }
+
+                // depth of the visible cubes first, so the textured draw shades only what stays in front
+                if (prepass.Enabled())
+                {
+                    TRACE_SCOPE("prepass");
+                    prepass.BeginDepth();
+                    depthShader.use();
+                    depthShader.setMat4("projection", camera.GetProjectionMatrix(aspect));
+                    depthShader.setMat4("view", camera.GetViewMatrix());
+                    glBindVertexArray(depthVAO);
+                    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)visible.size());
+                    prepass.EndDepth();
+                    fieldShader.use();
+                }
+
+                // the visible cubes, both materials, one draw
+                {
+                    TRACE_SCOPE("draw");
+                    prepass.BeginColor();
+                    glBindVertexArray(VAO);
+                    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)visible.size());
+                    prepass.EndColor();
+                }
+                profiler.End();
+            });
+            scene = graph.Write(fieldPass, scene);
+
+            // multisampled: resolve color and depth (the occlusion culler reads it) into a single sampled target
+            FrameResource shown = scene;
+            if (offscreen && msaaSamples > 1)
+            {
+                FrameResource resolved = graph.Create("resolved", RenderTargetDesc(sceneWidth, sceneHeight, GL_RGBA8, GL_DEPTH24_STENCIL8));
+                int resolvePass = graph.AddPass("resolve", [&, scene, resolved]() {
+                    if (graph.Target(scene) && graph.Target(resolved))
+                        graph.Target(scene)->BlitTo(*graph.Target(resolved), GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                });
+                graph.Read(resolvePass, scene);
+                shown = graph.Write(resolvePass, resolved);
+            }
+
+            // then show it, upscaled when dynamic resolution drew it smaller
+            if (offscreen)
+            {
+                int presentPass = graph.AddPass("present", [&, shown]() {
+                    if (graph.Target(shown))
+                        graph.Target(shown)->BlitTo(0, framebufferWidth, framebufferHeight);
+                    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                    glViewport(0, 0, framebufferWidth, framebufferHeight);
+                });
+                graph.Read(presentPass, shown);
+                backbuffer = graph.Write(presentPass, backbuffer);
+            }
+            else
+                backbuffer = scene;
+
+            // the depth the field left, for the next frames' occlusion culling
+            if (occlusion.Enabled())
+            {
+                int hizPass = graph.AddPass("hiz readback", [&, shown]() {
+                    occlusion.EndFrame(window, camera.GetProjectionMatrix(aspect) * camera.GetViewMatrix(),
+                                       graph.Framebuffer(shown), graph.Width(shown), graph.Height(shown));
+                });
+                graph.Read(hizPass, shown);
+                graph.SideEffect(hizPass);
+            }
+
+            // the cursor moved: the visible cubes again, ids only and shading just the pixel under it
+            int pickPass = graph.AddPass("pick", [&]() {
+                if (picker.Begin(window))
+                {
+                    pickShader.use();
+                    pickShader.setMat4("projection", camera.GetProjectionMatrix(aspect));
+                    pickShader.setMat4("view", camera.GetViewMatrix());
+                    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)visible.size());
+                    picker.End();
+                    fieldShader.use();
+                }
+                int cube;
+                if (picker.Poll(cube))
+                {
+                    if (cube != hoveredCube && cube >= 0)
+                        std::cout << "Cube " << cube << " under the cursor" << std::endl;
+                    hoveredCube = cube;
+                }
+            });
+            graph.SideEffect(pickPass);
+
+            // the capture is taken before the HUD, so it never shows in goldens
+            int goldenPass = graph.AddPass("golden", [&]() { golden.Frame(window); });
+            graph.Read(goldenPass, backbuffer);
+            graph.SideEffect(goldenPass);
+
+            int hudPass = graph.AddPass("hud", [&]() {
+                profiler.Begin("hud");
+                hud.Draw(window);
+                profiler.End();
+            });
+            backbuffer = graph.Write(hudPass, backbuffer);
+
+            if (graph.Compile())
+                graph.Execute();
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            profiler.Begin("swap");
+            {
+                TRACE_SCOPE("swap");
+                glfwSwapBuffers(window);
+            }
+            profiler.End();
+            targets.EndFrame();
+            profiler.EndFrame();
+            bench.EndFrame();
+            glfwPollEvents();
+        }
+
+        profiler.Flush();
+        prepass.Flush();
+        bench.AddSection("gpu_scopes", profiler.ReportJSON());
+        std::ostringstream culling;
+        culling << "{\"cubes\": " << instances.size() << ", \"drawn_per_frame\": "
+                << (culledFrames ? drawnCubes / culledFrames : 0.0) << "}";
+        bench.AddSection("frustum_culling", culling.str());
+        if (occlusion.Enabled())
+            bench.AddSection("occlusion_culling", occlusion.ReportJSON());
+        if (msaaSamples > 1 || dynres.Enabled())
+            bench.AddSection("render_targets", targets.ReportJSON());
+        bench.AddSection("frame_graph", graph.ReportJSON());
+        bench.AddSection("depth_prepass", prepass.ReportJSON());
+        if (dynres.Enabled())
+            bench.AddSection("dynamic_resolution", dynres.ReportJSON());
+        bench.Finish();
+        if (!bench.Enabled())
+            profiler.PrintSummary();
+
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteVertexArrays(1, &depthVAO);
+        glDeleteBuffers(1, &depthVBO);
+        glDeleteTextures(1, &textureArray);
+
+        goldenOk = golden.Finish();
+        cursorPicker = NULL;
+    }
+    glfwTerminate();
+	return goldenOk ? 0 : 1;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    // Offscreen targets follow on the next frame: the pool hands out ones of the new size
+    // and drops the old ones a few frames later.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+
+    // the cube under the cursor, answered by the id buffer a frame or two later
+    if (cursorPicker)
+        cursorPicker->RequestPick(xpos, ypos);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(yoffset);
+}
+
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS){
+        glfwSetWindowShouldClose(window, true);
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS){
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    }
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS){
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    }
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS){
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    }
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS){
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+}
@@ -1,12 +1,14 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <bench/framebench.h>
+
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 
-int main()
+int main(int argc, char const *argv[])
 {
 	/**
 	 * @brief      Init glfw
@@ -21,72 +23,88 @@ int main()
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     //glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
-    /**
-     * Create the window
-     */
-    GLFWwindow* window = glfwCreateWindow(400, 150, "my first opengl window", NULL, NULL);
-    if (window == NULL)
-	{
-	    std::cout << "Failed to create GLFW window" << std::endl;
-	    glfwTerminate();
-	    return -1;
-	}
-	/**
-	 * @brief      Set the context to the window
-	 *
-	 * @param[in]  GLFWwindow window
-	 */
-	glfwMakeContextCurrent(window);
-
-	/**
-	 * @brief      Callback for everytime the window is resized
-	 *
-	 * @param[in]  GLFWwindow
-	 * @param[in]  
-	 */
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-	/**
-	 * GLAD init
-	 * We pass GLAD the function to load the adress of the OpenGL function pointers which is OS-specific. 
-	 * GLFW gives us glfwGetProcAddress that defines the correct function based on which OS we're compiling for.
-	 */
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-	{
-	    std::cout << "Failed to initialize GLAD" << std::endl;
-	    return -1;
-	}
-
-	/**
-	 * Start the render loop
-	 */
-	while(!glfwWindowShouldClose(window))
-	{
-		/**
-		 * @brief      Trigger the event polls
-		 *
-		 * @param[in]  GLFWwindow window
-		 */
-		processInput(window);
-
-		// rendering commands here
-		// glclear all previous iteration drawing from screen (in this case, the color buffer)
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-
-		/**
-		 * @brief      Dump the color buffer inside the window
-		 *
-		 * @param[in]  GLFWwindow window
-		 */
-	    glfwSwapBuffers(window);
-
-	    /**
-	     * @brief      polls for event (like keyboard or mouse call)
-	     * 				and change window state, calls corresponding methods via callback
-	     */
-	    glfwPollEvents();    
-	}
+    // locals of this block own GL objects: it closes before glfwTerminate() so their destructors run with a live context
+    {
+        /**
+         * Headless benchmark mode with --bench (see bench/framebench.h)
+         */
+        FrameBenchmark bench(argc, argv, "firstWindow");
+        bench.HintWindow();
+
+        /**
+         * Create the window
+         */
+        GLFWwindow* window = glfwCreateWindow(400, 150, "my first opengl window", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        /**
+         * @brief      Set the context to the window
+         *
+         * @param[in]  GLFWwindow window
+         */
+        glfwMakeContextCurrent(window);
+
+        /**
+         * @brief      Callback for everytime the window is resized
+         *
+         * @param[in]  GLFWwindow
+         * @param[in]  
+         */
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        /**
+         * GLAD init
+         * We pass GLAD the function to load the adress of the OpenGL function pointers which is OS-specific. 
+         * GLFW gives us glfwGetProcAddress that defines the correct function based on which OS we're compiling for.
+         */
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+
+        bench.Start();
+
+        /**
+         * Start the render loop
+         */
+        while(!glfwWindowShouldClose(window) && bench.Running())
+        {
+            bench.BeginFrame();
+
+            /**
+             * @brief      Trigger the event polls
+             *
+             * @param[in]  GLFWwindow window
+             */
+            processInput(window);
+
+            // rendering commands here
+            // glclear all previous iteration drawing from screen (in this case, the color buffer)
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            /**
+             * @brief      Dump the color buffer inside the window
+             *
+             * @param[in]  GLFWwindow window
+             */
+            glfwSwapBuffers(window);
+            bench.EndFrame();
+
+            /**
+             * @brief      polls for event (like keyboard or mouse call)
+             * 				and change window state, calls corresponding methods via callback
+             */
+            glfwPollEvents();    
+        }
+
+        bench.Finish();
+    }
 
 	/**
 	 * @brief      Clean up glfw and its resources
@@ -0,0 +1,341 @@
+#ifndef FRAMEBENCH_H
+#define FRAMEBENCH_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <bench/glcounters.h>
+#include <bench/glintercept.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+/**
+ * Headless, deterministic frame benchmark for the samples
+ *
+ * A sample creates one FrameBenchmark from its command line. Without
+ * --bench nothing changes; with it the window is hidden, vsync is off,
+ * the scene clock advances by a fixed step per frame and the loop stops
+ * by itself, then CPU frame time, GPU frame time (GL_TIME_ELAPSED),
+ * draw calls, state changes and triangles per second are written as
+ * JSON. Options:
+ *
+ *     --bench            enable
+ *     --frames N         measured frames (default 600)
+ *     --seconds T        measure for T seconds of wall time instead
+ *     --warmup N         frames run before measuring (default 60)
+ *     --dt S             fixed scene time step (default 1/60)
+ *     --out file.json    report destination (default stdout)
+ *     --glcalls          count every GL call by entry point (bench/glintercept.h)
+ *     --glcalls-timing   same, also timing each call on the CPU
+ *
+ * Usage in a sample:
+ *
+ *     FrameBenchmark bench(argc, argv, "camera");
+ *     bench.HintWindow();                 // before glfwCreateWindow
+ *     ...gladLoadGLLoader...
+ *     bench.Start();
+ *     while (!glfwWindowShouldClose(window) && bench.Running())
+ *     {
+ *         bench.BeginFrame();
+ *         ...render with bench.Time() as the clock...
+ *         glfwSwapBuffers(window);
+ *         bench.EndFrame();
+ *         glfwPollEvents();
+ *     }
+ *     bench.Finish();
+ *
+ * On machines without a GPU run it on Mesa's software rasterizer under a
+ * virtual display: xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./cameraBin --bench
+ */
+class FrameBenchmark
+{
+public:
+
+    FrameBenchmark(int argc, char const *argv[], const char* scene)
+        : scene(scene), enabled(false), frames(600), seconds(0.0), warmup(60), dt(1.0 / 60.0),
+          glCalls(false), glCallTiming(false), frame(0), gpuTimer(false) {
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--bench") == 0)
+                enabled = true;
+            else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+                frames = (unsigned int)atoi(argv[++i]);
+            else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+                seconds = atof(argv[++i]);
+            else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+                warmup = (unsigned int)atoi(argv[++i]);
+            else if (strcmp(argv[i], "--dt") == 0 && i + 1 < argc)
+                dt = atof(argv[++i]);
+            else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+                output = argv[++i];
+            else if (strcmp(argv[i], "--glcalls") == 0)
+                glCalls = true;
+            else if (strcmp(argv[i], "--glcalls-timing") == 0)
+                glCalls = glCallTiming = true;
+        }
+        for (int q = 0; q < QUERY_RING; q++)
+            pending[q] = false;
+    }
+    ~FrameBenchmark(){
+        if (gpuTimer)
+            glDeleteQueries(QUERY_RING, queries);
+    }
+
+    FrameBenchmark(const FrameBenchmark&) = delete;
+    FrameBenchmark& operator=(const FrameBenchmark&) = delete;
+
+    bool Enabled() const { return enabled; }
+
+    /**
+     * @brief      Hide the window of a benchmark run, call before glfwCreateWindow
+     */
+    void HintWindow() const {
+        if (enabled)
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
+
+    /**
+     * @brief      Hook the GL counters and create the timer queries, call once GL is loaded
+     */
+    void Start(){
+        if (!enabled)
+            return;
+        glfwSwapInterval(0);
+        InstallGLCounters();
+        if (glCalls)
+            InstallGLIntercept(glCallTiming);
+        // drop errors left by the sample's setup, the next one is about the queries
+        while (glGetError() != GL_NO_ERROR) {}
+        glGenQueries(QUERY_RING, queries);
+        gpuTimer = glGetError() == GL_NO_ERROR;
+        const GLubyte* name = glGetString(GL_RENDERER);
+        renderer = name ? (const char*)name : "unknown";
+        startWall = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief      False once a benchmark run has measured enough frames
+     */
+    bool Running() const {
+        if (!enabled || frame < warmup)
+            return true;
+        if (seconds > 0.0)
+            return measuredSeconds() < seconds;
+        return frame < warmup + frames;
+    }
+
+    /**
+     * @brief      Scene clock: fixed steps when benchmarking, glfwGetTime() otherwise
+     */
+    double Time() const {
+        return enabled ? frame * dt : glfwGetTime();
+    }
+
+    /**
+     * @brief      Fixed time step, or 0 when not benchmarking (the sample keeps its own)
+     */
+    float DeltaTime() const {
+        return enabled ? (float)dt : 0.0f;
+    }
+
+    /**
+     * @brief      Move a camera along the scripted benchmark path
+     *
+     * The camera orbits target once every 8 seconds of scene time, at the
+     * given radius and height, always looking at it. Does nothing outside
+     * a benchmark run so the sample keeps its interactive camera.
+     */
+    template <class CameraT>
+    void ScriptCamera(CameraT& camera, glm::vec3 target, float radius, float height) const {
+        if (!enabled)
+            return;
+        float angle = (float)(Time() * 2.0 * 3.14159265358979 / 8.0);
+        camera.LookAt(target + glm::vec3(radius * cos(angle), height, radius * sin(angle)), target);
+    }
+
+    /**
+     * @brief      Add a section to the report
+     *
+     * @param      key   JSON key
+     * @param      json  a JSON value, e.g. GpuProfiler::ReportJSON()
+     */
+    void AddSection(const std::string& key, const std::string& json){
+        if (enabled)
+            sections.push_back(std::make_pair(key, json));
+    }
+
+    void BeginFrame(){
+        if (!enabled)
+            return;
+        // waiting on an old timer result is part of the frame's cost
+        frameStart = std::chrono::steady_clock::now();
+        if (frame == warmup)
+        {
+            ResetGLCounters();
+            ResetGLIntercept();
+            startWall = frameStart;
+        }
+        int slot = (int)(frame % QUERY_RING);
+        if (gpuTimer)
+        {
+            collect(slot);
+            glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+        }
+    }
+
+    /**
+     * @brief      Close the frame, call right after glfwSwapBuffers
+     */
+    void EndFrame(){
+        if (!enabled)
+            return;
+        double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        int slot = (int)(frame % QUERY_RING);
+        if (gpuTimer)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            pending[slot] = true;
+            pendingMeasured[slot] = frame >= warmup;
+        }
+        if (frame >= warmup)
+            cpuFrameMs.push_back(cpuMs);
+        if (glCalls)
+            GLInterceptFrame();
+        frame++;
+    }
+
+    /**
+     * @brief      Write the report of a benchmark run
+     *
+     * @return     false if the report could not be written
+     */
+    bool Finish(){
+        if (!enabled)
+            return true;
+        double wall = measuredSeconds();
+        for (int q = 0; gpuTimer && q < QUERY_RING; q++)
+            collect(q);
+
+        const GLCounters& counters = GetGLCounters();
+        double measured = (double)cpuFrameMs.size();
+        std::ostringstream json;
+        json << "{\n"
+             << "  \"scene\": \"" << escape(scene) << "\",\n"
+             << "  \"renderer\": \"" << escape(renderer) << "\",\n"
+             << "  \"frames\": " << cpuFrameMs.size() << ",\n"
+             << "  \"warmup_frames\": " << warmup << ",\n"
+             << "  \"fixed_dt\": " << dt << ",\n"
+             << "  \"wall_seconds\": " << wall << ",\n"
+             << "  \"cpu_frame_ms\": " << summary(cpuFrameMs) << ",\n"
+             << "  \"gpu_frame_ms\": " << (gpuTimer ? summary(gpuFrameMs) : "null") << ",\n"
+             << "  \"draw_calls_per_frame\": " << (measured > 0 ? counters.drawCalls / measured : 0.0) << ",\n"
+             << "  \"state_changes_per_frame\": " << (measured > 0 ? counters.stateChanges / measured : 0.0) << ",\n"
+             << "  \"triangles_per_frame\": " << (measured > 0 ? counters.triangles / measured : 0.0) << ",\n"
+             << "  \"triangles_per_second\": " << (wall > 0 ? counters.triangles / wall : 0.0);
+        if (glCalls)
+            json << ",\n  \"gl_calls\": " << GLInterceptReportJSON();
+        for (size_t i = 0; i < sections.size(); i++)
+            json << ",\n  \"" << escape(sections[i].first) << "\": " << sections[i].second;
+        json << "\n}\n";
+
+        if (output.empty())
+        {
+            std::cout << json.str();
+            return true;
+        }
+        std::ofstream file(output.c_str());
+        file << json.str();
+        if (!file)
+        {
+            std::cout << "ERROR::FRAMEBENCH::CANNOT_WRITE " << output << std::endl;
+            return false;
+        }
+        std::cout << scene << ": " << cpuFrameMs.size() << " frames, report in " << output << std::endl;
+        if (glCalls)
+            PrintGLCallStats(10);
+        return true;
+    }
+
+private:
+
+    static const int QUERY_RING = 8;    // frames in flight before a timer result is read
+
+    std::string scene;
+    std::string renderer;
+    std::string output;
+    bool enabled;
+    unsigned int frames;
+    double seconds;
+    unsigned int warmup;
+    double dt;
+    bool glCalls;
+    bool glCallTiming;
+
+    unsigned long frame;
+    std::chrono::steady_clock::time_point startWall;
+    std::chrono::steady_clock::time_point frameStart;
+    std::vector<double> cpuFrameMs;
+    std::vector<double> gpuFrameMs;
+    std::vector<std::pair<std::string, std::string> > sections;
+
+    bool gpuTimer;
+    GLuint queries[QUERY_RING];
+    bool pending[QUERY_RING];
+    bool pendingMeasured[QUERY_RING];
+
+    double measuredSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startWall).count();
+    }
+
+    // Read back the timer of the frame that last used this slot; it was
+    // issued QUERY_RING frames ago so this practically never waits
+    void collect(int slot){
+        if (!pending[slot])
+            return;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &ns);
+        if (pendingMeasured[slot])
+            gpuFrameMs.push_back(ns / 1.0e6);
+        pending[slot] = false;
+    }
+
+    static std::string summary(std::vector<double> values){
+        if (values.empty())
+            return "null";
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); i++)
+            sum += values[i];
+        std::ostringstream out;
+        out << "{ \"mean\": " << sum / values.size()
+            << ", \"min\": " << values.front()
+            << ", \"median\": " << values[values.size() / 2]
+            << ", \"p95\": " << values[std::min(values.size() - 1, values.size() * 95 / 100)]
+            << ", \"max\": " << values.back() << " }";
+        return out.str();
+    }
+
+    static std::string escape(const std::string& text){
+        std::string out;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] == '"' || text[i] == '\\')
+                out += '\\';
+            if ((unsigned char)text[i] >= 0x20)
+                out += text[i];
+        }
+        return out;
+    }
+};
+#endif
@@ -0,0 +1,188 @@
+#ifndef GLCOUNTERS_H
+#define GLCOUNTERS_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+/**
+ * Draw call and state change counters
+ *
+ * InstallGLCounters() swaps glad's function pointers for the draw and
+ * state calls below with counting wrappers that forward to the driver,
+ * so a sample is measured without touching its render code. Call it
+ * after gladLoadGLLoader; counts accumulate until ResetGLCounters().
+ */
+
+struct GLCounters {
+    uint64_t drawCalls;
+    uint64_t triangles;         // triangles submitted, instances included
+    uint64_t stateChanges;      // program, VAO, buffer, texture, framebuffer and fixed state binds
+};
+
+namespace glcounters_detail {
+
+struct Originals {
+    PFNGLDRAWARRAYSPROC              drawArrays;
+    PFNGLDRAWELEMENTSPROC            drawElements;
+    PFNGLDRAWARRAYSINSTANCEDPROC     drawArraysInstanced;
+    PFNGLDRAWELEMENTSINSTANCEDPROC   drawElementsInstanced;
+    PFNGLDRAWRANGEELEMENTSPROC       drawRangeElements;
+    PFNGLUSEPROGRAMPROC              useProgram;
+    PFNGLBINDVERTEXARRAYPROC         bindVertexArray;
+    PFNGLBINDBUFFERPROC              bindBuffer;
+    PFNGLBINDTEXTUREPROC             bindTexture;
+    PFNGLACTIVETEXTUREPROC           activeTexture;
+    PFNGLBINDFRAMEBUFFERPROC         bindFramebuffer;
+    PFNGLENABLEPROC                  enable;
+    PFNGLDISABLEPROC                 disable;
+    PFNGLBLENDFUNCPROC               blendFunc;
+    PFNGLDEPTHFUNCPROC               depthFunc;
+    PFNGLDEPTHMASKPROC               depthMask;
+    PFNGLCULLFACEPROC                cullFace;
+    PFNGLVIEWPORTPROC                viewport;
+};
+
+inline Originals& originals()
+{
+    static Originals o;
+    return o;
+}
+
+inline GLCounters& counters()
+{
+    static GLCounters c = {0, 0, 0};
+    return c;
+}
+
+inline void countDraw(GLenum mode, GLsizei count, GLsizei instances)
+{
+    uint64_t triangles = 0;
+    if (mode == GL_TRIANGLES)
+        triangles = (uint64_t)count / 3;
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+        triangles = (uint64_t)count - 2;
+    counters().drawCalls++;
+    counters().triangles += triangles * (uint64_t)(instances > 0 ? instances : 0);
+}
+
+inline void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count){
+    countDraw(mode, count, 1);
+    originals().drawArrays(mode, first, count);
+}
+inline void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices){
+    countDraw(mode, count, 1);
+    originals().drawElements(mode, count, type, indices);
+}
+inline void APIENTRY drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances){
+    countDraw(mode, count, instances);
+    originals().drawArraysInstanced(mode, first, count, instances);
+}
+inline void APIENTRY drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances){
+    countDraw(mode, count, instances);
+    originals().drawElementsInstanced(mode, count, type, indices, instances);
+}
+inline void APIENTRY drawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices){
+    countDraw(mode, count, 1);
+    originals().drawRangeElements(mode, start, end, count, type, indices);
+}
+
+inline void APIENTRY useProgram(GLuint program){
+    counters().stateChanges++;
+    originals().useProgram(program);
+}
+inline void APIENTRY bindVertexArray(GLuint array){
+    counters().stateChanges++;
+    originals().bindVertexArray(array);
+}
+inline void APIENTRY bindBuffer(GLenum target, GLuint buffer){
+    counters().stateChanges++;
+    originals().bindBuffer(target, buffer);
+}
+inline void APIENTRY bindTexture(GLenum target, GLuint texture){
+    counters().stateChanges++;
+    originals().bindTexture(target, texture);
+}
+inline void APIENTRY activeTexture(GLenum unit){
+    counters().stateChanges++;
+    originals().activeTexture(unit);
+}
+inline void APIENTRY bindFramebuffer(GLenum target, GLuint framebuffer){
+    counters().stateChanges++;
+    originals().bindFramebuffer(target, framebuffer);
+}
+inline void APIENTRY enable(GLenum cap){
+    counters().stateChanges++;
+    originals().enable(cap);
+}
+inline void APIENTRY disable(GLenum cap){
+    counters().stateChanges++;
+    originals().disable(cap);
+}
+inline void APIENTRY blendFunc(GLenum src, GLenum dst){
+    counters().stateChanges++;
+    originals().blendFunc(src, dst);
+}
+inline void APIENTRY depthFunc(GLenum func){
+    counters().stateChanges++;
+    originals().depthFunc(func);
+}
+inline void APIENTRY depthMask(GLboolean flag){
+    counters().stateChanges++;
+    originals().depthMask(flag);
+}
+inline void APIENTRY cullFace(GLenum mode){
+    counters().stateChanges++;
+    originals().cullFace(mode);
+}
+inline void APIENTRY viewport(GLint x, GLint y, GLsizei width, GLsizei height){
+    counters().stateChanges++;
+    originals().viewport(x, y, width, height);
+}
+
+} // namespace glcounters_detail
+
+/**
+ * @brief      Route the counted GL calls through the counting wrappers
+ *
+ * Safe to call more than once; calls made before it are not counted.
+ */
+inline void InstallGLCounters()
+{
+    using namespace glcounters_detail;
+    Originals& o = originals();
+    if (glad_glDrawArrays == drawArrays)
+        return;
+    o.drawArrays            = glad_glDrawArrays;            glad_glDrawArrays            = drawArrays;
+    o.drawElements          = glad_glDrawElements;          glad_glDrawElements          = drawElements;
+    o.drawArraysInstanced   = glad_glDrawArraysInstanced;   glad_glDrawArraysInstanced   = drawArraysInstanced;
+    o.drawElementsInstanced = glad_glDrawElementsInstanced; glad_glDrawElementsInstanced = drawElementsInstanced;
+    o.drawRangeElements     = glad_glDrawRangeElements;     glad_glDrawRangeElements     = drawRangeElements;
+    o.useProgram            = glad_glUseProgram;            glad_glUseProgram            = useProgram;
+    o.bindVertexArray       = glad_glBindVertexArray;       glad_glBindVertexArray       = bindVertexArray;
+    o.bindBuffer            = glad_glBindBuffer;            glad_glBindBuffer            = bindBuffer;
+    o.bindTexture           = glad_glBindTexture;           glad_glBindTexture           = bindTexture;
+    o.activeTexture         = glad_glActiveTexture;         glad_glActiveTexture         = activeTexture;
+    o.bindFramebuffer       = glad_glBindFramebuffer;       glad_glBindFramebuffer       = bindFramebuffer;
+    o.enable                = glad_glEnable;                glad_glEnable                = enable;
+    o.disable               = glad_glDisable;               glad_glDisable               = disable;
+    o.blendFunc             = glad_glBlendFunc;             glad_glBlendFunc             = blendFunc;
+    o.depthFunc             = glad_glDepthFunc;             glad_glDepthFunc             = depthFunc;
+    o.depthMask             = glad_glDepthMask;             glad_glDepthMask             = depthMask;
+    o.cullFace              = glad_glCullFace;              glad_glCullFace              = cullFace;
+    o.viewport              = glad_glViewport;              glad_glViewport              = viewport;
+}
+
+inline const GLCounters& GetGLCounters()
+{
+    return glcounters_detail::counters();
+}
+
+inline void ResetGLCounters()
+{
+    GLCounters& c = glcounters_detail::counters();
+    c.drawCalls = 0;
+    c.triangles = 0;
+    c.stateChanges = 0;
+}
+#endif
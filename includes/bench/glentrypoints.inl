@@ -0,0 +1,700 @@
+// Generated from glad.c by 'make entrypoints' in benchmarks/frameBench, do not edit
+GL_ENTRY_POINT(ActiveShaderProgram)
+GL_ENTRY_POINT(ActiveTexture)
+GL_ENTRY_POINT(AttachShader)
+GL_ENTRY_POINT(BeginConditionalRender)
+GL_ENTRY_POINT(BeginQuery)
+GL_ENTRY_POINT(BeginQueryIndexed)
+GL_ENTRY_POINT(BeginTransformFeedback)
+GL_ENTRY_POINT(BindAttribLocation)
+GL_ENTRY_POINT(BindBuffer)
+GL_ENTRY_POINT(BindBufferBase)
+GL_ENTRY_POINT(BindBufferRange)
+GL_ENTRY_POINT(BindBuffersBase)
+GL_ENTRY_POINT(BindBuffersRange)
+GL_ENTRY_POINT(BindFragDataLocation)
+GL_ENTRY_POINT(BindFragDataLocationIndexed)
+GL_ENTRY_POINT(BindFramebuffer)
+GL_ENTRY_POINT(BindImageTexture)
+GL_ENTRY_POINT(BindImageTextures)
+GL_ENTRY_POINT(BindProgramPipeline)
+GL_ENTRY_POINT(BindRenderbuffer)
+GL_ENTRY_POINT(BindSampler)
+GL_ENTRY_POINT(BindSamplers)
+GL_ENTRY_POINT(BindTexture)
+GL_ENTRY_POINT(BindTextureUnit)
+GL_ENTRY_POINT(BindTextures)
+GL_ENTRY_POINT(BindTransformFeedback)
+GL_ENTRY_POINT(BindVertexArray)
+GL_ENTRY_POINT(BindVertexBuffer)
+GL_ENTRY_POINT(BindVertexBuffers)
+GL_ENTRY_POINT(BlendColor)
+GL_ENTRY_POINT(BlendEquation)
+GL_ENTRY_POINT(BlendEquationSeparate)
+GL_ENTRY_POINT(BlendEquationSeparatei)
+GL_ENTRY_POINT(BlendEquationi)
+GL_ENTRY_POINT(BlendFunc)
+GL_ENTRY_POINT(BlendFuncSeparate)
+GL_ENTRY_POINT(BlendFuncSeparatei)
+GL_ENTRY_POINT(BlendFunci)
+GL_ENTRY_POINT(BlitFramebuffer)
+GL_ENTRY_POINT(BlitNamedFramebuffer)
+GL_ENTRY_POINT(BufferData)
+GL_ENTRY_POINT(BufferStorage)
+GL_ENTRY_POINT(BufferSubData)
+GL_ENTRY_POINT(CheckFramebufferStatus)
+GL_ENTRY_POINT(CheckNamedFramebufferStatus)
+GL_ENTRY_POINT(ClampColor)
+GL_ENTRY_POINT(Clear)
+GL_ENTRY_POINT(ClearBufferData)
+GL_ENTRY_POINT(ClearBufferSubData)
+GL_ENTRY_POINT(ClearBufferfi)
+GL_ENTRY_POINT(ClearBufferfv)
+GL_ENTRY_POINT(ClearBufferiv)
+GL_ENTRY_POINT(ClearBufferuiv)
+GL_ENTRY_POINT(ClearColor)
+GL_ENTRY_POINT(ClearDepth)
+GL_ENTRY_POINT(ClearDepthf)
+GL_ENTRY_POINT(ClearNamedBufferData)
+GL_ENTRY_POINT(ClearNamedBufferSubData)
+GL_ENTRY_POINT(ClearNamedFramebufferfi)
+GL_ENTRY_POINT(ClearNamedFramebufferfv)
+GL_ENTRY_POINT(ClearNamedFramebufferiv)
+GL_ENTRY_POINT(ClearNamedFramebufferuiv)
+GL_ENTRY_POINT(ClearStencil)
+GL_ENTRY_POINT(ClearTexImage)
+GL_ENTRY_POINT(ClearTexSubImage)
+GL_ENTRY_POINT(ClientWaitSync)
+GL_ENTRY_POINT(ClipControl)
+GL_ENTRY_POINT(ColorMask)
+GL_ENTRY_POINT(ColorMaski)
+GL_ENTRY_POINT(ColorP3ui)
+GL_ENTRY_POINT(ColorP3uiv)
+GL_ENTRY_POINT(ColorP4ui)
+GL_ENTRY_POINT(ColorP4uiv)
+GL_ENTRY_POINT(CompileShader)
+GL_ENTRY_POINT(CompressedTexImage1D)
+GL_ENTRY_POINT(CompressedTexImage2D)
+GL_ENTRY_POINT(CompressedTexImage3D)
+GL_ENTRY_POINT(CompressedTexSubImage1D)
+GL_ENTRY_POINT(CompressedTexSubImage2D)
+GL_ENTRY_POINT(CompressedTexSubImage3D)
+GL_ENTRY_POINT(CompressedTextureSubImage1D)
+GL_ENTRY_POINT(CompressedTextureSubImage2D)
+GL_ENTRY_POINT(CompressedTextureSubImage3D)
+GL_ENTRY_POINT(CopyBufferSubData)
+GL_ENTRY_POINT(CopyImageSubData)
+GL_ENTRY_POINT(CopyNamedBufferSubData)
+GL_ENTRY_POINT(CopyTexImage1D)
+GL_ENTRY_POINT(CopyTexImage2D)
+GL_ENTRY_POINT(CopyTexSubImage1D)
+GL_ENTRY_POINT(CopyTexSubImage2D)
+GL_ENTRY_POINT(CopyTexSubImage3D)
+GL_ENTRY_POINT(CopyTextureSubImage1D)
+GL_ENTRY_POINT(CopyTextureSubImage2D)
+GL_ENTRY_POINT(CopyTextureSubImage3D)
+GL_ENTRY_POINT(CreateBuffers)
+GL_ENTRY_POINT(CreateFramebuffers)
+GL_ENTRY_POINT(CreateProgram)
+GL_ENTRY_POINT(CreateProgramPipelines)
+GL_ENTRY_POINT(CreateQueries)
+GL_ENTRY_POINT(CreateRenderbuffers)
+GL_ENTRY_POINT(CreateSamplers)
+GL_ENTRY_POINT(CreateShader)
+GL_ENTRY_POINT(CreateShaderProgramv)
+GL_ENTRY_POINT(CreateTextures)
+GL_ENTRY_POINT(CreateTransformFeedbacks)
+GL_ENTRY_POINT(CreateVertexArrays)
+GL_ENTRY_POINT(CullFace)
+GL_ENTRY_POINT(DebugMessageCallback)
+GL_ENTRY_POINT(DebugMessageControl)
+GL_ENTRY_POINT(DebugMessageInsert)
+GL_ENTRY_POINT(DeleteBuffers)
+GL_ENTRY_POINT(DeleteFramebuffers)
+GL_ENTRY_POINT(DeleteProgram)
+GL_ENTRY_POINT(DeleteProgramPipelines)
+GL_ENTRY_POINT(DeleteQueries)
+GL_ENTRY_POINT(DeleteRenderbuffers)
+GL_ENTRY_POINT(DeleteSamplers)
+GL_ENTRY_POINT(DeleteShader)
+GL_ENTRY_POINT(DeleteSync)
+GL_ENTRY_POINT(DeleteTextures)
+GL_ENTRY_POINT(DeleteTransformFeedbacks)
+GL_ENTRY_POINT(DeleteVertexArrays)
+GL_ENTRY_POINT(DepthFunc)
+GL_ENTRY_POINT(DepthMask)
+GL_ENTRY_POINT(DepthRange)
+GL_ENTRY_POINT(DepthRangeArrayv)
+GL_ENTRY_POINT(DepthRangeIndexed)
+GL_ENTRY_POINT(DepthRangef)
+GL_ENTRY_POINT(DetachShader)
+GL_ENTRY_POINT(Disable)
+GL_ENTRY_POINT(DisableVertexArrayAttrib)
+GL_ENTRY_POINT(DisableVertexAttribArray)
+GL_ENTRY_POINT(Disablei)
+GL_ENTRY_POINT(DispatchCompute)
+GL_ENTRY_POINT(DispatchComputeIndirect)
+GL_ENTRY_POINT(DrawArrays)
+GL_ENTRY_POINT(DrawArraysIndirect)
+GL_ENTRY_POINT(DrawArraysInstanced)
+GL_ENTRY_POINT(DrawArraysInstancedBaseInstance)
+GL_ENTRY_POINT(DrawBuffer)
+GL_ENTRY_POINT(DrawBuffers)
+GL_ENTRY_POINT(DrawElements)
+GL_ENTRY_POINT(DrawElementsBaseVertex)
+GL_ENTRY_POINT(DrawElementsIndirect)
+GL_ENTRY_POINT(DrawElementsInstanced)
+GL_ENTRY_POINT(DrawElementsInstancedBaseInstance)
+GL_ENTRY_POINT(DrawElementsInstancedBaseVertex)
+GL_ENTRY_POINT(DrawElementsInstancedBaseVertexBaseInstance)
+GL_ENTRY_POINT(DrawRangeElements)
+GL_ENTRY_POINT(DrawRangeElementsBaseVertex)
+GL_ENTRY_POINT(DrawTransformFeedback)
+GL_ENTRY_POINT(DrawTransformFeedbackInstanced)
+GL_ENTRY_POINT(DrawTransformFeedbackStream)
+GL_ENTRY_POINT(DrawTransformFeedbackStreamInstanced)
+GL_ENTRY_POINT(Enable)
+GL_ENTRY_POINT(EnableVertexArrayAttrib)
+GL_ENTRY_POINT(EnableVertexAttribArray)
+GL_ENTRY_POINT(Enablei)
+GL_ENTRY_POINT(EndConditionalRender)
+GL_ENTRY_POINT(EndQuery)
+GL_ENTRY_POINT(EndQueryIndexed)
+GL_ENTRY_POINT(EndTransformFeedback)
+GL_ENTRY_POINT(FenceSync)
+GL_ENTRY_POINT(Finish)
+GL_ENTRY_POINT(Flush)
+GL_ENTRY_POINT(FlushMappedBufferRange)
+GL_ENTRY_POINT(FlushMappedNamedBufferRange)
+GL_ENTRY_POINT(FramebufferParameteri)
+GL_ENTRY_POINT(FramebufferRenderbuffer)
+GL_ENTRY_POINT(FramebufferTexture)
+GL_ENTRY_POINT(FramebufferTexture1D)
+GL_ENTRY_POINT(FramebufferTexture2D)
+GL_ENTRY_POINT(FramebufferTexture3D)
+GL_ENTRY_POINT(FramebufferTextureLayer)
+GL_ENTRY_POINT(FrontFace)
+GL_ENTRY_POINT(GenBuffers)
+GL_ENTRY_POINT(GenFramebuffers)
+GL_ENTRY_POINT(GenProgramPipelines)
+GL_ENTRY_POINT(GenQueries)
+GL_ENTRY_POINT(GenRenderbuffers)
+GL_ENTRY_POINT(GenSamplers)
+GL_ENTRY_POINT(GenTextures)
+GL_ENTRY_POINT(GenTransformFeedbacks)
+GL_ENTRY_POINT(GenVertexArrays)
+GL_ENTRY_POINT(GenerateMipmap)
+GL_ENTRY_POINT(GenerateTextureMipmap)
+GL_ENTRY_POINT(GetActiveAtomicCounterBufferiv)
+GL_ENTRY_POINT(GetActiveAttrib)
+GL_ENTRY_POINT(GetActiveSubroutineName)
+GL_ENTRY_POINT(GetActiveSubroutineUniformName)
+GL_ENTRY_POINT(GetActiveSubroutineUniformiv)
+GL_ENTRY_POINT(GetActiveUniform)
+GL_ENTRY_POINT(GetActiveUniformBlockName)
+GL_ENTRY_POINT(GetActiveUniformBlockiv)
+GL_ENTRY_POINT(GetActiveUniformName)
+GL_ENTRY_POINT(GetActiveUniformsiv)
+GL_ENTRY_POINT(GetAttachedShaders)
+GL_ENTRY_POINT(GetAttribLocation)
+GL_ENTRY_POINT(GetBooleani_v)
+GL_ENTRY_POINT(GetBooleanv)
+GL_ENTRY_POINT(GetBufferParameteri64v)
+GL_ENTRY_POINT(GetBufferParameteriv)
+GL_ENTRY_POINT(GetBufferPointerv)
+GL_ENTRY_POINT(GetBufferSubData)
+GL_ENTRY_POINT(GetCompressedTexImage)
+GL_ENTRY_POINT(GetCompressedTextureImage)
+GL_ENTRY_POINT(GetCompressedTextureSubImage)
+GL_ENTRY_POINT(GetDebugMessageLog)
+GL_ENTRY_POINT(GetDoublei_v)
+GL_ENTRY_POINT(GetDoublev)
+GL_ENTRY_POINT(GetError)
+GL_ENTRY_POINT(GetFloati_v)
+GL_ENTRY_POINT(GetFloatv)
+GL_ENTRY_POINT(GetFragDataIndex)
+GL_ENTRY_POINT(GetFragDataLocation)
+GL_ENTRY_POINT(GetFramebufferAttachmentParameteriv)
+GL_ENTRY_POINT(GetFramebufferParameteriv)
+GL_ENTRY_POINT(GetGraphicsResetStatus)
+GL_ENTRY_POINT(GetInteger64i_v)
+GL_ENTRY_POINT(GetInteger64v)
+GL_ENTRY_POINT(GetIntegeri_v)
+GL_ENTRY_POINT(GetIntegerv)
+GL_ENTRY_POINT(GetInternalformati64v)
+GL_ENTRY_POINT(GetInternalformativ)
+GL_ENTRY_POINT(GetMultisamplefv)
+GL_ENTRY_POINT(GetNamedBufferParameteri64v)
+GL_ENTRY_POINT(GetNamedBufferParameteriv)
+GL_ENTRY_POINT(GetNamedBufferPointerv)
+GL_ENTRY_POINT(GetNamedBufferSubData)
+GL_ENTRY_POINT(GetNamedFramebufferAttachmentParameteriv)
+GL_ENTRY_POINT(GetNamedFramebufferParameteriv)
+GL_ENTRY_POINT(GetNamedRenderbufferParameteriv)
+GL_ENTRY_POINT(GetObjectLabel)
+GL_ENTRY_POINT(GetObjectPtrLabel)
+GL_ENTRY_POINT(GetPointerv)
+GL_ENTRY_POINT(GetProgramBinary)
+GL_ENTRY_POINT(GetProgramInfoLog)
+GL_ENTRY_POINT(GetProgramInterfaceiv)
+GL_ENTRY_POINT(GetProgramPipelineInfoLog)
+GL_ENTRY_POINT(GetProgramPipelineiv)
+GL_ENTRY_POINT(GetProgramResourceIndex)
+GL_ENTRY_POINT(GetProgramResourceLocation)
+GL_ENTRY_POINT(GetProgramResourceLocationIndex)
+GL_ENTRY_POINT(GetProgramResourceName)
+GL_ENTRY_POINT(GetProgramResourceiv)
+GL_ENTRY_POINT(GetProgramStageiv)
+GL_ENTRY_POINT(GetProgramiv)
+GL_ENTRY_POINT(GetQueryBufferObjecti64v)
+GL_ENTRY_POINT(GetQueryBufferObjectiv)
+GL_ENTRY_POINT(GetQueryBufferObjectui64v)
+GL_ENTRY_POINT(GetQueryBufferObjectuiv)
+GL_ENTRY_POINT(GetQueryIndexediv)
+GL_ENTRY_POINT(GetQueryObjecti64v)
+GL_ENTRY_POINT(GetQueryObjectiv)
+GL_ENTRY_POINT(GetQueryObjectui64v)
+GL_ENTRY_POINT(GetQueryObjectuiv)
+GL_ENTRY_POINT(GetQueryiv)
+GL_ENTRY_POINT(GetRenderbufferParameteriv)
+GL_ENTRY_POINT(GetSamplerParameterIiv)
+GL_ENTRY_POINT(GetSamplerParameterIuiv)
+GL_ENTRY_POINT(GetSamplerParameterfv)
+GL_ENTRY_POINT(GetSamplerParameteriv)
+GL_ENTRY_POINT(GetShaderInfoLog)
+GL_ENTRY_POINT(GetShaderPrecisionFormat)
+GL_ENTRY_POINT(GetShaderSource)
+GL_ENTRY_POINT(GetShaderiv)
+GL_ENTRY_POINT(GetString)
+GL_ENTRY_POINT(GetStringi)
+GL_ENTRY_POINT(GetSubroutineIndex)
+GL_ENTRY_POINT(GetSubroutineUniformLocation)
+GL_ENTRY_POINT(GetSynciv)
+GL_ENTRY_POINT(GetTexImage)
+GL_ENTRY_POINT(GetTexLevelParameterfv)
+GL_ENTRY_POINT(GetTexLevelParameteriv)
+GL_ENTRY_POINT(GetTexParameterIiv)
+GL_ENTRY_POINT(GetTexParameterIuiv)
+GL_ENTRY_POINT(GetTexParameterfv)
+GL_ENTRY_POINT(GetTexParameteriv)
+GL_ENTRY_POINT(GetTextureImage)
+GL_ENTRY_POINT(GetTextureLevelParameterfv)
+GL_ENTRY_POINT(GetTextureLevelParameteriv)
+GL_ENTRY_POINT(GetTextureParameterIiv)
+GL_ENTRY_POINT(GetTextureParameterIuiv)
+GL_ENTRY_POINT(GetTextureParameterfv)
+GL_ENTRY_POINT(GetTextureParameteriv)
+GL_ENTRY_POINT(GetTextureSubImage)
+GL_ENTRY_POINT(GetTransformFeedbackVarying)
+GL_ENTRY_POINT(GetTransformFeedbacki64_v)
+GL_ENTRY_POINT(GetTransformFeedbacki_v)
+GL_ENTRY_POINT(GetTransformFeedbackiv)
+GL_ENTRY_POINT(GetUniformBlockIndex)
+GL_ENTRY_POINT(GetUniformIndices)
+GL_ENTRY_POINT(GetUniformLocation)
+GL_ENTRY_POINT(GetUniformSubroutineuiv)
+GL_ENTRY_POINT(GetUniformdv)
+GL_ENTRY_POINT(GetUniformfv)
+GL_ENTRY_POINT(GetUniformiv)
+GL_ENTRY_POINT(GetUniformuiv)
+GL_ENTRY_POINT(GetVertexArrayIndexed64iv)
+GL_ENTRY_POINT(GetVertexArrayIndexediv)
+GL_ENTRY_POINT(GetVertexArrayiv)
+GL_ENTRY_POINT(GetVertexAttribIiv)
+GL_ENTRY_POINT(GetVertexAttribIuiv)
+GL_ENTRY_POINT(GetVertexAttribLdv)
+GL_ENTRY_POINT(GetVertexAttribPointerv)
+GL_ENTRY_POINT(GetVertexAttribdv)
+GL_ENTRY_POINT(GetVertexAttribfv)
+GL_ENTRY_POINT(GetVertexAttribiv)
+GL_ENTRY_POINT(GetnColorTable)
+GL_ENTRY_POINT(GetnCompressedTexImage)
+GL_ENTRY_POINT(GetnConvolutionFilter)
+GL_ENTRY_POINT(GetnHistogram)
+GL_ENTRY_POINT(GetnMapdv)
+GL_ENTRY_POINT(GetnMapfv)
+GL_ENTRY_POINT(GetnMapiv)
+GL_ENTRY_POINT(GetnMinmax)
+GL_ENTRY_POINT(GetnPixelMapfv)
+GL_ENTRY_POINT(GetnPixelMapuiv)
+GL_ENTRY_POINT(GetnPixelMapusv)
+GL_ENTRY_POINT(GetnPolygonStipple)
+GL_ENTRY_POINT(GetnSeparableFilter)
+GL_ENTRY_POINT(GetnTexImage)
+GL_ENTRY_POINT(GetnUniformdv)
+GL_ENTRY_POINT(GetnUniformfv)
+GL_ENTRY_POINT(GetnUniformiv)
+GL_ENTRY_POINT(GetnUniformuiv)
+GL_ENTRY_POINT(Hint)
+GL_ENTRY_POINT(InvalidateBufferData)
+GL_ENTRY_POINT(InvalidateBufferSubData)
+GL_ENTRY_POINT(InvalidateFramebuffer)
+GL_ENTRY_POINT(InvalidateNamedFramebufferData)
+GL_ENTRY_POINT(InvalidateNamedFramebufferSubData)
+GL_ENTRY_POINT(InvalidateSubFramebuffer)
+GL_ENTRY_POINT(InvalidateTexImage)
+GL_ENTRY_POINT(InvalidateTexSubImage)
+GL_ENTRY_POINT(IsBuffer)
+GL_ENTRY_POINT(IsEnabled)
+GL_ENTRY_POINT(IsEnabledi)
+GL_ENTRY_POINT(IsFramebuffer)
+GL_ENTRY_POINT(IsProgram)
+GL_ENTRY_POINT(IsProgramPipeline)
+GL_ENTRY_POINT(IsQuery)
+GL_ENTRY_POINT(IsRenderbuffer)
+GL_ENTRY_POINT(IsSampler)
+GL_ENTRY_POINT(IsShader)
+GL_ENTRY_POINT(IsSync)
+GL_ENTRY_POINT(IsTexture)
+GL_ENTRY_POINT(IsTransformFeedback)
+GL_ENTRY_POINT(IsVertexArray)
+GL_ENTRY_POINT(LineWidth)
+GL_ENTRY_POINT(LinkProgram)
+GL_ENTRY_POINT(LogicOp)
+GL_ENTRY_POINT(MapBuffer)
+GL_ENTRY_POINT(MapBufferRange)
+GL_ENTRY_POINT(MapNamedBuffer)
+GL_ENTRY_POINT(MapNamedBufferRange)
+GL_ENTRY_POINT(MemoryBarrier)
+GL_ENTRY_POINT(MemoryBarrierByRegion)
+GL_ENTRY_POINT(MinSampleShading)
+GL_ENTRY_POINT(MultiDrawArrays)
+GL_ENTRY_POINT(MultiDrawArraysIndirect)
+GL_ENTRY_POINT(MultiDrawArraysIndirectCount)
+GL_ENTRY_POINT(MultiDrawElements)
+GL_ENTRY_POINT(MultiDrawElementsBaseVertex)
+GL_ENTRY_POINT(MultiDrawElementsIndirect)
+GL_ENTRY_POINT(MultiDrawElementsIndirectCount)
+GL_ENTRY_POINT(MultiTexCoordP1ui)
+GL_ENTRY_POINT(MultiTexCoordP1uiv)
+GL_ENTRY_POINT(MultiTexCoordP2ui)
+GL_ENTRY_POINT(MultiTexCoordP2uiv)
+GL_ENTRY_POINT(MultiTexCoordP3ui)
+GL_ENTRY_POINT(MultiTexCoordP3uiv)
+GL_ENTRY_POINT(MultiTexCoordP4ui)
+GL_ENTRY_POINT(MultiTexCoordP4uiv)
+GL_ENTRY_POINT(NamedBufferData)
+GL_ENTRY_POINT(NamedBufferStorage)
+GL_ENTRY_POINT(NamedBufferSubData)
+GL_ENTRY_POINT(NamedFramebufferDrawBuffer)
+GL_ENTRY_POINT(NamedFramebufferDrawBuffers)
+GL_ENTRY_POINT(NamedFramebufferParameteri)
+GL_ENTRY_POINT(NamedFramebufferReadBuffer)
+GL_ENTRY_POINT(NamedFramebufferRenderbuffer)
+GL_ENTRY_POINT(NamedFramebufferTexture)
+GL_ENTRY_POINT(NamedFramebufferTextureLayer)
+GL_ENTRY_POINT(NamedRenderbufferStorage)
+GL_ENTRY_POINT(NamedRenderbufferStorageMultisample)
+GL_ENTRY_POINT(NormalP3ui)
+GL_ENTRY_POINT(NormalP3uiv)
+GL_ENTRY_POINT(ObjectLabel)
+GL_ENTRY_POINT(ObjectPtrLabel)
+GL_ENTRY_POINT(PatchParameterfv)
+GL_ENTRY_POINT(PatchParameteri)
+GL_ENTRY_POINT(PauseTransformFeedback)
+GL_ENTRY_POINT(PixelStoref)
+GL_ENTRY_POINT(PixelStorei)
+GL_ENTRY_POINT(PointParameterf)
+GL_ENTRY_POINT(PointParameterfv)
+GL_ENTRY_POINT(PointParameteri)
+GL_ENTRY_POINT(PointParameteriv)
+GL_ENTRY_POINT(PointSize)
+GL_ENTRY_POINT(PolygonMode)
+GL_ENTRY_POINT(PolygonOffset)
+GL_ENTRY_POINT(PolygonOffsetClamp)
+GL_ENTRY_POINT(PopDebugGroup)
+GL_ENTRY_POINT(PrimitiveRestartIndex)
+GL_ENTRY_POINT(ProgramBinary)
+GL_ENTRY_POINT(ProgramParameteri)
+GL_ENTRY_POINT(ProgramUniform1d)
+GL_ENTRY_POINT(ProgramUniform1dv)
+GL_ENTRY_POINT(ProgramUniform1f)
+GL_ENTRY_POINT(ProgramUniform1fv)
+GL_ENTRY_POINT(ProgramUniform1i)
+GL_ENTRY_POINT(ProgramUniform1iv)
+GL_ENTRY_POINT(ProgramUniform1ui)
+GL_ENTRY_POINT(ProgramUniform1uiv)
+GL_ENTRY_POINT(ProgramUniform2d)
+GL_ENTRY_POINT(ProgramUniform2dv)
+GL_ENTRY_POINT(ProgramUniform2f)
+GL_ENTRY_POINT(ProgramUniform2fv)
+GL_ENTRY_POINT(ProgramUniform2i)
+GL_ENTRY_POINT(ProgramUniform2iv)
+GL_ENTRY_POINT(ProgramUniform2ui)
+GL_ENTRY_POINT(ProgramUniform2uiv)
+GL_ENTRY_POINT(ProgramUniform3d)
+GL_ENTRY_POINT(ProgramUniform3dv)
+GL_ENTRY_POINT(ProgramUniform3f)
+GL_ENTRY_POINT(ProgramUniform3fv)
+GL_ENTRY_POINT(ProgramUniform3i)
+GL_ENTRY_POINT(ProgramUniform3iv)
+GL_ENTRY_POINT(ProgramUniform3ui)
+GL_ENTRY_POINT(ProgramUniform3uiv)
+GL_ENTRY_POINT(ProgramUniform4d)
+GL_ENTRY_POINT(ProgramUniform4dv)
+GL_ENTRY_POINT(ProgramUniform4f)
+GL_ENTRY_POINT(ProgramUniform4fv)
+GL_ENTRY_POINT(ProgramUniform4i)
+GL_ENTRY_POINT(ProgramUniform4iv)
+GL_ENTRY_POINT(ProgramUniform4ui)
+GL_ENTRY_POINT(ProgramUniform4uiv)
+GL_ENTRY_POINT(ProgramUniformMatrix2dv)
+GL_ENTRY_POINT(ProgramUniformMatrix2fv)
+GL_ENTRY_POINT(ProgramUniformMatrix2x3dv)
+GL_ENTRY_POINT(ProgramUniformMatrix2x3fv)
+GL_ENTRY_POINT(ProgramUniformMatrix2x4dv)
+GL_ENTRY_POINT(ProgramUniformMatrix2x4fv)
+GL_ENTRY_POINT(ProgramUniformMatrix3dv)
+GL_ENTRY_POINT(ProgramUniformMatrix3fv)
+GL_ENTRY_POINT(ProgramUniformMatrix3x2dv)
+GL_ENTRY_POINT(ProgramUniformMatrix3x2fv)
+GL_ENTRY_POINT(ProgramUniformMatrix3x4dv)
+GL_ENTRY_POINT(ProgramUniformMatrix3x4fv)
+GL_ENTRY_POINT(ProgramUniformMatrix4dv)
+GL_ENTRY_POINT(ProgramUniformMatrix4fv)
+GL_ENTRY_POINT(ProgramUniformMatrix4x2dv)
+GL_ENTRY_POINT(ProgramUniformMatrix4x2fv)
+GL_ENTRY_POINT(ProgramUniformMatrix4x3dv)
+GL_ENTRY_POINT(ProgramUniformMatrix4x3fv)
+GL_ENTRY_POINT(ProvokingVertex)
+GL_ENTRY_POINT(PushDebugGroup)
+GL_ENTRY_POINT(QueryCounter)
+GL_ENTRY_POINT(ReadBuffer)
+GL_ENTRY_POINT(ReadPixels)
+GL_ENTRY_POINT(ReadnPixels)
+GL_ENTRY_POINT(ReleaseShaderCompiler)
+GL_ENTRY_POINT(RenderbufferStorage)
+GL_ENTRY_POINT(RenderbufferStorageMultisample)
+GL_ENTRY_POINT(ResumeTransformFeedback)
+GL_ENTRY_POINT(SampleCoverage)
+GL_ENTRY_POINT(SampleMaski)
+GL_ENTRY_POINT(SamplerParameterIiv)
+GL_ENTRY_POINT(SamplerParameterIuiv)
+GL_ENTRY_POINT(SamplerParameterf)
+GL_ENTRY_POINT(SamplerParameterfv)
+GL_ENTRY_POINT(SamplerParameteri)
+GL_ENTRY_POINT(SamplerParameteriv)
+GL_ENTRY_POINT(Scissor)
+GL_ENTRY_POINT(ScissorArrayv)
+GL_ENTRY_POINT(ScissorIndexed)
+GL_ENTRY_POINT(ScissorIndexedv)
+GL_ENTRY_POINT(SecondaryColorP3ui)
+GL_ENTRY_POINT(SecondaryColorP3uiv)
+GL_ENTRY_POINT(ShaderBinary)
+GL_ENTRY_POINT(ShaderSource)
+GL_ENTRY_POINT(ShaderStorageBlockBinding)
+GL_ENTRY_POINT(SpecializeShader)
+GL_ENTRY_POINT(StencilFunc)
+GL_ENTRY_POINT(StencilFuncSeparate)
+GL_ENTRY_POINT(StencilMask)
+GL_ENTRY_POINT(StencilMaskSeparate)
+GL_ENTRY_POINT(StencilOp)
+GL_ENTRY_POINT(StencilOpSeparate)
+GL_ENTRY_POINT(TexBuffer)
+GL_ENTRY_POINT(TexBufferRange)
+GL_ENTRY_POINT(TexCoordP1ui)
+GL_ENTRY_POINT(TexCoordP1uiv)
+GL_ENTRY_POINT(TexCoordP2ui)
+GL_ENTRY_POINT(TexCoordP2uiv)
+GL_ENTRY_POINT(TexCoordP3ui)
+GL_ENTRY_POINT(TexCoordP3uiv)
+GL_ENTRY_POINT(TexCoordP4ui)
+GL_ENTRY_POINT(TexCoordP4uiv)
+GL_ENTRY_POINT(TexImage1D)
+GL_ENTRY_POINT(TexImage2D)
+GL_ENTRY_POINT(TexImage2DMultisample)
+GL_ENTRY_POINT(TexImage3D)
+GL_ENTRY_POINT(TexImage3DMultisample)
+GL_ENTRY_POINT(TexParameterIiv)
+GL_ENTRY_POINT(TexParameterIuiv)
+GL_ENTRY_POINT(TexParameterf)
+GL_ENTRY_POINT(TexParameterfv)
+GL_ENTRY_POINT(TexParameteri)
+GL_ENTRY_POINT(TexParameteriv)
+GL_ENTRY_POINT(TexStorage1D)
+GL_ENTRY_POINT(TexStorage2D)
+GL_ENTRY_POINT(TexStorage2DMultisample)
+GL_ENTRY_POINT(TexStorage3D)
+GL_ENTRY_POINT(TexStorage3DMultisample)
+GL_ENTRY_POINT(TexSubImage1D)
+GL_ENTRY_POINT(TexSubImage2D)
+GL_ENTRY_POINT(TexSubImage3D)
+GL_ENTRY_POINT(TextureBarrier)
+GL_ENTRY_POINT(TextureBuffer)
+GL_ENTRY_POINT(TextureBufferRange)
+GL_ENTRY_POINT(TextureParameterIiv)
+GL_ENTRY_POINT(TextureParameterIuiv)
+GL_ENTRY_POINT(TextureParameterf)
+GL_ENTRY_POINT(TextureParameterfv)
+GL_ENTRY_POINT(TextureParameteri)
+GL_ENTRY_POINT(TextureParameteriv)
+GL_ENTRY_POINT(TextureStorage1D)
+GL_ENTRY_POINT(TextureStorage2D)
+GL_ENTRY_POINT(TextureStorage2DMultisample)
+GL_ENTRY_POINT(TextureStorage3D)
+GL_ENTRY_POINT(TextureStorage3DMultisample)
+GL_ENTRY_POINT(TextureSubImage1D)
+GL_ENTRY_POINT(TextureSubImage2D)
+GL_ENTRY_POINT(TextureSubImage3D)
+GL_ENTRY_POINT(TextureView)
+GL_ENTRY_POINT(TransformFeedbackBufferBase)
+GL_ENTRY_POINT(TransformFeedbackBufferRange)
+GL_ENTRY_POINT(TransformFeedbackVaryings)
+GL_ENTRY_POINT(Uniform1d)
+GL_ENTRY_POINT(Uniform1dv)
+GL_ENTRY_POINT(Uniform1f)
+GL_ENTRY_POINT(Uniform1fv)
+GL_ENTRY_POINT(Uniform1i)
+GL_ENTRY_POINT(Uniform1iv)
+GL_ENTRY_POINT(Uniform1ui)
+GL_ENTRY_POINT(Uniform1uiv)
+GL_ENTRY_POINT(Uniform2d)
+GL_ENTRY_POINT(Uniform2dv)
+GL_ENTRY_POINT(Uniform2f)
+GL_ENTRY_POINT(Uniform2fv)
+GL_ENTRY_POINT(Uniform2i)
+GL_ENTRY_POINT(Uniform2iv)
+GL_ENTRY_POINT(Uniform2ui)
+GL_ENTRY_POINT(Uniform2uiv)
+GL_ENTRY_POINT(Uniform3d)
+GL_ENTRY_POINT(Uniform3dv)
+GL_ENTRY_POINT(Uniform3f)
+GL_ENTRY_POINT(Uniform3fv)
+GL_ENTRY_POINT(Uniform3i)
+GL_ENTRY_POINT(Uniform3iv)
+GL_ENTRY_POINT(Uniform3ui)
+GL_ENTRY_POINT(Uniform3uiv)
+GL_ENTRY_POINT(Uniform4d)
+GL_ENTRY_POINT(Uniform4dv)
+GL_ENTRY_POINT(Uniform4f)
+GL_ENTRY_POINT(Uniform4fv)
+GL_ENTRY_POINT(Uniform4i)
+GL_ENTRY_POINT(Uniform4iv)
+GL_ENTRY_POINT(Uniform4ui)
+GL_ENTRY_POINT(Uniform4uiv)
+GL_ENTRY_POINT(UniformBlockBinding)
+GL_ENTRY_POINT(UniformMatrix2dv)
+GL_ENTRY_POINT(UniformMatrix2fv)
+GL_ENTRY_POINT(UniformMatrix2x3dv)
+GL_ENTRY_POINT(UniformMatrix2x3fv)
+GL_ENTRY_POINT(UniformMatrix2x4dv)
+GL_ENTRY_POINT(UniformMatrix2x4fv)
+GL_ENTRY_POINT(UniformMatrix3dv)
+GL_ENTRY_POINT(UniformMatrix3fv)
+GL_ENTRY_POINT(UniformMatrix3x2dv)
+GL_ENTRY_POINT(UniformMatrix3x2fv)
+GL_ENTRY_POINT(UniformMatrix3x4dv)
+GL_ENTRY_POINT(UniformMatrix3x4fv)
+GL_ENTRY_POINT(UniformMatrix4dv)
+GL_ENTRY_POINT(UniformMatrix4fv)
+GL_ENTRY_POINT(UniformMatrix4x2dv)
+GL_ENTRY_POINT(UniformMatrix4x2fv)
+GL_ENTRY_POINT(UniformMatrix4x3dv)
+GL_ENTRY_POINT(UniformMatrix4x3fv)
+GL_ENTRY_POINT(UniformSubroutinesuiv)
+GL_ENTRY_POINT(UnmapBuffer)
+GL_ENTRY_POINT(UnmapNamedBuffer)
+GL_ENTRY_POINT(UseProgram)
+GL_ENTRY_POINT(UseProgramStages)
+GL_ENTRY_POINT(ValidateProgram)
+GL_ENTRY_POINT(ValidateProgramPipeline)
+GL_ENTRY_POINT(VertexArrayAttribBinding)
+GL_ENTRY_POINT(VertexArrayAttribFormat)
+GL_ENTRY_POINT(VertexArrayAttribIFormat)
+GL_ENTRY_POINT(VertexArrayAttribLFormat)
+GL_ENTRY_POINT(VertexArrayBindingDivisor)
+GL_ENTRY_POINT(VertexArrayElementBuffer)
+GL_ENTRY_POINT(VertexArrayVertexBuffer)
+GL_ENTRY_POINT(VertexArrayVertexBuffers)
+GL_ENTRY_POINT(VertexAttrib1d)
+GL_ENTRY_POINT(VertexAttrib1dv)
+GL_ENTRY_POINT(VertexAttrib1f)
+GL_ENTRY_POINT(VertexAttrib1fv)
+GL_ENTRY_POINT(VertexAttrib1s)
+GL_ENTRY_POINT(VertexAttrib1sv)
+GL_ENTRY_POINT(VertexAttrib2d)
+GL_ENTRY_POINT(VertexAttrib2dv)
+GL_ENTRY_POINT(VertexAttrib2f)
+GL_ENTRY_POINT(VertexAttrib2fv)
+GL_ENTRY_POINT(VertexAttrib2s)
+GL_ENTRY_POINT(VertexAttrib2sv)
+GL_ENTRY_POINT(VertexAttrib3d)
+GL_ENTRY_POINT(VertexAttrib3dv)
+GL_ENTRY_POINT(VertexAttrib3f)
+GL_ENTRY_POINT(VertexAttrib3fv)
+GL_ENTRY_POINT(VertexAttrib3s)
+GL_ENTRY_POINT(VertexAttrib3sv)
+GL_ENTRY_POINT(VertexAttrib4Nbv)
+GL_ENTRY_POINT(VertexAttrib4Niv)
+GL_ENTRY_POINT(VertexAttrib4Nsv)
+GL_ENTRY_POINT(VertexAttrib4Nub)
+GL_ENTRY_POINT(VertexAttrib4Nubv)
+GL_ENTRY_POINT(VertexAttrib4Nuiv)
+GL_ENTRY_POINT(VertexAttrib4Nusv)
+GL_ENTRY_POINT(VertexAttrib4bv)
+GL_ENTRY_POINT(VertexAttrib4d)
+GL_ENTRY_POINT(VertexAttrib4dv)
+GL_ENTRY_POINT(VertexAttrib4f)
+GL_ENTRY_POINT(VertexAttrib4fv)
+GL_ENTRY_POINT(VertexAttrib4iv)
+GL_ENTRY_POINT(VertexAttrib4s)
+GL_ENTRY_POINT(VertexAttrib4sv)
+GL_ENTRY_POINT(VertexAttrib4ubv)
+GL_ENTRY_POINT(VertexAttrib4uiv)
+GL_ENTRY_POINT(VertexAttrib4usv)
+GL_ENTRY_POINT(VertexAttribBinding)
+GL_ENTRY_POINT(VertexAttribDivisor)
+GL_ENTRY_POINT(VertexAttribFormat)
+GL_ENTRY_POINT(VertexAttribI1i)
+GL_ENTRY_POINT(VertexAttribI1iv)
+GL_ENTRY_POINT(VertexAttribI1ui)
+GL_ENTRY_POINT(VertexAttribI1uiv)
+GL_ENTRY_POINT(VertexAttribI2i)
+GL_ENTRY_POINT(VertexAttribI2iv)
+GL_ENTRY_POINT(VertexAttribI2ui)
+GL_ENTRY_POINT(VertexAttribI2uiv)
+GL_ENTRY_POINT(VertexAttribI3i)
+GL_ENTRY_POINT(VertexAttribI3iv)
+GL_ENTRY_POINT(VertexAttribI3ui)
+GL_ENTRY_POINT(VertexAttribI3uiv)
+GL_ENTRY_POINT(VertexAttribI4bv)
+GL_ENTRY_POINT(VertexAttribI4i)
+GL_ENTRY_POINT(VertexAttribI4iv)
+GL_ENTRY_POINT(VertexAttribI4sv)
+GL_ENTRY_POINT(VertexAttribI4ubv)
+GL_ENTRY_POINT(VertexAttribI4ui)
+GL_ENTRY_POINT(VertexAttribI4uiv)
+GL_ENTRY_POINT(VertexAttribI4usv)
+GL_ENTRY_POINT(VertexAttribIFormat)
+GL_ENTRY_POINT(VertexAttribIPointer)
+GL_ENTRY_POINT(VertexAttribL1d)
+GL_ENTRY_POINT(VertexAttribL1dv)
+GL_ENTRY_POINT(VertexAttribL2d)
+GL_ENTRY_POINT(VertexAttribL2dv)
+GL_ENTRY_POINT(VertexAttribL3d)
+GL_ENTRY_POINT(VertexAttribL3dv)
+GL_ENTRY_POINT(VertexAttribL4d)
+GL_ENTRY_POINT(VertexAttribL4dv)
+GL_ENTRY_POINT(VertexAttribLFormat)
+GL_ENTRY_POINT(VertexAttribLPointer)
+GL_ENTRY_POINT(VertexAttribP1ui)
+GL_ENTRY_POINT(VertexAttribP1uiv)
+GL_ENTRY_POINT(VertexAttribP2ui)
+GL_ENTRY_POINT(VertexAttribP2uiv)
+GL_ENTRY_POINT(VertexAttribP3ui)
+GL_ENTRY_POINT(VertexAttribP3uiv)
+GL_ENTRY_POINT(VertexAttribP4ui)
+GL_ENTRY_POINT(VertexAttribP4uiv)
+GL_ENTRY_POINT(VertexAttribPointer)
+GL_ENTRY_POINT(VertexBindingDivisor)
+GL_ENTRY_POINT(VertexP2ui)
+GL_ENTRY_POINT(VertexP2uiv)
+GL_ENTRY_POINT(VertexP3ui)
+GL_ENTRY_POINT(VertexP3uiv)
+GL_ENTRY_POINT(VertexP4ui)
+GL_ENTRY_POINT(VertexP4uiv)
+GL_ENTRY_POINT(Viewport)
+GL_ENTRY_POINT(ViewportArrayv)
+GL_ENTRY_POINT(ViewportIndexedf)
+GL_ENTRY_POINT(ViewportIndexedfv)
+GL_ENTRY_POINT(WaitSync)
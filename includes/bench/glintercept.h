@@ -0,0 +1,255 @@
+#ifndef GLINTERCEPT_H
+#define GLINTERCEPT_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/**
+ * GL call interception layer
+ *
+ * InstallGLIntercept() puts a hook in front of every entry point glad
+ * loaded (the table in bench/glentrypoints.inl is generated from glad.c,
+ * see `make entrypoints` in benchmarks/frameBench). Each hook counts the
+ * call and forwards it to the driver; with timing on it also measures
+ * the CPU time spent in the call. Calling GLInterceptFrame() once per
+ * frame turns the counts into calls per frame by entry point, which is
+ * what shows redundant traffic such as a glGetUniformLocation every
+ * frame or rebinding an already bound texture.
+ *
+ *     gladLoadGLLoader(...);
+ *     InstallGLIntercept();               // or InstallGLIntercept(true) to time calls
+ *     while (...)
+ *     {
+ *         ...render...
+ *         GLInterceptFrame();
+ *     }
+ *     PrintGLCallStats();
+ *
+ * The samples enable it with --bench --glcalls (see bench/framebench.h).
+ * Hooks are not removable; they cost an increment per call when idle.
+ */
+
+enum GLEntryPoint {
+#define GL_ENTRY_POINT(name) GL_ENTRY_##name,
+#include <bench/glentrypoints.inl>
+#undef GL_ENTRY_POINT
+    GL_ENTRY_POINT_COUNT
+};
+
+// One entry point's calls since the last ResetGLIntercept()
+struct GLCallStats {
+    const char* name;
+    uint64_t calls;
+    uint64_t maxPerFrame;
+    double callsPerFrame;
+    double totalMs;             // CPU time inside the call, 0 without timing
+};
+
+namespace glintercept_detail {
+
+typedef void (APIENTRYP GenericProc)(void);
+
+struct State {
+    GenericProc originals[GL_ENTRY_POINT_COUNT];
+    uint64_t frameCalls[GL_ENTRY_POINT_COUNT];      // current frame
+    uint64_t totalCalls[GL_ENTRY_POINT_COUNT];      // finished frames
+    uint64_t maxCalls[GL_ENTRY_POINT_COUNT];
+    uint64_t totalNs[GL_ENTRY_POINT_COUNT];
+    uint64_t frames;
+    bool installed;
+    bool timing;
+};
+
+// Zero initialized, GL is only called from the context's thread
+inline State& state()
+{
+    static State s;
+    return s;
+}
+
+inline const char* entryName(int id)
+{
+    static const char* const names[] = {
+#define GL_ENTRY_POINT(name) "gl" #name,
+#include <bench/glentrypoints.inl>
+#undef GL_ENTRY_POINT
+    };
+    return names[id];
+}
+
+class CallTimer
+{
+public:
+    explicit CallTimer(uint64_t& ns) : ns(ns), start(std::chrono::steady_clock::now()) {}
+    ~CallTimer(){
+        ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    uint64_t& ns;
+    std::chrono::steady_clock::time_point start;
+};
+
+// One hook per entry point, with the signature taken from glad's pointer type
+template <int ID, class Proc> struct Hook;
+
+template <int ID, class R, class... Args>
+struct Hook<ID, R (APIENTRYP)(Args...)>
+{
+    typedef R (APIENTRYP Proc)(Args...);
+
+    static R APIENTRY call(Args... args){
+        State& s = state();
+        s.frameCalls[ID]++;
+        Proc original = reinterpret_cast<Proc>(s.originals[ID]);
+        if (!s.timing)
+            return original(args...);
+        CallTimer timer(s.totalNs[ID]);
+        return original(args...);
+    }
+};
+
+} // namespace glintercept_detail
+
+/**
+ * @brief      Hook every loaded GL entry point, call after gladLoadGLLoader
+ *
+ * Entry points the driver does not provide stay NULL. Calling it again
+ * only changes the timing setting.
+ *
+ * @param      timing  also measure the CPU time of every call
+ */
+inline void InstallGLIntercept(bool timing = false)
+{
+    using namespace glintercept_detail;
+    State& s = state();
+    s.timing = timing;
+    if (s.installed)
+        return;
+#define GL_ENTRY_POINT(name)                                                                    \
+    if (glad_gl##name)                                                                          \
+    {                                                                                           \
+        s.originals[GL_ENTRY_##name] = reinterpret_cast<GenericProc>(glad_gl##name);            \
+        glad_gl##name = &Hook<GL_ENTRY_##name, decltype(glad_gl##name)>::call;                  \
+    }
+#include <bench/glentrypoints.inl>
+#undef GL_ENTRY_POINT
+    s.installed = true;
+}
+
+/**
+ * @brief      Close the current frame's counts, call once per frame
+ */
+inline void GLInterceptFrame()
+{
+    glintercept_detail::State& s = glintercept_detail::state();
+    for (int i = 0; i < GL_ENTRY_POINT_COUNT; i++)
+    {
+        s.totalCalls[i] += s.frameCalls[i];
+        s.maxCalls[i] = std::max(s.maxCalls[i], s.frameCalls[i]);
+        s.frameCalls[i] = 0;
+    }
+    s.frames++;
+}
+
+inline void ResetGLIntercept()
+{
+    glintercept_detail::State& s = glintercept_detail::state();
+    for (int i = 0; i < GL_ENTRY_POINT_COUNT; i++)
+    {
+        s.frameCalls[i] = 0;
+        s.totalCalls[i] = 0;
+        s.maxCalls[i] = 0;
+        s.totalNs[i] = 0;
+    }
+    s.frames = 0;
+}
+
+/**
+ * @brief      Entry points called over the finished frames, most called first
+ */
+inline std::vector<GLCallStats> GetGLCallStats()
+{
+    const glintercept_detail::State& s = glintercept_detail::state();
+    std::vector<GLCallStats> stats;
+    for (int i = 0; i < GL_ENTRY_POINT_COUNT; i++)
+    {
+        if (!s.totalCalls[i])
+            continue;
+        GLCallStats entry;
+        entry.name = glintercept_detail::entryName(i);
+        entry.calls = s.totalCalls[i];
+        entry.maxPerFrame = s.maxCalls[i];
+        entry.callsPerFrame = s.frames ? (double)s.totalCalls[i] / s.frames : 0.0;
+        entry.totalMs = s.totalNs[i] / 1.0e6;
+        stats.push_back(entry);
+    }
+    std::stable_sort(stats.begin(), stats.end(), [](const GLCallStats& a, const GLCallStats& b) {
+        return a.calls > b.calls;
+    });
+    return stats;
+}
+
+/**
+ * @brief      The call statistics as a JSON object, for FrameBenchmark::AddSection
+ */
+inline std::string GLInterceptReportJSON()
+{
+    const glintercept_detail::State& s = glintercept_detail::state();
+    std::vector<GLCallStats> stats = GetGLCallStats();
+    uint64_t calls = 0;
+    for (size_t i = 0; i < stats.size(); i++)
+        calls += stats[i].calls;
+
+    std::ostringstream json;
+    json << "{\n    \"frames\": " << s.frames
+         << ",\n    \"calls_per_frame\": " << (s.frames ? (double)calls / s.frames : 0.0)
+         << ",\n    \"timed\": " << (s.timing ? "true" : "false")
+         << ",\n    \"entry_points\": {";
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        json << (i ? ",\n" : "\n") << "      \"" << stats[i].name << "\": { \"per_frame\": " << stats[i].callsPerFrame
+             << ", \"max_per_frame\": " << stats[i].maxPerFrame;
+        if (s.timing)
+            json << ", \"total_ms\": " << stats[i].totalMs
+                 << ", \"us_per_call\": " << stats[i].totalMs * 1.0e3 / stats[i].calls;
+        json << " }";
+    }
+    json << "\n    }\n  }";
+    return json.str();
+}
+
+/**
+ * @brief      Print the most called entry points
+ *
+ * @param      top   rows to print, 0 for all
+ */
+inline void PrintGLCallStats(unsigned int top = 20)
+{
+    const glintercept_detail::State& s = glintercept_detail::state();
+    std::vector<GLCallStats> stats = GetGLCallStats();
+    if (top && stats.size() > top)
+        stats.resize(top);
+    std::cout << "GL calls per frame over " << s.frames << " frames:" << std::endl;
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        char line[160];
+        if (s.timing)
+            snprintf(line, sizeof(line), "  %-32s %10.2f /frame (max %llu)  %9.3f ms  %8.3f us/call",
+                     stats[i].name, stats[i].callsPerFrame, (unsigned long long)stats[i].maxPerFrame,
+                     stats[i].totalMs, stats[i].totalMs * 1.0e3 / stats[i].calls);
+        else
+            snprintf(line, sizeof(line), "  %-32s %10.2f /frame (max %llu)",
+                     stats[i].name, stats[i].callsPerFrame, (unsigned long long)stats[i].maxPerFrame);
+        std::cout << line << std::endl;
+    }
+}
+#endif
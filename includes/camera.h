@@ -5,6 +5,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <profiling/trace.h>
+#include <scene/bounds.h>
+
 #include <vector>
 
 // Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
@@ -63,12 +66,36 @@ public:
     // Returns the view matrix calculated using Euler Angles and the LookAt Matrix
     glm::mat4 GetViewMatrix()
     {
+        TRACE_SCOPE("Camera::GetViewMatrix");
         return glm::lookAt(Position, Position + Front, Up);
     }
 
+    // Returns the perspective projection for the current zoom
+    glm::mat4 GetProjectionMatrix(float aspect, float zNear = 0.1f, float zFar = 100.0f)
+    {
+        return glm::perspective(glm::radians(Zoom), aspect, zNear, zFar);
+    }
+
+    // Returns the world space planes of what the camera sees, for culling (see scene/bvh.h)
+    Frustum GetFrustum(float aspect, float zNear = 0.1f, float zFar = 100.0f)
+    {
+        return Frustum::FromMatrix(GetProjectionMatrix(aspect, zNear, zFar) * GetViewMatrix());
+    }
+
+    // Returns the ray from the camera through a cursor position (window coordinates, origin top left), for picking
+    Ray GetScreenRay(float x, float y, float width, float height)
+    {
+        float tanHalfFov = tan(glm::radians(Zoom) * 0.5f);
+        float ndcX = 2.0f * x / width - 1.0f;
+        float ndcY = 1.0f - 2.0f * y / height;
+        glm::vec3 direction = Front + Right * (ndcX * tanHalfFov * width / height) + Up * (ndcY * tanHalfFov);
+        return Ray(Position, glm::normalize(direction));
+    }
+
     // Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
     void ProcessKeyboard(Camera_Movement direction, float deltaTime)
     {
+        TRACE_SCOPE("Camera::ProcessKeyboard");
         float velocity = MovementSpeed * deltaTime;
         if (direction == FORWARD)
             Position += Front * velocity;
@@ -83,6 +110,7 @@ public:
     // Processes input received from a mouse input system. Expects the offset value in both the x and y direction.
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true)
     {
+        TRACE_SCOPE("Camera::ProcessMouseMovement");
         xoffset *= MouseSensitivity;
         yoffset *= MouseSensitivity;
 
@@ -102,6 +130,16 @@ public:
         updateCameraVectors();
     }
 
+    // Places the camera at position looking at target. Used by scripted camera paths (see bench/framebench.h)
+    void LookAt(glm::vec3 position, glm::vec3 target)
+    {
+        Position = position;
+        glm::vec3 direction = glm::normalize(target - position);
+        Yaw   = glm::degrees(atan2(direction.z, direction.x));
+        Pitch = glm::degrees(asin(direction.y));
+        updateCameraVectors();
+    }
+
     // Processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
     void ProcessMouseScroll(float yoffset)
     {
@@ -0,0 +1,217 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include <stb_image.h>
+#endif
+
+#include <capture/readback.h>
+#include <capture/pngwrite.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/**
+ * Golden image checks for the samples
+ *
+ * Run headless and deterministic (--bench) a sample renders frame N,
+ * reads it back through AsyncReadback, optionally writes it as a PNG
+ * and compares it with a stored golden image. Options:
+ *
+ *     --capture file.png   write the captured frame
+ *     --golden file.png    compare the captured frame with this image
+ *     --capture-frame N    frame to capture (default 60)
+ *     --threshold T        channel difference that makes a pixel differ (default 8)
+ *     --tolerance P        percent of pixels allowed to differ (default 0.1)
+ *
+ * On a mismatch a diff image (differing pixels red over the dimmed
+ * golden) is written next to the capture. `make golden` in a sample
+ * checks it against goldens/<binary>.png, `make golden-update` records
+ * that image.
+ */
+
+struct ImageDiff {
+    int maxDifference;          // largest channel difference
+    double meanDifference;      // per channel
+    double psnr;                // dB, infinite for identical images
+    size_t differingPixels;
+    double differingPercent;
+};
+
+/**
+ * @brief      Compare two images of the same size, 8 bits per channel
+ *
+ * @param      threshold  channel difference above which a pixel counts as differing
+ * @param      diffImage  if not NULL, receives an RGB visualization
+ */
+inline ImageDiff CompareImages(const unsigned char* expected, const unsigned char* actual, int width, int height,
+                               int channels, int threshold, std::vector<unsigned char>* diffImage = NULL)
+{
+    ImageDiff diff;
+    diff.maxDifference = 0;
+    diff.differingPixels = 0;
+    double sum = 0.0, squares = 0.0;
+    size_t pixels = (size_t)width * height;
+    if (diffImage)
+        diffImage->resize(pixels * 3);
+    for (size_t p = 0; p < pixels; p++)
+    {
+        int worst = 0;
+        for (int c = 0; c < channels; c++)
+        {
+            int d = abs((int)expected[p * channels + c] - (int)actual[p * channels + c]);
+            worst = d > worst ? d : worst;
+            sum += d;
+            squares += (double)d * d;
+        }
+        diff.maxDifference = worst > diff.maxDifference ? worst : diff.maxDifference;
+        bool differs = worst > threshold;
+        diff.differingPixels += differs;
+        if (diffImage)
+        {
+            int sumExpected = 0;
+            for (int c = 0; c < channels; c++)
+                sumExpected += expected[p * channels + c];
+            unsigned char gray = (unsigned char)(sumExpected / (channels * 3));
+            unsigned char* out = &(*diffImage)[p * 3];
+            out[0] = differs ? 255 : gray;
+            out[1] = differs ? 0 : gray;
+            out[2] = differs ? 0 : gray;
+        }
+    }
+    double samples = (double)pixels * channels;
+    diff.meanDifference = samples > 0 ? sum / samples : 0.0;
+    double mse = samples > 0 ? squares / samples : 0.0;
+    diff.psnr = mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+    diff.differingPercent = pixels ? 100.0 * diff.differingPixels / pixels : 0.0;
+    return diff;
+}
+
+class GoldenCapture
+{
+public:
+
+    GoldenCapture(int argc, char const *argv[])
+        : captureFrame(60), threshold(8), tolerance(0.1), frame(0), captured(false) {
+        for (int i = 1; i + 1 < argc; i++)
+        {
+            if (strcmp(argv[i], "--capture") == 0)
+                capturePath = argv[++i];
+            else if (strcmp(argv[i], "--golden") == 0)
+                goldenPath = argv[++i];
+            else if (strcmp(argv[i], "--capture-frame") == 0)
+                captureFrame = (unsigned long)atol(argv[++i]);
+            else if (strcmp(argv[i], "--threshold") == 0)
+                threshold = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--tolerance") == 0)
+                tolerance = atof(argv[++i]);
+        }
+    }
+
+    GoldenCapture(const GoldenCapture&) = delete;
+    GoldenCapture& operator=(const GoldenCapture&) = delete;
+
+    bool Enabled() const { return !capturePath.empty() || !goldenPath.empty(); }
+
+    /**
+     * @brief      Count a rendered frame, call after drawing and before glfwSwapBuffers
+     */
+    void Frame(GLFWwindow* window){
+        if (!Enabled())
+            return;
+        if (frame == captureFrame)
+        {
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            readback.reset(new AsyncReadback(1));
+            readback->Request(0, GL_BACK, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, frame);
+        }
+        else if (readback && !captured)
+            captured = readback->Poll(result);
+        frame++;
+    }
+
+    /**
+     * @brief      Write and compare the capture, call after the loop
+     *
+     * @return     false if the capture is missing or differs from the golden image
+     */
+    bool Finish(){
+        if (!Enabled())
+            return true;
+        if (readback && !captured)
+            captured = readback->Poll(result, true);
+        if (!captured)
+        {
+            std::cout << "ERROR::GOLDEN::FRAME_NOT_RENDERED " << captureFrame << std::endl;
+            return false;
+        }
+        // GL returns the bottom row first, images start at the top
+        size_t stride = (size_t)result.width * 3;
+        std::vector<unsigned char> image(result.pixels.size());
+        for (int y = 0; y < result.height; y++)
+            memcpy(&image[y * stride], &result.pixels[(result.height - 1 - y) * stride], stride);
+
+        bool ok = true;
+        if (!capturePath.empty())
+            ok = WritePNG(capturePath.c_str(), image.data(), result.width, result.height, 3);
+        if (!goldenPath.empty())
+            ok = compare(image) && ok;
+        return ok;
+    }
+
+private:
+
+    std::string capturePath;
+    std::string goldenPath;
+    unsigned long captureFrame;
+    int threshold;
+    double tolerance;
+
+    unsigned long frame;
+    std::unique_ptr<AsyncReadback> readback;
+    ReadbackResult result;
+    bool captured;
+
+    bool compare(const std::vector<unsigned char>& image){
+        int width, height, channels;
+        unsigned char* golden = stbi_load(goldenPath.c_str(), &width, &height, &channels, 3);
+        if (!golden)
+        {
+            std::cout << "ERROR::GOLDEN::CANNOT_LOAD " << goldenPath << std::endl;
+            return false;
+        }
+        if (width != result.width || height != result.height)
+        {
+            std::cout << "ERROR::GOLDEN::SIZE_MISMATCH " << goldenPath << " is " << width << "x" << height
+                      << ", frame is " << result.width << "x" << result.height << std::endl;
+            stbi_image_free(golden);
+            return false;
+        }
+        std::vector<unsigned char> diffImage;
+        ImageDiff diff = CompareImages(golden, image.data(), width, height, 3, threshold, &diffImage);
+        stbi_image_free(golden);
+
+        bool pass = diff.differingPercent <= tolerance;
+        std::cout << (pass ? "GOLDEN::PASS " : "ERROR::GOLDEN::MISMATCH ") << goldenPath
+                  << ": " << diff.differingPercent << "% pixels differ (tolerance " << tolerance
+                  << "%), max " << diff.maxDifference << ", mean " << diff.meanDifference
+                  << ", PSNR " << diff.psnr << " dB" << std::endl;
+        if (!pass)
+        {
+            std::string diffPath = (capturePath.empty() ? goldenPath : capturePath) + ".diff.png";
+            if (WritePNG(diffPath.c_str(), diffImage.data(), width, height, 3))
+                std::cout << "Diff image: " << diffPath << std::endl;
+        }
+        return pass;
+    }
+};
+#endif
@@ -0,0 +1,428 @@
+#ifndef JPEGWRITE_H
+#define JPEGWRITE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+
+/**
+ * Minimal baseline JPEG writer, 8 bit grey, RGB or RGBA (alpha dropped)
+ *
+ * Huffman coded with the example tables of the JPEG standard (Annex K),
+ * quantization tables scaled by quality the way libjpeg does, 4:2:0 or
+ * 4:4:4 chroma and optional restart markers every N MCUs. The DCT is a
+ * plain separable float one: this makes test inputs (the decode
+ * benchmark's large images), it is not meant to be fast.
+ */
+
+namespace jpegwrite_detail {
+
+// block position (row major) of the n-th coefficient in zigzag order
+const unsigned char zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+const unsigned char lumaQuant[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99
+};
+
+const unsigned char chromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99
+};
+
+// Huffman tables as DHT stores them: codes per length 1..16, then the symbols
+const unsigned char lumaDcBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const unsigned char chromaDcBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const unsigned char dcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const unsigned char lumaAcBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const unsigned char lumaAcValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+const unsigned char chromaAcBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const unsigned char chromaAcValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+// code and length per symbol
+struct HuffmanCodes {
+    uint16_t code[256];
+    unsigned char size[256];
+
+    HuffmanCodes(const unsigned char* bits, const unsigned char* values){
+        for (int i = 0; i < 256; i++)
+            size[i] = 0;
+        unsigned int c = 0;
+        int k = 0;
+        for (int length = 1; length <= 16; length++, c <<= 1)
+        {
+            for (int i = 0; i < bits[length - 1]; i++, k++)
+            {
+                code[values[k]] = (uint16_t)c++;
+                size[values[k]] = (unsigned char)length;
+            }
+        }
+    }
+};
+
+// Most significant bit first, with 0xFF bytes stuffed
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out), bits(0), count(0) {}
+
+    void put(uint32_t value, int n){
+        bits = (bits << n) | (value & ((1u << n) - 1));
+        count += n;
+        while (count >= 8)
+        {
+            unsigned char b = (unsigned char)(bits >> (count - 8));
+            out.push_back(b);
+            if (b == 0xFF)
+                out.push_back(0);
+            count -= 8;
+        }
+        bits &= (1u << count) - 1;
+    }
+    // pad the last byte with 1 bits
+    void flush(){
+        if (count)
+            put(0x7F, 8 - count);
+    }
+
+private:
+    std::vector<unsigned char>& out;
+    uint32_t bits;
+    int count;
+};
+
+inline void put16(std::vector<unsigned char>& out, int v)
+{
+    out.push_back((unsigned char)(v >> 8));
+    out.push_back((unsigned char)v);
+}
+
+// libjpeg's quality scaling
+inline void scaleQuant(const unsigned char* base, int quality, unsigned char* out)
+{
+    quality = quality < 1 ? 1 : quality > 100 ? 100 : quality;
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; i++)
+    {
+        int q = (base[i] * scale + 50) / 100;
+        out[i] = (unsigned char)(q < 1 ? 1 : q > 255 ? 255 : q);
+    }
+}
+
+// One component sampled on its own grid, level shifted
+struct Plane {
+    int width, height;
+    std::vector<float> samples;
+
+    float at(int x, int y) const {
+        x = x < width ? x : width - 1;
+        y = y < height ? y : height - 1;
+        return samples[(size_t)y * width + x];
+    }
+};
+
+inline int category(int v)
+{
+    int a = v < 0 ? -v : v, n = 0;
+    while (a)
+    {
+        n++;
+        a >>= 1;
+    }
+    return n;
+}
+
+class BlockEncoder
+{
+public:
+    BlockEncoder(){
+        for (int x = 0; x < 8; x++)
+            for (int u = 0; u < 8; u++)
+                basis[x][u] = (float)(0.5 * (u ? 1.0 : 1.0 / std::sqrt(2.0)) * std::cos((2 * x + 1) * u * 3.14159265358979323846 / 16));
+    }
+
+    // DCT, quantize and code the 8x8 block at (bx, by) of the plane
+    void encode(BitWriter& w, const Plane& plane, int bx, int by, const unsigned char* quant,
+                const HuffmanCodes& dc, const HuffmanCodes& ac, int& dcPred) const {
+        float block[8][8], rows[8][8];
+        for (int y = 0; y < 8; y++)
+            for (int x = 0; x < 8; x++)
+                block[y][x] = plane.at(bx * 8 + x, by * 8 + y);
+        for (int y = 0; y < 8; y++)
+            for (int u = 0; u < 8; u++)
+            {
+                float s = 0;
+                for (int x = 0; x < 8; x++)
+                    s += block[y][x] * basis[x][u];
+                rows[y][u] = s;
+            }
+        int coeff[64];
+        for (int v = 0; v < 8; v++)
+            for (int u = 0; u < 8; u++)
+            {
+                float s = 0;
+                for (int y = 0; y < 8; y++)
+                    s += rows[y][u] * basis[y][v];
+                coeff[v * 8 + u] = (int)std::lround(s / quant[v * 8 + u]);
+            }
+
+        int diff = coeff[0] - dcPred;
+        dcPred = coeff[0];
+        int s = category(diff);
+        w.put(dc.code[s], dc.size[s]);
+        if (s)
+            w.put(diff < 0 ? diff - 1 : diff, s);
+        int run = 0;
+        for (int k = 1; k < 64; k++)
+        {
+            // the standard tables stop at 10 bit AC values
+            int c = std::max(-1023, std::min(1023, coeff[zigzag[k]]));
+            if (c == 0)
+            {
+                run++;
+                continue;
+            }
+            for (; run >= 16; run -= 16)
+                w.put(ac.code[0xf0], ac.size[0xf0]);
+            s = category(c);
+            int rs = (run << 4) | s;
+            w.put(ac.code[rs], ac.size[rs]);
+            w.put(c < 0 ? c - 1 : c, s);
+            run = 0;
+        }
+        if (run)
+            w.put(ac.code[0], ac.size[0]);
+    }
+
+private:
+    float basis[8][8];
+};
+
+} // namespace jpegwrite_detail
+
+/**
+ * @brief      Encode an 8 bit image as a baseline JFIF
+ *
+ * @param      channels         1 grey, 3 RGB, 4 RGBA (alpha is not stored)
+ * @param      quality          1..100, libjpeg's scale
+ * @param      subsample        4:2:0 chroma, 4:4:4 otherwise
+ * @param      restartInterval  MCUs between restart markers, 0 for none
+ *
+ * @return     the file's bytes, empty if the image is not supported
+ */
+inline std::vector<unsigned char> EncodeJPEG(const unsigned char* pixels, int width, int height, int channels,
+                                             int quality = 90, bool subsample = true, int restartInterval = 0)
+{
+    using namespace jpegwrite_detail;
+    std::vector<unsigned char> out;
+    if ((channels != 1 && channels != 3 && channels != 4) || width <= 0 || height <= 0 ||
+        width > 65535 || height > 65535 || restartInterval < 0 || restartInterval > 65535)
+        return out;
+    int count = channels == 1 ? 1 : 3;
+    int factor = count == 3 && subsample ? 2 : 1;
+
+    // YCbCr planes, chroma averaged down when subsampled
+    Plane planes[3];
+    for (int c = 0; c < count; c++)
+    {
+        int f = c ? factor : 1;
+        planes[c].width = (width + f - 1) / f;
+        planes[c].height = (height + f - 1) / f;
+        planes[c].samples.assign((size_t)planes[c].width * planes[c].height, 0.0f);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const unsigned char* p = pixels + ((size_t)y * width + x) * channels;
+            if (count == 1)
+            {
+                planes[0].samples[(size_t)y * width + x] = p[0] - 128.0f;
+                continue;
+            }
+            float r = p[0], g = p[1], b = p[2];
+            float ycc[3] = {
+                0.299f * r + 0.587f * g + 0.114f * b - 128.0f,
+                -0.168736f * r - 0.331264f * g + 0.5f * b,
+                0.5f * r - 0.418688f * g - 0.081312f * b
+            };
+            planes[0].samples[(size_t)y * width + x] = ycc[0];
+            for (int c = 1; c < 3; c++)
+                planes[c].samples[(size_t)(y / factor) * planes[c].width + x / factor] += ycc[c];
+        }
+    }
+    for (int c = 1; c < count; c++)
+    {
+        // edge samples may cover fewer than factor^2 pixels
+        for (int y = 0; y < planes[c].height; y++)
+            for (int x = 0; x < planes[c].width; x++)
+            {
+                int n = (std::min(width, (x + 1) * factor) - x * factor) * (std::min(height, (y + 1) * factor) - y * factor);
+                planes[c].samples[(size_t)y * planes[c].width + x] /= (float)n;
+            }
+    }
+
+    unsigned char quant[2][64];
+    scaleQuant(lumaQuant, quality, quant[0]);
+    scaleQuant(chromaQuant, quality, quant[1]);
+
+    static const unsigned char app0[14] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    out.push_back(0xFF); out.push_back(0xD8);
+    out.push_back(0xFF); out.push_back(0xE0);
+    put16(out, 16);
+    out.insert(out.end(), app0, app0 + 14);
+
+    int tables = count == 3 ? 2 : 1;
+    out.push_back(0xFF); out.push_back(0xDB);
+    put16(out, 2 + 65 * tables);
+    for (int t = 0; t < tables; t++)
+    {
+        out.push_back((unsigned char)t);
+        for (int i = 0; i < 64; i++)
+            out.push_back(quant[t][zigzag[i]]);
+    }
+
+    out.push_back(0xFF); out.push_back(0xC0);
+    put16(out, 8 + 3 * count);
+    out.push_back(8);
+    put16(out, height);
+    put16(out, width);
+    out.push_back((unsigned char)count);
+    for (int c = 0; c < count; c++)
+    {
+        out.push_back((unsigned char)(c + 1));
+        out.push_back(c == 0 ? (unsigned char)(factor * 16 + factor) : 0x11);
+        out.push_back(c == 0 ? 0 : 1);
+    }
+
+    const unsigned char* bits[4] = {lumaDcBits, lumaAcBits, chromaDcBits, chromaAcBits};
+    const unsigned char* values[4] = {dcValues, lumaAcValues, dcValues, chromaAcValues};
+    int lengths[4] = {12, 162, 12, 162};
+    out.push_back(0xFF); out.push_back(0xC4);
+    put16(out, 2 + (17 + 12 + 17 + 162) * tables);
+    for (int t = 0; t < 2 * tables; t++)
+    {
+        out.push_back((unsigned char)((t & 1) << 4 | t >> 1));
+        out.insert(out.end(), bits[t], bits[t] + 16);
+        out.insert(out.end(), values[t], values[t] + lengths[t]);
+    }
+
+    if (restartInterval)
+    {
+        out.push_back(0xFF); out.push_back(0xDD);
+        put16(out, 4);
+        put16(out, restartInterval);
+    }
+
+    out.push_back(0xFF); out.push_back(0xDA);
+    put16(out, 6 + 2 * count);
+    out.push_back((unsigned char)count);
+    for (int c = 0; c < count; c++)
+    {
+        out.push_back((unsigned char)(c + 1));
+        out.push_back(c == 0 ? 0x00 : 0x11);
+    }
+    out.push_back(0); out.push_back(63); out.push_back(0);
+
+    HuffmanCodes dc[2] = {HuffmanCodes(lumaDcBits, dcValues), HuffmanCodes(chromaDcBits, dcValues)};
+    HuffmanCodes ac[2] = {HuffmanCodes(lumaAcBits, lumaAcValues), HuffmanCodes(chromaAcBits, chromaAcValues)};
+    BlockEncoder encoder;
+    BitWriter w(out);
+    int dcPred[3] = {0, 0, 0};
+    int mcuX = (width + factor * 8 - 1) / (factor * 8);
+    int mcuY = (height + factor * 8 - 1) / (factor * 8);
+    int mcus = mcuX * mcuY;
+    for (int m = 0; m < mcus; m++)
+    {
+        if (restartInterval && m && m % restartInterval == 0)
+        {
+            w.flush();
+            out.push_back(0xFF);
+            out.push_back((unsigned char)(0xD0 + (m / restartInterval - 1) % 8));
+            dcPred[0] = dcPred[1] = dcPred[2] = 0;
+        }
+        int i = m % mcuX, j = m / mcuX;
+        for (int y = 0; y < factor; y++)
+            for (int x = 0; x < factor; x++)
+                encoder.encode(w, planes[0], i * factor + x, j * factor + y, quant[0], dc[0], ac[0], dcPred[0]);
+        for (int c = 1; c < count; c++)
+            encoder.encode(w, planes[c], i, j, quant[1], dc[1], ac[1], dcPred[c]);
+    }
+    w.flush();
+    out.push_back(0xFF); out.push_back(0xD9);
+    return out;
+}
+
+/**
+ * @brief      Write an 8 bit image as a baseline JPEG file, see EncodeJPEG
+ *
+ * @return     true on success
+ */
+inline bool WriteJPEG(const char* path, const unsigned char* pixels, int width, int height, int channels,
+                      int quality = 90, bool subsample = true, int restartInterval = 0)
+{
+    std::vector<unsigned char> bytes = EncodeJPEG(pixels, width, height, channels, quality, subsample, restartInterval);
+    if (bytes.empty())
+    {
+        std::cout << "ERROR::JPEG::UNSUPPORTED_IMAGE " << path << std::endl;
+        return false;
+    }
+    FILE* f = fopen(path, "wb");
+    if (!f)
+    {
+        std::cout << "ERROR::JPEG::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    fclose(f);
+    if (!ok)
+        std::cout << "ERROR::JPEG::SHORT_WRITE " << path << std::endl;
+    return ok;
+}
+#endif
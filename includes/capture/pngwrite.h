@@ -0,0 +1,280 @@
+#ifndef PNGWRITE_H
+#define PNGWRITE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+/**
+ * Minimal PNG writer, 8 bit RGB or RGBA
+ *
+ * stb_image only reads, and the repo has no zlib, so the zlib stream is
+ * produced here: greedy LZ77 over a 32K window with a hash of 3 bytes,
+ * coded with deflate's fixed Huffman tables, one block. Rows get the
+ * cheapest of the None/Sub/Up filters. Rendered frames (flat backgrounds,
+ * repeated texels) come out a few times smaller than raw.
+ */
+
+namespace pngwrite_detail {
+
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out), bits(0), count(0) {}
+
+    // value's low n bits, least significant first
+    void put(uint32_t value, int n){
+        bits |= value << count;
+        count += n;
+        while (count >= 8)
+        {
+            out.push_back((unsigned char)bits);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+    // Huffman codes go most significant bit first
+    void putCode(uint32_t code, int n){
+        uint32_t reversed = 0;
+        for (int i = 0; i < n; i++)
+            reversed |= ((code >> i) & 1) << (n - 1 - i);
+        put(reversed, n);
+    }
+    void flush(){
+        if (count)
+            out.push_back((unsigned char)bits);
+        bits = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<unsigned char>& out;
+    uint32_t bits;
+    int count;
+};
+
+inline void putLiteral(BitWriter& w, int symbol)
+{
+    if (symbol < 144)       w.putCode(0x30 + symbol, 8);
+    else if (symbol < 256)  w.putCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)  w.putCode(symbol - 256, 7);
+    else                    w.putCode(0xc0 + symbol - 280, 8);
+}
+
+inline void putMatch(BitWriter& w, int length, int distance)
+{
+    static const int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                                       67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                     1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const int distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    int l = 28;
+    while (lengthBase[l] > length)
+        l--;
+    putLiteral(w, 257 + l);
+    w.put(length - lengthBase[l], lengthExtra[l]);
+    int d = 29;
+    while (distBase[d] > distance)
+        d--;
+    w.putCode(d, 5);
+    w.put(distance - distBase[d], distExtra[d]);
+}
+
+inline uint32_t adler32(const unsigned char* data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+    while (size)
+    {
+        size_t n = size < 5552 ? size : 5552;
+        size -= n;
+        for (; n; n--)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+inline uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// zlib stream of data, one fixed Huffman block
+inline std::vector<unsigned char> deflate(const std::vector<unsigned char>& data)
+{
+    const int WINDOW = 32768, MIN_MATCH = 3, MAX_MATCH = 258, HASH_BITS = 15;
+    std::vector<unsigned char> out;
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter w(out);
+    w.put(1, 1);            // final block
+    w.put(1, 2);            // fixed Huffman
+
+    std::vector<int> head(1 << HASH_BITS, -1);
+    const size_t n = data.size();
+    size_t i = 0;
+    while (i < n)
+    {
+        int bestLength = 0, bestDistance = 0;
+        if (i + MIN_MATCH <= n)
+        {
+            uint32_t h = ((data[i] << 16) | (data[i + 1] << 8) | data[i + 2]) * 2654435761u >> (32 - HASH_BITS);
+            int candidate = head[h];
+            head[h] = (int)i;
+            if (candidate >= 0 && (int)i - candidate <= WINDOW)
+            {
+                size_t limit = n - i < (size_t)MAX_MATCH ? n - i : (size_t)MAX_MATCH;
+                size_t length = 0;
+                while (length < limit && data[candidate + length] == data[i + length])
+                    length++;
+                if (length >= (size_t)MIN_MATCH)
+                {
+                    bestLength = (int)length;
+                    bestDistance = (int)i - candidate;
+                }
+            }
+        }
+        if (bestLength)
+        {
+            putMatch(w, bestLength, bestDistance);
+            // keep the hash current inside the match, cheaply: its last position only
+            size_t last = i + bestLength - 1;
+            if (last + MIN_MATCH <= n)
+                head[((data[last] << 16) | (data[last + 1] << 8) | data[last + 2]) * 2654435761u >> (32 - HASH_BITS)] = (int)last;
+            i += bestLength;
+        }
+        else
+            putLiteral(w, data[i++]);
+    }
+    putLiteral(w, 256);
+    w.flush();
+
+    uint32_t adler = adler32(data.data(), data.size());
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((unsigned char)(adler >> shift));
+    return out;
+}
+
+inline void putChunk(FILE* f, const char* type, const std::vector<unsigned char>& data)
+{
+    unsigned char header[8];
+    uint32_t size = (uint32_t)data.size();
+    for (int i = 0; i < 4; i++)
+        header[i] = (unsigned char)(size >> (24 - 8 * i));
+    memcpy(header + 4, type, 4);
+    uint32_t crc = crc32(header + 4, 4);
+    crc = crc32(data.data(), data.size(), crc);
+    unsigned char trailer[4];
+    for (int i = 0; i < 4; i++)
+        trailer[i] = (unsigned char)(crc >> (24 - 8 * i));
+    fwrite(header, 1, 8, f);
+    fwrite(data.data(), 1, data.size(), f);
+    fwrite(trailer, 1, 4, f);
+}
+
+} // namespace pngwrite_detail
+
+/**
+ * @brief      Write 8 bit pixels as a PNG
+ *
+ * @param      path      destination
+ * @param      pixels    rows of width * channels bytes, tightly packed
+ * @param      channels  3 (RGB) or 4 (RGBA)
+ * @param      flipY     rows are bottom to top, as glReadPixels returns them
+ *
+ * @return     false if the file could not be written
+ */
+inline bool WritePNG(const char* path, const unsigned char* pixels, int width, int height, int channels, bool flipY = false)
+{
+    using namespace pngwrite_detail;
+    if ((channels != 3 && channels != 4) || width <= 0 || height <= 0)
+    {
+        std::cout << "ERROR::PNG::UNSUPPORTED_IMAGE " << path << std::endl;
+        return false;
+    }
+    size_t stride = (size_t)width * channels;
+    std::vector<unsigned char> filtered;
+    filtered.reserve((stride + 1) * height);
+    std::vector<unsigned char> candidate[3];
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = pixels + stride * (flipY ? height - 1 - y : y);
+        const unsigned char* above = y ? pixels + stride * (flipY ? height - y : y - 1) : NULL;
+        // None, Sub, Up; keep the one with the smallest sum of magnitudes
+        int best = 0;
+        long bestCost = -1;
+        for (int type = 0; type < 3; type++)
+        {
+            std::vector<unsigned char>& c = candidate[type];
+            c.resize(stride);
+            long cost = 0;
+            for (size_t x = 0; x < stride; x++)
+            {
+                unsigned char predict = 0;
+                if (type == 1 && x >= (size_t)channels)
+                    predict = row[x - channels];
+                else if (type == 2 && above)
+                    predict = above[x];
+                c[x] = (unsigned char)(row[x] - predict);
+                cost += c[x] < 128 ? c[x] : 256 - c[x];
+            }
+            if (bestCost < 0 || cost < bestCost)
+            {
+                best = type;
+                bestCost = cost;
+            }
+        }
+        filtered.push_back((unsigned char)best);
+        filtered.insert(filtered.end(), candidate[best].begin(), candidate[best].end());
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f)
+    {
+        std::cout << "ERROR::PNG::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    fwrite(signature, 1, 8, f);
+    std::vector<unsigned char> header(13, 0);
+    for (int i = 0; i < 4; i++)
+    {
+        header[i] = (unsigned char)(width >> (24 - 8 * i));
+        header[4 + i] = (unsigned char)(height >> (24 - 8 * i));
+    }
+    header[8] = 8;                              // bit depth
+    header[9] = channels == 4 ? 6 : 2;          // RGBA or RGB
+    putChunk(f, "IHDR", header);
+    putChunk(f, "IDAT", deflate(filtered));
+    putChunk(f, "IEND", std::vector<unsigned char>());
+    bool ok = ferror(f) == 0;
+    fclose(f);
+    if (!ok)
+        std::cout << "ERROR::PNG::SHORT_WRITE " << path << std::endl;
+    return ok;
+}
+#endif
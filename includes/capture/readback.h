@@ -0,0 +1,210 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+/**
+ * Asynchronous framebuffer readback
+ *
+ * glReadPixels into client memory waits for the GPU to finish the frame.
+ * Here every request reads into a pixel pack buffer of a small ring and
+ * drops a fence behind it; Poll() only maps a buffer once its fence has
+ * signaled, normally a frame or two later, so nothing stalls.
+ *
+ *     AsyncReadback readback;
+ *     ...render...
+ *     readback.Request(0, GL_BACK, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, frame);
+ *     glfwSwapBuffers(window);
+ *     ReadbackResult result;
+ *     while (readback.Poll(result))
+ *         ...use result.pixels, bottom row first as GL returns them...
+ *
+ * The pixel buffers and fences are deleted by the destructor, which needs
+ * the context: anything holding a readback goes before glfwTerminate().
+ */
+
+struct ReadbackResult {
+    uint64_t tag;               // whatever the request passed, e.g. its frame
+    int width;
+    int height;
+    GLenum format;
+    GLenum type;
+    std::vector<unsigned char> pixels;
+};
+
+class AsyncReadback
+{
+public:
+
+    explicit AsyncReadback(int ringSize = 3) : slots(ringSize), next(0), oldest(0), pending(0) {
+        for (size_t i = 0; i < slots.size(); i++)
+            glGenBuffers(1, &slots[i].pbo);
+    }
+    ~AsyncReadback(){
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].fence)
+                glDeleteSync(slots[i].fence);
+            glDeleteBuffers(1, &slots[i].pbo);
+        }
+    }
+
+    AsyncReadback(const AsyncReadback&) = delete;
+    AsyncReadback& operator=(const AsyncReadback&) = delete;
+
+    /**
+     * @brief      Queue a read of a framebuffer region
+     *
+     * @param      framebuffer  0 for the default framebuffer
+     * @param      readBuffer   GL_BACK, GL_FRONT or GL_COLOR_ATTACHMENTi
+     * @param      format       e.g. GL_RGBA, GL_RED_INTEGER, GL_DEPTH_COMPONENT
+     * @param      type         e.g. GL_UNSIGNED_BYTE, GL_UNSIGNED_INT, GL_FLOAT
+     * @param      tag          returned with the result
+     *
+     * @return     false when every buffer of the ring is still in flight;
+     *             Poll() first, or drop the request
+     */
+    bool Request(GLuint framebuffer, GLenum readBuffer, int x, int y, int width, int height,
+                 GLenum format, GLenum type, uint64_t tag){
+        if (pending == (int)slots.size())
+            return false;
+        size_t size = (size_t)width * height * pixelSize(format, type);
+        if (!size)
+        {
+            std::cout << "ERROR::READBACK::UNSUPPORTED_FORMAT" << std::endl;
+            return false;
+        }
+        Slot& slot = slots[next];
+
+        GLint oldFramebuffer, oldPack, oldAlignment, oldReadBuffer;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldFramebuffer);
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &oldPack);
+        glGetIntegerv(GL_PACK_ALIGNMENT, &oldAlignment);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glGetIntegerv(GL_READ_BUFFER, &oldReadBuffer);
+        glReadBuffer(readBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        if (slot.capacity < size)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+            slot.capacity = size;
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(x, y, width, height, format, type, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, oldAlignment);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, oldPack);
+        glReadBuffer(oldReadBuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, oldFramebuffer);
+
+        slot.tag = tag;
+        slot.width = width;
+        slot.height = height;
+        slot.format = format;
+        slot.type = type;
+        slot.size = size;
+        next = (next + 1) % (int)slots.size();
+        pending++;
+        return true;
+    }
+
+    /**
+     * @brief      Hand over the oldest request if the GPU is done with it
+     *
+     * @param      out   the pixels, rows bottom to top, tightly packed
+     * @param      wait  block until the oldest request is done
+     *
+     * @return     false if nothing was ready (or nothing is pending)
+     */
+    bool Poll(ReadbackResult& out, bool wait = false){
+        if (!pending)
+            return false;
+        Slot& slot = slots[oldest];
+        GLenum state = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000ull : 0);
+        if (state == GL_TIMEOUT_EXPIRED)
+        {
+            if (!wait)
+                return false;
+            // a second is far beyond any frame, keep waiting
+            while ((state = glClientWaitSync(slot.fence, 0, 1000000000ull)) == GL_TIMEOUT_EXPIRED) {}
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+        oldest = (oldest + 1) % (int)slots.size();
+        pending--;
+        if (state == GL_WAIT_FAILED)
+        {
+            std::cout << "ERROR::READBACK::WAIT_FAILED" << std::endl;
+            return false;
+        }
+
+        GLint oldPack;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &oldPack);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT);
+        bool ok = data != NULL;
+        if (ok)
+        {
+            out.tag = slot.tag;
+            out.width = slot.width;
+            out.height = slot.height;
+            out.format = slot.format;
+            out.type = slot.type;
+            out.pixels.resize(slot.size);
+            memcpy(out.pixels.data(), data, slot.size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        else
+            std::cout << "ERROR::READBACK::MAP_FAILED" << std::endl;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, oldPack);
+        return ok;
+    }
+
+    // Requests not handed over yet
+    int Pending() const { return pending; }
+
+    static size_t pixelSize(GLenum format, GLenum type){
+        size_t channels = 0, bytes = 0;
+        switch (format)
+        {
+            case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: channels = 1; break;
+            case GL_RG: case GL_RG_INTEGER: channels = 2; break;
+            case GL_RGB: case GL_RGB_INTEGER: channels = 3; break;
+            case GL_RGBA: case GL_RGBA_INTEGER: case GL_BGRA: channels = 4; break;
+        }
+        switch (type)
+        {
+            case GL_UNSIGNED_BYTE: bytes = 1; break;
+            case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: bytes = 2; break;
+            case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: bytes = 4; break;
+        }
+        return channels * bytes;
+    }
+
+private:
+
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = 0;
+        size_t capacity = 0;
+        size_t size = 0;
+        uint64_t tag = 0;
+        int width = 0;
+        int height = 0;
+        GLenum format = 0;
+        GLenum type = 0;
+    };
+
+    std::vector<Slot> slots;
+    int next;                   // slot of the next request
+    int oldest;                 // slot of the oldest pending request
+    int pending;
+};
+#endif
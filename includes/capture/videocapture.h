@@ -0,0 +1,293 @@
+#ifndef VIDEOCAPTURE_H
+#define VIDEOCAPTURE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <capture/readback.h>
+#include <capture/yuv.h>
+#include <profiling/trace.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+/**
+ * Streaming Y4M capture of the rendered frames
+ *
+ * Every frame is read back through an AsyncReadback ring, so the render
+ * loop never waits on glReadPixels; finished reads go to worker threads
+ * that convert RGBA to YUV 4:2:0 (SSE2, capture/yuv.h) and write the
+ * frames in order as a YUV4MPEG2 stream, to a file or to stdout:
+ *
+ *     ./cameraBin --bench --frames 1800 --record flythrough.y4m
+ *     ./cameraBin --bench --frames 1800 --record - | ffmpeg -i - -c:v libx264 flythrough.mp4
+ *
+ * Options:
+ *
+ *     --record file.y4m     destination, - for stdout (std::cout then goes to stderr)
+ *     --record-fps N        frame rate written in the header (default 60)
+ *     --record-size WxH     window size to record at, e.g. 1920x1080 (see Width()/Height())
+ *
+ * With --bench the scene advances a fixed step per frame, so the video
+ * plays at the right speed whatever the recording costs. No frame is
+ * dropped: when conversion falls MAX_IN_FLIGHT frames behind, Frame()
+ * waits and counts it in the summary.
+ */
+
+class VideoCapture
+{
+public:
+
+    static const int READBACK_RING = 4;
+
+    VideoCapture(int argc, char const *argv[])
+        : fps(60), width(0), height(0), out(NULL), oldCout(NULL), frames(0), written(0), waits(0),
+          nextSequence(0), nextToWrite(0), started(false), stopping(false), failed(false) {
+        for (int i = 1; i + 1 < argc; i++)
+        {
+            if (strcmp(argv[i], "--record") == 0)
+                path = argv[++i];
+            else if (strcmp(argv[i], "--record-fps") == 0)
+                fps = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--record-size") == 0)
+                sscanf(argv[++i], "%dx%d", &width, &height);
+        }
+        if (path.empty())
+            return;
+        if (path == "-")
+        {
+            out = stdout;
+            // keep the samples' messages out of the video stream
+            oldCout = std::cout.rdbuf(std::cerr.rdbuf());
+        }
+        else
+            out = fopen(path.c_str(), "wb");
+        if (!out)
+        {
+            std::cout << "ERROR::VIDEOCAPTURE::CANNOT_WRITE " << path << std::endl;
+            path.clear();
+        }
+    }
+    ~VideoCapture(){
+        Finish();
+    }
+
+    VideoCapture(const VideoCapture&) = delete;
+    VideoCapture& operator=(const VideoCapture&) = delete;
+
+    bool Enabled() const { return !path.empty(); }
+
+    /**
+     * @brief      Requested recording size, or the given default without --record-size
+     */
+    int Width(int fallback) const { return width > 0 ? width : fallback; }
+    int Height(int fallback) const { return height > 0 ? height : fallback; }
+
+    /**
+     * @brief      Queue the frame for recording, call after drawing and before glfwSwapBuffers
+     */
+    void Frame(GLFWwindow* window){
+        if (!Enabled() || failed)
+            return;
+        TRACE_SCOPE("VideoCapture::Frame");
+        if (!readback)
+            start(window);
+
+        collect(false);
+        if (readback->Pending() == READBACK_RING)
+            collect(true);
+        int w, h;
+        glfwGetFramebufferSize(window, &w, &h);
+        if ((w & ~1) != frameWidth || (h & ~1) != frameHeight)
+        {
+            std::cout << "ERROR::VIDEOCAPTURE::SIZE_CHANGED, recording stopped" << std::endl;
+            failed = true;
+            return;
+        }
+        readback->Request(0, GL_BACK, 0, h - frameHeight, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, frames++);
+    }
+
+    /**
+     * @brief      Drain the readbacks and workers and close the stream
+     *
+     * Call while the GL context is still alive (before glfwTerminate).
+     */
+    void Finish(){
+        if (!Enabled())
+            return;
+        if (readback)
+        {
+            while (readback->Pending())
+                collect(true);
+            readback.reset();
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        workers.clear();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (out && out != stdout)
+            fclose(out);
+        else if (out)
+            fflush(out);
+        out = NULL;
+        // no frame ever reached start(): there is no size or start time to report
+        if (started)
+            std::cout << "Recorded " << written << " frames " << frameWidth << "x" << frameHeight << " to " << path
+                      << " in " << seconds << " s (" << (seconds > 0 ? written / seconds : 0.0) << " fps), "
+                      << waits << " waits on the encoder" << std::endl;
+        if (oldCout)
+            std::cout.rdbuf(oldCout);
+        oldCout = NULL;
+        path.clear();
+    }
+
+private:
+
+    static const int MAX_IN_FLIGHT = 8;     // frames read back but not written yet
+
+    struct Job {
+        uint64_t sequence;
+        std::vector<unsigned char> rgba;
+    };
+
+    std::string path;
+    int fps;
+    int width, height;                      // --record-size
+    int frameWidth = 0, frameHeight = 0;    // recorded size, even
+    FILE* out;
+    std::streambuf* oldCout;
+    std::chrono::steady_clock::time_point startTime;
+
+    std::unique_ptr<AsyncReadback> readback;
+    uint64_t frames;
+    uint64_t written;
+    uint64_t waits;
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable workAvailable;
+    std::condition_variable progress;       // a frame was written
+    std::deque<Job> jobs;
+    std::vector<std::vector<unsigned char> > spareBuffers;
+    uint64_t nextSequence;
+    uint64_t nextToWrite;
+    bool started;                           // start() ran, frameWidth/frameHeight and startTime are set
+    bool stopping;
+    bool failed;
+
+    void start(GLFWwindow* window){
+        int w, h;
+        glfwGetFramebufferSize(window, &w, &h);
+        // 4:2:0 needs even sizes, an odd last row or column is left out
+        frameWidth = w & ~1;
+        frameHeight = h & ~1;
+        fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", frameWidth, frameHeight, fps);
+        readback.reset(new AsyncReadback(READBACK_RING));
+        startTime = std::chrono::steady_clock::now();
+        started = true;
+
+        unsigned int cores = std::thread::hardware_concurrency();
+        unsigned int count = cores > 2 ? cores - 1 : 1;
+        for (unsigned int i = 0; i < count; i++)
+            workers.push_back(std::thread(&VideoCapture::work, this));
+    }
+
+    // Hand finished readbacks to the workers
+    void collect(bool wait){
+        for (;;)
+        {
+            ReadbackResult result;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!spareBuffers.empty())
+                {
+                    result.pixels.swap(spareBuffers.back());
+                    spareBuffers.pop_back();
+                }
+            }
+            if (!readback->Poll(result, wait))
+            {
+                recycle(result.pixels);
+                return;
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            if (nextSequence - nextToWrite >= (uint64_t)MAX_IN_FLIGHT)
+            {
+                waits++;
+                progress.wait(guard, [this]() { return nextSequence - nextToWrite < (uint64_t)MAX_IN_FLIGHT; });
+            }
+            Job job;
+            job.sequence = nextSequence++;
+            job.rgba.swap(result.pixels);
+            jobs.push_back(std::move(job));
+            guard.unlock();
+            workAvailable.notify_one();
+            // one blocking poll is enough, the rest only if already done
+            wait = false;
+        }
+    }
+
+    void recycle(std::vector<unsigned char>& buffer){
+        if (buffer.capacity() == 0)
+            return;
+        std::lock_guard<std::mutex> guard(lock);
+        spareBuffers.push_back(std::vector<unsigned char>());
+        spareBuffers.back().swap(buffer);
+    }
+
+    // Convert in parallel, write in sequence order
+    void work(){
+        TRACE_THREAD_NAME("video encoder");
+        std::vector<unsigned char> yuv((size_t)frameWidth * frameHeight * 3 / 2);
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                workAvailable.wait(guard, [this]() { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            {
+                TRACE_SCOPE("RgbaToYuv420");
+                RgbaToYuv420(job.rgba.data(), frameWidth, frameHeight, true, yuv.data());
+            }
+            recycle(job.rgba);
+
+            std::unique_lock<std::mutex> guard(lock);
+            progress.wait(guard, [this, &job]() { return nextToWrite == job.sequence; });
+            // it is this frame's turn, nobody else writes until nextToWrite moves on
+            guard.unlock();
+            {
+                TRACE_SCOPE("write frame");
+                fputs("FRAME\n", out);
+                fwrite(yuv.data(), 1, yuv.size(), out);
+            }
+            guard.lock();
+            written++;
+            nextToWrite++;
+            guard.unlock();
+            progress.notify_all();
+        }
+    }
+};
+#endif
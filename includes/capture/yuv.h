@@ -0,0 +1,142 @@
+#ifndef YUV_H
+#define YUV_H
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * RGBA to planar YUV 4:2:0, BT.601 limited range
+ *
+ *     Y = (( 66 R + 129 G +  25 B + 128) >> 8) + 16
+ *     U = ((-38 R -  74 G + 112 B + 128) >> 8) + 128
+ *     V = ((112 R -  94 G -  18 B + 128) >> 8) + 128
+ *
+ * U and V are taken from the sum of each 2x2 block (so the rounding is
+ * on the block, not per pixel), sited at the block centre as Y4M's
+ * C420jpeg expects. The SSE2 and scalar paths give identical bytes.
+ */
+
+namespace yuv_detail {
+
+inline uint8_t lumaOf(const uint8_t* p)
+{
+    return (uint8_t)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+}
+
+// r, g, b are sums over a 2x2 block
+inline void chromaOf(int r, int g, int b, uint8_t& u, uint8_t& v)
+{
+    u = (uint8_t)(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+    v = (uint8_t)(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+}
+
+// One pair of source rows into a pair of Y rows and one U and V row, columns [x, width)
+inline void convertRowsScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1,
+                              uint8_t* u, uint8_t* v, int x, int width)
+{
+    for (; x < width; x += 2)
+    {
+        const uint8_t* a = row0 + x * 4;
+        const uint8_t* b = row1 + x * 4;
+        y0[x] = lumaOf(a);
+        y0[x + 1] = lumaOf(a + 4);
+        y1[x] = lumaOf(b);
+        y1[x + 1] = lumaOf(b + 4);
+        chromaOf(a[0] + a[4] + b[0] + b[4], a[1] + a[5] + b[1] + b[5], a[2] + a[6] + b[2] + b[6], u[x / 2], v[x / 2]);
+    }
+}
+
+#if defined(__SSE2__)
+// Y of 4 RGBA pixels as 32 bit lanes
+inline __m128i luma4(__m128i px, __m128i zero, __m128i coef)
+{
+    __m128 a = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(px, zero), coef));
+    __m128 b = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(px, zero), coef));
+    __m128i sum = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+                                _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+}
+
+// 8 pixels of both rows per step: 16 Y, 4 U, 4 V
+inline int convertRowsSSE2(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1,
+                           uint8_t* u, uint8_t* v, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coefY = _mm_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0);
+    const __m128i coefU = _mm_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0);
+    const __m128i coefV = _mm_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0);
+    const __m128i round = _mm_set1_epi32(512), bias = _mm_set1_epi32(128);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + x * 4));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + x * 4 + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + x * 4));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + x * 4 + 16));
+
+        __m128i ya = _mm_packs_epi32(luma4(a0, zero, coefY), luma4(a1, zero, coefY));
+        __m128i yb = _mm_packs_epi32(luma4(b0, zero, coefY), luma4(b1, zero, coefY));
+        _mm_storel_epi64((__m128i*)(y0 + x), _mm_packus_epi16(ya, zero));
+        _mm_storel_epi64((__m128i*)(y1 + x), _mm_packus_epi16(yb, zero));
+
+        for (int half = 0; half < 2; half++)
+        {
+            __m128i top = half ? a1 : a0, bottom = half ? b1 : b0;
+            // vertical sums of 2 pixel pairs, then horizontal: the two 2x2 blocks of these 4 columns
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+            __m128i blocks = _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)),
+                                                _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+            __m128 us = _mm_castsi128_ps(_mm_madd_epi16(blocks, coefU));
+            __m128 vs = _mm_castsi128_ps(_mm_madd_epi16(blocks, coefV));
+            __m128i uv = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(us, vs, _MM_SHUFFLE(2, 0, 2, 0))),
+                                       _mm_castps_si128(_mm_shuffle_ps(us, vs, _MM_SHUFFLE(3, 1, 3, 1))));
+            uv = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(uv, round), 10), bias);
+            uint32_t packed = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(uv, zero), zero));
+            int c = x / 2 + half * 2;
+            u[c]     = (uint8_t)packed;
+            u[c + 1] = (uint8_t)(packed >> 8);
+            v[c]     = (uint8_t)(packed >> 16);
+            v[c + 1] = (uint8_t)(packed >> 24);
+        }
+    }
+    return x;
+}
+#endif
+
+} // namespace yuv_detail
+
+/**
+ * @brief      Convert an RGBA image to planar YUV 4:2:0
+ *
+ * @param      rgba    width * height pixels, 4 bytes each
+ * @param      width   even
+ * @param      height  even
+ * @param      flipY   rgba is bottom row first, as glReadPixels returns it
+ * @param      out     width * height * 3 / 2 bytes: Y plane, then U, then V
+ */
+inline void RgbaToYuv420(const uint8_t* rgba, int width, int height, bool flipY, uint8_t* out)
+{
+    uint8_t* yPlane = out;
+    uint8_t* uPlane = out + (size_t)width * height;
+    uint8_t* vPlane = uPlane + (size_t)(width / 2) * (height / 2);
+    size_t stride = (size_t)width * 4;
+    for (int y = 0; y + 1 < height; y += 2)
+    {
+        const uint8_t* row0 = rgba + stride * (flipY ? height - 1 - y : y);
+        const uint8_t* row1 = rgba + stride * (flipY ? height - 2 - y : y + 1);
+        uint8_t* y0 = yPlane + (size_t)width * y;
+        uint8_t* y1 = y0 + width;
+        uint8_t* u = uPlane + (size_t)(width / 2) * (y / 2);
+        uint8_t* v = vPlane + (size_t)(width / 2) * (y / 2);
+        int x = 0;
+#if defined(__SSE2__)
+        x = yuv_detail::convertRowsSSE2(row0, row1, y0, y1, u, v, width);
+#endif
+        yuv_detail::convertRowsScalar(row0, row1, y0, y1, u, v, x, width);
+    }
+}
+#endif
@@ -4,6 +4,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <profiling/trace.h>
+
 #include <iostream>
 
 class Chores
@@ -26,7 +28,17 @@ public:
 	 * @return     the window object
 	 */
 	GLFWwindow* CreateWindow(){
-		GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+		return CreateWindow(SCR_WIDTH, SCR_HEIGHT);
+	}
+
+	/**
+	 * @brief      Create the window object with a given size
+	 *
+	 * @return     the window object
+	 */
+	GLFWwindow* CreateWindow(unsigned int width, unsigned int height){
+		TRACE_SCOPE("Chores::CreateWindow");
+		GLFWwindow* window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
 	    if (window == NULL)
 	    {
 	        std::cout << "Failed to create GLFW window" << std::endl;
@@ -40,6 +52,7 @@ public:
     // glad: load all OpenGL function pointers
     // ---------------------------------------
 	void InitGlad(){
+		TRACE_SCOPE("Chores::InitGlad");
 	    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	    {
 	        std::cout << "Failed to initialize GLAD" << std::endl;
@@ -53,6 +66,7 @@ private:
 	 * @brief      Init GLFW
 	 */
 	void initGlfw(){
+		TRACE_SCOPE("Chores::initGlfw");
 		glfwInit();
 	    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -0,0 +1,105 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <profiling/trace.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of threads that run one job at a time, fork and join
+ *
+ * Run(job) calls job(thread index) once on every thread, the calling one
+ * being index 0, and returns when all of them are done; a pool of one
+ * thread runs the job inline. The workers sleep on a condition variable
+ * in between, so a pool costs nothing while idle. Used by the software
+ * rasterizer (softraster/softraster.h) and the scene graph update
+ * (scene/scenegraph.h).
+ */
+
+class WorkerPool
+{
+public:
+
+    /**
+     * @param      threads  pool size, the calling thread included
+     * @param      name     thread name in --trace output
+     */
+    explicit WorkerPool(unsigned int threads, const char* name = "worker")
+        : name(name), current(NULL), generation(0), busy(0), stopping(false) {
+        for (unsigned int i = 1; i < threads; i++)
+            workers.push_back(std::thread(&WorkerPool::work, this, i));
+    }
+    ~WorkerPool(){
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int Size() const { return (unsigned int)workers.size() + 1; }
+
+    // job(thread index) once on every thread, returns when all are done
+    void Run(const std::function<void(unsigned int)>& job){
+        if (workers.empty())
+        {
+            job(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current = &job;
+            busy = (unsigned int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        job(0);
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this]() { return busy == 0; });
+        current = NULL;
+    }
+
+private:
+
+    std::vector<std::thread> workers;
+    const char* name;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(unsigned int)>* current;
+    uint64_t generation;
+    unsigned int busy;
+    bool stopping;
+
+    void work(unsigned int index){
+        TRACE_THREAD_NAME(name);
+        uint64_t seen = 0;
+        for (;;)
+        {
+            const std::function<void(unsigned int)>* job;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [this, seen]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                job = current;
+            }
+            (*job)(index);
+            std::lock_guard<std::mutex> guard(lock);
+            if (--busy == 0)
+                done.notify_one();
+        }
+    }
+};
+#endif
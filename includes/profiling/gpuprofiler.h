@@ -0,0 +1,296 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/**
+ * Scoped GPU profiler
+ *
+ * Named scopes nest freely: each one brackets its GL commands with two
+ * GL_TIMESTAMP queries (glQueryCounter), so unlike GL_TIME_ELAPSED an
+ * outer scope can stay open around inner ones. The CPU time of the same
+ * scope is taken alongside.
+ *
+ * Queries of a frame are only read back when its slot in the ring comes
+ * round again, FRAME_LATENCY frames later; by then the GPU is normally
+ * done with them and reading never stalls the pipeline (if it would, the
+ * read still happens and is counted in Stalls()).
+ *
+ *     GpuProfiler profiler;                  // once GL is loaded
+ *     while (...)
+ *     {
+ *         profiler.BeginFrame();             // opens the "frame" scope
+ *         { GpuScope scope(profiler, "clear"); glClear(...); }
+ *         { GpuScope scope(profiler, "draw");  ... }
+ *         { GpuScope scope(profiler, "swap");  glfwSwapBuffers(window); }
+ *         profiler.EndFrame();
+ *     }
+ *     profiler.Flush();
+ *     profiler.PrintSummary();
+ *
+ * The destructor deletes the queries, so the profiler has to go while the
+ * context is still current, before glfwTerminate().
+ */
+
+// One scope of a resolved frame
+struct GpuScopeTiming {
+    const char* name;
+    int depth;                  // 0 is the frame itself
+    double cpuMs;
+    double gpuMs;
+};
+
+struct GpuFrameTimings {
+    uint64_t frame;             // BeginFrame() count when it was recorded
+    std::vector<GpuScopeTiming> scopes;     // in begin order, parents before children
+};
+
+class GpuProfiler
+{
+public:
+
+    static const int FRAME_LATENCY = 4;     // frames in the ring
+
+    GpuProfiler() : frameCount(0), open(false), stalls(0) {
+        latest.frame = 0;
+    }
+    ~GpuProfiler(){
+        for (int i = 0; i < FRAME_LATENCY; i++)
+            if (!slots[i].queries.empty())
+                glDeleteQueries((GLsizei)slots[i].queries.size(), slots[i].queries.data());
+    }
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    /**
+     * @brief      Start recording a frame, resolving the one recorded FRAME_LATENCY frames ago
+     */
+    void BeginFrame(){
+        Slot& slot = slots[frameCount % FRAME_LATENCY];
+        resolve(slot, true);
+        slot.frame = frameCount;
+        slot.scopes.clear();
+        slot.nextQuery = 0;
+        stack.clear();
+        open = true;
+        Begin("frame");
+    }
+
+    void EndFrame(){
+        if (!open)
+            return;
+        while (!stack.empty())
+            End();
+        open = false;
+        frameCount++;
+    }
+
+    /**
+     * @brief      Open a scope, the name must outlive the profiler (a literal)
+     */
+    void Begin(const char* name){
+        if (!open)
+            return;
+        Slot& slot = current();
+        Record record;
+        record.name = name;
+        record.depth = (int)stack.size();
+        record.beginQuery = query(slot);
+        record.endQuery = 0;
+        record.cpuBegin = std::chrono::steady_clock::now();
+        glQueryCounter(record.beginQuery, GL_TIMESTAMP);
+        stack.push_back(slot.scopes.size());
+        slot.scopes.push_back(record);
+    }
+
+    void End(){
+        if (!open || stack.empty())
+            return;
+        Slot& slot = current();
+        Record& record = slot.scopes[stack.back()];
+        stack.pop_back();
+        record.endQuery = query(slot);
+        glQueryCounter(record.endQuery, GL_TIMESTAMP);
+        record.cpuEnd = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief      Resolve every frame still in the ring, waiting for the GPU
+     *
+     * For the end of a run, before reading the totals.
+     */
+    void Flush(){
+        EndFrame();
+        for (int i = 0; i < FRAME_LATENCY; i++)
+            resolve(slots[(frameCount + i) % FRAME_LATENCY], false);
+    }
+
+    /**
+     * @brief      The most recently resolved frame, FRAME_LATENCY frames behind the current one
+     */
+    const GpuFrameTimings& Latest() const { return latest; }
+
+    // BeginFrame() count, the number of the frame being recorded
+    uint64_t Frame() const { return frameCount; }
+
+    // Result reads that had to wait for the GPU
+    uint64_t Stalls() const { return stalls; }
+
+    /**
+     * @brief      Per scope averages over every resolved frame, as a JSON object
+     *
+     * Keys are scope paths ("frame/draw"); meant to be embedded in a
+     * larger report (see FrameBenchmark::AddSection).
+     */
+    std::string ReportJSON() const {
+        std::ostringstream json;
+        json << "{";
+        bool first = true;
+        for (std::map<std::string, Totals>::const_iterator it = totals.begin(); it != totals.end(); ++it)
+        {
+            const Totals& t = it->second;
+            json << (first ? "\n" : ",\n") << "    \"" << it->first << "\": { \"count\": " << t.count
+                 << ", \"cpu_ms\": " << t.cpuMs / t.count
+                 << ", \"gpu_ms\": " << t.gpuMs / t.count
+                 << ", \"gpu_max_ms\": " << t.gpuMaxMs << " }";
+            first = false;
+        }
+        json << "\n  }";
+        return json.str();
+    }
+
+    void PrintSummary() const {
+        std::cout << "GPU profile, averages over resolved frames (" << stalls << " stalls):" << std::endl;
+        for (std::map<std::string, Totals>::const_iterator it = totals.begin(); it != totals.end(); ++it)
+        {
+            char line[160];
+            snprintf(line, sizeof(line), "  %-28s cpu %8.3f ms   gpu %8.3f ms (max %.3f)",
+                     it->first.c_str(), it->second.cpuMs / it->second.count,
+                     it->second.gpuMs / it->second.count, it->second.gpuMaxMs);
+            std::cout << line << std::endl;
+        }
+    }
+
+private:
+
+    struct Record {
+        const char* name;
+        int depth;
+        GLuint beginQuery;
+        GLuint endQuery;
+        std::chrono::steady_clock::time_point cpuBegin;
+        std::chrono::steady_clock::time_point cpuEnd;
+    };
+
+    struct Slot {
+        uint64_t frame;
+        std::vector<Record> scopes;
+        std::vector<GLuint> queries;    // grows to the largest frame seen, then reused
+        size_t nextQuery;
+
+        Slot() : frame(0), nextQuery(0) {}
+    };
+
+    struct Totals {
+        uint64_t count;
+        double cpuMs;
+        double gpuMs;
+        double gpuMaxMs;
+
+        Totals() : count(0), cpuMs(0.0), gpuMs(0.0), gpuMaxMs(0.0) {}
+    };
+
+    Slot slots[FRAME_LATENCY];
+    uint64_t frameCount;
+    bool open;
+    std::vector<size_t> stack;          // open scopes of the current frame
+    uint64_t stalls;
+    GpuFrameTimings latest;
+    std::map<std::string, Totals> totals;
+
+    Slot& current(){
+        return slots[frameCount % FRAME_LATENCY];
+    }
+
+    GLuint query(Slot& slot){
+        if (slot.nextQuery == slot.queries.size())
+        {
+            GLuint id;
+            glGenQueries(1, &id);
+            slot.queries.push_back(id);
+        }
+        return slot.queries[slot.nextQuery++];
+    }
+
+    void resolve(Slot& slot, bool countStall){
+        if (slot.scopes.empty())
+            return;
+        // the last query issued is the frame's end, when it is ready all are
+        GLint available = 0;
+        glGetQueryObjectiv(slot.queries[slot.nextQuery - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available && countStall)
+            stalls++;
+
+        latest.frame = slot.frame;
+        latest.scopes.clear();
+        std::vector<std::string> path;
+        for (size_t i = 0; i < slot.scopes.size(); i++)
+        {
+            const Record& record = slot.scopes[i];
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(record.beginQuery, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(record.endQuery, GL_QUERY_RESULT, &end);
+
+            GpuScopeTiming timing;
+            timing.name = record.name;
+            timing.depth = record.depth;
+            timing.cpuMs = std::chrono::duration<double, std::milli>(record.cpuEnd - record.cpuBegin).count();
+            timing.gpuMs = end > begin ? (end - begin) / 1.0e6 : 0.0;
+            latest.scopes.push_back(timing);
+
+            path.resize(record.depth);
+            path.push_back(record.name);
+            std::string key = path[0];
+            for (size_t p = 1; p < path.size(); p++)
+                key += "/" + path[p];
+            Totals& t = totals[key];
+            t.count++;
+            t.cpuMs += timing.cpuMs;
+            t.gpuMs += timing.gpuMs;
+            if (timing.gpuMs > t.gpuMaxMs)
+                t.gpuMaxMs = timing.gpuMs;
+        }
+        slot.scopes.clear();
+    }
+};
+
+/**
+ * Opens a profiler scope for the lifetime of the object
+ */
+class GpuScope
+{
+public:
+    GpuScope(GpuProfiler& profiler, const char* name) : profiler(profiler) {
+        profiler.Begin(name);
+    }
+    ~GpuScope(){
+        profiler.End();
+    }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    GpuProfiler& profiler;
+};
+#endif
@@ -0,0 +1,502 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <myshaders/shader_s.h>
+#include <bench/glcounters.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/**
+ * Frame time overlay
+ *
+ * Shows FPS, frame time, p50/p99 over the last FRAME_HISTORY frames,
+ * the scene's draw calls, state changes and triangles per frame, a frame
+ * time graph and the HUD's own CPU cost. Everything is drawn as quads
+ * in one dynamic vertex buffer from a glyph atlas (an embedded 5x7
+ * font), with one draw call.
+ *
+ * To stay well under 1% of a frame the text is only rebuilt every
+ * REFRESH_SECONDS; per frame the HUD appends the graph bars, uploads one
+ * small buffer and draws. GL state it touches is restored afterwards.
+ *
+ *     PerfHud hud("hud.vs", "hud.fs");    // once GL is loaded
+ *     while (...)
+ *     {
+ *         hud.ToggleOnKey(window, GLFW_KEY_F1);
+ *         ...render...
+ *         hud.Draw(window);               // last, before swapping
+ *         glfwSwapBuffers(window);
+ *     }
+ *
+ * Draw and state counts come from bench/glcounters.h, which the HUD
+ * installs; the HUD's own calls are left out of them.
+ *
+ * Its buffers, atlas and program are deleted by the destructor: destroy
+ * the HUD before glfwTerminate().
+ */
+
+struct HudVertex {
+    float x, y;                 // pixels from the top left
+    float u, v;
+    unsigned char color[4];
+};
+
+namespace perfhud_detail {
+
+const int GLYPH_W = 5, GLYPH_H = 7;
+const int CELL = 8;                     // atlas cell, glyphs sit in its top left
+const int ATLAS_COLUMNS = 16;
+const int FIRST_CHAR = 32, LAST_CHAR = 127;
+const int SOLID_CHAR = 127;             // filled cell, for bars and panels
+
+// Rows of 5 bits, most significant on the left; letters are upper case only
+const unsigned char FONT[LAST_CHAR - FIRST_CHAR + 1][GLYPH_H] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // ' '
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '!'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '"'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '#'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},   // '%'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '&'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // "'"
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02},   // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},   // ')'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '*'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // ','
+    {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00},   // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c},   // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},   // '/'
+    {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e},   // '0'
+    {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e},   // '1'
+    {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f},   // '2'
+    {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e},   // '3'
+    {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02},   // '4'
+    {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e},   // '5'
+    {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e},   // '6'
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},   // '7'
+    {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e},   // '8'
+    {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c},   // '9'
+    {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00},   // ':'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // ';'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '<'
+    {0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00},   // '='
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '>'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '?'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '@'
+    {0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},   // 'A'
+    {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},   // 'B'
+    {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e},   // 'C'
+    {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},   // 'D'
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f},   // 'E'
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},   // 'F'
+    {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f},   // 'G'
+    {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},   // 'H'
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},   // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},   // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},   // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},   // 'L'
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11},   // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},   // 'N'
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},   // 'O'
+    {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},   // 'P'
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d},   // 'Q'
+    {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},   // 'R'
+    {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e},   // 'S'
+    {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},   // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},   // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},   // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a},   // 'W'
+    {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},   // 'X'
+    {0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04},   // 'Y'
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},   // 'Z'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '['
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '\\'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // ']'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '_'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '`'
+    {0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},   // 'a'
+    {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},   // 'b'
+    {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e},   // 'c'
+    {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},   // 'd'
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f},   // 'e'
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},   // 'f'
+    {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f},   // 'g'
+    {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},   // 'h'
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},   // 'i'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},   // 'j'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},   // 'k'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},   // 'l'
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11},   // 'm'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},   // 'n'
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},   // 'o'
+    {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},   // 'p'
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d},   // 'q'
+    {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},   // 'r'
+    {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e},   // 's'
+    {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},   // 't'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},   // 'u'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},   // 'v'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a},   // 'w'
+    {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},   // 'x'
+    {0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04},   // 'y'
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},   // 'z'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},   // '|'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '}'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // '~'
+    {0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f},   // solid block, used for the graph
+};
+
+} // namespace perfhud_detail
+
+class PerfHud
+{
+public:
+
+    static const int FRAME_HISTORY = 240;       // frames kept for the percentiles
+    static const int GRAPH_BARS = 120;          // most recent frames in the graph
+    static const int MAX_QUADS = 1024;
+    static constexpr double REFRESH_SECONDS = 0.25;
+    static constexpr float GRAPH_MAX_MS = 33.3f;
+
+    /**
+     * @brief      Build the program, the glyph atlas and the buffers, call once GL is loaded
+     */
+    PerfHud(const char* vertexPath, const char* fragmentPath, int scale = 2)
+        : shader(vertexPath, fragmentPath), scale(scale), visible(true), keyDown(false),
+          history(FRAME_HISTORY, 0.0f), historyCount(0), historyNext(0),
+          windowFrames(0), hudMs(0.0), windowHudMs(0.0) {
+        InstallGLCounters();
+        memset(&windowCounters, 0, sizeof(windowCounters));
+        memset(&shown, 0, sizeof(shown));
+        lastCounters = GetGLCounters();
+        lastFrame = lastRefresh = std::chrono::steady_clock::now();
+
+        buildAtlas();
+
+        std::vector<unsigned short> indices(MAX_QUADS * 6);
+        for (int q = 0; q < MAX_QUADS; q++)
+        {
+            static const unsigned short corners[6] = {0, 1, 2, 2, 3, 0};
+            for (int i = 0; i < 6; i++)
+                indices[q * 6 + i] = (unsigned short)(q * 4 + corners[i]);
+        }
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 4 * sizeof(HudVertex), NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, u));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (void*)offsetof(HudVertex, color));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        GLint program;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        shader.use();
+        shader.setInt("glyphs", 0);
+        screenLoc = glGetUniformLocation(shader.ID, "screenSize");
+        glUseProgram(program);
+        lastCounters = GetGLCounters();
+    }
+    ~PerfHud(){
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteTextures(1, &atlas);
+        glDeleteProgram(shader.ID);
+    }
+
+    PerfHud(const PerfHud&) = delete;
+    PerfHud& operator=(const PerfHud&) = delete;
+
+    bool Visible() const { return visible; }
+    void SetVisible(bool show){ visible = show; }
+    void Toggle(){ visible = !visible; }
+
+    /**
+     * @brief      Toggle when key goes down, call once per frame
+     */
+    void ToggleOnKey(GLFWwindow* window, int key){
+        bool down = glfwGetKey(window, key) == GLFW_PRESS;
+        if (down && !keyDown)
+            Toggle();
+        keyDown = down;
+    }
+
+    /**
+     * @brief      Record the frame and draw the overlay on the bound framebuffer
+     *
+     * Call after the scene, before swapping: the frame time is the time
+     * between two calls.
+     */
+    void Draw(GLFWwindow* window){
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        recordFrame(start);
+        if (!visible)
+        {
+            lastCounters = GetGLCounters();
+            return;
+        }
+
+        if (text.empty() || std::chrono::duration<double>(start - lastRefresh).count() >= REFRESH_SECONDS)
+            refresh(start);
+
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        buildQuads();
+        if (!vertices.empty() && width > 0 && height > 0)
+            submit(width, height);
+
+        lastCounters = GetGLCounters();
+        hudMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+
+    Shader shader;
+    int scale;
+    bool visible;
+    bool keyDown;
+    unsigned int VAO, VBO, EBO, atlas;
+    int screenLoc;
+
+    std::vector<float> history;         // frame times in ms, a ring
+    int historyCount;
+    int historyNext;
+    std::chrono::steady_clock::time_point lastFrame;
+    std::chrono::steady_clock::time_point lastRefresh;
+
+    // scene counters, summed over the refresh window
+    GLCounters lastCounters;
+    GLCounters windowCounters;
+    int windowFrames;
+    double hudMs;
+    double windowHudMs;
+
+    struct Shown {
+        float fps, frameMs, p50, p99, drawCalls, stateChanges, triangles, hudMs;
+    } shown;
+
+    std::vector<HudVertex> text;        // rebuilt on refresh
+    std::vector<HudVertex> vertices;    // text plus this frame's graph
+
+    void buildAtlas(){
+        using namespace perfhud_detail;
+        const int rows = (LAST_CHAR - FIRST_CHAR + ATLAS_COLUMNS) / ATLAS_COLUMNS;
+        const int w = ATLAS_COLUMNS * CELL, h = rows * CELL;
+        std::vector<unsigned char> pixels(w * h, 0);
+        for (int c = FIRST_CHAR; c <= LAST_CHAR; c++)
+        {
+            int cx = (c - FIRST_CHAR) % ATLAS_COLUMNS * CELL, cy = (c - FIRST_CHAR) / ATLAS_COLUMNS * CELL;
+            for (int y = 0; y < GLYPH_H; y++)
+                for (int x = 0; x < GLYPH_W; x++)
+                    if (FONT[c - FIRST_CHAR][y] & (0x10 >> x))
+                        pixels[(cy + y) * w + cx + x] = 255;
+        }
+        atlasWidth = (float)w;
+        atlasHeight = (float)h;
+
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    float atlasWidth, atlasHeight;
+
+    void recordFrame(std::chrono::steady_clock::time_point now){
+        float ms = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+        lastFrame = now;
+        history[historyNext] = ms;
+        historyNext = (historyNext + 1) % FRAME_HISTORY;
+        historyCount = std::min(historyCount + 1, FRAME_HISTORY);
+
+        // everything counted since the HUD's last draw is the scene's
+        const GLCounters& now_ = GetGLCounters();
+        windowCounters.drawCalls    += since(now_.drawCalls, lastCounters.drawCalls);
+        windowCounters.stateChanges += since(now_.stateChanges, lastCounters.stateChanges);
+        windowCounters.triangles    += since(now_.triangles, lastCounters.triangles);
+        windowHudMs += hudMs;
+        windowFrames++;
+    }
+
+    // counters may have been reset in between (a benchmark's warmup)
+    static uint64_t since(uint64_t now, uint64_t last){
+        return now >= last ? now - last : now;
+    }
+
+    void refresh(std::chrono::steady_clock::time_point now){
+        lastRefresh = now;
+        std::vector<float> sorted(history.begin(), history.begin() + historyCount);
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (size_t i = 0; i < sorted.size(); i++)
+            sum += sorted[i];
+        float mean = sorted.empty() ? 0.0f : (float)(sum / sorted.size());
+        shown.frameMs = mean;
+        shown.fps = mean > 0.0f ? 1000.0f / mean : 0.0f;
+        shown.p50 = sorted.empty() ? 0.0f : sorted[sorted.size() / 2];
+        shown.p99 = sorted.empty() ? 0.0f : sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        float frames = (float)std::max(windowFrames, 1);
+        shown.drawCalls = windowCounters.drawCalls / frames;
+        shown.stateChanges = windowCounters.stateChanges / frames;
+        shown.triangles = windowCounters.triangles / frames;
+        shown.hudMs = (float)(windowHudMs / frames);
+        memset(&windowCounters, 0, sizeof(windowCounters));
+        windowFrames = 0;
+        windowHudMs = 0.0;
+
+        char line[64];
+        text.clear();
+        float x = (float)(8 * scale), y = (float)(8 * scale), lineHeight = (float)(10 * scale);
+        static const unsigned char white[4] = {255, 255, 255, 255};
+        snprintf(line, sizeof(line), "FPS %.1f  %.2f MS", shown.fps, shown.frameMs);
+        addText(line, x, y, white);
+        snprintf(line, sizeof(line), "P50 %.2f  P99 %.2f MS", shown.p50, shown.p99);
+        addText(line, x, y + lineHeight, white);
+        snprintf(line, sizeof(line), "DRAWS %.0f  STATE %.0f  TRIS %.0f", shown.drawCalls, shown.stateChanges, shown.triangles);
+        addText(line, x, y + 2 * lineHeight, white);
+        snprintf(line, sizeof(line), "HUD %.3f MS (%.2f%%)", shown.hudMs, shown.frameMs > 0.0f ? 100.0f * shown.hudMs / shown.frameMs : 0.0f);
+        addText(line, x, y + 3 * lineHeight, white);
+    }
+
+    void buildQuads(){
+        float x0 = (float)(4 * scale), y0 = (float)(4 * scale);
+        float graphTop = y0 + (float)(48 * scale), graphHeight = (float)(30 * scale);
+        float barWidth = (float)scale;
+        float panelWidth = std::max((float)(GRAPH_BARS * scale), (float)(34 * 6 * scale)) + (float)(8 * scale);
+
+        vertices.clear();
+        static const unsigned char panel[4] = {0, 0, 0, 160};
+        addSolid(x0, y0, x0 + panelWidth, graphTop + graphHeight + (float)(4 * scale), panel);
+        vertices.insert(vertices.end(), text.begin(), text.end());
+
+        // oldest on the left, green under 16.7 ms, yellow under 33.3, red above
+        float left = x0 + (float)(4 * scale), bottom = graphTop + graphHeight;
+        static const unsigned char target[4] = {255, 255, 255, 96};
+        float targetY = bottom - graphHeight * 16.7f / GRAPH_MAX_MS;
+        addSolid(left, targetY, left + GRAPH_BARS * barWidth, targetY + 1.0f, target);
+        int bars = std::min(historyCount, (int)GRAPH_BARS);
+        for (int i = 0; i < bars; i++)
+        {
+            float ms = history[(historyNext - bars + i + FRAME_HISTORY) % FRAME_HISTORY];
+            static const unsigned char green[4] = {64, 220, 64, 230}, yellow[4] = {240, 200, 40, 230}, red[4] = {240, 60, 60, 230};
+            const unsigned char* color = ms < 16.7f ? green : (ms < 33.3f ? yellow : red);
+            float h = graphHeight * (ms < GRAPH_MAX_MS ? ms : GRAPH_MAX_MS) / GRAPH_MAX_MS;
+            float bx = left + (GRAPH_BARS - bars + i) * barWidth;
+            addSolid(bx, bottom - h, bx + barWidth, bottom, color);
+        }
+    }
+
+    void submit(int width, int height){
+        // save what the HUD changes, so a sample that binds once before its loop keeps working
+        GLint program, vao, arrayBuffer, activeUnit, texture2D, viewport[4];
+        GLint blendSrcRGB, blendDstRGB, blendSrcAlpha, blendDstAlpha, blendEquationRGB, blendEquationAlpha;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit);
+        glActiveTexture(GL_TEXTURE0);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture2D);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrcRGB);
+        glGetIntegerv(GL_BLEND_DST_RGB, &blendDstRGB);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendSrcAlpha);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, &blendDstAlpha);
+        glGetIntegerv(GL_BLEND_EQUATION_RGB, &blendEquationRGB);
+        glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &blendEquationAlpha);
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST), blend = glIsEnabled(GL_BLEND), cull = glIsEnabled(GL_CULL_FACE);
+
+        GLsizei quads = (GLsizei)std::min(vertices.size() / 4, (size_t)MAX_QUADS);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // respecifying the store orphans last frame's, nothing waits for the GPU to be done with it
+        glBufferData(GL_ARRAY_BUFFER, quads * 4 * sizeof(HudVertex), vertices.data(), GL_STREAM_DRAW);
+
+        glUseProgram(shader.ID);
+        glUniform2f(screenLoc, (float)width, (float)height);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glBindVertexArray(VAO);
+        // the scene may have left a smaller viewport behind, e.g. from a shadow or offscreen pass
+        glViewport(0, 0, width, height);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDrawElements(GL_TRIANGLES, quads * 6, GL_UNSIGNED_SHORT, 0);
+
+        glBlendEquationSeparate(blendEquationRGB, blendEquationAlpha);
+        glBlendFuncSeparate(blendSrcRGB, blendDstRGB, blendSrcAlpha, blendDstAlpha);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        if (!blend)
+            glDisable(GL_BLEND);
+        if (cull)
+            glEnable(GL_CULL_FACE);
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+        glBindVertexArray(vao);
+        glBindTexture(GL_TEXTURE_2D, texture2D);
+        glActiveTexture(activeUnit);
+        glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+        glUseProgram(program);
+    }
+
+    void addQuad(std::vector<HudVertex>& out, float x0, float y0, float x1, float y1,
+                 float u0, float v0, float u1, float v1, const unsigned char color[4]){
+        HudVertex corners[4] = {
+            {x0, y0, u0, v0, {color[0], color[1], color[2], color[3]}},
+            {x0, y1, u0, v1, {color[0], color[1], color[2], color[3]}},
+            {x1, y1, u1, v1, {color[0], color[1], color[2], color[3]}},
+            {x1, y0, u1, v0, {color[0], color[1], color[2], color[3]}},
+        };
+        out.insert(out.end(), corners, corners + 4);
+    }
+
+    void addSolid(float x0, float y0, float x1, float y1, const unsigned char color[4]){
+        using namespace perfhud_detail;
+        // the middle of the filled cell, so nearest sampling stays inside it
+        float u = ((SOLID_CHAR - FIRST_CHAR) % ATLAS_COLUMNS * CELL + 2.5f) / atlasWidth;
+        float v = ((SOLID_CHAR - FIRST_CHAR) / ATLAS_COLUMNS * CELL + 3.5f) / atlasHeight;
+        addQuad(vertices, x0, y0, x1, y1, u, v, u, v, color);
+    }
+
+    void addText(const char* s, float x, float y, const unsigned char color[4]){
+        using namespace perfhud_detail;
+        float w = (float)(GLYPH_W * scale), h = (float)(GLYPH_H * scale), advance = (float)((GLYPH_W + 1) * scale);
+        for (; *s; s++, x += advance)
+        {
+            int c = (unsigned char)*s;
+            if (c <= FIRST_CHAR || c > LAST_CHAR)
+                continue;
+            float u = (float)((c - FIRST_CHAR) % ATLAS_COLUMNS * CELL), v = (float)((c - FIRST_CHAR) / ATLAS_COLUMNS * CELL);
+            addQuad(text, x, y, x + w, y + h, u / atlasWidth, v / atlasHeight,
+                    (u + GLYPH_W) / atlasWidth, (v + GLYPH_H) / atlasHeight, color);
+        }
+    }
+};
+#endif
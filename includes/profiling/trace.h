@@ -0,0 +1,304 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * CPU tracing scopes with Chrome Trace Event export
+ *
+ *     TRACE_SCOPE("draw");            // until the end of the block
+ *     TRACE_FUNCTION();               // named after the enclosing function
+ *     TRACE_THREAD_NAME("loader");    // label this thread in the viewer
+ *
+ * Every thread records into its own fixed size buffer with no locks: an
+ * event is written, then published with one release store of the count.
+ * Timestamps are raw TSC reads on x86 (converted to wall time when the
+ * trace is written) and clock_gettime(CLOCK_MONOTONIC) elsewhere, or
+ * everywhere with -DTRACE_USE_CLOCK_GETTIME.
+ *
+ * Recording only happens between TraceStart() and TraceStop(); outside
+ * a session a scope costs one relaxed load. Build with -DTRACE_DISABLED
+ * and the macros compile to nothing.
+ *
+ * TraceWrite() dumps Chrome's JSON trace format, which chrome://tracing
+ * and ui.perfetto.dev open directly. Samples take --trace file.json (see
+ * TraceSession).
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <time.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(TRACE_USE_CLOCK_GETTIME)
+#include <x86intrin.h>
+#define TRACE_HAS_TSC 1
+#endif
+
+namespace trace_detail {
+
+const uint32_t BUFFER_EVENTS = 1 << 16;     // per thread; later events are dropped and counted
+
+struct Event {
+    const char* name;       // string literal or __func__, never copied
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct ThreadBuffer {
+    std::unique_ptr<Event[]> events;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> dropped;
+    uint32_t tid;
+    std::string name;
+
+    explicit ThreadBuffer(uint32_t tid) : events(new Event[BUFFER_EVENTS]), count(0), dropped(0), tid(tid) {}
+};
+
+// Owns every thread's buffer, so events of finished threads survive until written
+struct Registry {
+    std::mutex lock;
+    std::vector<std::unique_ptr<ThreadBuffer> > buffers;
+    std::atomic<bool> recording;
+    uint64_t startTicks;
+    uint64_t startNs;
+
+    Registry() : recording(false), startTicks(0), startNs(0) {}
+};
+
+inline Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+inline uint64_t monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+inline uint64_t now()
+{
+#ifdef TRACE_HAS_TSC
+    return __rdtsc();
+#else
+    return monotonicNs();
+#endif
+}
+
+// Registration takes the lock, once per thread
+inline ThreadBuffer& threadBuffer()
+{
+    static thread_local ThreadBuffer* buffer = NULL;
+    if (!buffer)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        r.buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer((uint32_t)r.buffers.size() + 1)));
+        buffer = r.buffers.back().get();
+    }
+    return *buffer;
+}
+
+inline void record(const char* name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    uint32_t n = buffer.count.load(std::memory_order_relaxed);
+    if (n == BUFFER_EVENTS)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[n].name = name;
+    buffer.events[n].begin = begin;
+    buffer.events[n].end = end;
+    buffer.count.store(n + 1, std::memory_order_release);
+}
+
+inline void writeEscaped(FILE* f, const char* text)
+{
+    for (; *text; text++)
+    {
+        if (*text == '"' || *text == '\\')
+            fputc('\\', f);
+        if ((unsigned char)*text >= 0x20)
+            fputc(*text, f);
+    }
+}
+
+class Scope
+{
+public:
+    explicit Scope(const char* name) : name(name), begin(0) {
+        if (registry().recording.load(std::memory_order_relaxed))
+            begin = now();
+    }
+    ~Scope(){
+        if (begin && registry().recording.load(std::memory_order_relaxed))
+            record(name, begin, now());
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+} // namespace trace_detail
+
+/**
+ * @brief      Start recording, discarding events of a previous session
+ *
+ * Call while no other thread is recording.
+ */
+inline void TraceStart()
+{
+    trace_detail::Registry& r = trace_detail::registry();
+    {
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (size_t i = 0; i < r.buffers.size(); i++)
+        {
+            r.buffers[i]->count.store(0, std::memory_order_relaxed);
+            r.buffers[i]->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+    r.startNs = trace_detail::monotonicNs();
+    r.startTicks = trace_detail::now();
+    r.recording.store(true, std::memory_order_release);
+}
+
+inline void TraceStop()
+{
+    trace_detail::registry().recording.store(false, std::memory_order_release);
+}
+
+inline bool TraceRecording()
+{
+    return trace_detail::registry().recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief      Name the calling thread in the trace
+ */
+inline void TraceThreadName(const char* name)
+{
+    trace_detail::ThreadBuffer& buffer = trace_detail::threadBuffer();
+    // TraceWrite reads the names under the same lock
+    std::lock_guard<std::mutex> guard(trace_detail::registry().lock);
+    buffer.name = name;
+}
+
+/**
+ * @brief      Write everything recorded so far as Chrome Trace Event JSON
+ *
+ * @return     false if the file cannot be written
+ */
+inline bool TraceWrite(const char* path)
+{
+    trace_detail::Registry& r = trace_detail::registry();
+    // ticks to microseconds, measured over the session itself
+    double usPerTick = 1.0e-3;
+#ifdef TRACE_HAS_TSC
+    uint64_t endNs = trace_detail::monotonicNs();
+    uint64_t endTicks = trace_detail::now();
+    if (endTicks > r.startTicks)
+        usPerTick = (endNs - r.startNs) * 1.0e-3 / (double)(endTicks - r.startTicks);
+#endif
+
+    FILE* f = fopen(path, "w");
+    if (!f)
+    {
+        std::cout << "ERROR::TRACE::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"opengl\"}}");
+
+    size_t events = 0, dropped = 0;
+    std::lock_guard<std::mutex> guard(r.lock);
+    for (size_t b = 0; b < r.buffers.size(); b++)
+    {
+        const trace_detail::ThreadBuffer& buffer = *r.buffers[b];
+        if (!buffer.name.empty())
+        {
+            fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", buffer.tid);
+            trace_detail::writeEscaped(f, buffer.name.c_str());
+            fprintf(f, "\"}}");
+        }
+        uint32_t n = buffer.count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const trace_detail::Event& e = buffer.events[i];
+            fprintf(f, ",\n{\"name\":\"");
+            trace_detail::writeEscaped(f, e.name);
+            fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    buffer.tid, (double)(int64_t)(e.begin - r.startTicks) * usPerTick, (double)(e.end - e.begin) * usPerTick);
+        }
+        events += n;
+        dropped += buffer.dropped.load(std::memory_order_relaxed);
+    }
+    fprintf(f, "\n]}\n");
+    bool ok = ferror(f) == 0;
+    fclose(f);
+    if (!ok)
+    {
+        std::cout << "ERROR::TRACE::SHORT_WRITE " << path << std::endl;
+        return false;
+    }
+    std::cout << "Trace: " << events << " events (" << dropped << " dropped) written to " << path << std::endl;
+    return true;
+}
+
+/**
+ * Traces a whole run when the command line has --trace file.json: starts
+ * recording on construction and writes the file on destruction.
+ */
+class TraceSession
+{
+public:
+    TraceSession(int argc, char const *argv[]){
+        for (int i = 1; i + 1 < argc; i++)
+            if (strcmp(argv[i], "--trace") == 0)
+                path = argv[i + 1];
+        if (!path.empty())
+        {
+            TraceThreadName("main");
+            TraceStart();
+        }
+    }
+    ~TraceSession(){
+        if (path.empty())
+            return;
+        TraceStop();
+        TraceWrite(path.c_str());
+    }
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    std::string path;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef TRACE_DISABLED
+#define TRACE_SCOPE(name)
+#define TRACE_FUNCTION()
+#define TRACE_THREAD_NAME(name)
+#else
+#define TRACE_SCOPE(name) trace_detail::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_FUNCTION() trace_detail::Scope TRACE_CONCAT(traceScope, __LINE__)(__func__)
+#define TRACE_THREAD_NAME(name) TraceThreadName(name)
+#endif
+#endif
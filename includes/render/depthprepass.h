@@ -0,0 +1,154 @@
+#ifndef DEPTHPREPASS_H
+#define DEPTHPREPASS_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+/**
+ * Optional depth prepass, and the fragment work of the color pass
+ *
+ * With --prepass the opaque geometry is drawn twice: first depth only,
+ * with a position only program and vertex stream (no color writes, a
+ * fragment shader that does nothing), then in color with the depth test
+ * at GL_EQUAL and depth writes off, so the expensive fragment shader runs
+ * once per covered pixel instead of once per fragment that happened to
+ * be nearest when it was drawn. Both programs must compute gl_Position
+ * the same way and declare it invariant, or GL_EQUAL drops pixels.
+ *
+ *     DepthPrepass prepass(argc, argv);
+ *     ...
+ *     if (prepass.Enabled())
+ *     {
+ *         prepass.BeginDepth();
+ *         ...draw positions with the depth only program...
+ *         prepass.EndDepth();
+ *     }
+ *     prepass.BeginColor();
+ *     ...draw as usual...
+ *     prepass.EndColor();
+ *
+ * The color pass is bracketed by a GL_SAMPLES_PASSED query with or
+ * without the prepass: the samples that passed the depth test are the
+ * ones shaded, so two --bench runs compare the fragment work directly.
+ * Queries are read QUERY_LATENCY frames later, like the GPU profiler's,
+ * and deleted with the object, which must happen before glfwTerminate().
+ *
+ * Options:
+ *
+ *     --prepass            draw depth first, then color with GL_EQUAL
+ */
+
+class DepthPrepass
+{
+public:
+
+    static const int QUERY_LATENCY = 4;
+
+    DepthPrepass(int argc, char const *argv[]) : enabled(false), frame(0), frames(0), samples(0), stalls(0) {
+        for (int i = 1; i < argc; i++)
+            if (strcmp(argv[i], "--prepass") == 0)
+                enabled = true;
+        for (int i = 0; i < QUERY_LATENCY; i++)
+        {
+            queries[i] = 0;
+            pending[i] = false;
+        }
+    }
+    ~DepthPrepass(){
+        for (int i = 0; i < QUERY_LATENCY; i++)
+            if (queries[i])
+                glDeleteQueries(1, &queries[i]);
+    }
+
+    DepthPrepass(const DepthPrepass&) = delete;
+    DepthPrepass& operator=(const DepthPrepass&) = delete;
+
+    bool Enabled() const { return enabled; }
+
+    /**
+     * @brief      Depth only state: color writes off, depth writes on
+     */
+    void BeginDepth(){
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+    }
+
+    void EndDepth(){
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+
+    /**
+     * @brief      Color pass state, GL_EQUAL without depth writes after a prepass; starts counting samples
+     */
+    void BeginColor(){
+        if (enabled)
+        {
+            glDepthMask(GL_FALSE);
+            glDepthFunc(GL_EQUAL);
+        }
+        int slot = (int)(frame % QUERY_LATENCY);
+        collect(slot, true);
+        if (!queries[slot])
+            glGenQueries(1, &queries[slot]);
+        glBeginQuery(GL_SAMPLES_PASSED, queries[slot]);
+    }
+
+    void EndColor(){
+        glEndQuery(GL_SAMPLES_PASSED);
+        pending[frame % QUERY_LATENCY] = true;
+        frame++;
+        if (enabled)
+        {
+            glDepthMask(GL_TRUE);
+            glDepthFunc(GL_LESS);
+        }
+    }
+
+    /**
+     * @brief      Read every query still in flight, waiting for the GPU; for the end of a run
+     */
+    void Flush(){
+        for (int i = 0; i < QUERY_LATENCY; i++)
+            collect(i, false);
+    }
+
+    // Samples the color pass shaded, per frame
+    double ShadedPerFrame() const { return frames ? (double)samples / frames : 0.0; }
+
+    std::string ReportJSON() const {
+        std::ostringstream json;
+        json << "{\"enabled\": " << (enabled ? "true" : "false") << ", \"frames\": " << frames
+             << ", \"shaded_samples_per_frame\": " << ShadedPerFrame() << ", \"stalls\": " << stalls << "}";
+        return json.str();
+    }
+
+private:
+
+    bool enabled;
+    GLuint queries[QUERY_LATENCY];
+    bool pending[QUERY_LATENCY];
+    uint64_t frame;
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t stalls;
+
+    void collect(int slot, bool countStall){
+        if (!pending[slot])
+            return;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available && countStall)
+            stalls++;
+        GLuint64 passed = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &passed);
+        samples += passed;
+        frames++;
+        pending[slot] = false;
+    }
+};
+#endif
@@ -0,0 +1,156 @@
+#ifndef DYNRES_H
+#define DYNRES_H
+
+#include <profiling/gpuprofiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+/**
+ * Dynamic resolution: the scene's render scale follows its GPU frame time
+ *
+ * With --dynres MS the scene is drawn into an offscreen target of Scale()
+ * times the window size, upscaled when shown; every frame Update() reads
+ * the GPU time of the newest frame the profiler resolved and moves the
+ * scale towards what fits the MS budget, assuming the cost goes with the
+ * pixel count (the scale squared):
+ *
+ *   - over SHRINK_ABOVE of the budget it shrinks at once; it grows only
+ *     after GROW_AFTER frames in a row under GROW_BELOW, so a few fast
+ *     frames don't bring back the resolution that was over budget; in
+ *     between it stays put
+ *   - steps are at most MAX_STEP of the scale and land on multiples of
+ *     STEP, which keeps the number of target sizes (render/targetpool.h) small
+ *   - the timings are GpuProfiler::FRAME_LATENCY frames old, so after a
+ *     change only frames drawn at the new scale count
+ *
+ *     DynamicResolution dynres(argc, argv);
+ *     ...every frame, after profiler.BeginFrame()...
+ *     dynres.Update(profiler);
+ *     dynres.Apply(width, height, sceneWidth, sceneHeight);
+ *
+ * Options:
+ *
+ *     --dynres MS          GPU frame time budget in ms, enables scaling
+ *     --dynres-min S       lowest scale, 0.5 by default
+ */
+
+namespace dynres_detail {
+
+const double STEP = 0.05;           // scales are multiples of this
+const double MAX_STEP = 0.25;       // of the scale, per change
+const double SHRINK_ABOVE = 0.95;   // of the budget
+const double GROW_BELOW = 0.7;
+const int GROW_AFTER = 8;           // frames
+const double TARGET = 0.85;         // where a change aims
+
+} // namespace dynres_detail
+
+class DynamicResolution
+{
+public:
+
+    DynamicResolution(int argc, char const *argv[])
+        : enabled(false), budgetMs(0.0), minScale(0.5), scale(1.0), smoothedMs(-1.0), calm(0), lastSample(0),
+          sampled(false), settleFrame(0), frames(0), samples(0), overBudget(0), changes(0), scaleSum(0.0),
+          gpuMsSum(0.0), lowest(1.0) {
+        for (int i = 1; i + 1 < argc; i++)
+        {
+            if (strcmp(argv[i], "--dynres") == 0)
+                budgetMs = atof(argv[++i]);
+            else if (strcmp(argv[i], "--dynres-min") == 0)
+                minScale = std::min(1.0, std::max(dynres_detail::STEP, atof(argv[++i])));
+        }
+        enabled = budgetMs > 0.0;
+    }
+
+    bool Enabled() const { return enabled; }
+    double Scale() const { return scale; }
+
+    /**
+     * @brief      Feed the newest resolved frame time and adjust the scale, once per frame
+     */
+    void Update(const GpuProfiler& profiler){
+        using namespace dynres_detail;
+        if (!enabled)
+            return;
+        frames++;
+        scaleSum += scale;
+        const GpuFrameTimings& latest = profiler.Latest();
+        if (latest.scopes.empty() || (sampled && latest.frame == lastSample))
+            return;
+        lastSample = latest.frame;
+        sampled = true;
+        // drawn before the last change took effect
+        if (latest.frame < settleFrame)
+            return;
+        // scope 0 is the frame: on a software rasterizer the work lands wherever GL flushes
+        double ms = latest.scopes[0].gpuMs;
+        samples++;
+        gpuMsSum += ms;
+        overBudget += ms > budgetMs;
+        smoothedMs = smoothedMs < 0.0 ? ms : smoothedMs + 0.5 * (ms - smoothedMs);
+
+        calm = ms < budgetMs * GROW_BELOW ? calm + 1 : 0;
+        bool shrink = smoothedMs > budgetMs * SHRINK_ABOVE;
+        bool grow = calm >= GROW_AFTER && smoothedMs < budgetMs * GROW_BELOW && scale < 1.0;
+        if (!shrink && !grow)
+            return;
+        double wanted = scale * std::sqrt(budgetMs * TARGET / std::max(smoothedMs, 1e-3));
+        wanted = std::min(scale * (1.0 + MAX_STEP), std::max(scale * (1.0 - MAX_STEP), wanted));
+        wanted = std::min(1.0, std::max(minScale, std::floor(wanted / STEP + 0.5) * STEP));
+        if (std::fabs(wanted - scale) < STEP * 0.5)
+            return;
+        scale = wanted;
+        lowest = std::min(lowest, scale);
+        changes++;
+        // the frame being recorded is drawn at the new scale, but also pays for creating its targets
+        settleFrame = profiler.Frame() + 1;
+        smoothedMs = -1.0;
+        calm = 0;
+    }
+
+    /**
+     * @brief      The scene size for a window size, the window size itself when disabled
+     */
+    void Apply(int width, int height, int& sceneWidth, int& sceneHeight) const {
+        sceneWidth = std::max(1, (int)(width * scale + 0.5));
+        sceneHeight = std::max(1, (int)(height * scale + 0.5));
+    }
+
+    std::string ReportJSON() const {
+        std::ostringstream json;
+        json << "{\"budget_ms\": " << budgetMs << ", \"min_scale\": " << minScale
+             << ", \"scale_mean\": " << (frames ? scaleSum / frames : scale) << ", \"scale_lowest\": " << lowest
+             << ", \"scale_final\": " << scale << ", \"changes\": " << changes
+             << ", \"gpu_ms_mean\": " << (samples ? gpuMsSum / samples : 0.0)
+             << ", \"over_budget_percent\": " << (samples ? 100.0 * overBudget / samples : 0.0) << "}";
+        return json.str();
+    }
+
+private:
+
+    bool enabled;
+    double budgetMs;
+    double minScale;
+    double scale;
+    double smoothedMs;
+    int calm;                   // samples in a row under GROW_BELOW
+    uint64_t lastSample;        // profiler frame of the last timing read
+    bool sampled;
+    uint64_t settleFrame;       // first profiler frame drawn at the current scale
+
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t overBudget;
+    uint64_t changes;
+    double scaleSum;
+    double gpuMsSum;
+    double lowest;
+};
+#endif
@@ -0,0 +1,443 @@
+#ifndef FRAMEGRAPH_H
+#define FRAMEGRAPH_H
+
+#include <glad/glad.h>
+
+#include <render/rendertarget.h>
+#include <render/targetpool.h>
+#include <profiling/trace.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * A frame graph: render passes declare what they read and write, the
+ * graph works out the rest
+ *
+ * Every frame the passes are declared again, with the render targets
+ * they use as virtual resources: transient ones, described but not
+ * allocated, and imported ones that live outside the graph (the default
+ * framebuffer). Compile() then
+ *
+ *   - culls the passes nothing needs: a pass runs only if it has a side
+ *     effect (SideEffect(), or writing an imported resource) or writes
+ *     something a running pass reads
+ *   - orders the running passes by their dependencies, declaration order
+ *     among the independent ones
+ *   - gives every transient resource a lifetime, from the first running
+ *     pass that uses it to the last
+ *
+ * and Execute() runs the passes, acquiring each transient target from a
+ * RenderTargetPool (render/targetpool.h) just before its first pass and
+ * releasing it right after its last. A later resource of the same
+ * description gets the same target back, so resources whose lifetimes
+ * don't overlap share memory. PeakBytes() is the most transient memory
+ * alive at once, TransientBytes() what it would take without aliasing.
+ *
+ *     FrameGraph graph(pool);
+ *     graph.Reset();
+ *     FrameResource backbuffer = graph.Import("backbuffer", 0, width, height);
+ *     FrameResource scene = graph.Create("scene", RenderTargetDesc(width, height));
+ *     int main = graph.AddPass("main", [&]() { graph.Target(scene)->Bind(); ...draw... });
+ *     scene = graph.Write(main, scene);
+ *     int present = graph.AddPass("present", [&, scene]() { graph.Target(scene)->BlitTo(0, width, height); });
+ *     graph.Read(present, scene);
+ *     graph.Write(present, backbuffer);
+ *     if (graph.Compile())
+ *         graph.Execute();
+ *
+ * Write() returns a new version of the resource, later readers name that
+ * one; a pass writing a resource also sees what the earlier writers left
+ * in it (it draws on top), so it runs after them and keeps them alive.
+ */
+
+typedef int FrameResource;
+const FrameResource FRAME_NO_RESOURCE = -1;
+
+class FrameGraph
+{
+public:
+
+    explicit FrameGraph(RenderTargetPool& pool) : pool(pool), compiled(false), peakBytes(0), transientBytes(0),
+        frames(0), declaredSum(0), culledSum(0), transientSum(0), physicalSum(0), peakSum(0), peakMax(0),
+        unaliasedSum(0) {}
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    /**
+     * @brief      Forget the last frame's passes and resources, before declaring the next
+     */
+    void Reset(){
+        passes.clear();
+        resources.clear();
+        handles.clear();
+        order.clear();
+        compiled = false;
+        peakBytes = transientBytes = 0;
+    }
+
+    /**
+     * @brief      A transient render target, allocated only if a running pass uses it
+     */
+    FrameResource Create(const char* name, const RenderTargetDesc& desc){
+        Resource resource;
+        resource.name = name;
+        resource.desc = desc;
+        resources.push_back(resource);
+        return newHandle((int)resources.size() - 1, -1);
+    }
+
+    /**
+     * @brief      A framebuffer owned elsewhere, 0 for the default one
+     */
+    FrameResource Import(const char* name, GLuint framebuffer, int width, int height){
+        Resource resource;
+        resource.name = name;
+        resource.imported = true;
+        resource.framebuffer = framebuffer;
+        resource.desc.width = width;
+        resource.desc.height = height;
+        resources.push_back(resource);
+        return newHandle((int)resources.size() - 1, -1);
+    }
+
+    /**
+     * @brief      Declare a pass, execute runs in Execute() if the pass survives culling
+     *
+     * @return     the pass, for Read(), Write() and SideEffect()
+     */
+    int AddPass(const char* name, std::function<void()> execute){
+        Pass pass;
+        pass.name = name;
+        pass.execute = execute;
+        passes.push_back(pass);
+        compiled = false;
+        return (int)passes.size() - 1;
+    }
+
+    void Read(int pass, FrameResource resource){
+        if (!validPass(pass) || !validHandle(resource))
+            return;
+        passes[pass].reads.push_back(resource);
+        handles[resource].readers.push_back(pass);
+    }
+
+    /**
+     * @brief      Declare that a pass writes a resource
+     *
+     * @return     the written version, what later passes should read
+     */
+    FrameResource Write(int pass, FrameResource resource){
+        if (!validPass(pass) || !validHandle(resource))
+            return FRAME_NO_RESOURCE;
+        // drawing on top of what is there: the earlier version is read too
+        if (handles[resource].producer >= 0)
+            Read(pass, resource);
+        FrameResource written = newHandle(handles[resource].resource, pass);
+        handles[written].previous = resource;
+        passes[pass].writes.push_back(written);
+        return written;
+    }
+
+    /**
+     * @brief      Keep a pass whatever reads its results (readbacks, captures, presenting)
+     */
+    void SideEffect(int pass){
+        if (validPass(pass))
+            passes[pass].sideEffect = true;
+    }
+
+    /**
+     * @brief      Cull, order and place the transient resources
+     *
+     * @return     false if the dependencies have a cycle
+     */
+    bool Compile(){
+        TRACE_SCOPE("FrameGraph::Compile");
+        order.clear();
+        // culling: from the passes with side effects back through what they read
+        std::vector<int> stack;
+        for (size_t p = 0; p < passes.size(); p++)
+        {
+            Pass& pass = passes[p];
+            pass.alive = pass.sideEffect;
+            for (size_t w = 0; w < pass.writes.size(); w++)
+                if (resources[handles[pass.writes[w]].resource].imported)
+                    pass.alive = true;
+            if (pass.alive)
+                stack.push_back((int)p);
+        }
+        while (!stack.empty())
+        {
+            Pass& pass = passes[stack.back()];
+            stack.pop_back();
+            for (size_t r = 0; r < pass.reads.size(); r++)
+            {
+                int producer = handles[pass.reads[r]].producer;
+                if (producer >= 0 && !passes[producer].alive)
+                {
+                    passes[producer].alive = true;
+                    stack.push_back(producer);
+                }
+            }
+        }
+
+        // ordering: a pass after the producers of what it reads, and a writer after
+        // the readers of the version it replaces; the first ready pass in declaration order goes next
+        std::vector<std::vector<int> > after(passes.size());
+        std::vector<int> waiting(passes.size(), 0);
+        for (size_t p = 0; p < passes.size(); p++)
+        {
+            if (!passes[p].alive)
+                continue;
+            for (size_t r = 0; r < passes[p].reads.size(); r++)
+                addEdge(handles[passes[p].reads[r]].producer, (int)p, after, waiting);
+            for (size_t w = 0; w < passes[p].writes.size(); w++)
+            {
+                const Handle& written = handles[passes[p].writes[w]];
+                const std::vector<int>& readers = handles[written.previous].readers;
+                for (size_t r = 0; r < readers.size(); r++)
+                    if (readers[r] != (int)p)
+                        addEdge(readers[r], (int)p, after, waiting);
+            }
+        }
+        size_t alive = 0;
+        for (size_t p = 0; p < passes.size(); p++)
+            alive += passes[p].alive;
+        std::vector<bool> done(passes.size(), false);
+        while (order.size() < alive)
+        {
+            int next = -1;
+            for (size_t p = 0; p < passes.size() && next < 0; p++)
+                if (passes[p].alive && !done[p] && waiting[p] == 0)
+                    next = (int)p;
+            if (next < 0)
+            {
+                std::cout << "ERROR::FRAMEGRAPH::CYCLE" << std::endl;
+                order.clear();
+                return false;
+            }
+            done[next] = true;
+            order.push_back(next);
+            for (size_t a = 0; a < after[next].size(); a++)
+                waiting[after[next][a]]--;
+        }
+
+        // lifetimes, in positions of the order
+        for (size_t r = 0; r < resources.size(); r++)
+            resources[r].first = resources[r].last = -1;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const Pass& pass = passes[order[i]];
+            for (size_t r = 0; r < pass.reads.size(); r++)
+                touch(handles[pass.reads[r]].resource, (int)i);
+            for (size_t w = 0; w < pass.writes.size(); w++)
+                touch(handles[pass.writes[w]].resource, (int)i);
+        }
+        peakBytes = transientBytes = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            size_t bytes = 0;
+            for (size_t r = 0; r < resources.size(); r++)
+                if (!resources[r].imported && resources[r].first >= 0 && resources[r].first <= (int)i && (int)i <= resources[r].last)
+                    bytes += resources[r].desc.Bytes();
+            peakBytes = bytes > peakBytes ? bytes : peakBytes;
+        }
+        for (size_t r = 0; r < resources.size(); r++)
+            if (!resources[r].imported && resources[r].first >= 0)
+                transientBytes += resources[r].desc.Bytes();
+        compiled = true;
+        return true;
+    }
+
+    /**
+     * @brief      Run the compiled passes in order
+     */
+    void Execute(){
+        if (!compiled)
+            return;
+        TRACE_SCOPE("FrameGraph::Execute");
+        std::vector<const RenderTarget*> physical;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            for (size_t r = 0; r < resources.size(); r++)
+            {
+                Resource& resource = resources[r];
+                if (resource.imported || resource.first != (int)i)
+                    continue;
+                resource.target = pool.Acquire(resource.desc);
+                if (!resource.target)
+                    std::cout << "ERROR::FRAMEGRAPH::TARGET_FAILED " << resource.name << std::endl;
+                bool seen = false;
+                for (size_t t = 0; t < physical.size(); t++)
+                    seen = seen || physical[t] == resource.target;
+                if (!seen && resource.target)
+                    physical.push_back(resource.target);
+            }
+            Pass& pass = passes[order[i]];
+            {
+                TRACE_SCOPE(pass.name);
+                pass.execute();
+            }
+            for (size_t r = 0; r < resources.size(); r++)
+            {
+                Resource& resource = resources[r];
+                if (resource.imported || resource.last != (int)i)
+                    continue;
+                pool.Release(resource.target);
+                resource.target = NULL;
+            }
+        }
+
+        size_t transient = 0;
+        for (size_t r = 0; r < resources.size(); r++)
+            transient += !resources[r].imported && resources[r].first >= 0;
+        frames++;
+        declaredSum += passes.size();
+        culledSum += passes.size() - order.size();
+        transientSum += transient;
+        physicalSum += physical.size();
+        peakSum += peakBytes;
+        peakMax = peakBytes > peakMax ? peakBytes : peakMax;
+        unaliasedSum += transientBytes;
+    }
+
+    /**
+     * @brief      The target of a transient resource, only while a pass that uses it runs
+     */
+    RenderTarget* Target(FrameResource resource) const {
+        return validHandle(resource) ? resources[handles[resource].resource].target : NULL;
+    }
+
+    // The framebuffer to bind for a resource, transient or imported
+    GLuint Framebuffer(FrameResource resource) const {
+        if (!validHandle(resource))
+            return 0;
+        const Resource& r = resources[handles[resource].resource];
+        return r.imported ? r.framebuffer : (r.target ? r.target->Framebuffer() : 0);
+    }
+    int Width(FrameResource resource) const { return validHandle(resource) ? resources[handles[resource].resource].desc.width : 0; }
+    int Height(FrameResource resource) const { return validHandle(resource) ? resources[handles[resource].resource].desc.height : 0; }
+
+    int Passes() const { return (int)passes.size(); }
+    // Passes declared but not run, after Compile()
+    int Culled() const { return compiled ? (int)(passes.size() - order.size()) : 0; }
+    // Most transient memory alive at once this frame, after Compile()
+    size_t PeakBytes() const { return peakBytes; }
+    // The transient memory without aliasing, every used resource its own target
+    size_t TransientBytes() const { return transientBytes; }
+
+    /**
+     * @brief      Run order of the compiled frame, for debugging: "main -> post -> present"
+     */
+    std::string Describe() const {
+        std::string text;
+        for (size_t i = 0; i < order.size(); i++)
+            text += (i ? " -> " : "") + std::string(passes[order[i]].name);
+        return text;
+    }
+
+    std::string ReportJSON() const {
+        double perFrame = frames ? 1.0 / frames : 0.0;
+        std::ostringstream json;
+        json << "{\"frames\": " << frames << ", \"passes_per_frame\": " << declaredSum * perFrame
+             << ", \"culled_per_frame\": " << culledSum * perFrame
+             << ", \"transient_resources_per_frame\": " << transientSum * perFrame
+             << ", \"physical_targets_per_frame\": " << physicalSum * perFrame
+             << ", \"peak_transient_bytes\": " << peakSum * perFrame << ", \"peak_transient_bytes_max\": " << peakMax
+             << ", \"unaliased_transient_bytes\": " << unaliasedSum * perFrame
+             << ", \"order\": \"" << Describe() << "\"}";
+        return json.str();
+    }
+
+private:
+
+    struct Resource {
+        const char* name;
+        RenderTargetDesc desc;
+        bool imported;
+        GLuint framebuffer;         // imported only
+        RenderTarget* target;       // transient, while in use
+        int first;                  // positions in the order, -1 when unused
+        int last;
+
+        Resource() : name(""), imported(false), framebuffer(0), target(NULL), first(-1), last(-1) {}
+    };
+
+    // a version of a resource
+    struct Handle {
+        int resource;
+        int producer;               // the pass that wrote it, -1 for the initial contents
+        FrameResource previous;
+        std::vector<int> readers;
+    };
+
+    struct Pass {
+        const char* name;
+        std::function<void()> execute;
+        std::vector<FrameResource> reads;
+        std::vector<FrameResource> writes;
+        bool sideEffect;
+        bool alive;
+
+        Pass() : name(""), sideEffect(false), alive(false) {}
+    };
+
+    RenderTargetPool& pool;
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    std::vector<Handle> handles;
+    std::vector<int> order;
+    bool compiled;
+    size_t peakBytes;
+    size_t transientBytes;
+
+    uint64_t frames;
+    uint64_t declaredSum;
+    uint64_t culledSum;
+    uint64_t transientSum;
+    uint64_t physicalSum;
+    double peakSum;
+    size_t peakMax;
+    double unaliasedSum;
+
+    FrameResource newHandle(int resource, int producer){
+        Handle handle;
+        handle.resource = resource;
+        handle.producer = producer;
+        handle.previous = FRAME_NO_RESOURCE;
+        handles.push_back(handle);
+        return (FrameResource)handles.size() - 1;
+    }
+
+    bool validPass(int pass) const {
+        if (pass >= 0 && pass < (int)passes.size())
+            return true;
+        std::cout << "ERROR::FRAMEGRAPH::INVALID_PASS" << std::endl;
+        return false;
+    }
+    bool validHandle(FrameResource resource) const {
+        return resource >= 0 && resource < (FrameResource)handles.size();
+    }
+
+    void addEdge(int from, int to, std::vector<std::vector<int> >& after, std::vector<int>& waiting) const {
+        if (from < 0 || from == to || !passes[from].alive)
+            return;
+        after[from].push_back(to);
+        waiting[to]++;
+    }
+
+    void touch(int resource, int position){
+        Resource& r = resources[resource];
+        if (r.first < 0)
+            r.first = position;
+        r.last = position;
+    }
+};
+#endif
@@ -0,0 +1,252 @@
+#ifndef RENDERTARGET_H
+#define RENDERTARGET_H
+
+#include <glad/glad.h>
+
+#include <profiling/trace.h>
+
+#include <cstddef>
+#include <iostream>
+
+/**
+ * Offscreen render targets
+ *
+ * A framebuffer object with an optional color and depth attachment.
+ * Single sampled color is a texture, so later passes can sample it;
+ * multisampled color and all depth are renderbuffers. BlitTo() copies to
+ * another target or the default framebuffer with glBlitFramebuffer,
+ * which for a multisampled source is the MSAA resolve.
+ *
+ *     RenderTarget scene;
+ *     scene.Create(RenderTargetDesc(width, height, GL_RGBA8, GL_DEPTH24_STENCIL8, 4));
+ *     scene.Bind();
+ *     ...draw...
+ *     scene.BlitTo(0, width, height);              // resolve to the screen
+ *
+ * Targets that come and go every frame, or with the window size, should
+ * come from a RenderTargetPool (render/targetpool.h) instead.
+ *
+ * The destructor deletes the framebuffer and its attachments; a target
+ * must not outlive the GL context.
+ */
+
+struct RenderTargetDesc {
+    int width;
+    int height;
+    GLenum color;               // internal format, e.g. GL_RGBA8, GL_RGBA16F, GL_R32UI; 0 for none
+    GLenum depth;               // e.g. GL_DEPTH24_STENCIL8, GL_DEPTH_COMPONENT24; 0 for none
+    int samples;                // 1, or the MSAA sample count
+
+    RenderTargetDesc(int width = 0, int height = 0, GLenum color = GL_RGBA8, GLenum depth = GL_DEPTH24_STENCIL8, int samples = 1)
+        : width(width), height(height), color(color), depth(depth), samples(samples) {}
+
+    bool operator==(const RenderTargetDesc& other) const {
+        return width == other.width && height == other.height && color == other.color &&
+               depth == other.depth && samples == other.samples;
+    }
+    bool operator!=(const RenderTargetDesc& other) const { return !(*this == other); }
+
+    // Approximate GPU memory of a target made from this
+    size_t Bytes() const {
+        return (size_t)width * height * samples * (pixelBytes(color) + pixelBytes(depth));
+    }
+
+    // Bytes per sample of an internal format, 4 for the ones not listed
+    static size_t pixelBytes(GLenum internalFormat){
+        switch (internalFormat)
+        {
+            case 0: return 0;
+            case GL_R8: return 1;
+            case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: return 2;
+            case GL_RGB8: case GL_DEPTH_COMPONENT24: return 3;
+            case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: return 8;
+            case GL_RGBA32F: return 16;
+            default: return 4;
+        }
+    }
+};
+
+class RenderTarget
+{
+public:
+
+    RenderTarget() : fbo(0), colorTexture(0), colorRenderbuffer(0), depthRenderbuffer(0) {}
+    ~RenderTarget(){
+        Release();
+    }
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    /**
+     * @brief      Allocate the attachments, replacing whatever the target had
+     *
+     * The sample count is clamped to what the implementation supports.
+     *
+     * @return     false if the framebuffer is incomplete (the target is then empty)
+     */
+    bool Create(const RenderTargetDesc& description){
+        TRACE_SCOPE("RenderTarget::Create");
+        Release();
+        desc = description;
+        if (desc.width <= 0 || desc.height <= 0 || (!desc.color && !desc.depth))
+        {
+            std::cout << "ERROR::RENDERTARGET::INVALID_DESCRIPTION" << std::endl;
+            return false;
+        }
+        GLint maxSamples;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        desc.samples = desc.samples < 1 ? 1 : (desc.samples > maxSamples ? maxSamples : desc.samples);
+
+        GLint oldRead, oldDraw, oldTexture, oldRenderbuffer;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldRead);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDraw);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexture);
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRenderbuffer);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        if (desc.color && desc.samples == 1)
+        {
+            GLenum format, type;
+            transferFormat(desc.color, format, type);
+            glGenTextures(1, &colorTexture);
+            glBindTexture(GL_TEXTURE_2D, colorTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, desc.color, desc.width, desc.height, 0, format, type, NULL);
+            // integer formats can't be filtered
+            GLint filter = format == GL_RED_INTEGER || format == GL_RG_INTEGER || format == GL_RGBA_INTEGER ? GL_NEAREST : GL_LINEAR;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        }
+        else if (desc.color)
+        {
+            glGenRenderbuffers(1, &colorRenderbuffer);
+            glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer);
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, desc.samples, desc.color, desc.width, desc.height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer);
+        }
+        else
+        {
+            // depth only: GL 3.3 still checks the draw and read buffers for completeness
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+        if (desc.depth)
+        {
+            glGenRenderbuffers(1, &depthRenderbuffer);
+            glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, desc.samples > 1 ? desc.samples : 0, desc.depth, desc.width, desc.height);
+            GLenum attachment = desc.depth == GL_DEPTH24_STENCIL8 || desc.depth == GL_DEPTH32F_STENCIL8
+                                ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, depthRenderbuffer);
+        }
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, oldRead);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDraw);
+        glBindTexture(GL_TEXTURE_2D, oldTexture);
+        glBindRenderbuffer(GL_RENDERBUFFER, oldRenderbuffer);
+        if (!complete)
+        {
+            std::cout << "ERROR::RENDERTARGET::FRAMEBUFFER_INCOMPLETE" << std::endl;
+            Release();
+            return false;
+        }
+        return true;
+    }
+
+    void Release(){
+        if (fbo)
+            glDeleteFramebuffers(1, &fbo);
+        if (colorTexture)
+            glDeleteTextures(1, &colorTexture);
+        if (colorRenderbuffer)
+            glDeleteRenderbuffers(1, &colorRenderbuffer);
+        if (depthRenderbuffer)
+            glDeleteRenderbuffers(1, &depthRenderbuffer);
+        fbo = colorTexture = colorRenderbuffer = depthRenderbuffer = 0;
+    }
+
+    bool Valid() const { return fbo != 0; }
+    const RenderTargetDesc& Desc() const { return desc; }
+    int Width() const { return desc.width; }
+    int Height() const { return desc.height; }
+    int Samples() const { return desc.samples; }
+    GLuint Framebuffer() const { return fbo; }
+    // the color texture to sample, 0 when multisampled or without color
+    GLuint ColorTexture() const { return colorTexture; }
+
+    // Approximate GPU memory of the attachments
+    size_t Bytes() const {
+        return fbo ? desc.Bytes() : 0;
+    }
+
+    /**
+     * @brief      Draw into the target, viewport set to its size
+     */
+    void Bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, desc.width, desc.height);
+    }
+
+    /**
+     * @brief      Copy into another framebuffer with glBlitFramebuffer, resolving MSAA
+     *
+     * @param      framebuffer  0 for the default framebuffer
+     * @param      mask         GL_COLOR_BUFFER_BIT and/or GL_DEPTH_BUFFER_BIT; depth
+     *                          needs the same depth format on both sides
+     *
+     * A multisampled source has to be copied at its own size; depth is
+     * always copied nearest, color scales linearly.
+     */
+    void BlitTo(GLuint framebuffer, int width, int height, GLbitfield mask = GL_COLOR_BUFFER_BIT) const {
+        if (!fbo)
+            return;
+        TRACE_SCOPE("RenderTarget::BlitTo");
+        bool sameSize = width == desc.width && height == desc.height;
+        if (desc.samples > 1 && !sameSize)
+        {
+            std::cout << "ERROR::RENDERTARGET::RESOLVE_SIZE_MISMATCH" << std::endl;
+            return;
+        }
+        GLint oldRead, oldDraw;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldRead);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDraw);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        GLenum filter = sameSize || (mask & GL_DEPTH_BUFFER_BIT) ? GL_NEAREST : GL_LINEAR;
+        glBlitFramebuffer(0, 0, desc.width, desc.height, 0, 0, width, height, mask, filter);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, oldRead);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDraw);
+    }
+    void BlitTo(const RenderTarget& target, GLbitfield mask = GL_COLOR_BUFFER_BIT) const {
+        BlitTo(target.Framebuffer(), target.Width(), target.Height(), mask);
+    }
+
+private:
+
+    RenderTargetDesc desc;
+    GLuint fbo;
+    GLuint colorTexture;
+    GLuint colorRenderbuffer;
+    GLuint depthRenderbuffer;
+
+    // a format and type glTexImage2D accepts with no data for an internal format
+    static void transferFormat(GLenum internalFormat, GLenum& format, GLenum& type){
+        switch (internalFormat)
+        {
+            case GL_R32UI: format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; break;
+            case GL_R32I: format = GL_RED_INTEGER; type = GL_INT; break;
+            case GL_RG32UI: format = GL_RG_INTEGER; type = GL_UNSIGNED_INT; break;
+            case GL_RGBA32UI: format = GL_RGBA_INTEGER; type = GL_UNSIGNED_INT; break;
+            case GL_R8: case GL_R16F: case GL_R32F: format = GL_RED; type = GL_FLOAT; break;
+            case GL_RG8: case GL_RG16F: case GL_RG32F: format = GL_RG; type = GL_FLOAT; break;
+            case GL_RGBA16F: case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; break;
+            default: format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+        }
+    }
+};
+#endif
@@ -0,0 +1,147 @@
+#ifndef TARGETPOOL_H
+#define TARGETPOOL_H
+
+#include <render/rendertarget.h>
+#include <profiling/trace.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * A pool of transient render targets, keyed by size and format
+ *
+ *     RenderTargetPool targets;
+ *     ...every frame...
+ *     RenderTarget* scene = targets.Acquire(RenderTargetDesc(width, height, GL_RGBA8, GL_DEPTH24_STENCIL8, 4));
+ *     ...draw into it, resolve it...
+ *     targets.Release(scene);
+ *     targets.EndFrame();
+ *
+ * Acquire() hands out a free target made for exactly that description,
+ * creating one only when none is free, so the same passes every frame
+ * allocate nothing after the first. After a resize the targets of the
+ * old size are no longer asked for; EndFrame() deletes free targets
+ * nobody acquired for a few frames, rather than on the resize itself,
+ * so dragging a window edge back and forth doesn't churn memory either.
+ *
+ * Destroying the pool deletes every target it made, acquired or not, so
+ * it too has to go before glfwTerminate().
+ */
+
+class RenderTargetPool
+{
+public:
+
+    explicit RenderTargetPool(int keepFrames = 3) : keepFrames(keepFrames), frame(0), created(0), reused(0), peakBytes(0) {}
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    /**
+     * @brief      A free target of this description, created if there is none
+     *
+     * @return     NULL if the target can't be created
+     */
+    RenderTarget* Acquire(const RenderTargetDesc& desc){
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            Entry& entry = entries[i];
+            if (!entry.inUse && entry.desc == desc)
+            {
+                entry.inUse = true;
+                entry.lastUsed = frame;
+                reused++;
+                return entry.target.get();
+            }
+        }
+        TRACE_SCOPE("RenderTargetPool::Acquire::Create");
+        std::unique_ptr<RenderTarget> target(new RenderTarget());
+        if (!target->Create(desc))
+            return NULL;
+        Entry entry;
+        entry.desc = desc;
+        entry.target = std::move(target);
+        entry.inUse = true;
+        entry.lastUsed = frame;
+        entries.push_back(std::move(entry));
+        created++;
+        size_t bytes = Bytes();
+        peakBytes = bytes > peakBytes ? bytes : peakBytes;
+        return entries.back().target.get();
+    }
+
+    /**
+     * @brief      Give a target back, it can be acquired again right away
+     */
+    void Release(RenderTarget* target){
+        if (!target)
+            return;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].target.get() == target)
+            {
+                entries[i].inUse = false;
+                return;
+            }
+        }
+        std::cout << "ERROR::TARGETPOOL::NOT_FROM_THIS_POOL" << std::endl;
+    }
+
+    /**
+     * @brief      Delete the free targets unused for keepFrames frames
+     */
+    void EndFrame(){
+        frame++;
+        size_t kept = 0;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].inUse || frame - entries[i].lastUsed <= (uint64_t)keepFrames)
+            {
+                if (kept != i)
+                    entries[kept] = std::move(entries[i]);
+                kept++;
+            }
+        }
+        entries.resize(kept);
+    }
+
+    // Targets held, in use or free
+    size_t Size() const { return entries.size(); }
+
+    // GPU memory of the targets held
+    size_t Bytes() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < entries.size(); i++)
+            bytes += entries[i].target->Bytes();
+        return bytes;
+    }
+
+    std::string ReportJSON() const {
+        std::ostringstream json;
+        json << "{\"targets\": " << entries.size() << ", \"created\": " << created << ", \"reused\": " << reused
+             << ", \"bytes\": " << Bytes() << ", \"peak_bytes\": " << peakBytes << "}";
+        return json.str();
+    }
+
+private:
+
+    struct Entry {
+        RenderTargetDesc desc;          // as asked for, the target may have clamped its samples
+        std::unique_ptr<RenderTarget> target;
+        bool inUse;
+        uint64_t lastUsed;
+    };
+
+    int keepFrames;
+    std::vector<Entry> entries;
+    uint64_t frame;
+    uint64_t created;
+    uint64_t reused;
+    size_t peakBytes;
+};
+#endif
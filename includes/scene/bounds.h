@@ -0,0 +1,160 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+/**
+ * Bounding volumes and the tests scene queries are made of
+ *
+ * Aabb is an axis aligned box, Frustum the six planes of a view
+ * projection matrix (pointing inwards, so a point is inside when every
+ * plane is >= 0 at it), Ray an origin and a direction. Used by the BVH
+ * (scene/bvh.h) for culling and picking.
+ */
+
+struct Aabb {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    Aabb() : min(FLT_MAX), max(-FLT_MAX) {}
+    Aabb(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+    bool Empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+    // per component, so it compiles to minss / maxss whatever glm::min does with NaNs
+    void Grow(const glm::vec3& p){
+        min = glm::vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = glm::vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+    void Grow(const Aabb& b){
+        min = glm::vec3(std::min(min.x, b.min.x), std::min(min.y, b.min.y), std::min(min.z, b.min.z));
+        max = glm::vec3(std::max(max.x, b.max.x), std::max(max.y, b.max.y), std::max(max.z, b.max.z));
+    }
+
+    glm::vec3 Center() const { return (min + max) * 0.5f; }
+    glm::vec3 Extent() const { return max - min; }
+
+    // half the surface area, what the SAH compares
+    float HalfArea() const {
+        if (Empty())
+            return 0.0f;
+        glm::vec3 e = max - min;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+/**
+ * @brief      Bounds of a box after a transform, without transforming its 8 corners (Arvo)
+ */
+inline Aabb TransformAabb(const Aabb& box, const glm::mat4& m)
+{
+    Aabb out(glm::vec3(m[3].x, m[3].y, m[3].z), glm::vec3(m[3].x, m[3].y, m[3].z));
+    for (int c = 0; c < 3; c++)
+    {
+        for (int r = 0; r < 3; r++)
+        {
+            float a = m[c][r] * box.min[c], b = m[c][r] * box.max[c];
+            out.min[r] += std::min(a, b);
+            out.max[r] += std::max(a, b);
+        }
+    }
+    return out;
+}
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    Ray() {}
+    Ray(const glm::vec3& origin, const glm::vec3& direction) : origin(origin), direction(direction) {}
+};
+
+/**
+ * @brief      Slab test of a ray against a box
+ *
+ * @param      invDirection  1 / ray.direction per component (infinities are fine)
+ * @param      tNear         distance along the ray where it enters the box, 0 if it starts inside
+ *
+ * @return     true if the ray meets the box within [0, tMax]
+ */
+inline bool RayAabb(const Ray& ray, const glm::vec3& invDirection, const Aabb& box, float tMax, float& tNear)
+{
+    float t0 = 0.0f, t1 = tMax;
+    for (int a = 0; a < 3; a++)
+    {
+        float near = (box.min[a] - ray.origin[a]) * invDirection[a];
+        float far = (box.max[a] - ray.origin[a]) * invDirection[a];
+        if (near > far)
+            std::swap(near, far);
+        // NaN (origin on a slab plane of a parallel ray) leaves t0, t1 alone
+        t0 = near > t0 ? near : t0;
+        t1 = far < t1 ? far : t1;
+        if (t0 > t1)
+            return false;
+    }
+    tNear = t0;
+    return true;
+}
+
+enum FrustumTest {
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECTS,
+    FRUSTUM_INSIDE
+};
+
+struct Frustum {
+    glm::vec4 planes[6];        // left, right, bottom, top, near, far: xyz normal, w distance
+
+    /**
+     * @brief      The planes of projection * view (Gribb and Hartmann), world space
+     */
+    static Frustum FromMatrix(const glm::mat4& viewProjection){
+        Frustum f;
+        const glm::mat4& m = viewProjection;
+        for (int i = 0; i < 3; i++)
+        {
+            for (int side = 0; side < 2; side++)
+            {
+                float sign = side == 0 ? 1.0f : -1.0f;
+                glm::vec4 p(m[0][3] + sign * m[0][i], m[1][3] + sign * m[1][i],
+                            m[2][3] + sign * m[2][i], m[3][3] + sign * m[3][i]);
+                float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+                f.planes[i * 2 + side] = length > 0.0f ? p / length : p;
+            }
+        }
+        return f;
+    }
+
+    /**
+     * @brief      Where a box is relative to the frustum
+     *
+     * @param      mask  planes still to test, bit i for plane i; planes the box
+     *                   is fully inside of are cleared, so children skip them
+     */
+    FrustumTest Test(const Aabb& box, unsigned int& mask) const {
+        glm::vec3 center = box.Center(), half = (box.max - box.min) * 0.5f;
+        for (int i = 0; i < 6; i++)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+            const glm::vec4& p = planes[i];
+            float distance = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+            float radius = std::fabs(p.x) * half.x + std::fabs(p.y) * half.y + std::fabs(p.z) * half.z;
+            if (distance < -radius)
+                return FRUSTUM_OUTSIDE;
+            if (distance >= radius)
+                mask &= ~(1u << i);
+        }
+        return mask ? FRUSTUM_INTERSECTS : FRUSTUM_INSIDE;
+    }
+
+    bool Intersects(const Aabb& box) const {
+        unsigned int mask = 0x3f;
+        return Test(box, mask) != FRUSTUM_OUTSIDE;
+    }
+};
+#endif
@@ -0,0 +1,429 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <scene/bounds.h>
+#include <profiling/trace.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Bounding volume hierarchy over object bounds
+ *
+ *     Bvh bvh;
+ *     bvh.Build(bounds);                       // one Aabb per object, world space
+ *     bvh.Query(camera.GetFrustum(aspect), visible);
+ *     int picked = bvh.Raycast(camera.GetScreenRay(x, y, width, height), t);
+ *     ...objects move...
+ *     bvh.Refit(bounds);                       // same objects, new bounds
+ *
+ * Build() splits with a binned surface area heuristic: at every node the
+ * object centroids are dropped into BINS slabs along the axis they spread
+ * most along (SSE2 min / max per bin) and the plane between two slabs
+ * with the least area weighted object count wins, down to MAX_LEAF
+ * objects per leaf. Refit() keeps the tree and only recomputes the boxes
+ * bottom up, which is right for objects that move a little per frame;
+ * after large motion the tree gets loose and a new Build() pays off.
+ *
+ * Nodes are 32 bytes, children are allocated in pairs after their parent,
+ * and every subtree owns a contiguous range of the object order, so a
+ * node the frustum fully contains is emitted without testing anything
+ * below it. Queries return object indices as given to Build().
+ */
+
+struct BvhNode {
+    Aabb bounds;
+    int first;          // leaf: first entry in the object order; inner: left child, right is first + 1
+    int count;          // leaf: objects, > 0; inner: minus the objects of the subtree
+};
+
+class Bvh
+{
+public:
+
+    static const int MAX_LEAF = 4;
+    static const int BINS = 16;
+    // past this depth nodes are halved instead, so no tree gets deeper than the traversal stacks
+    static const int MAX_SAH_DEPTH = 64;
+    static const int STACK = 128;
+
+    Bvh() {}
+
+    /**
+     * @brief      Build the tree over count objects, an empty tree for none
+     */
+    void Build(const Aabb* bounds, size_t count){
+        TRACE_SCOPE("Bvh::Build");
+        nodes.clear();
+        order.resize(count);
+        orderedBounds.resize(count);
+        if (count == 0)
+            return;
+        // partitioned in place, so every node's objects are one contiguous run
+        std::vector<BuildItem> items(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i].min = bounds[i].min;
+            items[i].object = (int)i;
+            items[i].max = bounds[i].max;
+            items[i].zero = 0.0f;
+        }
+        nodes.reserve(2 * count);
+        BvhNode root;
+        root.first = 0;
+        root.count = (int)count;
+        nodes.push_back(root);
+
+        // a node's bounds and centroid bounds come from its parent's split, one pass less per level
+        struct Pending { int node; int depth; Side side; };
+        Pending pending;
+        pending.node = 0;
+        pending.depth = 0;
+        bound(items.data(), (int)count, pending.side);
+        std::vector<Pending> stack(1, pending);
+        while (!stack.empty())
+        {
+            pending = stack.back();
+            stack.pop_back();
+            int index = pending.node;
+            int first = nodes[index].first, n = nodes[index].count;
+            nodes[index].bounds = pending.side.box;
+            if (n <= MAX_LEAF)
+                continue;
+
+            BuildItem* begin = &items[first];
+            Side sides[2];
+            int leftCount = pending.depth < MAX_SAH_DEPTH ? split(begin, n, pending.side.centroids, sides) : 0;
+            if (leftCount == 0)
+            {
+                // past the depth limit, or every centroid in one place: halve the run
+                leftCount = n / 2;
+                bound(begin, leftCount, sides[0]);
+                bound(begin + leftCount, n - leftCount, sides[1]);
+            }
+            int left = (int)nodes.size();
+            BvhNode child;
+            child.first = first;
+            child.count = leftCount;
+            nodes.push_back(child);
+            child.first = first + leftCount;
+            child.count = n - leftCount;
+            nodes.push_back(child);
+            nodes[index].first = left;
+            nodes[index].count = -n;
+            for (int c = 1; c >= 0; c--)
+            {
+                Pending next;
+                next.node = left + c;
+                next.depth = pending.depth + 1;
+                next.side = sides[c];
+                stack.push_back(next);
+            }
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            order[i] = items[i].object;
+            orderedBounds[i] = items[i].Box();
+        }
+    }
+
+    void Build(const std::vector<Aabb>& bounds){ Build(bounds.data(), bounds.size()); }
+
+    /**
+     * @brief      New bounds for the objects of the last Build(), same tree
+     */
+    void Refit(const Aabb* bounds){
+        TRACE_SCOPE("Bvh::Refit");
+        for (size_t i = 0; i < order.size(); i++)
+            orderedBounds[i] = bounds[order[i]];
+        // children come after their parent, so a backward sweep sees them first
+        for (size_t i = nodes.size(); i-- > 0;)
+        {
+            BvhNode& node = nodes[i];
+            Aabb box;
+            if (node.count > 0)
+            {
+                for (int o = node.first; o < node.first + node.count; o++)
+                    box.Grow(orderedBounds[o]);
+            }
+            else
+            {
+                box = nodes[node.first].bounds;
+                box.Grow(nodes[node.first + 1].bounds);
+            }
+            node.bounds = box;
+        }
+    }
+
+    void Refit(const std::vector<Aabb>& bounds){ Refit(bounds.data()); }
+
+    size_t Objects() const { return order.size(); }
+    size_t Nodes() const { return nodes.size(); }
+    Aabb Bounds() const { return nodes.empty() ? Aabb() : nodes[0].bounds; }
+
+    /**
+     * @brief      Call visit(object) for every object whose bounds meet the frustum
+     */
+    template <class F>
+    void Query(const Frustum& frustum, F visit) const {
+        if (nodes.empty())
+            return;
+        struct Entry { int node; unsigned int mask; };
+        Entry stack[STACK];
+        int top = 0;
+        stack[top++] = Entry{0, 0x3fu};
+        while (top > 0)
+        {
+            Entry entry = stack[--top];
+            const BvhNode& node = nodes[entry.node];
+            unsigned int mask = entry.mask;
+            FrustumTest test = frustum.Test(node.bounds, mask);
+            if (test == FRUSTUM_OUTSIDE)
+                continue;
+            if (test == FRUSTUM_INSIDE)
+            {
+                int first = subtreeFirst(entry.node), n = node.count > 0 ? node.count : -node.count;
+                for (int o = first; o < first + n; o++)
+                    visit(order[o]);
+                continue;
+            }
+            if (node.count > 0)
+            {
+                for (int o = node.first; o < node.first + node.count; o++)
+                {
+                    unsigned int objectMask = mask;
+                    if (frustum.Test(orderedBounds[o], objectMask) != FRUSTUM_OUTSIDE)
+                        visit(order[o]);
+                }
+                continue;
+            }
+            stack[top++] = Entry{node.first + 1, mask};
+            stack[top++] = Entry{node.first, mask};
+        }
+    }
+
+    /**
+     * @brief      Append the objects whose bounds meet the frustum
+     */
+    void Query(const Frustum& frustum, std::vector<int>& visible) const {
+        Query(frustum, [&visible](int object) { visible.push_back(object); });
+    }
+
+    /**
+     * @brief      Closest object along a ray
+     *
+     * @param      intersect  bool(int object, const Ray& ray, float tMax, float& t),
+     *                        the exact test of one object whose bounds the ray meets
+     * @param      t          distance to the hit, in units of ray.direction
+     *
+     * @return     the object, -1 for none within tMax
+     */
+    template <class F>
+    int Raycast(const Ray& ray, float& t, F intersect, float tMax = FLT_MAX) const {
+        int hit = -1;
+        if (nodes.empty())
+            return hit;
+        glm::vec3 inv(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+        float best = tMax, tNode;
+        if (!RayAabb(ray, inv, nodes[0].bounds, best, tNode))
+            return hit;
+        struct Entry { int node; float t; };
+        Entry stack[STACK];
+        int top = 0;
+        stack[top++] = Entry{0, tNode};
+        while (top > 0)
+        {
+            Entry entry = stack[--top];
+            if (entry.t > best)
+                continue;
+            const BvhNode& node = nodes[entry.node];
+            if (node.count > 0)
+            {
+                for (int o = node.first; o < node.first + node.count; o++)
+                {
+                    float tObject;
+                    if (RayAabb(ray, inv, orderedBounds[o], best, tObject) && intersect(order[o], ray, best, tObject)
+                        && tObject <= best)
+                    {
+                        best = tObject;
+                        hit = order[o];
+                    }
+                }
+                continue;
+            }
+            // nearer child on top of the stack, it often makes the farther one skippable
+            float tLeft, tRight;
+            bool left = RayAabb(ray, inv, nodes[node.first].bounds, best, tLeft);
+            bool right = RayAabb(ray, inv, nodes[node.first + 1].bounds, best, tRight);
+            if (left && right && tRight < tLeft)
+            {
+                stack[top++] = Entry{node.first, tLeft};
+                stack[top++] = Entry{node.first + 1, tRight};
+                continue;
+            }
+            if (right)
+                stack[top++] = Entry{node.first + 1, tRight};
+            if (left)
+                stack[top++] = Entry{node.first, tLeft};
+        }
+        if (hit >= 0)
+            t = best;
+        return hit;
+    }
+
+    /**
+     * @brief      Closest object bounds along a ray
+     */
+    int Raycast(const Ray& ray, float& t, float tMax = FLT_MAX) const {
+        return Raycast(ray, t, [](int, const Ray&, float, float&) { return true; }, tMax);
+    }
+
+private:
+
+    // an object during Build(): min and max are 16 byte loads for the SSE2
+    // binning, min's spare lane holds the object and max's is zero
+    struct BuildItem {
+        glm::vec3 min;
+        int object;
+        glm::vec3 max;
+        float zero;
+
+        Aabb Box() const { return Aabb(min, max); }
+        float Centroid(int axis) const { return (min[axis] + max[axis]) * 0.5f; }
+        glm::vec3 Centroid() const { return (min + max) * 0.5f; }
+    };
+
+    // bounds of a run of build items, and of their centroids
+    struct Side {
+        Aabb box;
+        Aabb centroids;
+    };
+
+    std::vector<BvhNode> nodes;
+    std::vector<int> order;             // object indices, leaves own contiguous ranges
+    std::vector<Aabb> orderedBounds;    // bounds in that order, read by the leaf tests
+
+    int subtreeFirst(int index) const {
+        while (nodes[index].count < 0)
+            index = nodes[index].first;
+        return nodes[index].first;
+    }
+
+    static void bound(const BuildItem* items, int n, Side& side){
+        side.box = Aabb();
+        side.centroids = Aabb();
+        for (int i = 0; i < n; i++)
+        {
+            side.box.Grow(items[i].Box());
+            side.centroids.Grow(items[i].Centroid());
+        }
+    }
+
+    // Partitions the n items by the best binned SAH plane and returns how many
+    // went left, 0 when no plane separates them; sides gets both children's bounds
+    int split(BuildItem* items, int n, const Aabb& centroidBox, Side sides[2]){
+        struct Bin { Side side; int count; };
+        glm::vec3 extent = centroidBox.Extent();
+        // the axis the centroids spread most along, as in Wald's binned builder
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        if (!(extent[axis] > 0.0f))
+            return 0;
+        Bin bins[BINS];
+        for (int b = 0; b < BINS; b++)
+            bins[b].count = 0;
+        float scale = BINS / extent[axis], minimum = centroidBox.min[axis];
+#if defined(__SSE2__)
+        // the boxes and centroid bounds of the bins as 4 wide min / max, the last lane unused
+        __m128 binMin[BINS], binMax[BINS], binCentroidMin[BINS], binCentroidMax[BINS];
+        const __m128 half = _mm_set1_ps(0.5f);
+        // the object in min's spare lane is a denormal as a float, slow to add: cleared
+        const __m128 xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        for (int b = 0; b < BINS; b++)
+        {
+            binMin[b] = binCentroidMin[b] = _mm_set1_ps(FLT_MAX);
+            binMax[b] = binCentroidMax[b] = _mm_set1_ps(-FLT_MAX);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int b = std::min(BINS - 1, (int)((items[i].Centroid(axis) - minimum) * scale));
+            __m128 lo = _mm_and_ps(_mm_loadu_ps(&items[i].min.x), xyz), hi = _mm_loadu_ps(&items[i].max.x);
+            __m128 centroid = _mm_mul_ps(_mm_add_ps(lo, hi), half);
+            bins[b].count++;
+            binMin[b] = _mm_min_ps(binMin[b], lo);
+            binMax[b] = _mm_max_ps(binMax[b], hi);
+            binCentroidMin[b] = _mm_min_ps(binCentroidMin[b], centroid);
+            binCentroidMax[b] = _mm_max_ps(binCentroidMax[b], centroid);
+        }
+        for (int b = 0; b < BINS; b++)
+        {
+            if (!bins[b].count)
+                continue;
+            float lo[4], hi[4], centroidLo[4], centroidHi[4];
+            _mm_storeu_ps(lo, binMin[b]);
+            _mm_storeu_ps(hi, binMax[b]);
+            _mm_storeu_ps(centroidLo, binCentroidMin[b]);
+            _mm_storeu_ps(centroidHi, binCentroidMax[b]);
+            bins[b].side.box = Aabb(glm::vec3(lo[0], lo[1], lo[2]), glm::vec3(hi[0], hi[1], hi[2]));
+            bins[b].side.centroids = Aabb(glm::vec3(centroidLo[0], centroidLo[1], centroidLo[2]),
+                                          glm::vec3(centroidHi[0], centroidHi[1], centroidHi[2]));
+        }
+#else
+        for (int i = 0; i < n; i++)
+        {
+            Bin& bin = bins[std::min(BINS - 1, (int)((items[i].Centroid(axis) - minimum) * scale))];
+            bin.count++;
+            bin.side.box.Grow(items[i].Box());
+            bin.side.centroids.Grow(items[i].Centroid());
+        }
+#endif
+        // cost of splitting after bin b: sweep the right side, then the left
+        float rightCost[BINS];
+        Aabb right;
+        int rightCount = 0;
+        for (int b = BINS - 1; b > 0; b--)
+        {
+            right.Grow(bins[b].side.box);
+            rightCount += bins[b].count;
+            rightCost[b - 1] = rightCount * right.HalfArea();
+        }
+        float bestCost = FLT_MAX;
+        int bestBin = -1;
+        Aabb left;
+        int leftCount = 0;
+        for (int b = 0; b < BINS - 1; b++)
+        {
+            left.Grow(bins[b].side.box);
+            leftCount += bins[b].count;
+            float cost = leftCount * left.HalfArea() + rightCost[b];
+            if (leftCount > 0 && leftCount < n && cost < bestCost)
+            {
+                bestCost = cost;
+                bestBin = b;
+            }
+        }
+        if (bestBin < 0)
+            return 0;
+
+        for (int c = 0; c < 2; c++)
+            sides[c] = Side();
+        for (int b = 0; b < BINS; b++)
+        {
+            Side& side = sides[b <= bestBin ? 0 : 1];
+            side.box.Grow(bins[b].side.box);
+            side.centroids.Grow(bins[b].side.centroids);
+        }
+        BuildItem* mid = std::partition(items, items + n, [&](const BuildItem& item) {
+            return std::min(BINS - 1, (int)((item.Centroid(axis) - minimum) * scale)) <= bestBin;
+        });
+        return (int)(mid - items);
+    }
+};
+#endif
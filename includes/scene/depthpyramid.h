@@ -0,0 +1,170 @@
+#ifndef DEPTHPYRAMID_H
+#define DEPTHPYRAMID_H
+
+#include <scene/bounds.h>
+#include <profiling/trace.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Hierarchical Z on the CPU: a max depth mip chain and box occlusion tests
+ *
+ *     DepthPyramid pyramid;
+ *     pyramid.Build(depth, width, height, projection * view);   // window depth, bottom row first
+ *     if (!pyramid.Occluded(bounds))
+ *         ...draw...
+ *
+ * Level 0 is the depth buffer as glReadPixels(GL_DEPTH_COMPONENT, GL_FLOAT)
+ * returns it, every texel of the next level the farthest of the 2x2 below
+ * (odd sizes round up and the last texel also covers the extra row or
+ * column), so a texel is never nearer than anything it covers. A box is
+ * projected with the matrix the depth was rendered with; it is occluded
+ * when its nearest corner lies behind the farthest depth of every texel
+ * under its screen rectangle, read from the level where that rectangle
+ * spans at most a few texels. Boxes crossing the near plane or entirely
+ * off screen are never occluded.
+ *
+ * The test is conservative for the view the depth came from. Tested
+ * against an older frame's depth (async readback) an object that has
+ * just come out from behind an occluder can stay hidden for the frames
+ * of latency.
+ */
+
+class DepthPyramid
+{
+public:
+
+    // texels per side a test reads at most, per level choice
+    static const int TEST_SPAN = 4;
+
+    DepthPyramid() {}
+
+    /**
+     * @brief      Build the chain from a depth buffer
+     *
+     * @param      depth           width x height window depths in [0, 1], rows bottom to top
+     * @param      viewProjection  the matrix the depth was rendered with
+     */
+    void Build(const float* depth, int width, int height, const glm::mat4& viewProjection){
+        TRACE_SCOPE("DepthPyramid::Build");
+        matrix = viewProjection;
+        levels.clear();
+        if (width <= 0 || height <= 0)
+            return;
+        levels.push_back(Level());
+        levels[0].width = width;
+        levels[0].height = height;
+        levels[0].depth.assign(depth, depth + (size_t)width * height);
+        while (levels.back().width > 1 || levels.back().height > 1)
+        {
+            levels.push_back(Level());
+            const Level& below = levels[levels.size() - 2];
+            Level& level = levels.back();
+            level.width = (below.width + 1) / 2;
+            level.height = (below.height + 1) / 2;
+            level.depth.resize((size_t)level.width * level.height);
+            for (int y = 0; y < level.height; y++)
+            {
+                const float* row0 = &below.depth[(size_t)(2 * y) * below.width];
+                const float* row1 = &below.depth[(size_t)std::min(2 * y + 1, below.height - 1) * below.width];
+                reduceRow(row0, row1, below.width, &level.depth[(size_t)y * level.width], level.width);
+            }
+        }
+    }
+
+    bool Valid() const { return !levels.empty(); }
+    int Levels() const { return (int)levels.size(); }
+    int Width() const { return levels.empty() ? 0 : levels[0].width; }
+    int Height() const { return levels.empty() ? 0 : levels[0].height; }
+
+    /**
+     * @brief      Whether a world space box is hidden behind the depth, false when unsure
+     */
+    bool Occluded(const Aabb& box) const {
+        if (levels.empty())
+            return false;
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 1e30f;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            glm::vec4 p(corner & 1 ? box.max.x : box.min.x, corner & 2 ? box.max.y : box.min.y,
+                        corner & 4 ? box.max.z : box.min.z, 1.0f);
+            glm::vec4 clip = matrix * p;
+            // at or behind the eye: the box crosses the near plane
+            if (clip.w <= 1e-5f)
+                return false;
+            float inv = 1.0f / clip.w;
+            float x = clip.x * inv, y = clip.y * inv, z = clip.z * inv;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearest = std::min(nearest, z);
+        }
+        nearest = nearest * 0.5f + 0.5f;
+        // off screen is the frustum's business; partly off screen, the part on it decides
+        if (nearest <= 0.0f || maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+            return false;
+
+        const Level& base = levels[0];
+        int x0 = toTexel(minX, base.width), x1 = toTexel(maxX, base.width);
+        int y0 = toTexel(minY, base.height), y1 = toTexel(maxY, base.height);
+        int l = 0;
+        while (l + 1 < (int)levels.size() && std::max((x1 >> l) - (x0 >> l), (y1 >> l) - (y0 >> l)) >= TEST_SPAN)
+            l++;
+        const Level& level = levels[l];
+        for (int y = y0 >> l; y <= (y1 >> l); y++)
+        {
+            const float* row = &level.depth[(size_t)y * level.width];
+            for (int x = x0 >> l; x <= (x1 >> l); x++)
+                if (row[x] >= nearest)
+                    return false;
+        }
+        return true;
+    }
+
+private:
+
+    struct Level {
+        int width;
+        int height;
+        std::vector<float> depth;   // rows bottom to top
+    };
+
+    std::vector<Level> levels;
+    glm::mat4 matrix;
+
+    // NDC to a texel column or row of level 0, clamped to the screen
+    static int toTexel(float ndc, int size){
+        float t = (std::min(std::max(ndc, -1.0f), 1.0f) * 0.5f + 0.5f) * size;
+        return std::min(size - 1, (int)t);
+    }
+
+    // out[x] = max of the 2x2 texels at (2x, 2x + 1) of both rows, the last column repeated for odd widths
+    static void reduceRow(const float* row0, const float* row1, int width, float* out, int outWidth){
+        int x = 0;
+#if defined(__SSE2__)
+        for (; 2 * x + 8 <= width; x += 4)
+        {
+            __m128 a = _mm_max_ps(_mm_loadu_ps(row0 + 2 * x), _mm_loadu_ps(row1 + 2 * x));
+            __m128 b = _mm_max_ps(_mm_loadu_ps(row0 + 2 * x + 4), _mm_loadu_ps(row1 + 2 * x + 4));
+            __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(out + x, _mm_max_ps(even, odd));
+        }
+#endif
+        for (; x < outWidth; x++)
+        {
+            int x1 = std::min(2 * x + 1, width - 1);
+            out[x] = std::max(std::max(row0[2 * x], row0[x1]), std::max(row1[2 * x], row1[x1]));
+        }
+    }
+};
+#endif
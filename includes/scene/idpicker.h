@@ -0,0 +1,179 @@
+#ifndef IDPICKER_H
+#define IDPICKER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <capture/readback.h>
+#include <render/rendertarget.h>
+#include <profiling/trace.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+/**
+ * Object picking from a GPU id buffer
+ *
+ * The cursor callback only asks for a pick. The next frame draws object
+ * ids (object + 1, 0 is nothing) into an R32UI target, scissored to the
+ * pixel under the cursor so only that pixel is shaded, and queues that
+ * one texel for an asynchronous readback (capture/readback.h). A frame or
+ * two later Poll() hands over the object. Nothing waits on the GPU and
+ * the cost does not grow with the number of objects beyond their
+ * vertices, whatever the scene.
+ *
+ *     IdPicker picker;
+ *     ...cursor callback: picker.RequestPick(xpos, ypos);
+ *     ...render the scene...
+ *     if (picker.Begin(window))
+ *     {
+ *         ...draw the objects with a shader writing their id + 1 as a uint...
+ *         picker.End();
+ *     }
+ *     int object;
+ *     if (picker.Poll(object))
+ *         ...object under the cursor, -1 for none...
+ *
+ * The answer is for the frame the pick was drawn in; moving the cursor
+ * again before it arrives queues another pick, the older answer still
+ * comes first.
+ *
+ * The id target and readback buffers belong to the picker and are deleted
+ * with it, so destroy it before the context and clear any pointer a GLFW
+ * callback keeps to it.
+ */
+
+class IdPicker
+{
+public:
+
+    IdPicker() : requested(false), cursorX(0.0), cursorY(0.0), pickX(0), pickY(0), frame(0), active(false) {}
+
+    IdPicker(const IdPicker&) = delete;
+    IdPicker& operator=(const IdPicker&) = delete;
+
+    /**
+     * @brief      Ask for the object at a cursor position, in window coordinates (top left origin)
+     */
+    void RequestPick(double x, double y){
+        cursorX = x;
+        cursorY = y;
+        requested = true;
+    }
+
+    /**
+     * @brief      Bind the id target for the pixel asked for, if a pick is pending
+     *
+     * Sizes the target to the framebuffer (recreated only when that
+     * changes), scissors to the pixel under the cursor and clears it to 0.
+     *
+     * @return     false when there is nothing to draw (no pick asked for, the
+     *             readback ring is full, the cursor is off the window)
+     */
+    bool Begin(GLFWwindow* window){
+        if (!requested || active)
+            return false;
+        if (readback && readback->Pending() == READBACK_RING)
+            return false;
+        int windowWidth, windowHeight, framebufferWidth, framebufferHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        requested = false;
+        if (windowWidth <= 0 || windowHeight <= 0 || framebufferWidth <= 0 || framebufferHeight <= 0)
+            return false;
+        // window coordinates to a framebuffer pixel, bottom row first
+        pickX = (int)(cursorX * framebufferWidth / windowWidth);
+        pickY = framebufferHeight - 1 - (int)(cursorY * framebufferHeight / windowHeight);
+        if (pickX < 0 || pickX >= framebufferWidth || pickY < 0 || pickY >= framebufferHeight)
+            return false;
+        // recreated only when the framebuffer size changes
+        RenderTargetDesc desc(framebufferWidth, framebufferHeight, GL_R32UI, GL_DEPTH_COMPONENT24);
+        if (!target.Valid() || target.Desc() != desc)
+            if (!target.Create(desc))
+                return false;
+
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldRead);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDraw);
+        glGetIntegerv(GL_VIEWPORT, oldViewport);
+        glGetIntegerv(GL_SCISSOR_BOX, oldScissor);
+        oldScissorTest = glIsEnabled(GL_SCISSOR_TEST);
+
+        target.Bind();
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(pickX, pickY, 1, 1);
+        const GLuint none[4] = { 0, 0, 0, 0 };
+        glClearBufferuiv(GL_COLOR, 0, none);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        active = true;
+        return true;
+    }
+
+    /**
+     * @brief      Queue the readback of the picked pixel and restore the framebuffer state
+     */
+    void End(){
+        if (!active)
+            return;
+        TRACE_SCOPE("IdPicker::End");
+        active = false;
+        if (!readback)
+            readback.reset(new AsyncReadback(READBACK_RING));
+        readback->Request(target.Framebuffer(), GL_COLOR_ATTACHMENT0, pickX, pickY, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, frame++);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, oldRead);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDraw);
+        glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+        glScissor(oldScissor[0], oldScissor[1], oldScissor[2], oldScissor[3]);
+        if (!oldScissorTest)
+            glDisable(GL_SCISSOR_TEST);
+    }
+
+    /**
+     * @brief      Hand over the newest finished pick
+     *
+     * @param      object  the object under the cursor then, -1 for none
+     *
+     * @return     false if no pick finished since the last call
+     */
+    bool Poll(int& object){
+        if (!readback)
+            return false;
+        bool found = false;
+        while (readback->Poll(result))
+        {
+            uint32_t id;
+            memcpy(&id, result.pixels.data(), sizeof(id));
+            object = (int)id - 1;
+            found = true;
+        }
+        return found;
+    }
+
+    // Picks drawn whose answer has not been handed over yet
+    int Pending() const { return readback ? readback->Pending() : 0; }
+
+private:
+
+    static const int READBACK_RING = 3;
+
+    RenderTarget target;
+    std::unique_ptr<AsyncReadback> readback;
+    ReadbackResult result;
+
+    bool requested;
+    double cursorX;
+    double cursorY;
+    int pickX;
+    int pickY;
+    uint64_t frame;
+
+    bool active;
+    GLint oldRead;
+    GLint oldDraw;
+    GLint oldViewport[4];
+    GLint oldScissor[4];
+    GLboolean oldScissorTest;
+};
+#endif
@@ -0,0 +1,153 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <scene/depthpyramid.h>
+#include <capture/readback.h>
+#include <profiling/trace.h>
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Hierarchical Z occlusion culling from the previous frames' depth
+ *
+ * With --hiz, after the scene is drawn its depth buffer is queued for an
+ * asynchronous readback (capture/readback.h); a frame or two later, once
+ * the GPU is done, BeginFrame() builds a DepthPyramid from it and
+ * Occluded() tests object bounds against that, after frustum culling and
+ * before the instance data goes to the GPU. Nothing waits on the GPU, the
+ * price is that the depth is a few frames old (see scene/depthpyramid.h):
+ * an object coming out from behind an occluder can appear that much late.
+ *
+ *     OcclusionCuller occlusion(argc, argv);
+ *     ...
+ *     occlusion.BeginFrame();
+ *     ...frustum culled list... if (!occlusion.Occluded(bounds[i])) ...draw i...
+ *     occlusion.EndFrame(window, projection * view);
+ *
+ * Options:
+ *
+ *     --hiz                cull occluded objects
+ *
+ * ReportJSON() has the objects tested and culled per frame and the CPU
+ * time spent; the frame time gain is the difference between two --bench
+ * runs, with and without --hiz ("make bench-hiz").
+ *
+ * The depth readback lives as long as the culler, destroy it while the
+ * context is current.
+ */
+
+class OcclusionCuller
+{
+public:
+
+    OcclusionCuller(int argc, char const *argv[])
+        : enabled(false), frame(0), matrices(8), frames(0), pyramids(0), tested(0), occluded(0), cpuMs(0.0) {
+        for (int i = 1; i < argc; i++)
+            if (strcmp(argv[i], "--hiz") == 0)
+                enabled = true;
+    }
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    bool Enabled() const { return enabled; }
+
+    /**
+     * @brief      Take the newest finished depth readback, call before the first Occluded() of a frame
+     */
+    void BeginFrame(){
+        if (!enabled || !readback)
+            return;
+        TRACE_SCOPE("OcclusionCuller::BeginFrame");
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool fresh = false;
+        while (readback->Poll(latest))
+            fresh = true;
+        if (fresh)
+        {
+            pyramid.Build((const float*)latest.pixels.data(), latest.width, latest.height,
+                          matrices[latest.tag % matrices.size()]);
+            pyramids++;
+        }
+        frames++;
+        cpuMs += elapsedMs(start);
+    }
+
+    /**
+     * @brief      Whether the box is hidden behind the latest depth, false before the first readback arrives
+     */
+    bool Occluded(const Aabb& box){
+        if (!enabled || !pyramid.Valid())
+            return false;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool hidden = pyramid.Occluded(box);
+        tested++;
+        occluded += hidden;
+        cpuMs += elapsedMs(start);
+        return hidden;
+    }
+
+    /**
+     * @brief      Queue the depth of the frame just drawn, call after the occluders and before the swap
+     *
+     * @param      framebuffer  where the scene's depth is, 0 for the default
+     *                          framebuffer; single sampled
+     * @param      width        its size, 0 for the window's framebuffer size
+     */
+    void EndFrame(GLFWwindow* window, const glm::mat4& viewProjection, GLuint framebuffer = 0, int width = 0, int height = 0){
+        if (!enabled)
+            return;
+        TRACE_SCOPE("OcclusionCuller::EndFrame");
+        if (!readback)
+            readback.reset(new AsyncReadback());
+        if (width <= 0 || height <= 0)
+            glfwGetFramebufferSize(window, &width, &height);
+        if (width <= 0 || height <= 0)
+            return;
+        // a full ring means the GPU is behind: skip this frame's depth rather than wait
+        GLenum readBuffer = framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK;
+        if (readback->Request(framebuffer, readBuffer, 0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, frame))
+            matrices[frame % matrices.size()] = viewProjection;
+        frame++;
+    }
+
+    std::string ReportJSON() const {
+        double perFrame = frames ? 1.0 / frames : 0.0;
+        std::ostringstream json;
+        json << "{\"frames\": " << frames << ", \"pyramids\": " << pyramids
+             << ", \"tested_per_frame\": " << tested * perFrame << ", \"occluded_per_frame\": " << occluded * perFrame
+             << ", \"occluded_percent\": " << (tested ? 100.0 * occluded / tested : 0.0)
+             << ", \"cpu_ms_per_frame\": " << cpuMs * perFrame << "}";
+        return json.str();
+    }
+
+private:
+
+    bool enabled;
+    std::unique_ptr<AsyncReadback> readback;
+    ReadbackResult latest;
+    DepthPyramid pyramid;
+    uint64_t frame;
+    std::vector<glm::mat4> matrices;    // view projection of each request, by tag
+    uint64_t frames;
+    uint64_t pyramids;
+    uint64_t tested;
+    uint64_t occluded;
+    double cpuMs;
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+#endif
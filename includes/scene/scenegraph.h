@@ -0,0 +1,313 @@
+#ifndef SCENEGRAPH_H
+#define SCENEGRAPH_H
+
+#include <jobs/workerpool.h>
+#include <profiling/trace.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Transform hierarchy: local and world matrices of many nodes
+ *
+ *     SceneGraph scene;
+ *     SceneNode field = scene.Add(SCENE_NO_PARENT);
+ *     SceneNode cube = scene.Add(field, glm::translate(glm::mat4(1.0f), offset));
+ *     ...
+ *     scene.SetLocal(field, spin);     // marks field dirty, nothing computed yet
+ *     scene.Update();                  // world = parent world * local, dirty subtrees only
+ *     shader.setMat4("model", scene.World(cube));
+ *
+ * Nodes live in a structure of arrays (local, world, parent, flags, one
+ * vector each) sorted by depth: roots first, then their children, and so
+ * on, so every parent comes before its children and Update() is a single
+ * forward pass. A node is recomputed when its local matrix was set or its
+ * parent was recomputed in the same pass; clean subtrees cost one byte
+ * test per node. Nodes of one depth do not depend on each other, so with
+ * more than one thread a large level is split across a WorkerPool and the
+ * levels run one after the other.
+ *
+ * SceneNode handles stay valid for the life of the graph; Add() may move
+ * nodes within the arrays, the handle to slot table follows. Nodes are
+ * never removed.
+ */
+
+typedef int SceneNode;
+const SceneNode SCENE_NO_PARENT = -1;
+
+namespace scenegraph_detail {
+
+// out = a * b, summed in the order glm's operator* uses so results match it bit for bit
+inline void mulMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+#if defined(__SSE2__)
+    const float* pa = &a[0][0];
+    const float* pb = &b[0][0];
+    float* po = &out[0][0];
+    __m128 a0 = _mm_loadu_ps(pa), a1 = _mm_loadu_ps(pa + 4), a2 = _mm_loadu_ps(pa + 8), a3 = _mm_loadu_ps(pa + 12);
+    for (int c = 0; c < 4; c++)
+    {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(pb[4 * c]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pb[4 * c + 1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pb[4 * c + 2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pb[4 * c + 3])));
+        _mm_storeu_ps(po + 4 * c, r);
+    }
+#else
+    out = a * b;
+#endif
+}
+
+} // namespace scenegraph_detail
+
+class SceneGraph
+{
+public:
+
+    // levels smaller than this are updated on the calling thread
+    static const size_t PARALLEL_LEVEL = 4096;
+
+    /**
+     * @param      threads  update threads, the calling one included; 0 is one per core
+     */
+    explicit SceneGraph(unsigned int threads = 1)
+        : pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()), "scene graph"),
+          layoutDirty(false), levelsValid(false), anyDirty(false), changedCount(0), lastDepth(0) {}
+
+    SceneGraph(const SceneGraph&) = delete;
+    SceneGraph& operator=(const SceneGraph&) = delete;
+
+    void Reserve(size_t nodes){
+        local.reserve(nodes);
+        world.reserve(nodes);
+        parentSlot.reserve(nodes);
+        depth.reserve(nodes);
+        dirty.reserve(nodes);
+        changed.reserve(nodes);
+        slotToNode.reserve(nodes);
+        nodeToSlot.reserve(nodes);
+    }
+
+    /**
+     * @brief      Add a node under parent, or a root with SCENE_NO_PARENT
+     *
+     * @return     the node, or SCENE_NO_PARENT for an unknown parent
+     */
+    SceneNode Add(SceneNode parent, const glm::mat4& localMatrix = glm::mat4(1.0f)){
+        if (parent != SCENE_NO_PARENT && (parent < 0 || parent >= (SceneNode)nodeToSlot.size()))
+        {
+            std::cout << "ERROR::SCENEGRAPH::INVALID_PARENT " << parent << std::endl;
+            return SCENE_NO_PARENT;
+        }
+        SceneNode node = (SceneNode)nodeToSlot.size();
+        int slot = (int)local.size();
+        int p = parent == SCENE_NO_PARENT ? -1 : nodeToSlot[parent];
+        int d = p < 0 ? 0 : depth[p] + 1;
+        // appending keeps parents first; only a shallower node breaks the depth order
+        if (d < lastDepth)
+            layoutDirty = true;
+        lastDepth = std::max(lastDepth, d);
+        local.push_back(localMatrix);
+        world.push_back(localMatrix);
+        parentSlot.push_back(p);
+        depth.push_back(d);
+        dirty.push_back(1);
+        changed.push_back(0);
+        slotToNode.push_back(node);
+        nodeToSlot.push_back(slot);
+        levelsValid = false;
+        anyDirty = true;
+        return node;
+    }
+
+    /**
+     * @brief      Replace a node's transform relative to its parent, applied by the next Update()
+     */
+    void SetLocal(SceneNode node, const glm::mat4& localMatrix){
+        int slot = nodeToSlot[node];
+        local[slot] = localMatrix;
+        dirty[slot] = 1;
+        anyDirty = true;
+    }
+
+    const glm::mat4& Local(SceneNode node) const { return local[nodeToSlot[node]]; }
+
+    /**
+     * @brief      World transform as of the last Update()
+     */
+    const glm::mat4& World(SceneNode node) const { return world[nodeToSlot[node]]; }
+
+    /**
+     * @brief      Whether the last Update() recomputed the node's world transform
+     */
+    bool Changed(SceneNode node) const { return changed[nodeToSlot[node]] != 0; }
+
+    SceneNode Parent(SceneNode node) const {
+        int p = parentSlot[nodeToSlot[node]];
+        return p < 0 ? SCENE_NO_PARENT : slotToNode[p];
+    }
+    int Depth(SceneNode node) const { return depth[nodeToSlot[node]]; }
+    size_t Size() const { return local.size(); }
+    unsigned int Threads() const { return pool.Size(); }
+
+    /**
+     * @brief      All world matrices in depth order, Slot() maps a node to its index
+     */
+    const glm::mat4* Worlds() const { return world.data(); }
+    size_t Slot(SceneNode node) const { return (size_t)nodeToSlot[node]; }
+
+    /**
+     * @brief      Recompute the world transforms of dirty nodes and their subtrees
+     *
+     * @return     number of nodes recomputed
+     */
+    size_t Update(){
+        TRACE_SCOPE("SceneGraph::Update");
+        if (layoutDirty)
+            sortByDepth();
+        if (!levelsValid)
+            findLevels();
+        if (!anyDirty)
+        {
+            if (changedCount)
+                memset(changed.data(), 0, changed.size());
+            changedCount = 0;
+            return 0;
+        }
+
+        size_t count = 0;
+        std::vector<size_t> counts(pool.Size());
+        for (size_t level = 0; level + 1 < levelStart.size(); level++)
+        {
+            size_t begin = levelStart[level], end = levelStart[level + 1];
+            if (pool.Size() == 1 || end - begin < PARALLEL_LEVEL)
+            {
+                count += updateRange(begin, end, level == 0);
+                continue;
+            }
+            // whole cache lines of flags per thread; rounding up so the last share reaches end
+            size_t share = ((end - begin + pool.Size() - 1) / pool.Size() + 63) & ~(size_t)63;
+            pool.Run([&](unsigned int thread) {
+                size_t b = std::min(end, begin + share * thread), e = std::min(end, b + share);
+                counts[thread] = b < e ? updateRange(b, e, level == 0) : 0;
+            });
+            for (size_t t = 0; t < counts.size(); t++)
+                count += counts[t];
+        }
+        anyDirty = false;
+        changedCount = count;
+        return count;
+    }
+
+private:
+
+    WorkerPool pool;
+
+    // one entry per slot, slots in depth order
+    std::vector<glm::mat4> local;
+    std::vector<glm::mat4> world;
+    std::vector<int> parentSlot;            // -1 for roots
+    std::vector<int> depth;
+    std::vector<unsigned char> dirty;       // local set since the last Update
+    std::vector<unsigned char> changed;     // world recomputed by the last Update
+    std::vector<SceneNode> slotToNode;
+
+    std::vector<int> nodeToSlot;
+    std::vector<size_t> levelStart;         // first slot of each depth, then Size()
+
+    bool layoutDirty;                       // slots are not grouped by depth
+    bool levelsValid;
+    bool anyDirty;
+    size_t changedCount;
+    int lastDepth;
+
+    size_t updateRange(size_t begin, size_t end, bool roots){
+        size_t count = 0;
+        if (roots)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                unsigned char c = dirty[i];
+                changed[i] = c;
+                if (c)
+                {
+                    dirty[i] = 0;
+                    world[i] = local[i];
+                    count++;
+                }
+            }
+            return count;
+        }
+        for (size_t i = begin; i < end; i++)
+        {
+            int p = parentSlot[i];
+            unsigned char c = dirty[i] | changed[p];
+            changed[i] = c;
+            if (c)
+            {
+                dirty[i] = 0;
+                scenegraph_detail::mulMat4(world[p], local[i], world[i]);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // stable counting sort of the slots by depth, parents stay ahead of their children
+    void sortByDepth(){
+        TRACE_SCOPE("SceneGraph::sortByDepth");
+        size_t n = local.size();
+        std::vector<size_t> start((size_t)lastDepth + 2, 0);
+        for (size_t i = 0; i < n; i++)
+            start[depth[i] + 1]++;
+        for (size_t d = 1; d < start.size(); d++)
+            start[d] += start[d - 1];
+        std::vector<int> newSlot(n);
+        for (size_t i = 0; i < n; i++)
+            newSlot[i] = (int)start[depth[i]]++;
+
+        permute(local, newSlot);
+        permute(world, newSlot);
+        permute(depth, newSlot);
+        permute(dirty, newSlot);
+        permute(changed, newSlot);
+        permute(slotToNode, newSlot);
+        permute(parentSlot, newSlot);
+        for (size_t i = 0; i < n; i++)
+        {
+            if (parentSlot[i] >= 0)
+                parentSlot[i] = newSlot[parentSlot[i]];
+            nodeToSlot[slotToNode[i]] = (int)i;
+        }
+        layoutDirty = false;
+        levelsValid = false;
+    }
+
+    template <typename T>
+    static void permute(std::vector<T>& values, const std::vector<int>& newSlot){
+        std::vector<T> moved(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+            moved[newSlot[i]] = values[i];
+        values.swap(moved);
+    }
+
+    void findLevels(){
+        levelStart.clear();
+        for (size_t i = 0; i < depth.size(); i++)
+            while ((int)levelStart.size() <= depth[i])
+                levelStart.push_back(i);
+        levelStart.push_back(depth.size());
+        levelsValid = true;
+    }
+};
+#endif
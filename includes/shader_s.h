@@ -3,6 +3,8 @@
 
 #include <glad/glad.h>
 
+#include <profiling/trace.h>
+
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -16,6 +18,7 @@ public:
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
     {
+        TRACE_SCOPE("Shader::Shader");
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
@@ -0,0 +1,186 @@
+#ifndef VTRANSFORM_H
+#define VTRANSFORM_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VTRANSFORM_HAVE_AVX2_PATH 1
+#endif
+
+/**
+ * Batch transform of CPU side positions by a 4x4 matrix
+ *
+ * Positions are kept as a structure of arrays, one stream per component,
+ * so a register holds the same component of 4 (SSE) or 8 (AVX2 + FMA)
+ * vertices and the matrix is applied with broadcast columns, no shuffles:
+ *
+ *     out.x = m[0].x * x + m[1].x * y + m[2].x * z + m[3].x
+ *     ...
+ *
+ * The widest kernel the CPU runs is picked once through CPUID; the others
+ * stay callable for testing and benchmarks (benchmarks/vertexTransform).
+ * Results match glm's mat4 * vec4 up to float rounding (FMA rounds once).
+ */
+
+enum VertexKernel {
+    VERTEX_KERNEL_SCALAR,
+    VERTEX_KERNEL_SSE,          // 4 vertices per step, SSE2
+    VERTEX_KERNEL_AVX2          // 8 vertices per step, AVX2 and FMA
+};
+
+namespace vtransform_detail {
+
+// [begin, end) one vertex at a time, the tail of the wide kernels too
+inline void transformScalar(const glm::mat4& m, const float* x, const float* y, const float* z, size_t begin, size_t end,
+                            float* outX, float* outY, float* outZ, float* outW)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float px = x[i], py = y[i], pz = z[i];
+        outX[i] = m[0][0] * px + m[1][0] * py + m[2][0] * pz + m[3][0];
+        outY[i] = m[0][1] * px + m[1][1] * py + m[2][1] * pz + m[3][1];
+        outZ[i] = m[0][2] * px + m[1][2] * py + m[2][2] * pz + m[3][2];
+        if (outW)
+            outW[i] = m[0][3] * px + m[1][3] * py + m[2][3] * pz + m[3][3];
+    }
+}
+
+#if defined(__SSE2__)
+// ROWS is 4 with w, 3 without: a constant, so the row loop unrolls
+template <int ROWS>
+inline size_t transformSSE(const glm::mat4& m, const float* x, const float* y, const float* z, size_t count,
+                           float* const* out)
+{
+    __m128 c[ROWS][4];
+    for (int r = 0; r < ROWS; r++)
+        for (int k = 0; k < 4; k++)
+            c[r][k] = _mm_set1_ps(m[k][r]);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+        for (int r = 0; r < ROWS; r++)
+        {
+            __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[r][0], px), _mm_mul_ps(c[r][1], py)),
+                                  _mm_add_ps(_mm_mul_ps(c[r][2], pz), c[r][3]));
+            _mm_storeu_ps(out[r] + i, v);
+        }
+    }
+    return i;
+}
+#endif
+
+#if defined(VTRANSFORM_HAVE_AVX2_PATH)
+template <int ROWS>
+__attribute__((target("avx2,fma")))
+inline size_t transformAVX2(const glm::mat4& m, const float* x, const float* y, const float* z, size_t count,
+                            float* const* out)
+{
+    __m256 c[ROWS][4];
+    for (int r = 0; r < ROWS; r++)
+        for (int k = 0; k < 4; k++)
+            c[r][k] = _mm256_set1_ps(m[k][r]);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+        for (int r = 0; r < ROWS; r++)
+        {
+            __m256 v = _mm256_fmadd_ps(c[r][0], px, _mm256_fmadd_ps(c[r][1], py, _mm256_fmadd_ps(c[r][2], pz, c[r][3])));
+            _mm256_storeu_ps(out[r] + i, v);
+        }
+    }
+    return i;
+}
+
+inline bool cpuHasAVX2FMA()
+{
+    static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("fma") != 0);
+    return has;
+}
+#endif
+
+} // namespace vtransform_detail
+
+/**
+ * @brief      Whether this CPU (and build) can run a kernel
+ */
+inline bool VertexKernelSupported(VertexKernel kernel)
+{
+    switch (kernel)
+    {
+        case VERTEX_KERNEL_SCALAR:
+            return true;
+        case VERTEX_KERNEL_SSE:
+#if defined(__SSE2__)
+            return true;
+#else
+            return false;
+#endif
+        case VERTEX_KERNEL_AVX2:
+#if defined(VTRANSFORM_HAVE_AVX2_PATH)
+            return vtransform_detail::cpuHasAVX2FMA();
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+/**
+ * @brief      The widest kernel this CPU runs
+ */
+inline VertexKernel BestVertexKernel()
+{
+    static const VertexKernel best = VertexKernelSupported(VERTEX_KERNEL_AVX2) ? VERTEX_KERNEL_AVX2
+                                   : VertexKernelSupported(VERTEX_KERNEL_SSE) ? VERTEX_KERNEL_SSE
+                                   : VERTEX_KERNEL_SCALAR;
+    return best;
+}
+
+inline const char* VertexKernelName(VertexKernel kernel)
+{
+    switch (kernel)
+    {
+        case VERTEX_KERNEL_SCALAR: return "scalar";
+        case VERTEX_KERNEL_SSE: return "SSE2";
+        case VERTEX_KERNEL_AVX2: return "AVX2+FMA";
+    }
+    return "?";
+}
+
+/**
+ * @brief      out = m * vec4(x, y, z, 1) for count positions
+ *
+ * @param      x, y, z  input streams, count floats each
+ * @param      outX, outY, outZ, outW  output streams, may alias the inputs
+ *                      element for element; outW NULL skips w (affine
+ *                      matrices, e.g. model to world)
+ * @param      kernel   an unsupported kernel falls back to the best one
+ */
+inline void TransformPositions(const glm::mat4& m, const float* x, const float* y, const float* z, size_t count,
+                               float* outX, float* outY, float* outZ, float* outW,
+                               VertexKernel kernel = BestVertexKernel())
+{
+    using namespace vtransform_detail;
+    if (!VertexKernelSupported(kernel))
+        kernel = BestVertexKernel();
+    float* const out[4] = {outX, outY, outZ, outW};
+    size_t done = 0;
+#if defined(VTRANSFORM_HAVE_AVX2_PATH)
+    if (kernel == VERTEX_KERNEL_AVX2)
+        done = outW ? transformAVX2<4>(m, x, y, z, count, out) : transformAVX2<3>(m, x, y, z, count, out);
+#endif
+#if defined(__SSE2__)
+    if (kernel == VERTEX_KERNEL_SSE)
+        done = outW ? transformSSE<4>(m, x, y, z, count, out) : transformSSE<3>(m, x, y, z, count, out);
+#endif
+    transformScalar(m, x, y, z, done, count, outX, outY, outZ, outW);
+}
+#endif
@@ -0,0 +1,638 @@
+#ifndef SOFTRASTER_H
+#define SOFTRASTER_H
+
+#include <softraster/softtexture.h>
+#include <jobs/workerpool.h>
+#include <profiling/trace.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Tile based software rasterizer
+ *
+ * Renders what the textured samples draw (positions and texture
+ * coordinates, one MVP, one texture, GL_LESS depth test) on the CPU, for
+ * machines without a GPU where the alternative is llvmpipe. The calls
+ * follow the GL ones they replace:
+ *
+ *     SoftRasterizer raster(800, 600);
+ *     raster.Clear(0.0f, 0.0f, 0.0f, 1.0f);                 // glClear, color and depth
+ *     raster.BindTexture(&texture);                          // glBindTexture
+ *     raster.DrawArrays(vertices, 5, 0, 3, 0, 36, mvp);      // attribute layout, glDrawArrays
+ *     raster.Flush();                                        // the frame is done
+ *     ...raster.Pixels(), RGBA8 rows top to bottom...
+ *
+ * DrawArrays only records the draw, like a command buffer: the vertices
+ * must stay alive until Flush(). Flush() then runs two passes over all
+ * threads. The front end splits the triangles of the frame in one range
+ * per thread: transform, clip against the near and far planes, set up
+ * edge and attribute planes and bin every triangle into the TILE x TILE
+ * tiles it touches. The back end hands out tiles: a tile is cleared and
+ * its bins are rasterized in submission order by a single thread, so no
+ * pixel is ever shared and draw order holds without locks.
+ *
+ * Coverage and depth are tested 4 pixels at a time (SSE2, plain C++
+ * otherwise) at pixel centers with the top-left fill rule; covered
+ * pixels get perspective correct texture coordinates and a trilinear
+ * sample, the mip level taken from the analytic derivatives.
+ */
+
+struct SoftRasterStats {
+    uint64_t triangles;         // submitted
+    uint64_t rasterized;        // after clipping and culling, clipped ones can split in two
+    uint64_t binned;            // triangle-tile pairs
+    uint64_t fragments;         // pixels that passed the depth test
+};
+
+namespace softraster_detail {
+
+// log2 within a few thousandths, plenty to pick and blend mip levels:
+// exponent plus a quadratic through the mantissa, x > 0
+inline float fastLog2(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, 4);
+    float exponent = (float)((int)(bits >> 23) - 127);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float f;
+    memcpy(&f, &bits, 4);
+    f -= 1.0f;
+    return exponent + f * (1.3465553f - 0.3465553f * f);
+}
+
+#if defined(__SSE2__)
+inline __m128 fastLog2(__m128 x)
+{
+    __m128i bits = _mm_castps_si128(x);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 f = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+    f = _mm_sub_ps(f, _mm_set1_ps(1.0f));
+    return _mm_add_ps(exponent, _mm_mul_ps(f, _mm_sub_ps(_mm_set1_ps(1.3465553f), _mm_mul_ps(_mm_set1_ps(0.3465553f), f))));
+}
+#endif
+
+struct ClipVertex {
+    glm::vec4 position;
+    float u, v;
+};
+
+// Triangle after setup: E(x, y) = a x + b y + c is > 0 inside for every edge
+struct Triangle {
+    float edgeA[3], edgeB[3];
+    double edgeC[3];            // double: vertices far off screen make c large
+    bool topLeft[3];            // pixels exactly on the edge belong to it
+    float zA, zB, zC;           // window depth
+    float qA, qB, qC;           // 1 / w
+    float uA, uB, uC;           // u / w
+    float vA, vB, vC;           // v / w
+    int minX, minY, maxX, maxY; // pixels whose center can be covered, max exclusive
+    const SoftTexture* texture;
+};
+
+struct Draw {
+    const float* vertices;
+    int stride;
+    int positionOffset;
+    int uvOffset;
+    int first;
+    int count;
+    glm::mat4 mvp;
+    const SoftTexture* texture;
+};
+
+// Triangles set up by one thread and their bins, in submission order
+struct Chunk {
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<uint32_t> > bins;
+    uint64_t submitted;
+    uint64_t binned;
+};
+
+} // namespace softraster_detail
+
+class SoftRasterizer
+{
+public:
+
+    static const int TILE = 64;
+
+    /**
+     * @param      threads  0 for one per core
+     */
+    SoftRasterizer(int width, int height, unsigned int threads = 0)
+        : pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()), "soft raster"),
+          width(0), height(0), texture(NULL), clearPending(false), clearColor(0) {
+        chunks.resize(pool.Size());
+        stats = SoftRasterStats();
+        Resize(width, height);
+    }
+
+    SoftRasterizer(const SoftRasterizer&) = delete;
+    SoftRasterizer& operator=(const SoftRasterizer&) = delete;
+
+    /**
+     * @brief      Change the framebuffer size, the contents are lost
+     */
+    void Resize(int newWidth, int newHeight){
+        if (newWidth == width && newHeight == height)
+            return;
+        width = std::max(newWidth, 1);
+        height = std::max(newHeight, 1);
+        tilesX = (width + TILE - 1) / TILE;
+        tilesY = (height + TILE - 1) / TILE;
+        // padded to whole tiles, 4 pixel steps never leave the buffers
+        stride = tilesX * TILE;
+        color.assign((size_t)stride * tilesY * TILE, 0);
+        depth.assign(color.size(), 1.0f);
+        depthStale.assign((size_t)tilesX * tilesY, false);
+        for (size_t c = 0; c < chunks.size(); c++)
+            chunks[c].bins.assign((size_t)tilesX * tilesY, std::vector<uint32_t>());
+    }
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    unsigned int Threads() const { return pool.Size(); }
+
+    /**
+     * @brief      RGBA8 pixels, red in the low byte, top row first, Stride() pixels per row
+     */
+    const uint32_t* Pixels() const { return color.data(); }
+    int Stride() const { return stride; }
+
+    /**
+     * @brief      Counters of the last Flush()
+     */
+    const SoftRasterStats& Stats() const { return stats; }
+
+    /**
+     * @brief      Clear color and depth (to 1), applied tile by tile during Flush()
+     */
+    void Clear(float r, float g, float b, float a){
+        clearColor = toByte(r) | toByte(g) << 8 | toByte(b) << 16 | toByte(a) << 24;
+        clearPending = true;
+    }
+
+    /**
+     * @brief      Texture for the next draws, NULL draws white
+     */
+    void BindTexture(const SoftTexture* bound){
+        texture = bound;
+    }
+
+    /**
+     * @brief      Record a triangle list, as glDrawArrays(GL_TRIANGLES, first, count)
+     *
+     * @param      vertices        interleaved floats, alive until Flush()
+     * @param      stride          floats per vertex
+     * @param      positionOffset  first float of the xyz position
+     * @param      uvOffset        first float of the texture coordinates
+     * @param      mvp             projection * view * model
+     */
+    void DrawArrays(const float* vertices, int stride, int positionOffset, int uvOffset, int first, int count,
+                    const glm::mat4& mvp){
+        if (count < 3)
+            return;
+        softraster_detail::Draw draw;
+        draw.vertices = vertices;
+        draw.stride = stride;
+        draw.positionOffset = positionOffset;
+        draw.uvOffset = uvOffset;
+        draw.first = first;
+        draw.count = count - count % 3;
+        draw.mvp = mvp;
+        draw.texture = texture;
+        draws.push_back(draw);
+    }
+
+    /**
+     * @brief      Rasterize everything recorded since the last Flush()
+     */
+    void Flush(){
+        TRACE_SCOPE("SoftRasterizer::Flush");
+        triangleStart.resize(draws.size() + 1);
+        triangleStart[0] = 0;
+        for (size_t d = 0; d < draws.size(); d++)
+            triangleStart[d + 1] = triangleStart[d] + draws[d].count / 3;
+        {
+            TRACE_SCOPE("setup and binning");
+            pool.Run([this](unsigned int thread) { frontEnd(thread); });
+        }
+        {
+            TRACE_SCOPE("rasterize tiles");
+            nextTile.store(0);
+            fragments.store(0);
+            pool.Run([this](unsigned int thread) { backEnd(); });
+        }
+        stats = SoftRasterStats();
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            stats.triangles += chunks[c].submitted;
+            stats.rasterized += chunks[c].triangles.size();
+            stats.binned += chunks[c].binned;
+        }
+        stats.fragments = fragments.load();
+        draws.clear();
+        clearPending = false;
+    }
+
+    /**
+     * @brief      Copy the visible pixels out, top row first
+     *
+     * @param      channels  3 (RGB) or 4 (RGBA)
+     */
+    void ReadPixels(unsigned char* out, int channels) const {
+        for (int y = 0; y < height; y++)
+        {
+            const uint32_t* row = &color[(size_t)y * stride];
+            for (int x = 0; x < width; x++, out += channels)
+            {
+                uint32_t p = row[x];
+                out[0] = (unsigned char)p;
+                out[1] = (unsigned char)(p >> 8);
+                out[2] = (unsigned char)(p >> 16);
+                if (channels == 4)
+                    out[3] = (unsigned char)(p >> 24);
+            }
+        }
+    }
+
+private:
+
+    typedef softraster_detail::ClipVertex ClipVertex;
+    typedef softraster_detail::Triangle Triangle;
+
+    WorkerPool pool;
+    int width, height;
+    int tilesX, tilesY;
+    int stride;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+    std::vector<char> depthStale;           // per tile, a clear was skipped
+
+    const SoftTexture* texture;
+    bool clearPending;
+    uint32_t clearColor;
+
+    std::vector<softraster_detail::Draw> draws;
+    std::vector<size_t> triangleStart;      // first triangle of each draw, frame wide
+    std::vector<softraster_detail::Chunk> chunks;
+    std::atomic<int> nextTile;
+    std::atomic<uint64_t> fragments;
+    SoftRasterStats stats;
+
+    static uint32_t toByte(float c){
+        return (uint32_t)(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    // Front end: this thread's share of the frame's triangles, to setup and bins
+    void frontEnd(unsigned int thread){
+        softraster_detail::Chunk& chunk = chunks[thread];
+        chunk.triangles.clear();
+        for (size_t t = 0; t < chunk.bins.size(); t++)
+            chunk.bins[t].clear();
+        chunk.binned = 0;
+
+        size_t total = triangleStart.back();
+        size_t begin = total * thread / chunks.size();
+        size_t end = total * (thread + 1) / chunks.size();
+        chunk.submitted = end - begin;
+        size_t d = std::upper_bound(triangleStart.begin(), triangleStart.end(), begin) - triangleStart.begin() - 1;
+        for (size_t t = begin; t < end; t++)
+        {
+            while (t >= triangleStart[d + 1])
+                d++;
+            const softraster_detail::Draw& draw = draws[d];
+            ClipVertex in[3];
+            for (int i = 0; i < 3; i++)
+            {
+                const float* v = draw.vertices + (size_t)(draw.first + (t - triangleStart[d]) * 3 + i) * draw.stride;
+                const float* p = v + draw.positionOffset;
+                in[i].position = draw.mvp * glm::vec4(p[0], p[1], p[2], 1.0f);
+                in[i].u = v[draw.uvOffset];
+                in[i].v = v[draw.uvOffset + 1];
+            }
+            clipAndSetup(in, draw.texture, chunk);
+        }
+    }
+
+    void clipAndSetup(const ClipVertex* in, const SoftTexture* tex, softraster_detail::Chunk& chunk){
+        // all three outside one plane of the frustum: nothing to draw
+        for (int axis = 0; axis < 3; axis++)
+        {
+            int below = 0, above = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                below += in[i].position[axis] < -in[i].position.w;
+                above += in[i].position[axis] > in[i].position.w;
+            }
+            if (below == 3 || above == 3)
+                return;
+        }
+        // x and y are left to the guard band, z is clipped: w must stay positive
+        ClipVertex polygon[9], scratch[9];
+        for (int i = 0; i < 3; i++)
+            polygon[i] = in[i];
+        int count = 3;
+        count = clipPlane(polygon, count, scratch, 1.0f);     // near: z + w >= 0
+        count = clipPlane(scratch, count, polygon, -1.0f);    // far:  w - z >= 0
+        for (int i = 1; i + 1 < count; i++)
+            setup(polygon[0], polygon[i], polygon[i + 1], tex, chunk);
+    }
+
+    // Sutherland-Hodgman against w + sign * z >= 0
+    static int clipPlane(const ClipVertex* in, int count, ClipVertex* out, float sign){
+        int written = 0;
+        for (int i = 0; i < count; i++)
+        {
+            const ClipVertex& a = in[i];
+            const ClipVertex& b = in[(i + 1) % count];
+            float da = a.position.w + sign * a.position.z;
+            float db = b.position.w + sign * b.position.z;
+            if (da >= 0.0f)
+                out[written++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da / (da - db);
+                ClipVertex& c = out[written++];
+                c.position = a.position + (b.position - a.position) * t;
+                c.u = a.u + (b.u - a.u) * t;
+                c.v = a.v + (b.v - a.v) * t;
+            }
+        }
+        return written;
+    }
+
+    void setup(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, const SoftTexture* tex,
+               softraster_detail::Chunk& chunk){
+        const ClipVertex* v[3] = {&a, &b, &c};
+        double x[3], y[3];
+        float z[3], q[3];
+        for (int i = 0; i < 3; i++)
+        {
+            q[i] = 1.0f / v[i]->position.w;
+            x[i] = (v[i]->position.x * q[i] * 0.5 + 0.5) * width;
+            y[i] = (0.5 - v[i]->position.y * q[i] * 0.5) * height;
+            z[i] = v[i]->position.z * q[i] * 0.5f + 0.5f;
+        }
+        double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0.0 || std::isnan(area))
+            return;
+        // no face culling, as in the samples: wind every triangle the same way
+        double sign = area > 0.0 ? 1.0 : -1.0;
+        area *= sign;
+
+        Triangle tri;
+        int minX = (int)std::ceil(std::min(x[0], std::min(x[1], x[2])) - 0.5);
+        int maxX = (int)std::floor(std::max(x[0], std::max(x[1], x[2])) - 0.5) + 1;
+        int minY = (int)std::ceil(std::min(y[0], std::min(y[1], y[2])) - 0.5);
+        int maxY = (int)std::floor(std::max(y[0], std::max(y[1], y[2])) - 0.5) + 1;
+        tri.minX = std::max(minX, 0);
+        tri.minY = std::max(minY, 0);
+        tri.maxX = std::min(maxX, width);
+        tri.maxY = std::min(maxY, height);
+        if (tri.minX >= tri.maxX || tri.minY >= tri.maxY)
+            return;
+
+        // edge i is opposite vertex i, its function is vertex i's barycentric times area
+        double ea[3], eb[3], ec[3];
+        for (int i = 0; i < 3; i++)
+        {
+            int j = (i + 1) % 3, k = (i + 2) % 3;
+            ea[i] = sign * (y[j] - y[k]);
+            eb[i] = sign * (x[k] - x[j]);
+            ec[i] = -(ea[i] * x[j] + eb[i] * y[j]);
+            tri.edgeA[i] = (float)ea[i];
+            tri.edgeB[i] = (float)eb[i];
+            tri.edgeC[i] = ec[i];
+            // left edges have the inside on their right, top edges below them (y grows down)
+            tri.topLeft[i] = ea[i] > 0.0 || (ea[i] == 0.0 && eb[i] > 0.0);
+        }
+        float attributes[4][3];
+        for (int i = 0; i < 3; i++)
+        {
+            attributes[0][i] = z[i];
+            attributes[1][i] = q[i];
+            attributes[2][i] = v[i]->u * q[i];
+            attributes[3][i] = v[i]->v * q[i];
+        }
+        float* planes[4][3] = {{&tri.zA, &tri.zB, &tri.zC}, {&tri.qA, &tri.qB, &tri.qC},
+                               {&tri.uA, &tri.uB, &tri.uC}, {&tri.vA, &tri.vB, &tri.vC}};
+        for (int p = 0; p < 4; p++)
+        {
+            double pa = 0.0, pb = 0.0, pc = 0.0;
+            for (int i = 0; i < 3; i++)
+            {
+                pa += ea[i] * attributes[p][i];
+                pb += eb[i] * attributes[p][i];
+                pc += ec[i] * attributes[p][i];
+            }
+            *planes[p][0] = (float)(pa / area);
+            *planes[p][1] = (float)(pb / area);
+            *planes[p][2] = (float)(pc / area);
+        }
+        tri.texture = tex;
+
+        uint32_t index = (uint32_t)chunk.triangles.size();
+        chunk.triangles.push_back(tri);
+        bin(tri, index, chunk);
+    }
+
+    void bin(const Triangle& tri, uint32_t index, softraster_detail::Chunk& chunk){
+        int tx0 = tri.minX / TILE, tx1 = (tri.maxX - 1) / TILE;
+        int ty0 = tri.minY / TILE, ty1 = (tri.maxY - 1) / TILE;
+        bool single = tx0 == tx1 && ty0 == ty1;
+        for (int ty = ty0; ty <= ty1; ty++)
+            for (int tx = tx0; tx <= tx1; tx++)
+            {
+                // skip the tiles of the bounding box entirely outside an edge:
+                // test each edge at the tile's pixel center most inside it
+                bool outside = false;
+                for (int e = 0; e < 3 && !single && !outside; e++)
+                {
+                    double cx = tri.edgeA[e] > 0.0f ? (tx + 1) * TILE - 0.5 : tx * TILE + 0.5;
+                    double cy = tri.edgeB[e] > 0.0f ? (ty + 1) * TILE - 0.5 : ty * TILE + 0.5;
+                    outside = tri.edgeA[e] * cx + tri.edgeB[e] * cy + tri.edgeC[e] < 0.0;
+                }
+                if (outside)
+                    continue;
+                chunk.bins[(size_t)ty * tilesX + tx].push_back(index);
+                chunk.binned++;
+            }
+    }
+
+    // Back end: tiles handed out one at a time until none is left
+    void backEnd(){
+        uint64_t passed = 0;
+        int tileCount = tilesX * tilesY;
+        for (int tile = nextTile.fetch_add(1); tile < tileCount; tile = nextTile.fetch_add(1))
+        {
+            int tileX = tile % tilesX * TILE, tileY = tile / tilesX * TILE;
+            bool empty = true;
+            for (size_t c = 0; c < chunks.size() && empty; c++)
+                empty = chunks[c].bins[tile].empty();
+            // depth is only cleared for tiles that test against it, the others
+            // remember that they owe a clear in case a later Flush draws there
+            if (clearPending)
+                depthStale[tile] = true;
+            bool clearDepth = !empty && depthStale[tile];
+            if (clearDepth)
+                depthStale[tile] = false;
+            for (int y = tileY; y < tileY + TILE && (clearPending || clearDepth); y++)
+            {
+                if (clearPending)
+                    std::fill_n(&color[(size_t)y * stride + tileX], TILE, clearColor);
+                if (clearDepth)
+                    std::fill_n(&depth[(size_t)y * stride + tileX], TILE, 1.0f);
+            }
+            for (size_t c = 0; c < chunks.size(); c++)
+            {
+                const std::vector<uint32_t>& bin = chunks[c].bins[tile];
+                for (size_t i = 0; i < bin.size(); i++)
+                    passed += rasterize(chunks[c].triangles[bin[i]], tileX, tileY);
+            }
+        }
+        fragments.fetch_add(passed);
+    }
+
+    // The pixel passed the depth test: perspective correct coordinates, mip level and sample
+    static uint32_t shade(const Triangle& tri, float px, float py){
+        if (!tri.texture || !tri.texture->Valid())
+            return 0xffffffffu;
+        float q = tri.qA * px + tri.qB * py + tri.qC;
+        float w = 1.0f / q;
+        float u = (tri.uA * px + tri.uB * py + tri.uC) * w;
+        float v = (tri.vA * px + tri.vB * py + tri.vC) * w;
+        // d(uq / q) = (d(uq) - u dq) / q, in texels of level 0
+        float sw = (float)tri.texture->Width() * w, sh = (float)tri.texture->Height() * w;
+        float dudx = (tri.uA - u * tri.qA) * sw, dudy = (tri.uB - u * tri.qB) * sw;
+        float dvdx = (tri.vA - v * tri.qA) * sh, dvdy = (tri.vB - v * tri.qB) * sh;
+        float rho2 = std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+        return tri.texture->Sample(u, v, 0.5f * softraster_detail::fastLog2(rho2));
+    }
+
+#if defined(__SSE2__)
+    // shade() for the lanes of bits, 4 pixels of a row from x
+    static void shade4(const Triangle& tri, int x, float py, int bits, uint32_t* out){
+        if (!tri.texture || !tri.texture->Valid())
+        {
+            for (int i = 0; i < 4; i++)
+                if (bits & (1 << i))
+                    out[i] = 0xffffffffu;
+            return;
+        }
+        __m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+        __m128 qA = _mm_set1_ps(tri.qA), uA = _mm_set1_ps(tri.uA), vA = _mm_set1_ps(tri.vA);
+        __m128 qB = _mm_set1_ps(tri.qB), uB = _mm_set1_ps(tri.uB), vB = _mm_set1_ps(tri.vB);
+        __m128 q = _mm_add_ps(_mm_mul_ps(qA, px), _mm_set1_ps(tri.qB * py + tri.qC));
+        __m128 w = _mm_div_ps(_mm_set1_ps(1.0f), q);
+        __m128 u = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(uA, px), _mm_set1_ps(tri.uB * py + tri.uC)), w);
+        __m128 v = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(vA, px), _mm_set1_ps(tri.vB * py + tri.vC)), w);
+        __m128 sw = _mm_mul_ps(_mm_set1_ps((float)tri.texture->Width()), w);
+        __m128 sh = _mm_mul_ps(_mm_set1_ps((float)tri.texture->Height()), w);
+        __m128 dudx = _mm_mul_ps(_mm_sub_ps(uA, _mm_mul_ps(u, qA)), sw);
+        __m128 dudy = _mm_mul_ps(_mm_sub_ps(uB, _mm_mul_ps(u, qB)), sw);
+        __m128 dvdx = _mm_mul_ps(_mm_sub_ps(vA, _mm_mul_ps(v, qA)), sh);
+        __m128 dvdy = _mm_mul_ps(_mm_sub_ps(vB, _mm_mul_ps(v, qB)), sh);
+        __m128 rho2 = _mm_max_ps(_mm_add_ps(_mm_mul_ps(dudx, dudx), _mm_mul_ps(dvdx, dvdx)),
+                                 _mm_add_ps(_mm_mul_ps(dudy, dudy), _mm_mul_ps(dvdy, dvdy)));
+        __m128 lod = _mm_mul_ps(_mm_set1_ps(0.5f), softraster_detail::fastLog2(rho2));
+        float us[4], vs[4], lods[4];
+        _mm_storeu_ps(us, u);
+        _mm_storeu_ps(vs, v);
+        _mm_storeu_ps(lods, lod);
+        for (int i = 0; i < 4; i++)
+            if (bits & (1 << i))
+                out[i] = tri.texture->Sample(us[i], vs[i], lods[i]);
+    }
+#endif
+
+    // One triangle over one tile, returns the pixels written
+    uint64_t rasterize(const Triangle& tri, int tileX, int tileY){
+        // 4 pixel steps from a multiple of 4: the extra pixels on the left are
+        // still in the tile and pass the edge tests only where the triangle
+        // really is; the ones at or past x1 are masked off, they may be past
+        // the right edge of the image
+        int x0 = std::max(tri.minX, tileX) & ~3, x1 = std::min(tri.maxX, tileX + TILE);
+        int y0 = std::max(tri.minY, tileY), y1 = std::min(tri.maxY, tileY + TILE);
+        uint64_t passed = 0;
+        for (int y = y0; y < y1; y++)
+        {
+            float py = y + 0.5f;
+            uint32_t* colorRow = &color[(size_t)y * stride];
+            float* depthRow = &depth[(size_t)y * stride];
+            float rowEdge[3];
+            for (int e = 0; e < 3; e++)
+                rowEdge[e] = (float)(tri.edgeA[e] * (x0 + 0.5) + tri.edgeB[e] * (double)py + tri.edgeC[e]);
+            int x = x0;
+#if defined(__SSE2__)
+            const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+            const __m128 zero = _mm_setzero_ps();
+            __m128 edge[3], step[3], inclusive[3];
+            for (int e = 0; e < 3; e++)
+            {
+                __m128 a = _mm_set1_ps(tri.edgeA[e]);
+                edge[e] = _mm_add_ps(_mm_set1_ps(rowEdge[e]), _mm_mul_ps(a, lane));
+                step[e] = _mm_mul_ps(a, _mm_set1_ps(4.0f));
+                inclusive[e] = _mm_castsi128_ps(_mm_set1_epi32(tri.topLeft[e] ? -1 : 0));
+            }
+            const __m128 zA = _mm_set1_ps(tri.zA);
+            const __m128 zRow = _mm_add_ps(_mm_set1_ps(tri.zB * py + tri.zC), _mm_mul_ps(zA, _mm_set1_ps(0.5f)));
+            const __m128 end = _mm_set1_ps((float)x1);
+            for (; x < x1; x += 4)
+            {
+                __m128 inside = _mm_cmplt_ps(_mm_add_ps(_mm_set1_ps((float)x), lane), end);
+                for (int e = 0; e < 3; e++)
+                {
+                    __m128 in = _mm_or_ps(_mm_cmpgt_ps(edge[e], zero),
+                                          _mm_and_ps(_mm_cmpeq_ps(edge[e], zero), inclusive[e]));
+                    inside = _mm_and_ps(inside, in);
+                    edge[e] = _mm_add_ps(edge[e], step[e]);
+                }
+                if (!_mm_movemask_ps(inside))
+                    continue;
+                __m128 z = _mm_add_ps(zRow, _mm_mul_ps(zA, _mm_add_ps(_mm_set1_ps((float)x), lane)));
+                __m128 old = _mm_loadu_ps(depthRow + x);
+                __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, old));
+                int bits = _mm_movemask_ps(pass);
+                if (!bits)
+                    continue;
+                _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, old)));
+                shade4(tri, x, py, bits, colorRow + x);
+                passed += (bits & 1) + (bits >> 1 & 1) + (bits >> 2 & 1) + (bits >> 3);
+            }
+#endif
+            for (; x < x1; x++)
+            {
+                float px = x + 0.5f;
+                bool inside = true;
+                for (int e = 0; e < 3; e++)
+                {
+                    float value = rowEdge[e] + tri.edgeA[e] * (x - x0);
+                    inside = inside && (value > 0.0f || (value == 0.0f && tri.topLeft[e]));
+                }
+                if (!inside)
+                    continue;
+                float z = tri.zA * px + tri.zB * py + tri.zC;
+                if (!(z < depthRow[x]))
+                    continue;
+                depthRow[x] = z;
+                colorRow[x] = shade(tri, px, py);
+                passed++;
+            }
+        }
+        return passed;
+    }
+};
+#endif
@@ -0,0 +1,136 @@
+#ifndef SOFTRENDERER_H
+#define SOFTRENDERER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <softraster/softraster.h>
+#include <profiling/trace.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <iostream>
+
+/**
+ * The software rasterizer as a drop-in backend of a sample
+ *
+ * With --softraster the sample draws its scene through SoftRasterizer
+ * instead of GL; GL is only used to put the finished frame on screen, a
+ * texture upload and one glBlitFramebuffer. Everything around the draw
+ * (--bench timings, --golden, --record, the HUD) is unchanged, so
+ *
+ *     ./cameraBin --bench --out gl.json
+ *     ./cameraBin --bench --out soft.json --softraster
+ *
+ * compare the two rasterizers on the same scene; under Xvfb the first one
+ * is llvmpipe. On llvmpipe the upload and blit of the finished frame are
+ * themselves a few ms at 800x600 ("SoftRenderer::Present" in --trace);
+ * benchmarks/softRaster times the rasterizer alone. Options:
+ *
+ *     --softraster         render on the CPU
+ *     --soft-threads N     rasterizer threads (default one per core)
+ */
+
+class SoftRenderer
+{
+public:
+
+    SoftRenderer(int argc, char const *argv[])
+        : enabled(false), threads(0), texture(0), framebuffer(0), textureWidth(0), textureHeight(0) {
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--softraster") == 0)
+                enabled = true;
+            else if (strcmp(argv[i], "--soft-threads") == 0 && i + 1 < argc)
+                threads = (unsigned int)atoi(argv[++i]);
+        }
+    }
+    ~SoftRenderer(){
+        if (framebuffer)
+            glDeleteFramebuffers(1, &framebuffer);
+        if (texture)
+            glDeleteTextures(1, &texture);
+    }
+
+    SoftRenderer(const SoftRenderer&) = delete;
+    SoftRenderer& operator=(const SoftRenderer&) = delete;
+
+    bool Enabled() const { return enabled; }
+
+    /**
+     * @brief      Size the rasterizer to the window and clear it, call before drawing
+     */
+    SoftRasterizer& Begin(GLFWwindow* window, float r, float g, float b, float a){
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        if (!raster)
+        {
+            raster.reset(new SoftRasterizer(width, height, threads));
+            std::cout << "Software rasterizer: " << raster->Threads() << " threads, "
+                      << SoftRasterizer::TILE << "x" << SoftRasterizer::TILE << " tiles" << std::endl;
+        }
+        raster->Resize(width, height);
+        raster->Clear(r, g, b, a);
+        return *raster;
+    }
+
+    SoftRasterizer& Raster() { return *raster; }
+
+    /**
+     * @brief      Rasterize the recorded draws and copy the frame to the default framebuffer
+     */
+    void Present(){
+        raster->Flush();
+        TRACE_SCOPE("SoftRenderer::Present");
+        GLint oldTexture, oldRead, oldDraw, oldRowLength, oldAlignment;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexture);
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldRead);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDraw);
+        glGetIntegerv(GL_UNPACK_ROW_LENGTH, &oldRowLength);
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+
+        int width = raster->Width(), height = raster->Height();
+        if (!texture)
+        {
+            glGenTextures(1, &texture);
+            glGenFramebuffers(1, &framebuffer);
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, raster->Stride());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (width != textureWidth || height != textureHeight)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, raster->Pixels());
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+            textureWidth = width;
+            textureHeight = height;
+        }
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, raster->Pixels());
+
+        // the rasterizer's rows go top down, GL's bottom up: flip in the blit
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, oldRowLength);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDraw);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, oldRead);
+        glBindTexture(GL_TEXTURE_2D, oldTexture);
+    }
+
+private:
+
+    bool enabled;
+    unsigned int threads;
+    std::unique_ptr<SoftRasterizer> raster;
+    GLuint texture;
+    GLuint framebuffer;
+    int textureWidth, textureHeight;
+};
+#endif
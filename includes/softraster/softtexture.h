@@ -0,0 +1,169 @@
+#ifndef SOFTTEXTURE_H
+#define SOFTTEXTURE_H
+
+#include <texture/imagedecode.h>
+#include <texture/mipgen.h>
+#include <profiling/trace.h>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Texture of the software rasterizer (softraster/softraster.h)
+ *
+ * RGBA8 mip chain sampled like a GL texture with GL_REPEAT wrapping and
+ * GL_LINEAR_MIPMAP_LINEAR / GL_LINEAR filters: texel centers at half
+ * texels, row 0 at v = 0 (as glTexImage2D takes stb_image's rows), the
+ * level picked from the screen space derivatives of the coordinates.
+ * Bilinear weights are 8 bit fixed point, the 4 channels of a texel in
+ * one multiply (16 bit SSE2 lanes, or two channels per 32 bit integer);
+ * both paths round the same way.
+ */
+
+class SoftTexture
+{
+public:
+
+    SoftTexture() {}
+
+    /**
+     * @brief      Take a mip chain as built by GenerateMipChain, 3 or 4 channels
+     *
+     * @return     false for an empty chain or an unsupported channel count
+     */
+    bool Load(const std::vector<TexPackImage>& chain, unsigned int channels){
+        levels.clear();
+        if (chain.empty() || (channels != 3 && channels != 4))
+        {
+            std::cout << "ERROR::SOFTTEXTURE::UNSUPPORTED_IMAGE" << std::endl;
+            return false;
+        }
+        levels.resize(chain.size());
+        for (size_t l = 0; l < chain.size(); l++)
+        {
+            Level& level = levels[l];
+            level.width = (int)chain[l].width;
+            level.height = (int)chain[l].height;
+            level.widthMask = (level.width & (level.width - 1)) ? -1 : level.width - 1;
+            level.heightMask = (level.height & (level.height - 1)) ? -1 : level.height - 1;
+            level.texels.resize((size_t)level.width * level.height);
+            const unsigned char* in = chain[l].texels.data();
+            for (size_t t = 0; t < level.texels.size(); t++, in += channels)
+                level.texels[t] = (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16
+                                | (uint32_t)(channels == 4 ? in[3] : 255) << 24;
+        }
+        return true;
+    }
+
+    /**
+     * @brief      Decode an image file and build its mips with the box filter, as LoadTextureAsync does
+     */
+    bool Load(const std::string& path){
+        TRACE_SCOPE("SoftTexture::Load");
+        DecodedImage image;
+        if (!DecodeImageFile(path, 0, image))
+        {
+            std::cout << "Failed to load texture " << path << std::endl;
+            return false;
+        }
+        std::vector<TexPackImage> chain = GenerateMipChain(image.pixels, image.width, image.height, image.channels,
+                                                           MIP_FILTER_BOX, false);
+        FreeDecodedImage(image);
+        return Load(chain, image.channels);
+    }
+
+    bool Valid() const { return !levels.empty(); }
+    int Width() const { return levels.empty() ? 0 : levels[0].width; }
+    int Height() const { return levels.empty() ? 0 : levels[0].height; }
+
+    /**
+     * @brief      Filtered texel at (u, v)
+     *
+     * @param      lod   log2 of the level 0 texels per pixel along the larger
+     *                   screen space derivative; 0 or less is magnification
+     *
+     * @return     RGBA8, red in the low byte
+     */
+    uint32_t Sample(float u, float v, float lod) const {
+        int last = (int)levels.size() - 1;
+        if (!(lod > 0.0f) || last == 0)
+            return bilinear(levels[0], u, v);
+        if (lod >= (float)last)
+            return bilinear(levels[last], u, v);
+        int level = (int)lod;
+        uint32_t a = bilinear(levels[level], u, v);
+        uint32_t b = bilinear(levels[level + 1], u, v);
+        return lerp(a, b, (uint32_t)((lod - level) * 256.0f));
+    }
+
+private:
+
+    struct Level {
+        int width;
+        int height;
+        int widthMask;                  // size - 1 for powers of two, else -1
+        int heightMask;
+        std::vector<uint32_t> texels;   // RGBA8, row 0 first
+    };
+
+    std::vector<Level> levels;
+
+    // std::floor is a libm call without SSE4.1
+    static int floorToInt(float f){
+        int i = (int)f;
+        return i - (f < (float)i);
+    }
+
+    // GL_REPEAT, a mask for the usual power of two sizes
+    static int wrap(int i, int size, int mask){
+        if (mask >= 0)
+            return i & mask;
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+
+    // a + (b - a) * t / 256 on the 4 bytes, two channels per multiply
+    static uint32_t lerp(uint32_t a, uint32_t b, uint32_t t){
+        uint32_t s = 256 - t;
+        uint32_t rb = ((a & 0x00ff00ffu) * s + (b & 0x00ff00ffu) * t + 0x00800080u) >> 8 & 0x00ff00ffu;
+        uint32_t ga = (((a >> 8) & 0x00ff00ffu) * s + ((b >> 8) & 0x00ff00ffu) * t + 0x00800080u) & 0xff00ff00u;
+        return rb | ga;
+    }
+
+    static uint32_t bilinear(const Level& level, float u, float v){
+        float x = u * level.width - 0.5f;
+        float y = v * level.height - 0.5f;
+        // 8 bit fixed point, floor by the arithmetic shift
+        int fx = floorToInt(x * 256.0f), fy = floorToInt(y * 256.0f);
+        int x0 = fx >> 8, y0 = fy >> 8;
+        uint32_t tx = (uint32_t)fx & 255, ty = (uint32_t)fy & 255;
+        int x1 = wrap(x0 + 1, level.width, level.widthMask), y1 = wrap(y0 + 1, level.height, level.heightMask);
+        x0 = wrap(x0, level.width, level.widthMask);
+        y0 = wrap(y0, level.height, level.heightMask);
+        const uint32_t* row0 = &level.texels[(size_t)y0 * level.width];
+        const uint32_t* row1 = &level.texels[(size_t)y1 * level.width];
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi16(128);
+        // columns x0 and x1 as [row0, row1] of 16 bit channels, blended across, then down
+        __m128i left = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)row0[x0]), _mm_cvtsi32_si128((int)row1[x0])), zero);
+        __m128i right = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)row0[x1]), _mm_cvtsi32_si128((int)row1[x1])), zero);
+        __m128i across = _mm_add_epi16(_mm_mullo_epi16(left, _mm_set1_epi16((short)(256 - tx))),
+                                       _mm_mullo_epi16(right, _mm_set1_epi16((short)tx)));
+        across = _mm_srli_epi16(_mm_add_epi16(across, round), 8);
+        short sy = (short)(256 - ty), ty16 = (short)ty;
+        __m128i down = _mm_mullo_epi16(across, _mm_setr_epi16(sy, sy, sy, sy, ty16, ty16, ty16, ty16));
+        down = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(down, _mm_srli_si128(down, 8)), round), 8);
+        return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(down, zero));
+#else
+        return lerp(lerp(row0[x0], row0[x1], tx), lerp(row1[x0], row1[x1], tx), ty);
+#endif
+    }
+};
+#endif
@@ -0,0 +1,220 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <texture/mapped_file.h>
+#include <texture/imagedecode.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/**
+ * ".gpak" asset pack: encoded image files concatenated behind an index
+ *
+ * Layout (all little endian):
+ *   AssetPackHeader
+ *   AssetPackEntry[entryCount]    sorted by name
+ *   file data, every file starting on an ASSETPACK_ALIGN boundary
+ *
+ * Files are stored as they are on disk (jpg, png...), so loading the
+ * whole texture set at startup is one open() and one mmap() of the pack,
+ * then stbi_load_from_memory straight out of the mapping.
+ */
+
+#define ASSETPACK_MAGIC    "GPAK"
+#define ASSETPACK_VERSION  1
+#define ASSETPACK_ALIGN    16
+#define ASSETPACK_NAME_MAX 48
+
+struct AssetPackHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct AssetPackEntry {
+    char     name[ASSETPACK_NAME_MAX];  // file name without directories, NUL terminated
+    uint64_t offset;                    // from the start of the file
+    uint64_t size;                      // in bytes
+};
+
+/**
+ * @brief      Name a file is stored under: its path without directories
+ */
+inline std::string AssetPackName(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/**
+ * @brief      Concatenate files into a .gpak
+ *
+ * @param      path   destination file
+ * @param      files  files to store, under their AssetPackName()
+ *
+ * @return     true on success
+ */
+inline bool WriteAssetPack(const char* path, const std::vector<std::string>& files)
+{
+    std::vector<AssetPackEntry> entries(files.size());
+    std::vector<std::vector<unsigned char> > contents(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        std::string name = AssetPackName(files[i]);
+        if (name.size() >= ASSETPACK_NAME_MAX)
+        {
+            std::cout << "ERROR::ASSETPACK::NAME_TOO_LONG " << files[i] << std::endl;
+            return false;
+        }
+        contents[i] = ReadFileBytes(files[i]);
+        if (contents[i].empty())
+        {
+            std::cout << "ERROR::ASSETPACK::CANNOT_READ " << files[i] << std::endl;
+            return false;
+        }
+        memset(&entries[i], 0, sizeof(AssetPackEntry));
+        memcpy(entries[i].name, name.c_str(), name.size());
+        entries[i].size = contents[i].size();
+        // remember the source so the data can follow the sorted index
+        entries[i].offset = i;
+    }
+    std::sort(entries.begin(), entries.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) {
+        return strcmp(a.name, b.name) < 0;
+    });
+    for (size_t i = 1; i < entries.size(); i++)
+    {
+        if (strcmp(entries[i - 1].name, entries[i].name) == 0)
+        {
+            std::cout << "ERROR::ASSETPACK::DUPLICATE_NAME " << entries[i].name << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<size_t> source(entries.size());
+    uint64_t offset = sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * entries.size();
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        source[i] = (size_t)entries[i].offset;
+        offset = (offset + ASSETPACK_ALIGN - 1) & ~(uint64_t)(ASSETPACK_ALIGN - 1);
+        entries[i].offset = offset;
+        offset += entries[i].size;
+    }
+
+    AssetPackHeader header;
+    memcpy(header.magic, ASSETPACK_MAGIC, 4);
+    header.version    = ASSETPACK_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.reserved   = 0;
+
+    FILE* f = fopen(path, "wb");
+    if (!f)
+    {
+        std::cout << "ERROR::ASSETPACK::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(entries.data(), sizeof(AssetPackEntry), entries.size(), f) == entries.size();
+    static const unsigned char zeros[ASSETPACK_ALIGN] = {0};
+    for (size_t i = 0; ok && i < entries.size(); i++)
+    {
+        const std::vector<unsigned char>& data = contents[source[i]];
+        long pad = (long)entries[i].offset - ftell(f);
+        ok = pad >= 0 && fwrite(zeros, 1, (size_t)pad, f) == (size_t)pad;
+        ok = ok && fwrite(data.data(), 1, data.size(), f) == data.size();
+    }
+    fclose(f);
+    if (!ok)
+        std::cout << "ERROR::ASSETPACK::SHORT_WRITE " << path << std::endl;
+    return ok;
+}
+
+/**
+ * Read side of a .gpak file. The whole pack is mapped once and read
+ * ahead; entries point into the mapping and stay valid while the
+ * AssetPack is alive.
+ */
+class AssetPack
+{
+public:
+
+    /**
+     * @brief      Map and validate a .gpak file
+     *
+     * @param      path  the file to open
+     *
+     * @return     true if the file is a well formed pack
+     */
+    bool Open(const char* path){
+        // startup reads every texture in the pack, start paging it all in now
+        if (!file.Open(path, MADV_WILLNEED))
+            return false;
+        if (file.size() < sizeof(AssetPackHeader))
+            return fail(path, "TRUNCATED_HEADER");
+
+        header = (const AssetPackHeader*)file.data();
+        if (memcmp(header->magic, ASSETPACK_MAGIC, 4) != 0)
+            return fail(path, "BAD_MAGIC");
+        if (header->version != ASSETPACK_VERSION)
+            return fail(path, "UNSUPPORTED_VERSION");
+        if ((file.size() - sizeof(AssetPackHeader)) / sizeof(AssetPackEntry) < header->entryCount)
+            return fail(path, "TRUNCATED_INDEX");
+
+        entries = (const AssetPackEntry*)(file.data() + sizeof(AssetPackHeader));
+        for (uint32_t i = 0; i < header->entryCount; i++)
+        {
+            if (entries[i].name[ASSETPACK_NAME_MAX - 1] != '\0')
+                return fail(path, "BAD_NAME");
+            if (entries[i].offset > file.size() || entries[i].size > file.size() - entries[i].offset)
+                return fail(path, "ENTRY_OUT_OF_BOUNDS");
+        }
+        return true;
+    }
+
+    bool isOpen() const { return header != NULL; }
+    unsigned int EntryCount() const { return header ? header->entryCount : 0; }
+    const AssetPackEntry& Entry(unsigned int i) const { return entries[i]; }
+
+    /**
+     * @brief      Look up a file by name (directories in name are ignored)
+     *
+     * @param      name  file name or path
+     * @param      out   the stored bytes, pointing into the mapping
+     *
+     * @return     false if the pack has no such file
+     */
+    bool Find(const std::string& name, EncodedImage& out) const {
+        if (!header)
+            return false;
+        std::string key = AssetPackName(name);
+        const AssetPackEntry* end = entries + header->entryCount;
+        const AssetPackEntry* it = std::lower_bound(entries, end, key, [](const AssetPackEntry& e, const std::string& k) {
+            return strcmp(e.name, k.c_str()) < 0;
+        });
+        if (it == end || key != it->name)
+            return false;
+        out.bytes = file.data() + it->offset;
+        out.size = (size_t)it->size;
+        return true;
+    }
+
+private:
+
+    MappedFile file;
+    const AssetPackHeader* header = NULL;
+    const AssetPackEntry* entries = NULL;
+
+    bool fail(const char* path, const char* what){
+        std::cout << "ERROR::ASSETPACK::" << what << " " << path << std::endl;
+        file.Close();
+        header = NULL;
+        entries = NULL;
+        return false;
+    }
+};
+#endif
@@ -0,0 +1,68 @@
+#ifndef ASYNCLOAD_H
+#define ASYNCLOAD_H
+
+#include <texture/imagedecode.h>
+#include <texture/stbi_arena.h>
+#include <texture/mipgen.h>
+#include <profiling/trace.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <iostream>
+
+/**
+ * Background texture loading
+ *
+ * Decoding and the whole mip chain are built on a worker thread; the
+ * render thread only polls the future and uploads the finished levels,
+ * so neither the jpg decode nor glGenerateMipmap ever run inside a frame.
+ */
+
+struct DecodedTexture {
+    bool ok;
+    unsigned int channels;
+    bool srgb;
+    std::vector<TexPackImage> levels;
+};
+
+/**
+ * @brief      Decode an image and build its mip chain on a worker thread
+ *
+ * @param      path    image file readable by stb_image
+ * @param      filter  mip filter
+ * @param      srgb    the image is sRGB encoded
+ */
+inline std::future<DecodedTexture> LoadTextureAsync(const std::string& path, MipFilter filter = MIP_FILTER_BOX, bool srgb = false)
+{
+    return std::async(std::launch::async, [path, filter, srgb]() {
+        TRACE_THREAD_NAME("texture loader");
+        TRACE_SCOPE("LoadTextureAsync");
+        DecodedTexture result;
+        result.ok = false;
+        result.srgb = srgb;
+        // decode scratch and pixels live in the worker's arena until the mips are built
+        StbiArenaScope arena;
+        DecodedImage image;
+        if (!DecodeImageFile(path, 0, image))
+        {
+            std::cout << "Failed to load texture " << path << std::endl;
+            result.channels = 0;
+            return result;
+        }
+        result.channels = image.channels;
+        result.levels = GenerateMipChain(image.pixels, image.width, image.height, image.channels, filter, srgb);
+        FreeDecodedImage(image);
+        result.ok = true;
+        return result;
+    });
+}
+
+/**
+ * @brief      Non blocking check on a pending load
+ */
+inline bool TextureLoadReady(const std::future<DecodedTexture>& pending)
+{
+    return pending.valid() && pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+#endif
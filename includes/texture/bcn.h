@@ -0,0 +1,484 @@
+#ifndef BCN_H
+#define BCN_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * CPU block compression for baked textures
+ *
+ * BC1 (DXT1, 8 bytes per 4x4 block, opaque) and BC3 (DXT5, 16 bytes per
+ * block: BC1 color + interpolated alpha). The encoder works on RGBA8
+ * input; edge blocks of images that are not a multiple of 4 replicate the
+ * last row/column. Decoders are provided too, for PSNR reporting and as
+ * a fallback on drivers without S3TC support.
+ */
+
+enum BCFormat {
+    BC_FORMAT_BC1,
+    BC_FORMAT_BC3
+};
+
+/**
+ * @brief      Size in bytes of a compressed image
+ */
+inline size_t BCImageSize(BCFormat format, unsigned int width, unsigned int height)
+{
+    size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+    return blocks * (format == BC_FORMAT_BC1 ? 8 : 16);
+}
+
+namespace bcn_detail {
+
+inline uint16_t pack565(int r, int g, int b)
+{
+    r = (r * 31 + 127) / 255;
+    g = (g * 63 + 127) / 255;
+    b = (b * 31 + 127) / 255;
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpack565(uint16_t c, unsigned char out[4])
+{
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (unsigned char)((r << 3) | (r >> 2));
+    out[1] = (unsigned char)((g << 2) | (g >> 4));
+    out[2] = (unsigned char)((b << 3) | (b >> 2));
+    out[3] = 255;
+}
+
+// Four color palette of a block in 4-color mode (c0 > c1)
+inline void bc1Palette(uint16_t c0, uint16_t c1, unsigned char pal[4][4])
+{
+    unpack565(c0, pal[0]);
+    unpack565(c1, pal[1]);
+    for (int k = 0; k < 3; k++)
+    {
+        pal[2][k] = (unsigned char)((2 * pal[0][k] + pal[1][k] + 1) / 3);
+        pal[3][k] = (unsigned char)((pal[0][k] + 2 * pal[1][k] + 1) / 3);
+    }
+    pal[2][3] = pal[3][3] = 255;
+}
+
+/**
+ * Pick the nearest palette entry for each of the 16 texels.
+ * Returns the packed 2-bit indices, err receives the summed squared error.
+ */
+inline uint32_t bc1SelectIndices(const unsigned char block[64], const unsigned char pal[4][4], unsigned int& err)
+{
+    uint32_t indices = 0;
+    err = 0;
+#if defined(__SSE2__)
+    // 4 texels per iteration, distances to all 4 palette entries at once
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i palette[4];
+    for (int p = 0; p < 4; p++)
+    {
+        int packed;
+        memcpy(&packed, pal[p], 4);
+        __m128i c = _mm_and_si128(_mm_set1_epi32(packed), rgbMask);
+        palette[p] = _mm_unpacklo_epi8(c, zero);
+    }
+    for (int i = 0; i < 16; i += 4)
+    {
+        __m128i px = _mm_and_si128(_mm_loadu_si128((const __m128i*)(block + i * 4)), rgbMask);
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+        __m128i best = _mm_set1_epi32(0x7FFFFFFF);
+        __m128i bestIdx = zero;
+        for (int p = 0; p < 4; p++)
+        {
+            __m128i dl = _mm_sub_epi16(lo, palette[p]);
+            __m128i dh = _mm_sub_epi16(hi, palette[p]);
+            __m128 a = _mm_castsi128_ps(_mm_madd_epi16(dl, dl));
+            __m128 b = _mm_castsi128_ps(_mm_madd_epi16(dh, dh));
+            __m128i d = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+                                      _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+            __m128i less = _mm_cmplt_epi32(d, best);
+            best = _mm_or_si128(_mm_and_si128(less, d), _mm_andnot_si128(less, best));
+            bestIdx = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi32(p)), _mm_andnot_si128(less, bestIdx));
+        }
+        int32_t e[4], idx[4];
+        _mm_storeu_si128((__m128i*)e, best);
+        _mm_storeu_si128((__m128i*)idx, bestIdx);
+        for (int k = 0; k < 4; k++)
+        {
+            err += e[k];
+            indices |= (uint32_t)idx[k] << (2 * (i + k));
+        }
+    }
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        unsigned int best = ~0u;
+        int bestIdx = 0;
+        for (int p = 0; p < 4; p++)
+        {
+            int dr = block[i * 4] - pal[p][0];
+            int dg = block[i * 4 + 1] - pal[p][1];
+            int db = block[i * 4 + 2] - pal[p][2];
+            unsigned int d = dr * dr + dg * dg + db * db;
+            if (d < best)
+            {
+                best = d;
+                bestIdx = p;
+            }
+        }
+        err += best;
+        indices |= (uint32_t)bestIdx << (2 * i);
+    }
+#endif
+    return indices;
+}
+
+// Orders the endpoints for 4-color mode, remapping indices if swapped
+inline void bc1Write(uint16_t c0, uint16_t c1, uint32_t indices, unsigned char out[8])
+{
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        // 0<->1, 2<->3: flip the low bit of every index
+        indices ^= 0x55555555;
+    }
+    else if (c0 == c1)
+    {
+        indices = 0;
+    }
+    out[0] = (unsigned char)(c0 & 0xFF);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF);
+    out[3] = (unsigned char)(c1 >> 8);
+    out[4] = (unsigned char)(indices & 0xFF);
+    out[5] = (unsigned char)((indices >> 8) & 0xFF);
+    out[6] = (unsigned char)((indices >> 16) & 0xFF);
+    out[7] = (unsigned char)(indices >> 24);
+}
+
+// Least squares endpoints for a fixed index assignment
+inline bool bc1Refit(const unsigned char block[64], uint32_t indices, float e0[3], float e1[3])
+{
+    static const float w0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0, bb = 0, ab = 0;
+    float ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++)
+    {
+        float a = w0[(indices >> (2 * i)) & 3];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int k = 0; k < 3; k++)
+        {
+            ax[k] += a * block[i * 4 + k];
+            bx[k] += b * block[i * 4 + k];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f)
+        return false;
+    float inv = 1.0f / det;
+    for (int k = 0; k < 3; k++)
+    {
+        e0[k] = std::min(255.0f, std::max(0.0f, (ax[k] * bb - bx[k] * ab) * inv));
+        e1[k] = std::min(255.0f, std::max(0.0f, (bx[k] * aa - ax[k] * ab) * inv));
+    }
+    return true;
+}
+
+/**
+ * Encode one 4x4 RGBA block (64 bytes, row major) to BC1.
+ * Endpoints come from the principal axis of the block colors, then one
+ * least squares refinement pass is kept if it lowers the error.
+ */
+inline void encodeBC1Block(const unsigned char block[64], unsigned char out[8])
+{
+    float mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++)
+            mean[k] += block[i * 4 + k];
+    for (int k = 0; k < 3; k++)
+        mean[k] /= 16.0f;
+
+    float cov[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 16; i++)
+    {
+        float r = block[i * 4] - mean[0];
+        float g = block[i * 4 + 1] - mean[1];
+        float b = block[i * 4 + 2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    // power iteration for the dominant eigenvector
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int it = 0; it < 8; it++)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+        if (len < 1e-6f)
+            break;
+        axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = (block[i * 4] - mean[0]) * axis[0] + (block[i * 4 + 1] - mean[1]) * axis[1] + (block[i * 4 + 2] - mean[2]) * axis[2];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float axisLen2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (axisLen2 < 1e-6f)
+        axisLen2 = 1.0f;
+
+    int e0[3], e1[3];
+    for (int k = 0; k < 3; k++)
+    {
+        e0[k] = (int)std::min(255.0f, std::max(0.0f, mean[k] + axis[k] * maxT / axisLen2 + 0.5f));
+        e1[k] = (int)std::min(255.0f, std::max(0.0f, mean[k] + axis[k] * minT / axisLen2 + 0.5f));
+    }
+    uint16_t c0 = pack565(e0[0], e0[1], e0[2]);
+    uint16_t c1 = pack565(e1[0], e1[1], e1[2]);
+    if (c0 < c1)
+        std::swap(c0, c1);
+
+    unsigned char pal[4][4];
+    unsigned int err;
+    bc1Palette(c0, c1, pal);
+    uint32_t indices = bc1SelectIndices(block, pal, err);
+
+    float r0[3], r1[3];
+    if (err > 0 && c0 != c1 && bc1Refit(block, indices, r0, r1))
+    {
+        uint16_t n0 = pack565((int)(r0[0] + 0.5f), (int)(r0[1] + 0.5f), (int)(r0[2] + 0.5f));
+        uint16_t n1 = pack565((int)(r1[0] + 0.5f), (int)(r1[1] + 0.5f), (int)(r1[2] + 0.5f));
+        if (n0 < n1)
+            std::swap(n0, n1);
+        if (n0 != n1)
+        {
+            unsigned int newErr;
+            bc1Palette(n0, n1, pal);
+            uint32_t newIndices = bc1SelectIndices(block, pal, newErr);
+            if (newErr < err)
+            {
+                c0 = n0;
+                c1 = n1;
+                indices = newIndices;
+            }
+        }
+    }
+    bc1Write(c0, c1, indices, out);
+}
+
+// Encode the alpha half of a BC3 block (8-alpha interpolation mode)
+inline void encodeBC3AlphaBlock(const unsigned char block[64], unsigned char out[8])
+{
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++)
+    {
+        a0 = std::max(a0, (int)block[i * 4 + 3]);
+        a1 = std::min(a1, (int)block[i * 4 + 3]);
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    uint64_t bits = 0;
+    if (a0 != a1)
+    {
+        // palette order of the 8 entries: a0, a1, then 6 steps from a0 towards a1
+        static const int remap[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+        int range = a0 - a1;
+        for (int i = 0; i < 16; i++)
+        {
+            int t = ((block[i * 4 + 3] - a1) * 7 + range / 2) / range;
+            bits |= (uint64_t)remap[t] << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (unsigned char)((bits >> (8 * i)) & 0xFF);
+}
+
+// Gather the 4x4 block at (bx, by), replicating edge texels
+inline void fetchBlock(const unsigned char* rgba, unsigned int width, unsigned int height, unsigned int bx, unsigned int by, unsigned char block[64])
+{
+    for (unsigned int y = 0; y < 4; y++)
+    {
+        unsigned int sy = std::min(by * 4 + y, height - 1);
+        for (unsigned int x = 0; x < 4; x++)
+        {
+            unsigned int sx = std::min(bx * 4 + x, width - 1);
+            memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+inline void encodeRows(BCFormat format, const unsigned char* rgba, unsigned int width, unsigned int height,
+                       unsigned int firstRow, unsigned int lastRow, unsigned char* out)
+{
+    unsigned int blocksX = (width + 3) / 4;
+    size_t blockBytes = format == BC_FORMAT_BC1 ? 8 : 16;
+    unsigned char block[64];
+    for (unsigned int by = firstRow; by < lastRow; by++)
+    {
+        for (unsigned int bx = 0; bx < blocksX; bx++)
+        {
+            unsigned char* dst = out + ((size_t)by * blocksX + bx) * blockBytes;
+            fetchBlock(rgba, width, height, bx, by, block);
+            if (format == BC_FORMAT_BC3)
+            {
+                encodeBC3AlphaBlock(block, dst);
+                dst += 8;
+            }
+            encodeBC1Block(block, dst);
+        }
+    }
+}
+
+} // namespace bcn_detail
+
+/**
+ * @brief      Compress an RGBA8 image
+ *
+ * Block rows are split evenly between worker threads.
+ *
+ * @param      format   BC1 or BC3
+ * @param      rgba     width * height * 4 bytes
+ * @param      threads  worker count, 0 picks the hardware concurrency
+ *
+ * @return     the compressed blocks, BCImageSize() bytes
+ */
+inline std::vector<unsigned char> EncodeBC(BCFormat format, const unsigned char* rgba, unsigned int width, unsigned int height, unsigned int threads = 0)
+{
+    std::vector<unsigned char> out(BCImageSize(format, width, height));
+    unsigned int blockRows = (height + 3) / 4;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, blockRows);
+
+    if (threads <= 1)
+    {
+        bcn_detail::encodeRows(format, rgba, width, height, 0, blockRows, out.data());
+        return out;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; t++)
+    {
+        unsigned int first = blockRows * t / threads;
+        unsigned int last = blockRows * (t + 1) / threads;
+        workers.push_back(std::thread(bcn_detail::encodeRows, format, rgba, width, height, first, last, out.data()));
+    }
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+    return out;
+}
+
+/**
+ * @brief      Decompress BC1/BC3 blocks back to RGBA8
+ *
+ * @return     width * height * 4 bytes
+ */
+inline std::vector<unsigned char> DecodeBC(BCFormat format, const unsigned char* blocks, unsigned int width, unsigned int height)
+{
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    unsigned int blocksX = (width + 3) / 4;
+    unsigned int blocksY = (height + 3) / 4;
+    size_t blockBytes = format == BC_FORMAT_BC1 ? 8 : 16;
+
+    for (unsigned int by = 0; by < blocksY; by++)
+    {
+        for (unsigned int bx = 0; bx < blocksX; bx++)
+        {
+            const unsigned char* src = blocks + ((size_t)by * blocksX + bx) * blockBytes;
+            unsigned char alpha[16];
+            memset(alpha, 255, sizeof(alpha));
+            if (format == BC_FORMAT_BC3)
+            {
+                int a[8] = { src[0], src[1] };
+                if (a[0] > a[1])
+                    for (int i = 1; i < 7; i++)
+                        a[i + 1] = ((7 - i) * a[0] + i * a[1] + 3) / 7;
+                else
+                {
+                    for (int i = 1; i < 5; i++)
+                        a[i + 1] = ((5 - i) * a[0] + i * a[1] + 2) / 5;
+                    a[6] = 0;
+                    a[7] = 255;
+                }
+                uint64_t bits = 0;
+                for (int i = 0; i < 6; i++)
+                    bits |= (uint64_t)src[2 + i] << (8 * i);
+                for (int i = 0; i < 16; i++)
+                    alpha[i] = (unsigned char)a[(bits >> (3 * i)) & 7];
+                src += 8;
+            }
+
+            uint16_t c0 = (uint16_t)(src[0] | (src[1] << 8));
+            uint16_t c1 = (uint16_t)(src[2] | (src[3] << 8));
+            uint32_t indices = (uint32_t)src[4] | ((uint32_t)src[5] << 8) | ((uint32_t)src[6] << 16) | ((uint32_t)src[7] << 24);
+            unsigned char pal[4][4];
+            bcn_detail::bc1Palette(c0, c1, pal);
+            if (c0 <= c1 && format == BC_FORMAT_BC1)
+            {
+                // 3-color mode: midpoint and transparent black
+                for (int k = 0; k < 3; k++)
+                    pal[2][k] = (unsigned char)((pal[0][k] + pal[1][k]) / 2);
+                pal[3][0] = pal[3][1] = pal[3][2] = pal[3][3] = 0;
+            }
+
+            for (unsigned int y = 0; y < 4; y++)
+            {
+                unsigned int py = by * 4 + y;
+                if (py >= height)
+                    break;
+                for (unsigned int x = 0; x < 4; x++)
+                {
+                    unsigned int px = bx * 4 + x;
+                    if (px >= width)
+                        break;
+                    int i = y * 4 + x;
+                    unsigned char* dst = rgba.data() + ((size_t)py * width + px) * 4;
+                    memcpy(dst, pal[(indices >> (2 * i)) & 3], 4);
+                    if (format == BC_FORMAT_BC3)
+                        dst[3] = alpha[i];
+                }
+            }
+        }
+    }
+    return rgba;
+}
+
+/**
+ * @brief      Peak signal to noise ratio between two RGBA8 images, in dB
+ *
+ * @param      withAlpha  include the alpha channel in the error
+ */
+inline double ImagePSNR(const unsigned char* a, const unsigned char* b, unsigned int width, unsigned int height, bool withAlpha)
+{
+    unsigned int channels = withAlpha ? 4 : 3;
+    double sum = 0.0;
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (unsigned int k = 0; k < channels; k++)
+        {
+            double d = (double)a[i * 4 + k] - (double)b[i * 4 + k];
+            sum += d * d;
+        }
+    }
+    double mse = sum / (double)(count * channels);
+    if (mse <= 0.0)
+        return 99.0;
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+#endif
@@ -0,0 +1,248 @@
+#ifndef IMAGEDECODE_H
+#define IMAGEDECODE_H
+
+// declarations only: the implementation is compiled by the sample that
+// defines STB_IMAGE_IMPLEMENTATION, and stb_image.h has no guard around it
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include <stb_image.h>
+#endif
+
+#include <texture/jpegdecode.h>
+#include <texture/mapped_file.h>
+#include <profiling/trace.h>
+
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Image decode backends
+ *
+ * Loaders talk to an ImageDecoder instead of calling stbi_load directly,
+ * so the decode strategy can be swapped (and benchmarked, see
+ * benchmarks/imageDecode) without touching them. Input is always an
+ * encoded file already in memory (a mapped file or an asset pack entry,
+ * never stdio reads); the pixels of a DecodedImage belong to the caller
+ * and are released with FreeDecodedImage(), since backends allocate them
+ * differently.
+ */
+
+// An encoded file in memory, not owned
+struct EncodedImage {
+    const unsigned char* bytes;
+    size_t size;
+};
+
+struct DecodedImage {
+    int width;
+    int height;
+    int channels;               // channels in pixels, not in the file
+    unsigned char* pixels;      // NULL if the decode failed
+    void (*release)(void*);     // frees pixels, NULL for stbi_image_free
+
+    DecodedImage() : width(0), height(0), channels(0), pixels(NULL), release(NULL) {}
+};
+
+/**
+ * @brief      Release the pixels of a decoded image, whichever backend made them
+ */
+inline void FreeDecodedImage(DecodedImage& image)
+{
+    if (image.release)
+        image.release(image.pixels);
+    else
+        stbi_image_free(image.pixels);
+    image.pixels = NULL;
+}
+
+class ImageDecoder
+{
+public:
+    virtual ~ImageDecoder() {}
+
+    virtual const char* Name() const = 0;
+
+    /**
+     * @brief      Decode one image
+     *
+     * @param      desiredChannels  0 keeps the file's channel count
+     *
+     * @return     false if the data could not be decoded
+     */
+    virtual bool Decode(const EncodedImage& in, int desiredChannels, DecodedImage& out) = 0;
+
+    /**
+     * @brief      Decode a set of images, out[i] matches in[i]
+     *
+     * The default decodes them one after the other.
+     */
+    virtual void DecodeBatch(const std::vector<EncodedImage>& in, int desiredChannels, std::vector<DecodedImage>& out){
+        out.resize(in.size());
+        for (size_t i = 0; i < in.size(); i++)
+            Decode(in[i], desiredChannels, out[i]);
+    }
+};
+
+// stb_image, single threaded: the reference backend
+class StbDecoder : public ImageDecoder
+{
+public:
+    const char* Name() const { return "stb_image"; }
+
+    bool Decode(const EncodedImage& in, int desiredChannels, DecodedImage& out){
+        int fileChannels;
+        out.pixels = stbi_load_from_memory(in.bytes, (int)in.size, &out.width, &out.height, &fileChannels, desiredChannels);
+        out.channels = desiredChannels ? desiredChannels : fileChannels;
+        out.release = stbi_image_free;
+        return out.pixels != NULL;
+    }
+};
+
+/**
+ * JPEGs through texture/jpegdecode.h, everything else through stb_image
+ *
+ * A single image is decoded by several threads at once (restart
+ * intervals, then bands of rows) with the widest SIMD kernels the CPU
+ * has; the pixels are the ones stb_image would produce. Files the JPEG
+ * decoder does not handle (progressive, CMYK, PNG...) go to stb.
+ */
+class JpegStbDecoder : public StbDecoder
+{
+public:
+    /**
+     * @param      threads  threads per image, 0 picks the hardware concurrency
+     */
+    explicit JpegStbDecoder(unsigned int threads = 0, JpegKernel kernel = BestJpegKernel()) : jpeg(threads, kernel) {
+        name = std::string("jpeg ") + JpegKernelName(jpeg.Kernel()) + ", " + std::to_string(jpeg.Threads()) +
+               (jpeg.Threads() == 1 ? " thread" : " threads");
+    }
+
+    const char* Name() const { return name.c_str(); }
+
+    bool Decode(const EncodedImage& in, int desiredChannels, DecodedImage& out){
+        int fileChannels;
+        if (jpeg.Decode(in.bytes, in.size, desiredChannels, out.width, out.height, fileChannels, out.pixels))
+        {
+            out.channels = desiredChannels ? desiredChannels : fileChannels;
+            out.release = free;
+            return true;
+        }
+        return StbDecoder::Decode(in, desiredChannels, out);
+    }
+
+private:
+    JpegDecoder jpeg;
+    std::string name;
+};
+
+/**
+ * stb_image on a pool of worker threads
+ *
+ * stb decodes a JPEG in one thread, so the parallelism is across images:
+ * workers pull the next undecoded image of the batch until none are left.
+ * This is what bulk texture loads need; a single image decodes at stb
+ * speed (JpegStbDecoder splits one image instead).
+ */
+class ParallelStbDecoder : public StbDecoder
+{
+public:
+    /**
+     * @param      threads  worker count, 0 picks the hardware concurrency
+     */
+    explicit ParallelStbDecoder(unsigned int threads = 0) : threadCount(threads) {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const char* Name() const { return "stb_image parallel"; }
+
+    void DecodeBatch(const std::vector<EncodedImage>& in, int desiredChannels, std::vector<DecodedImage>& out){
+        out.resize(in.size());
+        std::atomic<size_t> next(0);
+        unsigned int workers = (unsigned int)std::min<size_t>(threadCount, in.size());
+        std::vector<std::thread> pool;
+        for (unsigned int t = 0; t < workers; t++)
+        {
+            pool.push_back(std::thread([&]() {
+                for (size_t i = next++; i < in.size(); i = next++)
+                    Decode(in[i], desiredChannels, out[i]);
+            }));
+        }
+        for (size_t t = 0; t < pool.size(); t++)
+            pool[t].join();
+    }
+
+private:
+    unsigned int threadCount;
+};
+
+/**
+ * @brief      Read a whole file into memory
+ *
+ * @return     empty if the file cannot be read
+ */
+inline std::vector<unsigned char> ReadFileBytes(const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+        return std::vector<unsigned char>();
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief      The backend the texture loaders decode with
+ */
+inline ImageDecoder& DefaultImageDecoder()
+{
+    static JpegStbDecoder decoder;
+    return decoder;
+}
+
+/**
+ * @brief      Decode an image in memory with the default backend
+ *
+ * 3 and 4 channel images keep their channel count when desiredChannels
+ * is 0, anything else is expanded to RGBA.
+ *
+ * @return     false if the data cannot be decoded
+ */
+inline bool DecodeImage(const EncodedImage& in, int desiredChannels, DecodedImage& out)
+{
+    out.pixels = NULL;
+    if (!DefaultImageDecoder().Decode(in, desiredChannels, out))
+        return false;
+    if (desiredChannels == 0 && out.channels != 3 && out.channels != 4)
+    {
+        FreeDecodedImage(out);
+        return DefaultImageDecoder().Decode(in, 4, out);
+    }
+    return true;
+}
+
+/**
+ * @brief      Decode an image file with the default backend
+ *
+ * Drop-in for stbi_load, with the channel rules of DecodeImage(). The
+ * file is mapped and decoded in place instead of going through stdio.
+ *
+ * @return     false if the file cannot be mapped or decoded
+ */
+inline bool DecodeImageFile(const std::string& path, int desiredChannels, DecodedImage& out)
+{
+    TRACE_FUNCTION();
+    out.pixels = NULL;
+    // the decoder reads the file once front to back
+    MappedFile file;
+    if (!file.Open(path.c_str(), MADV_SEQUENTIAL))
+        return false;
+    file.Prefetch(0, file.size());
+    EncodedImage in;
+    in.bytes = file.data();
+    in.size = file.size();
+    return DecodeImage(in, desiredChannels, out);
+}
+#endif
@@ -0,0 +1,1613 @@
+#ifndef JPEGDECODE_H
+#define JPEGDECODE_H
+
+#include <jobs/workerpool.h>
+#include <profiling/trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JPEGDECODE_HAVE_AVX2_PATH 1
+#endif
+
+/**
+ * Baseline JPEG decoder that splits one image over threads and SIMD lanes
+ *
+ * A JPEG's entropy coded data is one serial bit stream, which is why
+ * stb_image decodes an image on one thread. Encoders that write restart
+ * markers (DRI, every N MCUs; cameras and the sample textures do) cut the
+ * stream into intervals that start byte aligned with fresh DC predictors,
+ * so once one memchr pass has found the markers the intervals decode in
+ * parallel, each straight through Huffman decode, dequantization and IDCT
+ * into the component planes. Upsampling and color conversion then run in
+ * parallel over bands of output rows.
+ *
+ * The IDCT and YCbCr to RGB kernels come in scalar, SSE2 (stb_image's
+ * own) and AVX2 versions. The AVX2 IDCT transforms two blocks at once, one
+ * per 128 bit lane; the AVX2 color conversion does 16 pixels per step, for
+ * RGB as well as RGBA output. The SIMD kernels compute exactly what
+ * stb_image computes on x86, so the pixels are byte identical to
+ * stbi_load_from_memory's and goldens made with either agree. The scalar
+ * kernel is stb_image's portable IDCT, which can round differently from
+ * its SSE2 one on extreme coefficients (never on the sample textures).
+ *
+ * Only 8 bit baseline and extended Huffman frames (SOF0/SOF1) with 1 or 3
+ * components are handled. Decode() returns false for anything else
+ * (progressive, arithmetic coded, CMYK, not a JPEG at all, or data that
+ * looks damaged) and the caller decodes with stb_image instead, see
+ * JpegStbDecoder in texture/imagedecode.h.
+ */
+
+enum JpegKernel {
+    JPEG_KERNEL_SCALAR,
+    JPEG_KERNEL_SSE2,           // one IDCT block, 8 pixels of color conversion per step
+    JPEG_KERNEL_AVX2            // two IDCT blocks, 16 pixels per step
+};
+
+namespace jpeg_detail {
+
+const int FAST_LOOKUP_BITS = 9;
+
+// images smaller than this decode on the calling thread alone
+const size_t PARALLEL_MIN_PIXELS = 1 << 16;
+// output rows per unit of upsampling and color conversion work
+const int BAND_ROWS = 16;
+
+// (1 << n) - 1
+const uint32_t bitMask[17] = {0, 1, 3, 7, 15, 31, 63, 127, 255, 511, 1023, 2047, 4095, 8191, 16383, 32767, 65535};
+// (-1 << n) + 1
+const int extendBias[16] = {0, -1, -3, -7, -15, -31, -63, -127, -255, -511, -1023, -2047, -4095, -8191, -16383, -32767};
+
+// block position (row major) of the n-th coefficient in zigzag order; corrupt runs past 63 land on 63
+const uint8_t dezigzag[64 + 15] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+    63, 63, 63, 63, 63, 63, 63, 63,
+    63, 63, 63, 63, 63, 63, 63
+};
+
+struct Huffman {
+    uint8_t fast[1 << FAST_LOOKUP_BITS];       // symbol index of codes up to FAST_LOOKUP_BITS long, 255 if longer
+    uint16_t code[256];
+    uint8_t values[256];
+    uint8_t size[257];
+    uint32_t maxcode[18];               // largest code + 1 per length, shifted to 16 bits
+    int delta[17];                      // code to symbol index per length
+    int16_t fastAc[1 << FAST_LOOKUP_BITS];     // AC tables: run, length and value of short codes in one lookup
+    bool defined;
+};
+
+inline bool buildHuffman(Huffman& h, const int* count)
+{
+    int k = 0;
+    for (int i = 0; i < 16; i++)
+        for (int j = 0; j < count[i]; j++)
+            h.size[k++] = (uint8_t)(i + 1);
+    h.size[k] = 0;
+
+    unsigned int code = 0;
+    k = 0;
+    int length;
+    for (length = 1; length <= 16; length++)
+    {
+        h.delta[length] = k - (int)code;
+        if (h.size[k] == length)
+        {
+            while (h.size[k] == length)
+                h.code[k++] = (uint16_t)(code++);
+            if (code - 1 >= (1u << length))
+                return false;
+        }
+        h.maxcode[length] = code << (16 - length);
+        code <<= 1;
+    }
+    h.maxcode[length] = 0xffffffff;
+
+    memset(h.fast, 255, sizeof(h.fast));
+    for (int i = 0; i < k; i++)
+    {
+        int s = h.size[i];
+        if (s <= FAST_LOOKUP_BITS)
+        {
+            int c = h.code[i] << (FAST_LOOKUP_BITS - s);
+            int m = 1 << (FAST_LOOKUP_BITS - s);
+            for (int j = 0; j < m; j++)
+                h.fast[c + j] = (uint8_t)i;
+        }
+    }
+    return true;
+}
+
+// Needs the symbol values: the magnitude bits of short codes are decoded with the code
+inline void buildFastAc(Huffman& h)
+{
+    for (int i = 0; i < (1 << FAST_LOOKUP_BITS); i++)
+    {
+        uint8_t fast = h.fast[i];
+        h.fastAc[i] = 0;
+        if (fast == 255)
+            continue;
+        int rs = h.values[fast];
+        int run = (rs >> 4) & 15;
+        int magbits = rs & 15;
+        int len = h.size[fast];
+        if (magbits && len + magbits <= FAST_LOOKUP_BITS)
+        {
+            int k = ((i << len) & ((1 << FAST_LOOKUP_BITS) - 1)) >> (FAST_LOOKUP_BITS - magbits);
+            if (k < (1 << (magbits - 1)))
+                k += 1 - (1 << magbits);
+            if (k >= -128 && k <= 127)
+                h.fastAc[i] = (int16_t)(k * 256 + run * 16 + len + magbits);
+        }
+    }
+}
+
+/**
+ * Bits of one restart interval. The interval ends where its marker starts
+ * (the scanner leaves no marker inside it), and running into the end is
+ * what stb_image sees as the marker: that fill stops without adding bits,
+ * later ones add zeros.
+ */
+struct BitReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t buffer;
+    int bits;
+    bool stopped;
+
+    BitReader(const uint8_t* begin, const uint8_t* end) : p(begin), end(end), buffer(0), bits(0), stopped(false) {}
+
+    void fill(){
+        do {
+            if (!stopped)
+            {
+                if (p == end)
+                {
+                    stopped = true;
+                    return;
+                }
+                unsigned int b = *p++;
+                // a stuffed 0xFF 00, fill bytes before the 00 included
+                if (b == 0xFF)
+                    while (p < end && *p++ == 0xFF) {}
+                buffer |= b << (24 - bits);
+            }
+            bits += 8;
+        } while (bits <= 24);
+    }
+};
+
+inline int huffDecode(BitReader& r, const Huffman& h)
+{
+    if (r.bits < 16)
+        r.fill();
+    int c = (r.buffer >> (32 - FAST_LOOKUP_BITS)) & ((1 << FAST_LOOKUP_BITS) - 1);
+    int k = h.fast[c];
+    if (k < 255)
+    {
+        int s = h.size[k];
+        if (s > r.bits)
+            return -1;
+        r.buffer <<= s;
+        r.bits -= s;
+        return h.values[k];
+    }
+    // longer codes: compare against maxcode, preshifted to 16 bits
+    unsigned int temp = r.buffer >> 16;
+    for (k = FAST_LOOKUP_BITS + 1; ; k++)
+        if (temp < h.maxcode[k])
+            break;
+    if (k == 17 || k > r.bits)
+        return -1;
+    c = ((r.buffer >> (32 - k)) & bitMask[k]) + h.delta[k];
+    if ((unsigned int)c > 255)
+        return -1;
+    r.bits -= k;
+    r.buffer <<= k;
+    return h.values[c];
+}
+
+// JPEG's receive and extend in one: n bits, sign extended; 1 <= n <= 15
+inline int extendReceive(BitReader& r, int n)
+{
+    if (r.bits < n)
+        r.fill();
+    int sign = (int32_t)r.buffer >> 31;
+    uint32_t k = (r.buffer << n) | (r.buffer >> (32 - n));
+    r.buffer = k & ~bitMask[n];
+    k &= bitMask[n];
+    r.bits -= n;
+    return (int)k + (extendBias[n] & ~sign);
+}
+
+// One block, dequantized, in row major order
+inline bool decodeBlock(BitReader& r, short* data, const Huffman& dc, const Huffman& ac, int& dcPred, const uint16_t* dequant)
+{
+    int t = huffDecode(r, dc);
+    if (t < 0 || t > 15)
+        return false;
+    memset(data, 0, 64 * sizeof(short));
+
+    int value = dcPred + (t ? extendReceive(r, t) : 0);
+    dcPred = value;
+    data[0] = (short)(value * dequant[0]);
+
+    int k = 1;
+    do {
+        if (r.bits < 16)
+            r.fill();
+        int c = (r.buffer >> (32 - FAST_LOOKUP_BITS)) & ((1 << FAST_LOOKUP_BITS) - 1);
+        int fast = ac.fastAc[c];
+        if (fast)
+        {
+            k += (fast >> 4) & 15;
+            int s = fast & 15;
+            r.buffer <<= s;
+            r.bits -= s;
+            unsigned int zig = dezigzag[k++];
+            data[zig] = (short)((fast >> 8) * dequant[zig]);
+        }
+        else
+        {
+            int rs = huffDecode(r, ac);
+            if (rs < 0)
+                return false;
+            int s = rs & 15;
+            if (s == 0)
+            {
+                if (rs != 0xf0)
+                    break;      // end of block
+                k += 16;
+            }
+            else
+            {
+                k += rs >> 4;
+                unsigned int zig = dezigzag[k++];
+                data[zig] = (short)(extendReceive(r, s) * dequant[zig]);
+            }
+        }
+    } while (k < 64);
+    return true;
+}
+
+inline uint8_t clampByte(int x)
+{
+    if ((unsigned int)x > 255)
+        return x < 0 ? 0 : 255;
+    return (uint8_t)x;
+}
+
+// Integer IDCT (jidctint's ISLOW), constants scaled by 4096
+#define JPEG_F2F(x) ((int)(((x) * 4096 + 0.5)))
+#define JPEG_FSH(x) ((x) * 4096)
+
+#define JPEG_IDCT_1D(s0, s1, s2, s3, s4, s5, s6, s7) \
+    int t0, t1, t2, t3, p1, p2, p3, p4, p5, x0, x1, x2, x3; \
+    p2 = s2; \
+    p3 = s6; \
+    p1 = (p2 + p3) * JPEG_F2F(0.5411961f); \
+    t2 = p1 + p3 * JPEG_F2F(-1.847759065f); \
+    t3 = p1 + p2 * JPEG_F2F(0.765366865f); \
+    p2 = s0; \
+    p3 = s4; \
+    t0 = JPEG_FSH(p2 + p3); \
+    t1 = JPEG_FSH(p2 - p3); \
+    x0 = t0 + t3; \
+    x3 = t0 - t3; \
+    x1 = t1 + t2; \
+    x2 = t1 - t2; \
+    t0 = s7; \
+    t1 = s5; \
+    t2 = s3; \
+    t3 = s1; \
+    p3 = t0 + t2; \
+    p4 = t1 + t3; \
+    p1 = t0 + t3; \
+    p2 = t1 + t2; \
+    p5 = (p3 + p4) * JPEG_F2F(1.175875602f); \
+    t0 = t0 * JPEG_F2F(0.298631336f); \
+    t1 = t1 * JPEG_F2F(2.053119869f); \
+    t2 = t2 * JPEG_F2F(3.072711026f); \
+    t3 = t3 * JPEG_F2F(1.501321110f); \
+    p1 = p5 + p1 * JPEG_F2F(-0.899976223f); \
+    p2 = p5 + p2 * JPEG_F2F(-2.562915447f); \
+    p3 = p3 * JPEG_F2F(-1.961570560f); \
+    p4 = p4 * JPEG_F2F(-0.390180644f); \
+    t3 += p1 + p4; \
+    t2 += p2 + p3; \
+    t1 += p2 + p4; \
+    t0 += p1 + p3;
+
+inline void idctScalar(uint8_t* out, int stride, const short* data)
+{
+    int val[64];
+    int* v = val;
+    const short* d = data;
+    // columns, keeping 2 extra bits of precision
+    for (int i = 0; i < 8; i++, d++, v++)
+    {
+        if (d[8] == 0 && d[16] == 0 && d[24] == 0 && d[32] == 0 && d[40] == 0 && d[48] == 0 && d[56] == 0)
+        {
+            int dc = d[0] * 4;
+            v[0] = v[8] = v[16] = v[24] = v[32] = v[40] = v[48] = v[56] = dc;
+            continue;
+        }
+        JPEG_IDCT_1D(d[0], d[8], d[16], d[24], d[32], d[40], d[48], d[56])
+        x0 += 512; x1 += 512; x2 += 512; x3 += 512;
+        v[0] = (x0 + t3) >> 10;
+        v[56] = (x0 - t3) >> 10;
+        v[8] = (x1 + t2) >> 10;
+        v[48] = (x1 - t2) >> 10;
+        v[16] = (x2 + t1) >> 10;
+        v[40] = (x2 - t1) >> 10;
+        v[24] = (x3 + t0) >> 10;
+        v[32] = (x3 - t0) >> 10;
+    }
+    // rows: remove 1 << 17 with rounding and add the 128 level shift
+    v = val;
+    for (int i = 0; i < 8; i++, v += 8, out += stride)
+    {
+        JPEG_IDCT_1D(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7])
+        x0 += 65536 + (128 << 17);
+        x1 += 65536 + (128 << 17);
+        x2 += 65536 + (128 << 17);
+        x3 += 65536 + (128 << 17);
+        out[0] = clampByte((x0 + t3) >> 17);
+        out[7] = clampByte((x0 - t3) >> 17);
+        out[1] = clampByte((x1 + t2) >> 17);
+        out[6] = clampByte((x1 - t2) >> 17);
+        out[2] = clampByte((x2 + t1) >> 17);
+        out[5] = clampByte((x2 - t1) >> 17);
+        out[3] = clampByte((x3 + t0) >> 17);
+        out[4] = clampByte((x3 - t0) >> 17);
+    }
+}
+
+#undef JPEG_IDCT_1D
+
+/*
+ * The SIMD IDCTs are stb_image's SSE2 one: 16 bit rows, 32 bit products
+ * with madd, a transpose between the column and the row pass. The AVX2
+ * version runs the same instruction sequence on two blocks, one per 128
+ * bit lane (unpack, pack and madd never cross lanes), so both match stb.
+ */
+#define JPEG_DCT_ROTATE_CONSTANTS(SET) \
+    const VEC rot0_0 = SET(JPEG_F2F(0.5411961f), JPEG_F2F(0.5411961f) + JPEG_F2F(-1.847759065f)); \
+    const VEC rot0_1 = SET(JPEG_F2F(0.5411961f) + JPEG_F2F(0.765366865f), JPEG_F2F(0.5411961f)); \
+    const VEC rot1_0 = SET(JPEG_F2F(1.175875602f) + JPEG_F2F(-0.899976223f), JPEG_F2F(1.175875602f)); \
+    const VEC rot1_1 = SET(JPEG_F2F(1.175875602f), JPEG_F2F(1.175875602f) + JPEG_F2F(-2.562915447f)); \
+    const VEC rot2_0 = SET(JPEG_F2F(-1.961570560f) + JPEG_F2F(0.298631336f), JPEG_F2F(-1.961570560f)); \
+    const VEC rot2_1 = SET(JPEG_F2F(-1.961570560f), JPEG_F2F(-1.961570560f) + JPEG_F2F(3.072711026f)); \
+    const VEC rot3_0 = SET(JPEG_F2F(-0.390180644f) + JPEG_F2F(2.053119869f), JPEG_F2F(-0.390180644f)); \
+    const VEC rot3_1 = SET(JPEG_F2F(-0.390180644f), JPEG_F2F(-0.390180644f) + JPEG_F2F(1.501321110f));
+
+// out0/out1 = x, y interleaved dotted with the even/odd constant pairs, 32 bit
+#define JPEG_DCT_ROT(out0, out1, x, y, c0, c1) \
+    VEC c0##lo = UNPACKLO16((x), (y)); \
+    VEC c0##hi = UNPACKHI16((x), (y)); \
+    VEC out0##_l = MADD(c0##lo, c0); \
+    VEC out0##_h = MADD(c0##hi, c0); \
+    VEC out1##_l = MADD(c0##lo, c1); \
+    VEC out1##_h = MADD(c0##hi, c1)
+
+// out = in << 12, widened to 32 bit
+#define JPEG_DCT_WIDEN(out, in) \
+    VEC out##_l = SRAI32(UNPACKLO16(ZERO, (in)), 4); \
+    VEC out##_h = SRAI32(UNPACKHI16(ZERO, (in)), 4)
+
+#define JPEG_DCT_WADD(out, a, b) \
+    VEC out##_l = ADD32(a##_l, b##_l); \
+    VEC out##_h = ADD32(a##_h, b##_h)
+
+#define JPEG_DCT_WSUB(out, a, b) \
+    VEC out##_l = SUB32(a##_l, b##_l); \
+    VEC out##_h = SUB32(a##_h, b##_h)
+
+// butterfly a/b, add bias, then shift by s and pack to 16 bit
+#define JPEG_DCT_BFLY32O(out0, out1, a, b, bias, s) \
+    { \
+        VEC abiased_l = ADD32(a##_l, bias); \
+        VEC abiased_h = ADD32(a##_h, bias); \
+        JPEG_DCT_WADD(sum, abiased, b); \
+        JPEG_DCT_WSUB(dif, abiased, b); \
+        out0 = PACKS32(SRAI32(sum_l, s), SRAI32(sum_h, s)); \
+        out1 = PACKS32(SRAI32(dif_l, s), SRAI32(dif_h, s)); \
+    }
+
+#define JPEG_DCT_INTERLEAVE8(a, b) \
+    tmp = a; \
+    a = UNPACKLO8(a, b); \
+    b = UNPACKHI8(tmp, b)
+
+#define JPEG_DCT_INTERLEAVE16(a, b) \
+    tmp = a; \
+    a = UNPACKLO16(a, b); \
+    b = UNPACKHI16(tmp, b)
+
+#define JPEG_DCT_PASS(bias, shift) \
+    { \
+        /* even part */ \
+        JPEG_DCT_ROT(t2e, t3e, row2, row6, rot0_0, rot0_1); \
+        VEC sum04 = ADD16(row0, row4); \
+        VEC dif04 = SUB16(row0, row4); \
+        JPEG_DCT_WIDEN(t0e, sum04); \
+        JPEG_DCT_WIDEN(t1e, dif04); \
+        JPEG_DCT_WADD(x0, t0e, t3e); \
+        JPEG_DCT_WSUB(x3, t0e, t3e); \
+        JPEG_DCT_WADD(x1, t1e, t2e); \
+        JPEG_DCT_WSUB(x2, t1e, t2e); \
+        /* odd part */ \
+        JPEG_DCT_ROT(y0o, y2o, row7, row3, rot2_0, rot2_1); \
+        JPEG_DCT_ROT(y1o, y3o, row5, row1, rot3_0, rot3_1); \
+        VEC sum17 = ADD16(row1, row7); \
+        VEC sum35 = ADD16(row3, row5); \
+        JPEG_DCT_ROT(y4o, y5o, sum17, sum35, rot1_0, rot1_1); \
+        JPEG_DCT_WADD(x4, y0o, y4o); \
+        JPEG_DCT_WADD(x5, y1o, y5o); \
+        JPEG_DCT_WADD(x6, y2o, y5o); \
+        JPEG_DCT_WADD(x7, y3o, y4o); \
+        JPEG_DCT_BFLY32O(row0, row7, x0, x7, bias, shift); \
+        JPEG_DCT_BFLY32O(row1, row6, x1, x6, bias, shift); \
+        JPEG_DCT_BFLY32O(row2, row5, x2, x5, bias, shift); \
+        JPEG_DCT_BFLY32O(row3, row4, x3, x4, bias, shift); \
+    }
+
+// column pass, 16 bit transpose, row pass, pack to bytes and transpose back
+#define JPEG_DCT_BODY() \
+    JPEG_DCT_PASS(bias0, 10); \
+    JPEG_DCT_INTERLEAVE16(row0, row4); \
+    JPEG_DCT_INTERLEAVE16(row1, row5); \
+    JPEG_DCT_INTERLEAVE16(row2, row6); \
+    JPEG_DCT_INTERLEAVE16(row3, row7); \
+    JPEG_DCT_INTERLEAVE16(row0, row2); \
+    JPEG_DCT_INTERLEAVE16(row1, row3); \
+    JPEG_DCT_INTERLEAVE16(row4, row6); \
+    JPEG_DCT_INTERLEAVE16(row5, row7); \
+    JPEG_DCT_INTERLEAVE16(row0, row1); \
+    JPEG_DCT_INTERLEAVE16(row2, row3); \
+    JPEG_DCT_INTERLEAVE16(row4, row5); \
+    JPEG_DCT_INTERLEAVE16(row6, row7); \
+    JPEG_DCT_PASS(bias1, 17); \
+    VEC p0 = PACKUS16(row0, row1); \
+    VEC p1 = PACKUS16(row2, row3); \
+    VEC p2 = PACKUS16(row4, row5); \
+    VEC p3 = PACKUS16(row6, row7); \
+    JPEG_DCT_INTERLEAVE8(p0, p2); \
+    JPEG_DCT_INTERLEAVE8(p1, p3); \
+    JPEG_DCT_INTERLEAVE8(p0, p1); \
+    JPEG_DCT_INTERLEAVE8(p2, p3); \
+    JPEG_DCT_INTERLEAVE8(p0, p2); \
+    JPEG_DCT_INTERLEAVE8(p1, p3);
+
+#if defined(__SSE2__)
+#define VEC __m128i
+#define ZERO _mm_setzero_si128()
+#define ADD16 _mm_add_epi16
+#define SUB16 _mm_sub_epi16
+#define ADD32 _mm_add_epi32
+#define SUB32 _mm_sub_epi32
+#define SRAI32 _mm_srai_epi32
+#define MADD _mm_madd_epi16
+#define PACKS32 _mm_packs_epi32
+#define PACKUS16 _mm_packus_epi16
+#define UNPACKLO8 _mm_unpacklo_epi8
+#define UNPACKHI8 _mm_unpackhi_epi8
+#define UNPACKLO16 _mm_unpacklo_epi16
+#define UNPACKHI16 _mm_unpackhi_epi16
+#define JPEG_DCT_CONST(x, y) _mm_setr_epi16((x), (y), (x), (y), (x), (y), (x), (y))
+
+// rows 0..7 of a block are p0, p0 high, p2, p2 high, p1, p1 high, p3, p3 high
+inline void storeBlockRows(uint8_t* out, int stride, __m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+    _mm_storel_epi64((__m128i*)out, p0); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_shuffle_epi32(p0, 0x4e)); out += stride;
+    _mm_storel_epi64((__m128i*)out, p2); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_shuffle_epi32(p2, 0x4e)); out += stride;
+    _mm_storel_epi64((__m128i*)out, p1); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_shuffle_epi32(p1, 0x4e)); out += stride;
+    _mm_storel_epi64((__m128i*)out, p3); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_shuffle_epi32(p3, 0x4e));
+}
+
+inline void idctSSE2(uint8_t* out, int stride, const short* data)
+{
+    JPEG_DCT_ROTATE_CONSTANTS(JPEG_DCT_CONST)
+    const __m128i bias0 = _mm_set1_epi32(512);
+    const __m128i bias1 = _mm_set1_epi32(65536 + (128 << 17));
+    __m128i tmp;
+    __m128i row0 = _mm_loadu_si128((const __m128i*)(data + 0 * 8));
+    __m128i row1 = _mm_loadu_si128((const __m128i*)(data + 1 * 8));
+    __m128i row2 = _mm_loadu_si128((const __m128i*)(data + 2 * 8));
+    __m128i row3 = _mm_loadu_si128((const __m128i*)(data + 3 * 8));
+    __m128i row4 = _mm_loadu_si128((const __m128i*)(data + 4 * 8));
+    __m128i row5 = _mm_loadu_si128((const __m128i*)(data + 5 * 8));
+    __m128i row6 = _mm_loadu_si128((const __m128i*)(data + 6 * 8));
+    __m128i row7 = _mm_loadu_si128((const __m128i*)(data + 7 * 8));
+    JPEG_DCT_BODY()
+    storeBlockRows(out, stride, p0, p1, p2, p3);
+}
+
+#undef VEC
+#undef ZERO
+#undef ADD16
+#undef SUB16
+#undef ADD32
+#undef SUB32
+#undef SRAI32
+#undef MADD
+#undef PACKS32
+#undef PACKUS16
+#undef UNPACKLO8
+#undef UNPACKHI8
+#undef UNPACKLO16
+#undef UNPACKHI16
+#undef JPEG_DCT_CONST
+#endif
+
+#if defined(JPEGDECODE_HAVE_AVX2_PATH)
+#define VEC __m256i
+#define ZERO _mm256_setzero_si256()
+#define ADD16 _mm256_add_epi16
+#define SUB16 _mm256_sub_epi16
+#define ADD32 _mm256_add_epi32
+#define SUB32 _mm256_sub_epi32
+#define SRAI32 _mm256_srai_epi32
+#define MADD _mm256_madd_epi16
+#define PACKS32 _mm256_packs_epi32
+#define PACKUS16 _mm256_packus_epi16
+#define UNPACKLO8 _mm256_unpacklo_epi8
+#define UNPACKHI8 _mm256_unpackhi_epi8
+#define UNPACKLO16 _mm256_unpacklo_epi16
+#define UNPACKHI16 _mm256_unpackhi_epi16
+#define JPEG_DCT_CONST(x, y) _mm256_set1_epi32((int)(((unsigned int)(y) << 16) | ((unsigned int)(x) & 0xffff)))
+
+__attribute__((target("avx2")))
+inline __m256i loadRowPair(const short* a, const short* b)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)a)),
+                                   _mm_loadu_si128((const __m128i*)b), 1);
+}
+
+__attribute__((target("avx2")))
+inline void storeBlockRowsAVX2(uint8_t* out, int stride, __m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+    _mm_storel_epi64((__m128i*)out, p0); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_unpackhi_epi64(p0, p0)); out += stride;
+    _mm_storel_epi64((__m128i*)out, p2); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_unpackhi_epi64(p2, p2)); out += stride;
+    _mm_storel_epi64((__m128i*)out, p1); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_unpackhi_epi64(p1, p1)); out += stride;
+    _mm_storel_epi64((__m128i*)out, p3); out += stride;
+    _mm_storel_epi64((__m128i*)out, _mm_unpackhi_epi64(p3, p3));
+}
+
+// Block a into the low lanes, block b into the high ones
+__attribute__((target("avx2")))
+inline void idctPairAVX2(uint8_t* outA, int strideA, const short* a, uint8_t* outB, int strideB, const short* b)
+{
+    JPEG_DCT_ROTATE_CONSTANTS(JPEG_DCT_CONST)
+    const __m256i bias0 = _mm256_set1_epi32(512);
+    const __m256i bias1 = _mm256_set1_epi32(65536 + (128 << 17));
+    __m256i tmp;
+    __m256i row0 = loadRowPair(a + 0 * 8, b + 0 * 8);
+    __m256i row1 = loadRowPair(a + 1 * 8, b + 1 * 8);
+    __m256i row2 = loadRowPair(a + 2 * 8, b + 2 * 8);
+    __m256i row3 = loadRowPair(a + 3 * 8, b + 3 * 8);
+    __m256i row4 = loadRowPair(a + 4 * 8, b + 4 * 8);
+    __m256i row5 = loadRowPair(a + 5 * 8, b + 5 * 8);
+    __m256i row6 = loadRowPair(a + 6 * 8, b + 6 * 8);
+    __m256i row7 = loadRowPair(a + 7 * 8, b + 7 * 8);
+    JPEG_DCT_BODY()
+    storeBlockRowsAVX2(outA, strideA, _mm256_castsi256_si128(p0), _mm256_castsi256_si128(p1),
+                       _mm256_castsi256_si128(p2), _mm256_castsi256_si128(p3));
+    storeBlockRowsAVX2(outB, strideB, _mm256_extracti128_si256(p0, 1), _mm256_extracti128_si256(p1, 1),
+                       _mm256_extracti128_si256(p2, 1), _mm256_extracti128_si256(p3, 1));
+}
+
+#undef VEC
+#undef ZERO
+#undef ADD16
+#undef SUB16
+#undef ADD32
+#undef SUB32
+#undef SRAI32
+#undef MADD
+#undef PACKS32
+#undef PACKUS16
+#undef UNPACKLO8
+#undef UNPACKHI8
+#undef UNPACKLO16
+#undef UNPACKHI16
+#undef JPEG_DCT_CONST
+
+inline bool cpuHasAVX2()
+{
+    static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return has;
+}
+#endif
+
+#undef JPEG_DCT_ROTATE_CONSTANTS
+#undef JPEG_DCT_ROT
+#undef JPEG_DCT_WIDEN
+#undef JPEG_DCT_WADD
+#undef JPEG_DCT_WSUB
+#undef JPEG_DCT_BFLY32O
+#undef JPEG_DCT_INTERLEAVE8
+#undef JPEG_DCT_INTERLEAVE16
+#undef JPEG_DCT_PASS
+#undef JPEG_DCT_BODY
+#undef JPEG_F2F
+#undef JPEG_FSH
+
+/**
+ * Takes the decoded blocks of an interval to the IDCT. The AVX2 kernel
+ * transforms blocks in pairs, so one can wait here for the next.
+ */
+class BlockSink
+{
+public:
+    explicit BlockSink(JpegKernel kernel) : kernel(kernel), pending(0) {}
+
+    // where the next block is decoded
+    short* Block() { return blocks[pending]; }
+
+    // transform Block() into out
+    void Add(uint8_t* out, int stride){
+#if defined(JPEGDECODE_HAVE_AVX2_PATH)
+        if (kernel == JPEG_KERNEL_AVX2)
+        {
+            outs[pending] = out;
+            strides[pending] = stride;
+            if (++pending == 2)
+            {
+                idctPairAVX2(outs[0], strides[0], blocks[0], outs[1], strides[1], blocks[1]);
+                pending = 0;
+            }
+            return;
+        }
+#endif
+#if defined(__SSE2__)
+        if (kernel != JPEG_KERNEL_SCALAR)
+        {
+            idctSSE2(out, stride, blocks[0]);
+            return;
+        }
+#endif
+        idctScalar(out, stride, blocks[0]);
+    }
+
+    // transform a block still waiting for its pair
+    void Flush(){
+#if defined(JPEGDECODE_HAVE_AVX2_PATH)
+        if (pending)
+        {
+            uint8_t unused[64];
+            idctPairAVX2(outs[0], strides[0], blocks[0], unused, 8, blocks[0]);
+            pending = 0;
+        }
+#endif
+    }
+
+private:
+    JpegKernel kernel;
+    alignas(32) short blocks[2][64];
+    uint8_t* outs[2];
+    int strides[2];
+    int pending;
+};
+
+// YCbCr to RGB in 20 bit fixed point; the SIMD kernels round the same way
+#define JPEG_FLOAT2FIXED(x) (((int)((x) * 4096.0f + 0.5f)) << 8)
+
+inline void ycbcrScalar(uint8_t* out, const uint8_t* y, const uint8_t* cb, const uint8_t* cr, int begin, int count, int step)
+{
+    out += begin * step;
+    for (int i = begin; i < count; i++, out += step)
+    {
+        int yFixed = (y[i] << 20) + (1 << 19);
+        int crv = cr[i] - 128;
+        int cbv = cb[i] - 128;
+        int r = yFixed + crv * JPEG_FLOAT2FIXED(1.40200f);
+        int g = yFixed + crv * -JPEG_FLOAT2FIXED(0.71414f) + ((cbv * -JPEG_FLOAT2FIXED(0.34414f)) & 0xffff0000);
+        int b = yFixed + cbv * JPEG_FLOAT2FIXED(1.77200f);
+        out[0] = clampByte(r >> 20);
+        out[1] = clampByte(g >> 20);
+        out[2] = clampByte(b >> 20);
+        if (step == 4)
+            out[3] = 255;
+    }
+}
+
+#undef JPEG_FLOAT2FIXED
+
+#if defined(__SSE2__)
+// stb_image's: RGBA only, 8 pixels per step; returns the pixels done
+inline int ycbcrSSE2(uint8_t* out, const uint8_t* y, const uint8_t* pcb, const uint8_t* pcr, int count)
+{
+    const __m128i signflip = _mm_set1_epi8(-0x80);
+    const __m128i crConst0 = _mm_set1_epi16((short)(1.40200f * 4096.0f + 0.5f));
+    const __m128i crConst1 = _mm_set1_epi16(-(short)(0.71414f * 4096.0f + 0.5f));
+    const __m128i cbConst0 = _mm_set1_epi16(-(short)(0.34414f * 4096.0f + 0.5f));
+    const __m128i cbConst1 = _mm_set1_epi16((short)(1.77200f * 4096.0f + 0.5f));
+    const __m128i yBias = _mm_set1_epi8((char)(unsigned char)128);
+    const __m128i alpha = _mm_set1_epi16(255);
+    int i = 0;
+    for (; i + 7 < count; i += 8)
+    {
+        __m128i crBiased = _mm_xor_si128(_mm_loadl_epi64((const __m128i*)(pcr + i)), signflip);
+        __m128i cbBiased = _mm_xor_si128(_mm_loadl_epi64((const __m128i*)(pcb + i)), signflip);
+        // y * 16 + 8, chroma - 128 shifted up by 8
+        __m128i yws = _mm_srli_epi16(_mm_unpacklo_epi8(yBias, _mm_loadl_epi64((const __m128i*)(y + i))), 4);
+        __m128i crw = _mm_unpacklo_epi8(_mm_setzero_si128(), crBiased);
+        __m128i cbw = _mm_unpacklo_epi8(_mm_setzero_si128(), cbBiased);
+        __m128i rws = _mm_add_epi16(_mm_mulhi_epi16(crConst0, crw), yws);
+        __m128i gws = _mm_add_epi16(_mm_add_epi16(_mm_mulhi_epi16(cbConst0, cbw), yws), _mm_mulhi_epi16(crw, crConst1));
+        __m128i bws = _mm_add_epi16(yws, _mm_mulhi_epi16(cbw, cbConst1));
+        __m128i brb = _mm_packus_epi16(_mm_srai_epi16(rws, 4), _mm_srai_epi16(bws, 4));
+        __m128i gxb = _mm_packus_epi16(_mm_srai_epi16(gws, 4), alpha);
+        __m128i t0 = _mm_unpacklo_epi8(brb, gxb);
+        __m128i t1 = _mm_unpackhi_epi8(brb, gxb);
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_unpacklo_epi16(t0, t1));
+        _mm_storeu_si128((__m128i*)(out + i * 4 + 16), _mm_unpackhi_epi16(t0, t1));
+    }
+    return i;
+}
+#endif
+
+#if defined(JPEGDECODE_HAVE_AVX2_PATH)
+// The SSE2 arithmetic on 16 pixels, RGBA or RGB; returns the pixels done
+__attribute__((target("avx2")))
+inline int ycbcrAVX2(uint8_t* out, const uint8_t* y, const uint8_t* pcb, const uint8_t* pcr, int count, int step)
+{
+    const __m128i signflip = _mm_set1_epi8(-0x80);
+    const __m256i crConst0 = _mm256_set1_epi16((short)(1.40200f * 4096.0f + 0.5f));
+    const __m256i crConst1 = _mm256_set1_epi16(-(short)(0.71414f * 4096.0f + 0.5f));
+    const __m256i cbConst0 = _mm256_set1_epi16(-(short)(0.34414f * 4096.0f + 0.5f));
+    const __m256i cbConst1 = _mm256_set1_epi16((short)(1.77200f * 4096.0f + 0.5f));
+    const __m256i yBias = _mm256_set1_epi16(8);
+    const __m256i alpha = _mm256_set1_epi16(255);
+    // RGBX to RGB within each group of 4 pixels
+    const __m256i dropX = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                           0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    // RGB stores write 16 bytes per 4 pixels (12 used), so keep 2 pixels after the last step
+    int last = step == 4 ? count - 16 : count - 18;
+    int i = 0;
+    for (; i <= last; i += 16)
+    {
+        __m256i yws = _mm256_add_epi16(_mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + i))), 4), yBias);
+        __m256i crw = _mm256_slli_epi16(_mm256_cvtepi8_epi16(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(pcr + i)), signflip)), 8);
+        __m256i cbw = _mm256_slli_epi16(_mm256_cvtepi8_epi16(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(pcb + i)), signflip)), 8);
+        __m256i rws = _mm256_add_epi16(_mm256_mulhi_epi16(crConst0, crw), yws);
+        __m256i gws = _mm256_add_epi16(_mm256_add_epi16(_mm256_mulhi_epi16(cbConst0, cbw), yws), _mm256_mulhi_epi16(crw, crConst1));
+        __m256i bws = _mm256_add_epi16(yws, _mm256_mulhi_epi16(cbw, cbConst1));
+        // per lane: r and b, g and 255 for 8 pixels, interleaved to RGBA
+        __m256i brb = _mm256_packus_epi16(_mm256_srai_epi16(rws, 4), _mm256_srai_epi16(bws, 4));
+        __m256i gxb = _mm256_packus_epi16(_mm256_srai_epi16(gws, 4), alpha);
+        __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+        __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+        __m256i o0 = _mm256_unpacklo_epi16(t0, t1);     // pixels 0..3 | 8..11
+        __m256i o1 = _mm256_unpackhi_epi16(t0, t1);     // pixels 4..7 | 12..15
+        if (step == 4)
+        {
+            _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_permute2x128_si256(o0, o1, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + i * 4 + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+        }
+        else
+        {
+            __m256i rgb0 = _mm256_shuffle_epi8(o0, dropX);
+            __m256i rgb1 = _mm256_shuffle_epi8(o1, dropX);
+            uint8_t* o = out + i * 3;
+            _mm_storeu_si128((__m128i*)o, _mm256_castsi256_si128(rgb0));
+            _mm_storeu_si128((__m128i*)(o + 12), _mm256_castsi256_si128(rgb1));
+            _mm_storeu_si128((__m128i*)(o + 24), _mm256_extracti128_si256(rgb0, 1));
+            _mm_storeu_si128((__m128i*)(o + 36), _mm256_extracti128_si256(rgb1, 1));
+        }
+    }
+    return i;
+}
+#endif
+
+inline void ycbcrRow(JpegKernel kernel, uint8_t* out, const uint8_t* y, const uint8_t* cb, const uint8_t* cr, int count, int step)
+{
+    int done = 0;
+#if defined(JPEGDECODE_HAVE_AVX2_PATH)
+    if (kernel == JPEG_KERNEL_AVX2)
+        done = ycbcrAVX2(out, y, cb, cr, count, step);
+#endif
+#if defined(__SSE2__)
+    if (kernel == JPEG_KERNEL_SSE2 && step == 4)
+        done = ycbcrSSE2(out, y, cb, cr, count);
+#endif
+    ycbcrScalar(out, y, cb, cr, done, count, step);
+}
+
+inline uint8_t computeY(int r, int g, int b)
+{
+    return (uint8_t)((r * 77 + g * 150 + 29 * b) >> 8);
+}
+
+// Chroma upsampling, stb_image's filters: how a component's samples become output pixels
+enum Resample {
+    RESAMPLE_1,         // full resolution, the plane row is used as is
+    RESAMPLE_V2,        // 2x vertically
+    RESAMPLE_H2,        // 2x horizontally
+    RESAMPLE_HV2,       // 2x both ways (4:2:0)
+    RESAMPLE_GENERIC    // other factors, nearest
+};
+
+#define JPEG_DIV4(x) ((uint8_t)((x) >> 2))
+#define JPEG_DIV16(x) ((uint8_t)((x) >> 4))
+
+inline const uint8_t* resampleV2(uint8_t* out, const uint8_t* near, const uint8_t* far, int w)
+{
+    for (int i = 0; i < w; i++)
+        out[i] = JPEG_DIV4(3 * near[i] + far[i] + 2);
+    return out;
+}
+
+inline const uint8_t* resampleH2(uint8_t* out, const uint8_t* in, int w)
+{
+    if (w == 1)
+    {
+        out[0] = out[1] = in[0];
+        return out;
+    }
+    out[0] = in[0];
+    out[1] = JPEG_DIV4(in[0] * 3 + in[1] + 2);
+    int i;
+    for (i = 1; i < w - 1; i++)
+    {
+        int n = 3 * in[i] + 2;
+        out[i * 2 + 0] = JPEG_DIV4(n + in[i - 1]);
+        out[i * 2 + 1] = JPEG_DIV4(n + in[i + 1]);
+    }
+    out[i * 2 + 0] = JPEG_DIV4(in[w - 2] * 3 + in[w - 1] + 2);
+    out[i * 2 + 1] = in[w - 1];
+    return out;
+}
+
+inline const uint8_t* resampleHV2(JpegKernel kernel, uint8_t* out, const uint8_t* near, const uint8_t* far, int w)
+{
+    if (w == 1)
+    {
+        out[0] = out[1] = JPEG_DIV4(3 * near[0] + far[0] + 2);
+        return out;
+    }
+    int i = 0;
+    int t1 = 3 * near[0] + far[0];
+#if defined(__SSE2__)
+    // stb_image's SSE2 filter, 8 input pixels per step; the last one needs the edge case below
+    if (kernel != JPEG_KERNEL_SCALAR)
+    {
+        for (; i < ((w - 1) & ~7); i += 8)
+        {
+            __m128i zero = _mm_setzero_si128();
+            __m128i farw = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(far + i)), zero);
+            __m128i nearw = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(near + i)), zero);
+            // 3 * near + far = 4 * near + (far - near)
+            __m128i curr = _mm_add_epi16(_mm_slli_epi16(nearw, 2), _mm_sub_epi16(farw, nearw));
+            __m128i prev = _mm_insert_epi16(_mm_slli_si128(curr, 2), t1, 0);
+            __m128i next = _mm_insert_epi16(_mm_srli_si128(curr, 2), 3 * near[i + 8] + far[i + 8], 7);
+            // even = 3 * curr + prev, odd = 3 * curr + next, plus rounding
+            __m128i curb = _mm_add_epi16(_mm_slli_epi16(curr, 2), _mm_set1_epi16(8));
+            __m128i even = _mm_add_epi16(_mm_sub_epi16(prev, curr), curb);
+            __m128i odd = _mm_add_epi16(_mm_sub_epi16(next, curr), curb);
+            __m128i de0 = _mm_srli_epi16(_mm_unpacklo_epi16(even, odd), 4);
+            __m128i de1 = _mm_srli_epi16(_mm_unpackhi_epi16(even, odd), 4);
+            _mm_storeu_si128((__m128i*)(out + i * 2), _mm_packus_epi16(de0, de1));
+            t1 = 3 * near[i + 7] + far[i + 7];
+        }
+        int t0 = t1;
+        t1 = 3 * near[i] + far[i];
+        out[i * 2] = JPEG_DIV16(3 * t1 + t0 + 8);
+        i++;
+    }
+    else
+#endif
+    {
+        (void)kernel;
+        out[0] = JPEG_DIV4(t1 + 2);
+        i = 1;
+    }
+    for (; i < w; i++)
+    {
+        int t0 = t1;
+        t1 = 3 * near[i] + far[i];
+        out[i * 2 - 1] = JPEG_DIV16(3 * t0 + t1 + 8);
+        out[i * 2] = JPEG_DIV16(3 * t1 + t0 + 8);
+    }
+    out[w * 2 - 1] = JPEG_DIV4(t1 + 2);
+    return out;
+}
+
+#undef JPEG_DIV4
+#undef JPEG_DIV16
+
+inline const uint8_t* resampleGeneric(uint8_t* out, const uint8_t* in, int w, int hs)
+{
+    for (int i = 0; i < w; i++)
+        for (int j = 0; j < hs; j++)
+            out[i * hs + j] = in[i];
+    return out;
+}
+
+// Bounds checked big endian reads over the marker segments
+struct ByteReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+
+    ByteReader(const uint8_t* begin, const uint8_t* end) : p(begin), end(end), ok(true) {}
+
+    int get8(){
+        if (p == end)
+        {
+            ok = false;
+            return 0;
+        }
+        return *p++;
+    }
+    int get16(){
+        int hi = get8();
+        return (hi << 8) | get8();
+    }
+    void skip(int n){
+        if (n < 0 || end - p < n)
+        {
+            ok = false;
+            p = end;
+        }
+        else
+            p += n;
+    }
+    // the next marker code, -1 if there is none here
+    int marker(){
+        if (get8() != 0xFF)
+            return -1;
+        int m = get8();
+        while (m == 0xFF && ok)
+            m = get8();
+        return ok ? m : -1;
+    }
+};
+
+struct Component {
+    int id;
+    int h, v;           // sampling factors
+    int tq;             // quantization table
+    int hd, ha;         // Huffman tables of the current scan
+    int x, y;           // samples holding image data
+    int w2, h2;         // plane size, whole MCUs
+    uint8_t* plane;
+    bool decoded;
+};
+
+struct Frame {
+    Huffman dc[4];
+    Huffman ac[4];
+    uint16_t dequant[4][64];
+    bool dequantDefined[4];
+    Component comp[4];
+    int count;              // 0 until the frame header
+    int width, height;
+    int hmax, vmax;
+    int mcuX, mcuY;
+    int restartInterval;    // MCUs, 0 for none
+    bool jfif;
+    int app14Transform;     // -1 without an Adobe segment
+    int rgbIds;             // components named 'R', 'G', 'B'
+};
+
+struct Scan {
+    int count;
+    int order[4];
+    int units;              // MCUs, or blocks of the one component
+    int unitsX;
+    int perInterval;
+    std::vector<const uint8_t*> begin;      // entropy coded bytes of each restart interval
+    std::vector<const uint8_t*> end;
+};
+
+inline bool readDQT(ByteReader& r, Frame& f)
+{
+    int length = r.get16() - 2;
+    while (length > 0 && r.ok)
+    {
+        int q = r.get8();
+        int precision = q >> 4, t = q & 15;
+        if (precision > 1 || t > 3)
+            return false;
+        for (int i = 0; i < 64; i++)
+            f.dequant[t][dezigzag[i]] = (uint16_t)(precision ? r.get16() : r.get8());
+        f.dequantDefined[t] = true;
+        length -= precision ? 129 : 65;
+    }
+    return length == 0 && r.ok;
+}
+
+inline bool readDHT(ByteReader& r, Frame& f)
+{
+    int length = r.get16() - 2;
+    while (length > 0 && r.ok)
+    {
+        int q = r.get8();
+        int tc = q >> 4, th = q & 15;
+        if (tc > 1 || th > 3)
+            return false;
+        int sizes[16], n = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            sizes[i] = r.get8();
+            n += sizes[i];
+        }
+        if (n > 256)
+            return false;
+        Huffman& h = tc ? f.ac[th] : f.dc[th];
+        if (!buildHuffman(h, sizes))
+            return false;
+        for (int i = 0; i < n; i++)
+            h.values[i] = (uint8_t)r.get8();
+        if (tc)
+            buildFastAc(h);
+        h.defined = true;
+        length -= 17 + n;
+    }
+    return length == 0 && r.ok;
+}
+
+// APPn and COM: only JFIF and Adobe's color transform matter
+inline bool readAPP(ByteReader& r, Frame& f, int m)
+{
+    int length = r.get16();
+    if (length < 2)
+        return false;
+    length -= 2;
+    if (r.end - r.p < length)
+        return false;
+    const uint8_t* next = r.p + length;
+    if (m == 0xE0 && length >= 5)
+    {
+        static const uint8_t tag[5] = {'J', 'F', 'I', 'F', 0};
+        bool ok = true;
+        for (int i = 0; i < 5; i++)
+            ok = (r.get8() == tag[i]) && ok;
+        if (ok)
+            f.jfif = true;
+    }
+    else if (m == 0xEE && length >= 12)
+    {
+        static const uint8_t tag[6] = {'A', 'd', 'o', 'b', 'e', 0};
+        bool ok = true;
+        for (int i = 0; i < 6; i++)
+            ok = (r.get8() == tag[i]) && ok;
+        if (ok)
+        {
+            r.skip(5);      // version, flags0, flags1
+            f.app14Transform = r.get8();
+        }
+    }
+    r.p = next;
+    return r.ok;
+}
+
+inline bool readSOF(ByteReader& r, Frame& f)
+{
+    int length = r.get16();
+    if (length < 11 || r.get8() != 8)
+        return false;
+    f.height = r.get16();
+    f.width = r.get16();
+    f.count = r.get8();
+    if (!r.ok || f.height == 0 || f.width == 0 || (f.count != 1 && f.count != 3) || length != 8 + 3 * f.count)
+        return false;
+    f.rgbIds = 0;
+    f.hmax = f.vmax = 1;
+    for (int i = 0; i < f.count; i++)
+    {
+        Component& c = f.comp[i];
+        c.id = r.get8();
+        if (f.count == 3 && c.id == "RGB"[i])
+            f.rgbIds++;
+        int q = r.get8();
+        c.h = q >> 4;
+        c.v = q & 15;
+        c.tq = r.get8();
+        if (c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4 || c.tq > 3)
+            return false;
+        f.hmax = std::max(f.hmax, c.h);
+        f.vmax = std::max(f.vmax, c.v);
+    }
+    f.mcuX = (f.width + f.hmax * 8 - 1) / (f.hmax * 8);
+    f.mcuY = (f.height + f.vmax * 8 - 1) / (f.vmax * 8);
+    uint64_t samples = 0;
+    for (int i = 0; i < f.count; i++)
+    {
+        Component& c = f.comp[i];
+        // upsampling factors must be whole
+        if (f.hmax % c.h || f.vmax % c.v)
+            return false;
+        c.x = (f.width * c.h + f.hmax - 1) / f.hmax;
+        c.y = (f.height * c.v + f.vmax - 1) / f.vmax;
+        c.w2 = f.mcuX * c.h * 8;
+        c.h2 = f.mcuY * c.v * 8;
+        c.decoded = false;
+        samples += (uint64_t)c.w2 * c.h2;
+    }
+    return r.ok && samples < (1u << 31) && (uint64_t)f.width * f.height * 4 < (1u << 31);
+}
+
+inline bool readSOS(ByteReader& r, Frame& f, Scan& s)
+{
+    int length = r.get16();
+    s.count = r.get8();
+    if (s.count < 1 || s.count > f.count || length != 6 + 2 * s.count)
+        return false;
+    for (int i = 0; i < s.count; i++)
+    {
+        int id = r.get8();
+        int q = r.get8();
+        int which = 0;
+        while (which < f.count && f.comp[which].id != id)
+            which++;
+        if (which == f.count)
+            return false;
+        Component& c = f.comp[which];
+        c.hd = q >> 4;
+        c.ha = q & 15;
+        // every table used must be defined, every component decoded once
+        if (c.hd > 3 || c.ha > 3 || !f.dc[c.hd].defined || !f.ac[c.ha].defined || !f.dequantDefined[c.tq] || c.decoded)
+            return false;
+        c.decoded = true;
+        s.order[i] = which;
+    }
+    int specStart = r.get8();
+    r.get8();       // spectral end, 63 in baseline
+    int approximation = r.get8();
+    if (!r.ok || specStart != 0 || approximation != 0)
+        return false;
+
+    if (s.count == 1)
+    {
+        const Component& c = f.comp[s.order[0]];
+        s.unitsX = (c.x + 7) >> 3;
+        s.units = s.unitsX * ((c.y + 7) >> 3);
+    }
+    else
+    {
+        s.unitsX = f.mcuX;
+        s.units = f.mcuX * f.mcuY;
+    }
+    s.perInterval = f.restartInterval ? f.restartInterval : s.units;
+    return true;
+}
+
+/**
+ * Split the entropy coded data at p into restart intervals; next gets the
+ * marker that ends the scan. A 0xFF in the data is followed by a stuffed
+ * 00 (after optional fill bytes), anything else is a marker.
+ */
+inline bool findIntervals(const uint8_t* p, const uint8_t* end, Scan& s, const uint8_t*& next)
+{
+    const uint8_t* start = p;
+    s.begin.clear();
+    s.end.clear();
+    for (;;)
+    {
+        const uint8_t* ff = (const uint8_t*)memchr(p, 0xFF, end - p);
+        if (!ff)
+            return false;
+        const uint8_t* q = ff + 1;
+        while (q < end && *q == 0xFF)
+            q++;
+        if (q == end)
+            return false;
+        if (*q == 0)
+        {
+            p = q + 1;
+            continue;
+        }
+        s.begin.push_back(start);
+        s.end.push_back(ff);
+        if (*q >= 0xD0 && *q <= 0xD7)
+        {
+            start = p = q + 1;
+            continue;
+        }
+        next = ff;
+        return (int)s.begin.size() == (s.units + s.perInterval - 1) / s.perInterval;
+    }
+}
+
+// Units of one restart interval, through the IDCT into the planes
+inline bool decodeInterval(const Frame& f, const Scan& s, size_t interval, JpegKernel kernel)
+{
+    BitReader bits(s.begin[interval], s.end[interval]);
+    BlockSink sink(kernel);
+    int dcPred[4] = {0, 0, 0, 0};
+    int first = (int)interval * s.perInterval;
+    int last = std::min(s.units, first + s.perInterval);
+    for (int unit = first; unit < last; unit++)
+    {
+        int i = unit % s.unitsX, j = unit / s.unitsX;
+        if (s.count == 1)
+        {
+            int n = s.order[0];
+            const Component& c = f.comp[n];
+            if (!decodeBlock(bits, sink.Block(), f.dc[c.hd], f.ac[c.ha], dcPred[n], f.dequant[c.tq]))
+                return false;
+            sink.Add(c.plane + (size_t)c.w2 * j * 8 + i * 8, c.w2);
+            continue;
+        }
+        for (int k = 0; k < s.count; k++)
+        {
+            int n = s.order[k];
+            const Component& c = f.comp[n];
+            for (int y = 0; y < c.v; y++)
+            {
+                for (int x = 0; x < c.h; x++)
+                {
+                    if (!decodeBlock(bits, sink.Block(), f.dc[c.hd], f.ac[c.ha], dcPred[n], f.dequant[c.tq]))
+                        return false;
+                    sink.Add(c.plane + (size_t)c.w2 * (j * c.v + y) * 8 + (i * c.h + x) * 8, c.w2);
+                }
+            }
+        }
+    }
+    sink.Flush();
+    // stb_image reads on to the marker after each interval and gives up on the scan if it is not there
+    if (bits.bits < 24)
+        bits.fill();
+    return bits.stopped;
+}
+
+// How one component's plane rows map to output rows
+struct ComponentRows {
+    Resample resample;
+    int hs;
+    int wLores;                 // plane samples per output row
+    std::vector<int> nearRow;   // per output row
+    std::vector<int> farRow;
+};
+
+// stb_image's stepping through the plane rows, replayed once up front so that any band of rows can be converted
+inline void planRows(const Frame& f, const Component& c, ComponentRows& rows)
+{
+    rows.hs = f.hmax / c.h;
+    int vs = f.vmax / c.v;
+    rows.wLores = (f.width + rows.hs - 1) / rows.hs;
+    if (rows.hs == 1 && vs == 1)
+        rows.resample = RESAMPLE_1;
+    else if (rows.hs == 1 && vs == 2)
+        rows.resample = RESAMPLE_V2;
+    else if (rows.hs == 2 && vs == 1)
+        rows.resample = RESAMPLE_H2;
+    else if (rows.hs == 2 && vs == 2)
+        rows.resample = RESAMPLE_HV2;
+    else
+        rows.resample = RESAMPLE_GENERIC;
+
+    rows.nearRow.resize(f.height);
+    rows.farRow.resize(f.height);
+    int ystep = vs >> 1, ypos = 0, line0 = 0, line1 = 0;
+    for (int j = 0; j < f.height; j++)
+    {
+        bool bottom = ystep >= (vs >> 1);
+        rows.nearRow[j] = bottom ? line1 : line0;
+        rows.farRow[j] = bottom ? line0 : line1;
+        if (++ystep >= vs)
+        {
+            ystep = 0;
+            line0 = line1;
+            if (++ypos < c.y)
+                line1++;
+        }
+    }
+}
+
+inline const uint8_t* resampleRow(JpegKernel kernel, const ComponentRows& rows, const Component& c, uint8_t* line, int j)
+{
+    const uint8_t* near = c.plane + (size_t)rows.nearRow[j] * c.w2;
+    const uint8_t* far = c.plane + (size_t)rows.farRow[j] * c.w2;
+    switch (rows.resample)
+    {
+        case RESAMPLE_1: return near;
+        case RESAMPLE_V2: return resampleV2(line, near, far, rows.wLores);
+        case RESAMPLE_H2: return resampleH2(line, near, rows.wLores);
+        case RESAMPLE_HV2: return resampleHV2(kernel, line, near, far, rows.wLores);
+        case RESAMPLE_GENERIC: return resampleGeneric(line, near, rows.wLores, rows.hs);
+    }
+    return near;
+}
+
+} // namespace jpeg_detail
+
+/**
+ * @brief      Whether this CPU (and build) can run a kernel
+ */
+inline bool JpegKernelSupported(JpegKernel kernel)
+{
+    switch (kernel)
+    {
+        case JPEG_KERNEL_SCALAR:
+            return true;
+        case JPEG_KERNEL_SSE2:
+#if defined(__SSE2__)
+            return true;
+#else
+            return false;
+#endif
+        case JPEG_KERNEL_AVX2:
+#if defined(JPEGDECODE_HAVE_AVX2_PATH)
+            return jpeg_detail::cpuHasAVX2();
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+/**
+ * @brief      The widest kernel this CPU runs
+ */
+inline JpegKernel BestJpegKernel()
+{
+    static const JpegKernel best = JpegKernelSupported(JPEG_KERNEL_AVX2) ? JPEG_KERNEL_AVX2
+                                 : JpegKernelSupported(JPEG_KERNEL_SSE2) ? JPEG_KERNEL_SSE2
+                                 : JPEG_KERNEL_SCALAR;
+    return best;
+}
+
+inline const char* JpegKernelName(JpegKernel kernel)
+{
+    switch (kernel)
+    {
+        case JPEG_KERNEL_SCALAR: return "scalar";
+        case JPEG_KERNEL_SSE2: return "SSE2";
+        case JPEG_KERNEL_AVX2: return "AVX2";
+    }
+    return "?";
+}
+
+class JpegDecoder
+{
+public:
+
+    /**
+     * @param      threads  pool size, the calling thread included; 0 picks the hardware concurrency
+     * @param      kernel   an unsupported kernel falls back to the best one
+     */
+    explicit JpegDecoder(unsigned int threads = 0, JpegKernel kernel = BestJpegKernel())
+        : kernel(JpegKernelSupported(kernel) ? kernel : BestJpegKernel()),
+          pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()), "jpeg") {}
+
+    JpegDecoder(const JpegDecoder&) = delete;
+    JpegDecoder& operator=(const JpegDecoder&) = delete;
+
+    unsigned int Threads() const { return pool.Size(); }
+    JpegKernel Kernel() const { return kernel; }
+
+    /**
+     * @brief      Decode a JPEG in memory, with stbi_load_from_memory's channel rules
+     *
+     * Safe to call from several threads; while one decode has the pool
+     * the others run on their calling thread.
+     *
+     * @param      desiredChannels  0 keeps the file's (1 or 3)
+     * @param      channels         the file's channel count, like stb's comp
+     * @param      pixels           width * height * (desiredChannels or channels) bytes,
+     *                              released with free()
+     *
+     * @return     false if the data is not a JPEG this decoder handles
+     */
+    bool Decode(const unsigned char* bytes, size_t size, int desiredChannels,
+                int& width, int& height, int& channels, unsigned char*& pixels){
+        TRACE_FUNCTION();
+        using namespace jpeg_detail;
+        pixels = NULL;
+        if (desiredChannels < 0 || desiredChannels > 4 || size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8)
+            return false;
+
+        std::unique_ptr<Frame> frame(new Frame());
+        Frame& f = *frame;
+        f.app14Transform = -1;
+        std::unique_ptr<uint8_t[]> planes;
+        bool parallel = false;
+        Scan scan;
+
+        ByteReader r(bytes + 2, bytes + size);
+        for (;;)
+        {
+            int m = r.marker();
+            if (m == 0xD9)              // EOI
+                break;
+            bool ok;
+            if (m == 0xDB)
+                ok = readDQT(r, f);
+            else if (m == 0xC4)
+                ok = readDHT(r, f);
+            else if (m == 0xDD)
+                ok = r.get16() == 4 && ((f.restartInterval = r.get16()), r.ok);
+            else if ((m >= 0xE0 && m <= 0xEF) || m == 0xFE)
+                ok = readAPP(r, f, m);
+            else if ((m == 0xC0 || m == 0xC1) && f.count == 0)
+            {
+                ok = readSOF(r, f);
+                if (ok)
+                {
+                    size_t total = 0;
+                    for (int i = 0; i < f.count; i++)
+                        total += (size_t)f.comp[i].w2 * f.comp[i].h2;
+                    planes.reset(new uint8_t[total]);
+                    uint8_t* plane = planes.get();
+                    for (int i = 0; i < f.count; i++)
+                    {
+                        f.comp[i].plane = plane;
+                        plane += (size_t)f.comp[i].w2 * f.comp[i].h2;
+                    }
+                    parallel = (size_t)f.width * f.height >= PARALLEL_MIN_PIXELS;
+                }
+            }
+            else if (m == 0xDA && f.count)
+            {
+                const uint8_t* next = NULL;
+                ok = readSOS(r, f, scan) && findIntervals(r.p, r.end, scan, next) && decodeScan(f, scan, parallel);
+                r.p = next;
+            }
+            else
+                ok = false;             // progressive, arithmetic, DNL, unknown or out of order
+            if (!ok)
+                return false;
+        }
+        for (int i = 0; i < f.count; i++)
+            if (!f.comp[i].decoded)
+                return false;
+        if (f.count == 0)
+            return false;
+
+        width = f.width;
+        height = f.height;
+        channels = f.count >= 3 ? 3 : 1;
+        int n = desiredChannels ? desiredChannels : channels;
+        pixels = (unsigned char*)malloc((size_t)n * f.width * f.height);
+        if (!pixels)
+            return false;
+        convert(f, n, parallel, pixels);
+        return true;
+    }
+
+private:
+
+    JpegKernel kernel;
+    WorkerPool pool;
+    std::mutex poolLock;
+
+    // job on every pool thread when the pool is free and the work is big enough, on the caller alone otherwise
+    void run(bool parallel, const std::function<void(unsigned int)>& job){
+        if (parallel && pool.Size() > 1)
+        {
+            std::unique_lock<std::mutex> guard(poolLock, std::try_to_lock);
+            if (guard.owns_lock())
+            {
+                pool.Run(job);
+                return;
+            }
+        }
+        job(0);
+    }
+
+    bool decodeScan(const jpeg_detail::Frame& f, const jpeg_detail::Scan& s, bool parallel){
+        TRACE_SCOPE("JpegDecoder::decodeScan");
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        run(parallel && s.begin.size() > 1, [&](unsigned int) {
+            for (size_t i = next++; i < s.begin.size() && !failed; i = next++)
+                if (!jpeg_detail::decodeInterval(f, s, i, kernel))
+                    failed = true;
+        });
+        return !failed;
+    }
+
+    // Upsampling and color conversion, stb_image's load_jpeg_image over bands of rows
+    void convert(const jpeg_detail::Frame& f, int n, bool parallel, unsigned char* pixels){
+        TRACE_SCOPE("JpegDecoder::convert");
+        using namespace jpeg_detail;
+        bool isRgb = f.count == 3 && (f.rgbIds == 3 || (f.app14Transform == 0 && !f.jfif));
+        // grey output from YCbCr only needs Y
+        int decodeN = f.count == 3 && n < 3 && !isRgb ? 1 : f.count;
+        ComponentRows rows[3];
+        for (int k = 0; k < decodeN; k++)
+            planRows(f, f.comp[k], rows[k]);
+
+        // per thread line buffers, wide enough for 4x upsampling past the edge
+        size_t lineStride = (size_t)f.width + 16;
+        std::vector<uint8_t> lines(lineStride * decodeN * pool.Size());
+        int bands = (f.height + BAND_ROWS - 1) / BAND_ROWS;
+        std::atomic<int> nextBand(0);
+        JpegKernel k = kernel;
+        run(parallel && bands > 1, [&](unsigned int worker) {
+            uint8_t* line = lines.data() + lineStride * decodeN * worker;
+            const uint8_t* rowData[3];
+            for (int band = nextBand++; band < bands; band = nextBand++)
+            {
+                int end = std::min(f.height, (band + 1) * BAND_ROWS);
+                for (int j = band * BAND_ROWS; j < end; j++)
+                {
+                    for (int c = 0; c < decodeN; c++)
+                        rowData[c] = resampleRow(k, rows[c], f.comp[c], line + lineStride * c, j);
+                    convertRow(f, n, isRgb, rowData, pixels + (size_t)n * f.width * j);
+                }
+            }
+        });
+    }
+
+    void convertRow(const jpeg_detail::Frame& f, int n, bool isRgb, const uint8_t* const* c, uint8_t* out) const {
+        using namespace jpeg_detail;
+        const uint8_t* y = c[0];
+        int w = f.width;
+        if (n >= 3)
+        {
+            if (f.count == 3 && !isRgb)
+                ycbcrRow(kernel, out, y, c[1], c[2], w, n);
+            else if (f.count == 3)
+            {
+                for (int i = 0; i < w; i++, out += n)
+                {
+                    out[0] = y[i];
+                    out[1] = c[1][i];
+                    out[2] = c[2][i];
+                    if (n == 4)
+                        out[3] = 255;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < w; i++, out += n)
+                {
+                    out[0] = out[1] = out[2] = y[i];
+                    if (n == 4)
+                        out[3] = 255;
+                }
+            }
+        }
+        else if (isRgb)
+        {
+            for (int i = 0; i < w; i++, out += n)
+            {
+                out[0] = computeY(y[i], c[1][i], c[2][i]);
+                if (n == 2)
+                    out[1] = 255;
+            }
+        }
+        else if (n == 1)
+            memcpy(out, y, w);
+        else
+        {
+            for (int i = 0; i < w; i++, out += 2)
+            {
+                out[0] = y[i];
+                out[1] = 255;
+            }
+        }
+    }
+};
+#endif
@@ -0,0 +1,109 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <iostream>
+
+/**
+ * Read-only memory mapping of a whole file.
+ *
+ * The mapping lives as long as the object, so pointers handed out by
+ * data() can be passed straight to glTexImage2D and friends without an
+ * intermediate copy. Open() takes an madvise() hint for the access
+ * pattern; Prefetch() starts paging in a range before it is touched.
+ */
+class MappedFile
+{
+public:
+
+	MappedFile() : ptr(NULL), length(0) {}
+	~MappedFile(){
+		Close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief      Map the file at path
+	 *
+	 * @param      path    the file to map
+	 * @param      advice  madvise() hint for the whole mapping, e.g.
+	 *                     MADV_SEQUENTIAL for a file read front to back
+	 *
+	 * @return     true on success
+	 */
+	bool Open(const char* path, int advice = MADV_NORMAL){
+		Close();
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+		{
+			std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+			return false;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			std::cout << "ERROR::MAPPED_FILE::EMPTY_OR_UNREADABLE " << path << std::endl;
+			close(fd);
+			return false;
+		}
+		void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// the mapping keeps its own reference to the file
+		close(fd);
+		if (p == MAP_FAILED)
+		{
+			std::cout << "ERROR::MAPPED_FILE::MMAP_FAILED " << path << std::endl;
+			return false;
+		}
+		ptr = (const unsigned char*)p;
+		length = (size_t)st.st_size;
+		if (advice != MADV_NORMAL)
+			madvise(p, length, advice);
+		return true;
+	}
+
+	/**
+	 * @brief      Ask the kernel to read a range ahead (MADV_WILLNEED)
+	 *
+	 * @param      offset  start of the range in the file
+	 * @param      count   bytes, clamped to the end of the file
+	 */
+	void Prefetch(size_t offset, size_t count) const {
+		if (!ptr || offset >= length)
+			return;
+		if (count > length - offset)
+			count = length - offset;
+		// madvise wants a page aligned start
+		size_t page = (size_t)sysconf(_SC_PAGESIZE);
+		size_t start = offset & ~(page - 1);
+		madvise((void*)(ptr + start), count + (offset - start), MADV_WILLNEED);
+	}
+
+	/**
+	 * @brief      Release the mapping, if any
+	 */
+	void Close(){
+		if (ptr)
+		{
+			munmap((void*)ptr, length);
+			ptr = NULL;
+			length = 0;
+		}
+	}
+
+	const unsigned char* data() const { return ptr; }
+	size_t size() const { return length; }
+	bool isOpen() const { return ptr != NULL; }
+
+private:
+
+	const unsigned char* ptr;
+	size_t length;
+};
+#endif
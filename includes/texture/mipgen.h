@@ -0,0 +1,305 @@
+#ifndef MIPGEN_H
+#define MIPGEN_H
+
+#include <texture/texpack.h>
+#include <profiling/trace.h>
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIPGEN_HAVE_AVX2_PATH 1
+#endif
+
+/**
+ * CPU mip chain generation
+ *
+ * Levels are filtered in linear light: sRGB input is decoded to float
+ * once, every level is downsampled from the previous float level and only
+ * the stored result is re-encoded to 8 bits. Alpha is always treated as
+ * linear. Texels are kept as 4 floats internally so one texel is one SSE
+ * register; the box filter also has an AVX2 path picked at runtime.
+ */
+
+enum MipFilter {
+    MIP_FILTER_BOX,     // 2x2 average
+    MIP_FILTER_KAISER   // 8 tap Kaiser windowed sinc, sharper minification
+};
+
+namespace mipgen_detail {
+
+struct FloatImage {
+    unsigned int width;
+    unsigned int height;
+    std::vector<float> texels;     // RGBA, 4 floats per texel
+
+    float* row(unsigned int y) { return &texels[(size_t)y * width * 4]; }
+    const float* row(unsigned int y) const { return &texels[(size_t)y * width * 4]; }
+};
+
+// Conversion tables, built once (thread safe static init, workers share them)
+struct SrgbTables {
+    float toLinear[256];
+    unsigned char toSrgb[4096];     // indexed by linear value, plenty for 8 bit output
+
+    SrgbTables(){
+        for (int i = 0; i < 256; i++)
+        {
+            float c = i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < 4096; i++)
+        {
+            float l = i / 4095.0f;
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = (unsigned char)std::min(255.0f, std::max(0.0f, c * 255.0f + 0.5f));
+        }
+    }
+};
+
+inline const SrgbTables& srgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+inline FloatImage toFloat(const unsigned char* texels, unsigned int width, unsigned int height, unsigned int channels, bool srgb)
+{
+    const float* lut = srgbTables().toLinear;
+    FloatImage img;
+    img.width = width;
+    img.height = height;
+    img.texels.resize((size_t)width * height * 4);
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++)
+    {
+        float* dst = &img.texels[i * 4];
+        const unsigned char* src = texels + i * channels;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            unsigned char v = src[std::min(k, channels - 1)];
+            dst[k] = srgb ? lut[v] : v / 255.0f;
+        }
+        dst[3] = channels == 4 ? src[3] / 255.0f : 1.0f;
+    }
+    return img;
+}
+
+inline TexPackImage toBytes(const FloatImage& img, unsigned int channels, bool srgb)
+{
+    const unsigned char* lut = srgbTables().toSrgb;
+    TexPackImage out;
+    out.width = img.width;
+    out.height = img.height;
+    out.texels.resize((size_t)img.width * img.height * channels);
+    size_t count = (size_t)img.width * img.height;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* src = &img.texels[i * 4];
+        unsigned char* dst = &out.texels[i * channels];
+        for (unsigned int k = 0; k < channels; k++)
+        {
+            float v = std::min(1.0f, std::max(0.0f, src[k]));
+            if (srgb && k < 3)
+                dst[k] = lut[(int)(v * 4095.0f + 0.5f)];
+            else
+                dst[k] = (unsigned char)(v * 255.0f + 0.5f);
+        }
+    }
+    return out;
+}
+
+#if defined(MIPGEN_HAVE_AVX2_PATH)
+// Two destination texels per iteration; needs an even source width
+__attribute__((target("avx2")))
+inline unsigned int boxRowAVX2(const float* s0, const float* s1, float* d, unsigned int dstWidth)
+{
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    unsigned int x = 0;
+    for (; x + 2 <= dstWidth; x += 2)
+    {
+        // source texels t0..t3 = 2x .. 2x+3 of both rows (4 floats each), for destination texels x and x+1
+        __m256 a01 = _mm256_loadu_ps(s0 + x * 8);
+        __m256 a23 = _mm256_loadu_ps(s0 + x * 8 + 8);
+        __m256 b01 = _mm256_loadu_ps(s1 + x * 8);
+        __m256 b23 = _mm256_loadu_ps(s1 + x * 8 + 8);
+        __m256 r01 = _mm256_add_ps(a01, b01);
+        __m256 r23 = _mm256_add_ps(a23, b23);
+        // [t0,t2] + [t1,t3]
+        __m256 even = _mm256_permute2f128_ps(r01, r23, 0x20);
+        __m256 odd  = _mm256_permute2f128_ps(r01, r23, 0x31);
+        _mm256_storeu_ps(d + x * 4, _mm256_mul_ps(_mm256_add_ps(even, odd), quarter));
+    }
+    return x;
+}
+
+inline bool cpuHasAVX2()
+{
+    static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return has;
+}
+#endif
+
+inline FloatImage downsampleBox(const FloatImage& src)
+{
+    FloatImage dst;
+    dst.width  = src.width  > 1 ? src.width  / 2 : 1;
+    dst.height = src.height > 1 ? src.height / 2 : 1;
+    dst.texels.resize((size_t)dst.width * dst.height * 4);
+
+    for (unsigned int y = 0; y < dst.height; y++)
+    {
+        const float* s0 = src.row(std::min(y * 2, src.height - 1));
+        const float* s1 = src.row(std::min(y * 2 + 1, src.height - 1));
+        float* d = dst.row(y);
+        unsigned int x = 0;
+#if defined(MIPGEN_HAVE_AVX2_PATH)
+        if (src.width % 2 == 0 && cpuHasAVX2())
+            x = boxRowAVX2(s0, s1, d, dst.width);
+#endif
+        for (; x < dst.width; x++)
+        {
+            unsigned int x0 = std::min(x * 2, src.width - 1) * 4;
+            unsigned int x1 = std::min(x * 2 + 1, src.width - 1) * 4;
+#if defined(__SSE2__)
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(s0 + x0), _mm_loadu_ps(s0 + x1)),
+                                    _mm_add_ps(_mm_loadu_ps(s1 + x0), _mm_loadu_ps(s1 + x1)));
+            _mm_storeu_ps(d + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+            for (int k = 0; k < 4; k++)
+                d[x * 4 + k] = 0.25f * (s0[x0 + k] + s0[x1 + k] + s1[x0 + k] + s1[x1 + k]);
+#endif
+        }
+    }
+    return dst;
+}
+
+#define MIPGEN_KAISER_TAPS 8
+
+// zeroth order modified Bessel function of the first kind
+inline double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 20; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Weights for the source texels at offsets -3.5 .. +3.5 from the destination center
+struct KaiserKernel {
+    float w[MIPGEN_KAISER_TAPS];
+
+    KaiserKernel(){
+        const double alpha = 4.0;
+        const double pi = 3.14159265358979323846;
+        double total = 0.0;
+        for (int i = 0; i < MIPGEN_KAISER_TAPS; i++)
+        {
+            double d = i - (MIPGEN_KAISER_TAPS - 1) / 2.0;   // source offset in texels
+            double t = d / 2.0;                                // in destination texels
+            double sinc = t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t);
+            double r = d / (MIPGEN_KAISER_TAPS / 2.0);
+            double window = besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(alpha);
+            w[i] = (float)(sinc * window);
+            total += w[i];
+        }
+        for (int i = 0; i < MIPGEN_KAISER_TAPS; i++)
+            w[i] = (float)(w[i] / total);
+    }
+};
+
+inline const float* kaiserWeights()
+{
+    static const KaiserKernel kernel;
+    return kernel.w;
+}
+
+// Separable 2x downsample along x (horizontal=true) or y
+inline FloatImage downsampleKaiser1D(const FloatImage& src, bool horizontal)
+{
+    const float* w = kaiserWeights();
+    FloatImage dst;
+    dst.width  = horizontal ? std::max(1u, src.width / 2) : src.width;
+    dst.height = horizontal ? src.height : std::max(1u, src.height / 2);
+    dst.texels.resize((size_t)dst.width * dst.height * 4);
+    int srcLen = horizontal ? (int)src.width : (int)src.height;
+
+    for (unsigned int y = 0; y < dst.height; y++)
+    {
+        float* d = dst.row(y);
+        for (unsigned int x = 0; x < dst.width; x++)
+        {
+            int center = (int)(horizontal ? x : y) * 2 - (MIPGEN_KAISER_TAPS / 2 - 1);
+#if defined(__SSE2__)
+            __m128 acc = _mm_setzero_ps();
+#else
+            float acc[4] = {0, 0, 0, 0};
+#endif
+            for (int t = 0; t < MIPGEN_KAISER_TAPS; t++)
+            {
+                int s = std::min(srcLen - 1, std::max(0, center + t));
+                const float* p = horizontal ? src.row(y) + (size_t)s * 4 : src.row(s) + (size_t)x * 4;
+#if defined(__SSE2__)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(w[t])));
+#else
+                for (int k = 0; k < 4; k++)
+                    acc[k] += p[k] * w[t];
+#endif
+            }
+#if defined(__SSE2__)
+            _mm_storeu_ps(d + x * 4, acc);
+#else
+            for (int k = 0; k < 4; k++)
+                d[x * 4 + k] = acc[k];
+#endif
+        }
+    }
+    return dst;
+}
+
+} // namespace mipgen_detail
+
+/**
+ * @brief      Build the full mip chain of an 8 bit image
+ *
+ * @param      texels    width * height * channels bytes, channels is 3 or 4
+ * @param      filter    box or Kaiser
+ * @param      srgb      color channels are sRGB encoded: filter in linear light
+ *
+ * @return     level 0 (a copy of the input) down to 1x1
+ */
+inline std::vector<TexPackImage> GenerateMipChain(const unsigned char* texels, unsigned int width, unsigned int height,
+                                                  unsigned int channels, MipFilter filter, bool srgb)
+{
+    TRACE_FUNCTION();
+    using namespace mipgen_detail;
+    std::vector<TexPackImage> levels(1);
+    levels[0].width = width;
+    levels[0].height = height;
+    levels[0].texels.assign(texels, texels + (size_t)width * height * channels);
+
+    FloatImage current = toFloat(texels, width, height, channels, srgb);
+    while (current.width > 1 || current.height > 1)
+    {
+        if (filter == MIP_FILTER_KAISER)
+        {
+            if (current.width > 1)
+                current = downsampleKaiser1D(current, true);
+            if (current.height > 1)
+                current = downsampleKaiser1D(current, false);
+        }
+        else
+            current = downsampleBox(current);
+        levels.push_back(toBytes(current, channels, srgb));
+    }
+    return levels;
+}
+#endif
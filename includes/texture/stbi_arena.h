@@ -0,0 +1,248 @@
+#ifndef STBI_ARENA_H
+#define STBI_ARENA_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+/**
+ * Per-thread bump allocator behind stb_image's STBI_MALLOC/STBI_REALLOC/STBI_FREE
+ *
+ * Include this before the STB_IMAGE_IMPLEMENTATION include of a sample:
+ *
+ *     #include <texture/stbi_arena.h>
+ *     #define STB_IMAGE_IMPLEMENTATION
+ *     #include <stb_image.h>
+ *
+ * While a StbiArenaScope is alive on a thread, every allocation stb makes
+ * on that thread (decode scratch and the output pixels) is bump allocated
+ * from the thread's arena and frees are no-ops; when the scope closes the
+ * arena is rewound in one step. Arena blocks are kept for the next scope,
+ * so after the first image a bulk load does no malloc/free at all. Pixels
+ * decoded inside a scope must be consumed (uploaded, copied into a mip
+ * chain...) before the scope ends.
+ *
+ * Outside a scope allocations go to the heap as usual.
+ */
+
+// Snapshot of the allocation counters, summed over all threads
+struct StbiAllocStats {
+    uint64_t arenaAllocs;       // bump allocations
+    uint64_t arenaBytes;
+    uint64_t arenaBlocks;       // blocks the arenas had to malloc (warm up)
+    uint64_t heapAllocs;        // allocations made outside a scope
+    uint64_t heapFrees;
+    uint64_t resets;            // scopes closed
+};
+
+namespace stbi_arena_detail {
+
+const uint32_t ARENA_MAGIC = 0xA4E4A001u;
+const uint32_t HEAP_MAGIC  = 0x4EA90001u;
+const size_t   BLOCK_SIZE  = 8 * 1024 * 1024;
+
+// In front of every allocation, keeps the payload 16 byte aligned
+struct Header {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t size;
+};
+
+struct Counters {
+    std::atomic<uint64_t> arenaAllocs;
+    std::atomic<uint64_t> arenaBytes;
+    std::atomic<uint64_t> arenaBlocks;
+    std::atomic<uint64_t> heapAllocs;
+    std::atomic<uint64_t> heapFrees;
+    std::atomic<uint64_t> resets;
+
+    Counters() : arenaAllocs(0), arenaBytes(0), arenaBlocks(0), heapAllocs(0), heapFrees(0), resets(0) {}
+};
+
+inline Counters& counters()
+{
+    static Counters c;
+    return c;
+}
+
+struct Block {
+    unsigned char* base;
+    size_t capacity;
+};
+
+struct Arena {
+    std::vector<Block> blocks;
+    size_t current;             // block being bumped
+    size_t offset;              // in that block
+    Header* last;               // most recent allocation, can grow in place
+    int depth;                  // nested scopes
+
+    Arena() : current(0), offset(0), last(NULL), depth(0) {}
+    ~Arena(){
+        for (size_t i = 0; i < blocks.size(); i++)
+            free(blocks[i].base);
+    }
+
+    void* allocate(size_t size){
+        size_t need = sizeof(Header) + ((size + 15) & ~(size_t)15);
+        while (current < blocks.size() && blocks[current].capacity - offset < need)
+        {
+            current++;
+            offset = 0;
+        }
+        if (current == blocks.size())
+        {
+            Block block;
+            block.capacity = need > BLOCK_SIZE ? need : BLOCK_SIZE;
+            block.base = (unsigned char*)malloc(block.capacity);
+            if (!block.base)
+                return NULL;
+            blocks.push_back(block);
+            offset = 0;
+            counters().arenaBlocks++;
+        }
+        Header* h = (Header*)(blocks[current].base + offset);
+        h->magic = ARENA_MAGIC;
+        h->reserved = 0;
+        h->size = size;
+        offset += need;
+        last = h;
+        counters().arenaAllocs++;
+        counters().arenaBytes += size;
+        return h + 1;
+    }
+
+    // Grow the most recent allocation without moving it, if the block has room
+    bool growInPlace(Header* h, size_t size){
+        if (h != last)
+            return false;
+        size_t start = (unsigned char*)h - blocks[current].base;
+        size_t need = sizeof(Header) + ((size + 15) & ~(size_t)15);
+        if (blocks[current].capacity - start < need)
+            return false;
+        counters().arenaBytes += size > h->size ? size - h->size : 0;
+        h->size = size;
+        offset = start + need;
+        return true;
+    }
+
+    void reset(){
+        current = 0;
+        offset = 0;
+        last = NULL;
+        counters().resets++;
+    }
+};
+
+inline Arena& threadArena()
+{
+    static thread_local Arena arena;
+    return arena;
+}
+
+inline void* heapAllocate(size_t size)
+{
+    Header* h = (Header*)malloc(sizeof(Header) + size);
+    if (!h)
+        return NULL;
+    h->magic = HEAP_MAGIC;
+    h->reserved = 0;
+    h->size = size;
+    counters().heapAllocs++;
+    return h + 1;
+}
+
+} // namespace stbi_arena_detail
+
+inline void* StbiArenaMalloc(size_t size)
+{
+    stbi_arena_detail::Arena& arena = stbi_arena_detail::threadArena();
+    if (arena.depth > 0)
+        return arena.allocate(size);
+    return stbi_arena_detail::heapAllocate(size);
+}
+
+inline void StbiArenaFree(void* p)
+{
+    if (!p)
+        return;
+    stbi_arena_detail::Header* h = (stbi_arena_detail::Header*)p - 1;
+    // arena memory goes back all at once when its scope closes
+    if (h->magic == stbi_arena_detail::HEAP_MAGIC)
+    {
+        stbi_arena_detail::counters().heapFrees++;
+        free(h);
+    }
+}
+
+inline void* StbiArenaRealloc(void* p, size_t newSize)
+{
+    if (!p)
+        return StbiArenaMalloc(newSize);
+    stbi_arena_detail::Header* h = (stbi_arena_detail::Header*)p - 1;
+    if (h->magic == stbi_arena_detail::HEAP_MAGIC)
+    {
+        stbi_arena_detail::Header* grown = (stbi_arena_detail::Header*)realloc(h, sizeof(stbi_arena_detail::Header) + newSize);
+        if (!grown)
+            return NULL;
+        grown->size = newSize;
+        stbi_arena_detail::counters().heapAllocs++;
+        return grown + 1;
+    }
+    stbi_arena_detail::Arena& arena = stbi_arena_detail::threadArena();
+    if (arena.depth > 0 && arena.growInPlace(h, newSize))
+        return p;
+    void* moved = StbiArenaMalloc(newSize);
+    if (moved)
+        memcpy(moved, p, h->size < newSize ? h->size : newSize);
+    return moved;
+}
+
+/**
+ * Routes this thread's stb_image allocations to its arena while alive,
+ * and rewinds the arena when the outermost scope closes.
+ */
+class StbiArenaScope
+{
+public:
+    StbiArenaScope(){
+        stbi_arena_detail::threadArena().depth++;
+    }
+    ~StbiArenaScope(){
+        stbi_arena_detail::Arena& arena = stbi_arena_detail::threadArena();
+        if (--arena.depth == 0)
+            arena.reset();
+    }
+
+    StbiArenaScope(const StbiArenaScope&) = delete;
+    StbiArenaScope& operator=(const StbiArenaScope&) = delete;
+};
+
+inline StbiAllocStats GetStbiAllocStats()
+{
+    stbi_arena_detail::Counters& c = stbi_arena_detail::counters();
+    StbiAllocStats s;
+    s.arenaAllocs = c.arenaAllocs;
+    s.arenaBytes  = c.arenaBytes;
+    s.arenaBlocks = c.arenaBlocks;
+    s.heapAllocs  = c.heapAllocs;
+    s.heapFrees   = c.heapFrees;
+    s.resets      = c.resets;
+    return s;
+}
+
+inline void PrintStbiAllocStats()
+{
+    StbiAllocStats s = GetStbiAllocStats();
+    std::cout << "stb_image allocations: " << s.arenaAllocs << " arena (" << s.arenaBytes / 1024 << " KB, "
+              << s.arenaBlocks << " blocks, " << s.resets << " resets), "
+              << s.heapAllocs << " malloc, " << s.heapFrees << " free" << std::endl;
+}
+
+#define STBI_MALLOC(sz)     StbiArenaMalloc(sz)
+#define STBI_REALLOC(p, sz) StbiArenaRealloc(p, sz)
+#define STBI_FREE(p)        StbiArenaFree(p)
+#endif
@@ -0,0 +1,172 @@
+#ifndef TEXARRAY_H
+#define TEXARRAY_H
+
+#include <glad/glad.h>
+
+#include <texture/mipgen.h>
+#include <texture/imagedecode.h>
+#include <texture/stbi_arena.h>
+#include <profiling/trace.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+/**
+ * Packs same sized images into the layers of one GL_TEXTURE_2D_ARRAY.
+ *
+ * Every material gets a layer index that goes to the shader (per instance
+ * or per vertex) next to its UVs, so a whole scene samples one texture
+ * object: one bind, and draws with different materials can be merged.
+ */
+class TextureArrayBuilder
+{
+public:
+
+    TextureArrayBuilder() : width(0), height(0), channels(0) {}
+
+    /**
+     * @brief      Add a layer from memory
+     *
+     * The first image fixes size and channel count, later ones must match.
+     * Grey and grey + alpha images are stored as RGB and RGBA.
+     *
+     * @param      name      material name, used by Layer()
+     * @param      texels    width * height * channels bytes
+     *
+     * @return     the layer index, -1 if the image does not fit the array
+     */
+    int Add(const std::string& name, const unsigned char* texels, unsigned int w, unsigned int h, unsigned int c){
+        std::map<std::string, int>::const_iterator it = layers.find(name);
+        if (it != layers.end())
+            return it->second;
+        if (c < 1 || c > 4)
+        {
+            std::cout << "ERROR::TEXARRAY::UNSUPPORTED_CHANNELS " << name << " has " << c << std::endl;
+            return -1;
+        }
+        unsigned int stored = c < 3 ? c + 2 : c;
+        if (images.empty())
+        {
+            width = w;
+            height = h;
+            channels = stored;
+        }
+        else if (w != width || h != height || stored != channels)
+        {
+            std::cout << "ERROR::TEXARRAY::LAYER_MISMATCH " << name << " is " << w << "x" << h << "x" << stored
+                      << ", array is " << width << "x" << height << "x" << channels << std::endl;
+            return -1;
+        }
+        if (c == stored)
+            images.push_back(std::vector<unsigned char>(texels, texels + (size_t)w * h * c));
+        else
+        {
+            // grey to RGB, alpha kept last
+            std::vector<unsigned char> expanded((size_t)w * h * stored);
+            for (size_t i = 0; i < (size_t)w * h; i++)
+            {
+                const unsigned char* src = texels + i * c;
+                unsigned char* dst = expanded.data() + i * stored;
+                dst[0] = dst[1] = dst[2] = src[0];
+                if (c == 2)
+                    dst[3] = src[1];
+            }
+            images.push_back(std::move(expanded));
+        }
+        int layer = (int)images.size() - 1;
+        layers[name] = layer;
+        return layer;
+    }
+
+    /**
+     * @brief      Add a layer from an image file, named after its path
+     *
+     * @return     the layer index, -1 on failure
+     */
+    int AddFile(const std::string& path){
+        TRACE_SCOPE("TextureArrayBuilder::AddFile");
+        // once the array format is known, decode to that channel count;
+        // Add() copies the pixels, so they can live in the arena
+        StbiArenaScope arena;
+        DecodedImage image;
+        if (!DecodeImageFile(path, channels, image))
+        {
+            std::cout << "Failed to load texture " << path << std::endl;
+            return -1;
+        }
+        int layer = Add(path, image.pixels, image.width, image.height, image.channels);
+        FreeDecodedImage(image);
+        return layer;
+    }
+
+    /**
+     * @brief      Layer index of a material added earlier, -1 if unknown
+     */
+    int Layer(const std::string& name) const {
+        std::map<std::string, int>::const_iterator it = layers.find(name);
+        return it == layers.end() ? -1 : it->second;
+    }
+
+    unsigned int LayerCount() const { return (unsigned int)images.size(); }
+
+    /**
+     * @brief      Create the array texture with a full mip chain per layer
+     *
+     * @param      filter  mip filter, see texture/mipgen.h
+     * @param      srgb    store as sRGB and filter in linear light
+     *
+     * @return     the GL_TEXTURE_2D_ARRAY object, 0 if no layer was added
+     */
+    unsigned int Build(MipFilter filter = MIP_FILTER_BOX, bool srgb = false) const {
+        TRACE_SCOPE("TextureArrayBuilder::Build");
+        if (images.empty())
+            return 0;
+        GLenum dataFormat = channels == 4 ? GL_RGBA : GL_RGB;
+        GLenum internalFormat = channels == 4 ? (srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8) : (srgb ? GL_SRGB8 : GL_RGB8);
+
+        std::vector<std::vector<TexPackImage> > chains(images.size());
+        for (size_t i = 0; i < images.size(); i++)
+            chains[i] = GenerateMipChain(images[i].data(), width, height, channels, filter, srgb);
+        GLsizei levelCount = (GLsizei)chains[0].size();
+
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        // allocate every level for all layers (glTexStorage3D needs 4.2, we ask for 3.3), then fill it in
+        for (GLsizei level = 0; level < levelCount; level++)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, chains[0][level].width, chains[0][level].height,
+                         (GLsizei)images.size(), 0, dataFormat, GL_UNSIGNED_BYTE, NULL);
+
+        GLint oldAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t layer = 0; layer < chains.size(); layer++)
+        {
+            for (GLsizei level = 0; level < levelCount; level++)
+            {
+                const TexPackImage& img = chains[layer][level];
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, (GLint)layer, img.width, img.height, 1,
+                                dataFormat, GL_UNSIGNED_BYTE, img.texels.data());
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+        return texture;
+    }
+
+private:
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int channels;
+    std::vector<std::vector<unsigned char> > images;
+    std::map<std::string, int> layers;
+};
+#endif
@@ -0,0 +1,238 @@
+#ifndef TEXCACHE_H
+#define TEXCACHE_H
+
+#include <glad/glad.h>
+
+#include <texture/texupload.h>
+#include <texture/mipgen.h>
+#include <texture/imagedecode.h>
+#include <texture/assetpack.h>
+#include <texture/stbi_arena.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <iostream>
+
+// How a texture is built from its file, part of the cache key
+struct TextureParams {
+    bool srgb;
+    MipFilter filter;
+
+    TextureParams(bool srgb = false, MipFilter filter = MIP_FILTER_BOX) : srgb(srgb), filter(filter) {}
+};
+
+/**
+ * Owns GL textures loaded from disk.
+ *
+ * Entries are keyed by path + params and reference counted: Acquire()
+ * returns the same texture object to every user and Release() drops a
+ * reference. Unreferenced entries stay resident (a later Acquire is a
+ * hit, no reload) until the resident size goes over the budget, then the
+ * least recently released ones are deleted first. Referenced textures are
+ * never evicted, so the budget can be exceeded while everything is in use.
+ *
+ * A "foo.jpg" request is served from "foo.gtex" when a baked version
+ * exists next to it (see textureBaker) and was baked with the same
+ * params (its sRGB and Kaiser flags), then from the asset pack set with
+ * SetAssetPack() if it holds "foo.jpg" (see assetPacker), and only then
+ * from the file itself.
+ *
+ * Whatever is still resident is deleted with the cache, so it must be
+ * destroyed while the GL context exists.
+ */
+class TextureCache
+{
+public:
+
+    struct Stats {
+        size_t residentBytes;
+        size_t budgetBytes;
+        size_t entries;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+
+        double HitRate() const {
+            uint64_t total = hits + misses;
+            return total ? (double)hits / (double)total : 0.0;
+        }
+    };
+
+    explicit TextureCache(size_t budgetBytes) : pack(NULL) {
+        stats.residentBytes = 0;
+        stats.budgetBytes = budgetBytes;
+        stats.entries = 0;
+        stats.hits = 0;
+        stats.misses = 0;
+        stats.evictions = 0;
+    }
+    ~TextureCache(){
+        for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            glDeleteTextures(1, &it->second.texture);
+    }
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    /**
+     * @brief      Get a texture, loading it on a miss
+     *
+     * @param      path    image file
+     * @param      params  how to build it
+     *
+     * @return     the texture object (one reference taken), 0 if loading failed
+     */
+    unsigned int Acquire(const std::string& path, const TextureParams& params = TextureParams()){
+        std::string key = makeKey(path, params);
+        std::map<std::string, Entry>::iterator it = entries.find(key);
+        if (it != entries.end())
+        {
+            stats.hits++;
+            Entry& entry = it->second;
+            if (entry.refCount++ == 0)
+                lru.erase(entry.lruPos);
+            return entry.texture;
+        }
+
+        stats.misses++;
+        Entry entry;
+        entry.bytes = 0;
+        entry.texture = load(path, params, entry.bytes);
+        if (!entry.texture)
+            return 0;
+        entry.refCount = 1;
+        entries[key] = entry;
+        byTexture[entry.texture] = key;
+        stats.residentBytes += entry.bytes;
+        stats.entries = entries.size();
+        evict();
+        return entry.texture;
+    }
+
+    /**
+     * @brief      Drop a reference taken by Acquire()
+     */
+    void Release(unsigned int texture){
+        std::map<unsigned int, std::string>::iterator owner = byTexture.find(texture);
+        if (owner == byTexture.end())
+            return;
+        Entry& entry = entries[owner->second];
+        if (entry.refCount == 0)
+            return;
+        if (--entry.refCount == 0)
+        {
+            lru.push_front(owner->second);
+            entry.lruPos = lru.begin();
+            evict();
+        }
+    }
+
+    /**
+     * @brief      Change the budget, evicting right away if needed
+     */
+    void SetBudget(size_t budgetBytes){
+        stats.budgetBytes = budgetBytes;
+        evict();
+    }
+
+    /**
+     * @brief      Serve image files from a pack, NULL to stop
+     *
+     * The pack must outlive the cache (or the next SetAssetPack call).
+     */
+    void SetAssetPack(const AssetPack* assetPack){
+        pack = assetPack;
+    }
+
+    const Stats& GetStats() const { return stats; }
+
+    void PrintStats() const {
+        std::cout << "TextureCache: " << stats.entries << " entries, "
+                  << stats.residentBytes / 1024 << " KB resident of " << stats.budgetBytes / 1024 << " KB, "
+                  << "hit rate " << stats.HitRate() * 100.0 << "% (" << stats.hits << "/" << stats.hits + stats.misses << "), "
+                  << stats.evictions << " evictions" << std::endl;
+    }
+
+private:
+
+    struct Entry {
+        unsigned int texture;
+        size_t bytes;
+        unsigned int refCount;
+        std::list<std::string>::iterator lruPos;    // valid while refCount == 0
+    };
+
+    Stats stats;
+    std::map<std::string, Entry> entries;
+    std::map<unsigned int, std::string> byTexture;
+    std::list<std::string> lru;                     // unreferenced keys, most recently released first
+    const AssetPack* pack;
+
+    static std::string makeKey(const std::string& path, const TextureParams& params){
+        return path + (params.srgb ? "|srgb" : "|linear") + (params.filter == MIP_FILTER_KAISER ? "|kaiser" : "|box");
+    }
+
+    void evict(){
+        while (stats.residentBytes > stats.budgetBytes && !lru.empty())
+        {
+            std::map<std::string, Entry>::iterator it = entries.find(lru.back());
+            lru.pop_back();
+            glDeleteTextures(1, &it->second.texture);
+            byTexture.erase(it->second.texture);
+            stats.residentBytes -= it->second.bytes;
+            stats.evictions++;
+            entries.erase(it);
+        }
+        stats.entries = entries.size();
+    }
+
+    unsigned int load(const std::string& path, const TextureParams& params, size_t& bytes){
+        TRACE_SCOPE("TextureCache::load");
+        // the extension of the file name, not a dot in a directory name
+        size_t slash = path.find_last_of('/');
+        size_t dot = path.find_last_of('.');
+        std::string bakedPath = (dot != std::string::npos && (slash == std::string::npos || dot > slash) ? path.substr(0, dot) : path) + ".gtex";
+        if (access(bakedPath.c_str(), R_OK) == 0)
+        {
+            TexPack baked;
+            if (baked.Open(bakedPath.c_str()))
+            {
+                // the key promises these params, a pack baked with others would hand out the wrong texels
+                bool kaiser = params.filter == MIP_FILTER_KAISER;
+                if (baked.IsSRGB() == params.srgb && baked.IsKaiser() == kaiser)
+                {
+                    // charged what GL holds: RGBA8 when the blocks had to be decompressed
+                    size_t uploaded = 0;
+                    unsigned int texture = UploadTexPack(baked, &uploaded);
+                    if (texture)
+                    {
+                        bytes += uploaded;
+                        return texture;
+                    }
+                    // otherwise build it from the source image below
+                }
+            }
+        }
+
+        // decode scratch and pixels live in this thread's arena until the mips are built
+        StbiArenaScope arena;
+        DecodedImage image;
+        EncodedImage packed;
+        bool decoded = pack && pack->Find(path, packed) ? DecodeImage(packed, 0, image) : DecodeImageFile(path, 0, image);
+        if (!decoded)
+        {
+            std::cout << "Failed to load texture " << path << std::endl;
+            return 0;
+        }
+        std::vector<TexPackImage> levels = GenerateMipChain(image.pixels, image.width, image.height, image.channels, params.filter, params.srgb);
+        FreeDecodedImage(image);
+        for (size_t i = 0; i < levels.size(); i++)
+            bytes += levels[i].texels.size();
+        return UploadMipChain(levels, image.channels, params.srgb);
+    }
+};
+#endif
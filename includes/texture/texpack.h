@@ -0,0 +1,229 @@
+#ifndef TEXPACK_H
+#define TEXPACK_H
+
+#include <texture/mapped_file.h>
+#include <texture/bcn.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+/**
+ * ".gtex" baked texture container
+ *
+ * Layout (all little endian):
+ *   TexPackHeader
+ *   TexPackLevel[levelCount]      level 0 is the full resolution image
+ *   texel data, every level starting on a TEXPACK_ALIGN boundary
+ *
+ * Texels are stored exactly as glTexImage2D / glCompressedTexImage2D
+ * expect them (rows tightly packed, first row is the first row of the
+ * source image), or as BC1/BC3 blocks for the compressed formats, so the
+ * loader can hand the mapped bytes to GL as-is.
+ */
+
+#define TEXPACK_MAGIC   "GTEX"
+#define TEXPACK_VERSION 1
+#define TEXPACK_ALIGN   16
+
+// Texel formats a pack can hold
+enum TexPackFormat {
+    TEXPACK_RGB8  = 0,
+    TEXPACK_RGBA8 = 1,
+    TEXPACK_BC1   = 2,     // see texture/bcn.h
+    TEXPACK_BC3   = 3
+};
+
+// Header flags
+enum TexPackFlags {
+    TEXPACK_FLAG_SRGB   = 1 << 0,
+    TEXPACK_FLAG_KAISER = 1 << 1      // mips built with MIP_FILTER_KAISER, box otherwise
+};
+
+struct TexPackHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct TexPackLevel {
+    uint64_t offset;    // from the start of the file
+    uint64_t size;      // in bytes
+    uint32_t width;
+    uint32_t height;
+};
+
+// One mip level handed to the writer
+struct TexPackImage {
+    unsigned int width;
+    unsigned int height;
+    std::vector<unsigned char> texels;
+};
+
+/**
+ * @brief      Whether levels hold 4x4 compressed blocks instead of texels
+ */
+inline bool TexPackIsCompressed(uint32_t format)
+{
+    return format == TEXPACK_BC1 || format == TEXPACK_BC3;
+}
+
+/**
+ * @brief      Bytes per texel of an uncompressed format
+ */
+inline unsigned int TexPackBytesPerTexel(uint32_t format)
+{
+    return format == TEXPACK_RGBA8 ? 4 : 3;
+}
+
+/**
+ * @brief      Bytes a level of this format and size needs: texels, or BC blocks
+ */
+inline uint64_t TexPackLevelBytes(uint32_t format, uint32_t width, uint32_t height)
+{
+    if (TexPackIsCompressed(format))
+        return BCImageSize(format == TEXPACK_BC1 ? BC_FORMAT_BC1 : BC_FORMAT_BC3, width, height);
+    return (uint64_t)width * height * TexPackBytesPerTexel(format);
+}
+
+/**
+ * @brief      Write a mip chain into a .gtex file
+ *
+ * @param      path    destination file
+ * @param      format  one of TexPackFormat
+ * @param      flags   TexPackFlags bits
+ * @param      levels  level 0 first, each level half the previous one
+ *
+ * @return     true on success
+ */
+inline bool WriteTexPack(const char* path, uint32_t format, uint32_t flags, const std::vector<TexPackImage>& levels)
+{
+    if (levels.empty())
+        return false;
+
+    TexPackHeader header;
+    memcpy(header.magic, TEXPACK_MAGIC, 4);
+    header.version    = TEXPACK_VERSION;
+    header.format     = format;
+    header.flags      = flags;
+    header.width      = levels[0].width;
+    header.height     = levels[0].height;
+    header.levelCount = (uint32_t)levels.size();
+    header.reserved   = 0;
+
+    std::vector<TexPackLevel> table(levels.size());
+    uint64_t offset = sizeof(TexPackHeader) + sizeof(TexPackLevel) * levels.size();
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        offset = (offset + TEXPACK_ALIGN - 1) & ~(uint64_t)(TEXPACK_ALIGN - 1);
+        table[i].offset = offset;
+        table[i].size   = levels[i].texels.size();
+        table[i].width  = levels[i].width;
+        table[i].height = levels[i].height;
+        offset += table[i].size;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f)
+    {
+        std::cout << "ERROR::TEXPACK::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(table.data(), sizeof(TexPackLevel), table.size(), f) == table.size();
+    static const unsigned char zeros[TEXPACK_ALIGN] = {0};
+    for (size_t i = 0; ok && i < levels.size(); i++)
+    {
+        long pad = (long)table[i].offset - ftell(f);
+        ok = pad >= 0 && fwrite(zeros, 1, (size_t)pad, f) == (size_t)pad;
+        ok = ok && fwrite(levels[i].texels.data(), 1, levels[i].texels.size(), f) == levels[i].texels.size();
+    }
+    fclose(f);
+    if (!ok)
+        std::cout << "ERROR::TEXPACK::SHORT_WRITE " << path << std::endl;
+    return ok;
+}
+
+/**
+ * Read side of a .gtex file. The file is mmap'ed and validated once;
+ * level pointers point into the mapping and stay valid while the
+ * TexPack is alive.
+ */
+class TexPack
+{
+public:
+
+    /**
+     * @brief      Map and validate a .gtex file
+     *
+     * @param      path  the file to open
+     *
+     * @return     true if the file is a well formed pack
+     */
+    bool Open(const char* path){
+        if (!file.Open(path))
+            return false;
+        if (file.size() < sizeof(TexPackHeader))
+            return fail(path, "TRUNCATED_HEADER");
+
+        header = (const TexPackHeader*)file.data();
+        if (memcmp(header->magic, TEXPACK_MAGIC, 4) != 0)
+            return fail(path, "BAD_MAGIC");
+        if (header->version != TEXPACK_VERSION)
+            return fail(path, "UNSUPPORTED_VERSION");
+        if (header->format > TEXPACK_BC3)
+            return fail(path, "UNKNOWN_FORMAT");
+        if (header->width == 0 || header->height == 0)
+            return fail(path, "BAD_SIZE");
+        if (header->levelCount == 0 || header->levelCount > 32)
+            return fail(path, "BAD_LEVEL_COUNT");
+        if (file.size() < sizeof(TexPackHeader) + sizeof(TexPackLevel) * header->levelCount)
+            return fail(path, "TRUNCATED_LEVEL_TABLE");
+
+        levels = (const TexPackLevel*)(file.data() + sizeof(TexPackHeader));
+        // every level half the previous one, level 0 the header's size, and big enough for its texels:
+        // the upload hands width, height and the mapped bytes to GL as they are
+        uint32_t width = header->width, height = header->height;
+        for (uint32_t i = 0; i < header->levelCount; i++)
+        {
+            if (levels[i].width != width || levels[i].height != height)
+                return fail(path, "BAD_MIP_CHAIN");
+            if (levels[i].size < TexPackLevelBytes(header->format, width, height))
+                return fail(path, "LEVEL_TOO_SMALL");
+            if (levels[i].offset > file.size() || levels[i].size > file.size() - levels[i].offset)
+                return fail(path, "LEVEL_OUT_OF_BOUNDS");
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        return true;
+    }
+
+    const TexPackHeader& Header() const { return *header; }
+    unsigned int LevelCount() const { return header->levelCount; }
+    const TexPackLevel& Level(unsigned int i) const { return levels[i]; }
+    const unsigned char* LevelData(unsigned int i) const { return file.data() + levels[i].offset; }
+    bool IsSRGB() const { return (header->flags & TEXPACK_FLAG_SRGB) != 0; }
+    bool IsKaiser() const { return (header->flags & TEXPACK_FLAG_KAISER) != 0; }
+
+private:
+
+    MappedFile file;
+    const TexPackHeader* header = NULL;
+    const TexPackLevel* levels = NULL;
+
+    bool fail(const char* path, const char* what){
+        std::cout << "ERROR::TEXPACK::" << what << " " << path << std::endl;
+        file.Close();
+        header = NULL;
+        levels = NULL;
+        return false;
+    }
+};
+#endif
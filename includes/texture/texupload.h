@@ -0,0 +1,206 @@
+#ifndef TEXUPLOAD_H
+#define TEXUPLOAD_H
+
+#include <glad/glad.h>
+
+#include <texture/texpack.h>
+#include <texture/bcn.h>
+#include <profiling/trace.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// S3TC tokens, glad was generated for core 4.6 without extensions
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT         0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT        0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT        0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT  0x8C4F
+#endif
+
+/**
+ * @brief      Look up an extension in the current context
+ *
+ * @param      name  e.g. "GL_EXT_texture_compression_s3tc"
+ */
+inline bool HasGLExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (ext && strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief      Create and bind a GL_TEXTURE_2D that will receive levelCount levels
+ *
+ * Repeat wrapping and trilinear filtering when there is a mip chain, the
+ * sampler settings every sample uses.
+ */
+inline unsigned int CreateMippedTexture2D(unsigned int levelCount)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+    return texture;
+}
+
+/**
+ * @brief      Upload every level of a baked texture into a new GL_TEXTURE_2D
+ *
+ * Texels are read directly from the pack's file mapping, there is no
+ * decode and no staging copy on our side; mips come from the file so
+ * glGenerateMipmap is not needed. BC1/BC3 packs go through
+ * glCompressedTexImage2D when GL_EXT_texture_compression_s3tc is present
+ * (and, for sRGB packs, GL_EXT_texture_sRGB or
+ * GL_EXT_texture_compression_s3tc_srgb) and are decompressed on the CPU
+ * otherwise. GL is handed the byte count each level's size and format
+ * need, never the one stored in the file.
+ *
+ * @param      pack           an opened TexPack
+ * @param      uploadedBytes  if not NULL, gets the bytes handed to GL: the
+ *                            decompressed RGBA8 size when S3TC is missing
+ *
+ * @return     the texture object, 0 on failure
+ */
+inline unsigned int UploadTexPack(const TexPack& pack, size_t* uploadedBytes = NULL)
+{
+    TRACE_FUNCTION();
+    const TexPackHeader& h = pack.Header();
+    GLenum dataFormat = GL_RGBA;
+    GLenum internalFormat;
+    bool decompress = false;
+    switch (h.format)
+    {
+    case TEXPACK_RGB8:
+        dataFormat = GL_RGB;
+        internalFormat = pack.IsSRGB() ? GL_SRGB8 : GL_RGB8;
+        break;
+    case TEXPACK_RGBA8:
+        dataFormat = GL_RGBA;
+        internalFormat = pack.IsSRGB() ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        break;
+    case TEXPACK_BC1:
+    case TEXPACK_BC3:
+        if (HasGLExtension("GL_EXT_texture_compression_s3tc") &&
+            (!pack.IsSRGB() || HasGLExtension("GL_EXT_texture_sRGB") || HasGLExtension("GL_EXT_texture_compression_s3tc_srgb")))
+        {
+            if (h.format == TEXPACK_BC1)
+                internalFormat = pack.IsSRGB() ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            else
+                internalFormat = pack.IsSRGB() ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        }
+        else
+        {
+            std::cout << "WARNING::TEXPACK::" << (pack.IsSRGB() ? "NO_SRGB_S3TC" : "NO_S3TC") << " decompressing on the CPU" << std::endl;
+            decompress = true;
+            internalFormat = pack.IsSRGB() ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        }
+        break;
+    default:
+        std::cout << "ERROR::TEXPACK::UNKNOWN_FORMAT " << h.format << std::endl;
+        return 0;
+    }
+
+    // a level shorter than its size and format need would make GL read past the mapping
+    for (unsigned int i = 0; i < pack.LevelCount(); i++)
+    {
+        const TexPackLevel& level = pack.Level(i);
+        if (level.size < TexPackLevelBytes(h.format, level.width, level.height))
+        {
+            std::cout << "ERROR::TEXPACK::LEVEL_TOO_SMALL level " << i << std::endl;
+            return 0;
+        }
+    }
+
+    unsigned int texture = CreateMippedTexture2D(pack.LevelCount());
+    size_t bytes = 0;
+
+    // RGB rows are tightly packed in the file, not 4 byte aligned
+    GLint oldAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int i = 0; i < pack.LevelCount(); i++)
+    {
+        const TexPackLevel& level = pack.Level(i);
+        if (decompress)
+        {
+            BCFormat bc = h.format == TEXPACK_BC1 ? BC_FORMAT_BC1 : BC_FORMAT_BC3;
+            std::vector<unsigned char> rgba = DecodeBC(bc, pack.LevelData(i), level.width, level.height);
+            bytes += rgba.size();
+            glTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        }
+        else if (TexPackIsCompressed(h.format))
+        {
+            bytes += TexPackLevelBytes(h.format, level.width, level.height);
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0,
+                                   (GLsizei)TexPackLevelBytes(h.format, level.width, level.height), pack.LevelData(i));
+        }
+        else
+        {
+            bytes += TexPackLevelBytes(h.format, level.width, level.height);
+            glTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0, dataFormat, GL_UNSIGNED_BYTE, pack.LevelData(i));
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+    if (uploadedBytes)
+        *uploadedBytes = bytes;
+    return texture;
+}
+
+/**
+ * @brief      Map a .gtex file and upload it
+ *
+ * @param      path  the baked texture
+ *
+ * @return     the texture object, 0 if the file is missing or invalid
+ */
+inline unsigned int LoadTexPack(const char* path)
+{
+    TexPack pack;
+    if (!pack.Open(path))
+        return 0;
+    return UploadTexPack(pack);
+}
+
+/**
+ * @brief      Upload a CPU generated mip chain (see texture/mipgen.h)
+ *
+ * @param      levels    level 0 first
+ * @param      channels  3 or 4
+ * @param      srgb      store as GL_SRGB8 / GL_SRGB8_ALPHA8
+ *
+ * @return     the texture object, 0 if there is nothing to upload
+ */
+inline unsigned int UploadMipChain(const std::vector<TexPackImage>& levels, unsigned int channels, bool srgb)
+{
+    TRACE_FUNCTION();
+    if (levels.empty())
+        return 0;
+    GLenum dataFormat = channels == 4 ? GL_RGBA : GL_RGB;
+    GLenum internalFormat = channels == 4 ? (srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8) : (srgb ? GL_SRGB8 : GL_RGB8);
+
+    unsigned int texture = CreateMippedTexture2D((unsigned int)levels.size());
+    GLint oldAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = 0; i < levels.size(); i++)
+        glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, levels[i].width, levels[i].height, 0, dataFormat, GL_UNSIGNED_BYTE, levels[i].texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+    return texture;
+}
+#endif
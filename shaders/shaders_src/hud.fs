@@ -0,0 +1,13 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+
+// glyph atlas, one channel of coverage; quads without text sample a solid texel
+uniform sampler2D glyphs;
+
+void main(){
+	FragColor = vec4(Color.rgb, Color.a * texture(glyphs, TexCoord).r);
+}
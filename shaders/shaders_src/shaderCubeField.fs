@@ -0,0 +1,16 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec3 TexCoord;
+
+// every material of the scene lives in one layer of this array
+uniform sampler2DArray ourTextures;
+
+void main(){
+
+	/**
+	 * the third coordinate selects the layer, it is not filtered
+	 */
+	FragColor = texture(ourTextures, TexCoord);
+}
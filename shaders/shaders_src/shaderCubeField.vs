@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per instance: model matrix (takes locations 2..5) and texture array layer
+layout (location = 2) in mat4 aModel;
+layout (location = 6) in float aLayer;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 TexCoord;
+
+// matches the depth prepass (shaderDepth.vs) exactly, for its GL_EQUAL test
+invariant gl_Position;
+
+void main()
+{
+	gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+	TexCoord = vec3(aTexCoord, aLayer);
+}
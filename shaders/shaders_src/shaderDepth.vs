@@ -0,0 +1,15 @@
+#version 330 core
+// depth prepass: positions only, per instance model matrix (takes locations 2..5) as in shaderCubeField.vs
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in mat4 aModel;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// the color pass tests GL_EQUAL against this depth, both shaders compute it the same way
+invariant gl_Position;
+
+void main()
+{
+	gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+
+// object id + 1 into the R32UI target, 0 is left for nothing
+out uint PickId;
+
+flat in uint Id;
+
+void main(){
+	PickId = Id + 1u;
+}
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+// per instance: model matrix (takes locations 2..5) and object id, as in shaderCubeField.vs
+layout (location = 2) in mat4 aModel;
+layout (location = 7) in uint aId;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+flat out uint Id;
+
+void main()
+{
+	gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+	Id = aId;
+}
@@ -0,0 +1,128 @@
+/**
+ * Offline texture baker
+ *
+ * Decodes an image once with stb_image, builds the whole mip chain on the
+ * CPU (texture/mipgen.h, filtered in linear light with -srgb) and writes
+ * it to a .gtex container (see texture/texpack.h) that the samples mmap
+ * and upload as-is at startup.
+ *
+ * Usage: bakerBin [-srgb] [-rgba] [-kaiser] [-bc1|-bc3] [-threads N] <input image> <output.gtex>
+ *
+ * With -bc1/-bc3 every level is block compressed (texture/bcn.h) and the
+ * encoder's PSNR and throughput are reported.
+ */
+#include <texture/stbi_arena.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <texture/texpack.h>
+#include <texture/bcn.h>
+#include <texture/mipgen.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+void usage()
+{
+    std::cout << "Usage: bakerBin [-srgb] [-rgba] [-kaiser] [-bc1|-bc3] [-threads N] <input image> <output.gtex>" << std::endl;
+}
+
+int main(int argc, char const *argv[])
+{
+    uint32_t flags = 0;
+    uint32_t format = TEXPACK_RGB8;
+    unsigned int threads = 0;
+    MipFilter filter = MIP_FILTER_BOX;
+    const char* input = NULL;
+    const char* output = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-srgb") == 0)
+            flags |= TEXPACK_FLAG_SRGB;
+        else if (strcmp(argv[i], "-rgba") == 0)
+            format = TEXPACK_RGBA8;
+        else if (strcmp(argv[i], "-kaiser") == 0)
+        {
+            filter = MIP_FILTER_KAISER;
+            flags |= TEXPACK_FLAG_KAISER;
+        }
+        else if (strcmp(argv[i], "-bc1") == 0)
+            format = TEXPACK_BC1;
+        else if (strcmp(argv[i], "-bc3") == 0)
+            format = TEXPACK_BC3;
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+            threads = (unsigned int)atoi(argv[++i]);
+        else if (!input)
+            input = argv[i];
+        else if (!output)
+            output = argv[i];
+        else
+        {
+            usage();
+            return -1;
+        }
+    }
+    if (!input || !output)
+    {
+        usage();
+        return -1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // the block encoder always works on RGBA
+    bool compressed = TexPackIsCompressed(format);
+    unsigned int channels = compressed ? 4 : TexPackBytesPerTexel(format);
+    int width, height, nrChannels;
+    std::vector<TexPackImage> levels;
+    {
+        StbiArenaScope arena;
+        unsigned char *data = stbi_load(input, &width, &height, &nrChannels, channels);
+        if (!data)
+        {
+            std::cout << "Failed to load texture " << input << ": " << stbi_failure_reason() << std::endl;
+            return -1;
+        }
+        levels = GenerateMipChain(data, width, height, channels, filter, (flags & TEXPACK_FLAG_SRGB) != 0);
+        stbi_image_free(data);
+    }
+
+    if (compressed)
+    {
+        BCFormat bc = format == TEXPACK_BC1 ? BC_FORMAT_BC1 : BC_FORMAT_BC3;
+        size_t texels = 0;
+        double encodeMs = 0.0;
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            TexPackImage& level = levels[i];
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            std::vector<unsigned char> blocks = EncodeBC(bc, level.texels.data(), level.width, level.height, threads);
+            encodeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            texels += (size_t)level.width * level.height;
+
+            if (i == 0)
+            {
+                std::vector<unsigned char> decoded = DecodeBC(bc, blocks.data(), level.width, level.height);
+                std::cout << "PSNR (level 0): " << ImagePSNR(level.texels.data(), decoded.data(), level.width, level.height, bc == BC_FORMAT_BC3) << " dB" << std::endl;
+            }
+            level.texels.swap(blocks);
+        }
+        std::cout << "Encoded " << texels << " texels in " << encodeMs << " ms ("
+                  << (encodeMs > 0.0 ? texels / (encodeMs * 1000.0) : 0.0) << " Mtexel/s)" << std::endl;
+    }
+
+    if (!WriteTexPack(output, format, flags, levels))
+        return -1;
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < levels.size(); i++)
+        bytes += levels[i].texels.size();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << input << " -> " << output << ": " << width << "x" << height
+              << ", " << levels.size() << " levels, " << bytes << " bytes, " << ms << " ms" << std::endl;
+    return 0;
+}